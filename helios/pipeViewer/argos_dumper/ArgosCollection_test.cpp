@@ -12,6 +12,16 @@
 #include "sparta/events/StartupEvent.hpp"
 
 #include "sparta/log/Tap.hpp"
+#include "sparta/pairs/SpartaKeyPairs.hpp"
+
+#include "transactiondb/src/Reader.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <sys/stat.h>
 
 TEST_INIT;
 
@@ -27,6 +37,42 @@ std::ostream & operator<<(std::ostream & os, const DummyObject & dumb) {
     return os;
 }
 
+// A pair collected object, so that the pipeout has pair records
+class PacketPairDef;
+class Packet
+{
+public:
+    using SpartaPairDefinitionType = PacketPairDef;
+    enum class Unit : std::uint8_t { ALU, FPU, LSU };
+
+    Packet(uint64_t uid, Unit unit) : uid_(uid), unit_(unit) {}
+    uint64_t getUid() const { return uid_; }
+    Unit getUnit() const { return unit_; }
+
+private:
+    uint64_t uid_;
+    Unit unit_;
+};
+
+std::ostream & operator<<(std::ostream & os, const Packet::Unit & unit) {
+    switch(unit) {
+        case Packet::Unit::ALU: os << "ALU"; break;
+        case Packet::Unit::FPU: os << "FPU"; break;
+        case Packet::Unit::LSU: os << "LSU"; break;
+    }
+    return os;
+}
+
+class PacketPairDef : public sparta::PairDefinition<Packet>
+{
+public:
+    PacketPairDef() : PairDefinition<Packet>() {
+        SPARTA_INVOKE_PAIRS(Packet);
+    }
+    SPARTA_REGISTER_PAIRS(SPARTA_ADDPAIR("uid", &Packet::getUid),
+                          SPARTA_ADDPAIR("unit", &Packet::getUnit))
+};
+
 class ObjectClk : public sparta::TreeNode
 {
 public:
@@ -37,6 +83,7 @@ public:
         pc1_always_close_(this, name + "0_int_manual_collectable_will_close"),
         pc2_(this, name + "1_int_local_collectable", &pc2_var),
         pc3_(this, name + "2_dummy_collectable", &pc3_dummy),
+        pc4_(this, name + "3_pair_collectable"),
         es_(this),
         ev_update_(&es_, "update", CREATE_SPARTA_HANDLER(ObjectClk, updateCollectables))
     {
@@ -62,6 +109,7 @@ public:
         std::stringstream ss;
         ss << pc3_dummy.msg << " " << pc2_var;
         pc3_dummy.msg = ss.str();
+        pc4_.collect(Packet(pc2_var, static_cast<Packet::Unit>(pc2_var % 3)));
         ev_update_.schedule(1);
     }
 
@@ -72,13 +120,76 @@ private:
     sparta::collection::Collectable<uint64_t>    pc1_always_close_;
     sparta::collection::Collectable<uint64_t>    pc2_;
     sparta::collection::Collectable<DummyObject> pc3_;
+    sparta::collection::Collectable<Packet>      pc4_;
     sparta::EventSet es_;
     sparta::Event<sparta::SchedulingPhase::Update> ev_update_;
     uint32_t toggle = 0;
 };
 
 
-int main()
+// Records everything a Reader finds, as text.  Locations are recorded
+// by name since their ids differ from one collection to the next.
+class RecordingCallback : public sparta::pipeViewer::PipelineDataCallback
+{
+public:
+    explicit RecordingCallback(const std::string & prefix)
+    {
+        std::ifstream location_file(prefix + "location.dat");
+        std::string line;
+        std::getline(location_file, line); // Version
+        while(std::getline(location_file, line)) {
+            const auto name_start = line.find(',') + 1;
+            const auto name_end = line.find(',', name_start);
+            locations_[std::stoul(line.substr(0, name_start - 1))] = line.substr(name_start, name_end - name_start);
+        }
+    }
+
+    void foundInstRecord(const instruction_t* r) override { record(r); }
+    void foundMemRecord(const memoryoperation_t* r) override { record(r); }
+    void foundAnnotationRecord(const annotation_t* r) override {
+        record(r);
+        out << r->annt << '\n';
+    }
+    void foundPairRecord(const pair_t* r) override {
+        record(r);
+        for(const auto & str : r->stringVector) {
+            out << str << ' ';
+        }
+        out << '\n';
+    }
+
+    std::ostringstream out;
+    uint64_t num_records = 0;
+
+private:
+    void record(const transaction_t* r) {
+        out << r->transaction_ID << ' ' << locations_.at(r->location_ID) << ' ' << r->time_Start << ' '
+            << r->time_End << ' ' << r->flags << ' ';
+        ++num_records;
+    }
+
+    std::unordered_map<uint32_t, std::string> locations_;
+};
+
+// Reads a window from a pipeout
+std::pair<std::string, uint64_t> readWindow(const std::string & prefix, uint64_t start, uint64_t end,
+                                            bool memory_map = false)
+{
+    sparta::pipeViewer::Reader reader(prefix, std::make_unique<RecordingCallback>(prefix), memory_map);
+    reader.getWindow(start, end);
+    const auto & cb = reader.getCallbackAs<RecordingCallback>();
+    return {cb.out.str(), cb.num_records};
+}
+
+int64_t fileSize(const std::string & filename)
+{
+    struct stat stat_result;
+    EXPECT_EQUAL(stat(filename.c_str(), &stat_result), 0);
+    return stat_result.st_size;
+}
+
+void runCollection(const std::string & prefix, uint64_t heartbeat, bool compress,
+                   uint64_t cycles = 100000)
 {
 
     // Start with a root
@@ -115,7 +226,9 @@ int main()
      // sparta::log::Tap scheduler_debug(sparta::TreeNode::getVirtualGlobalNode(),
      //                                sparta::log::categories::DEBUG, std::cout);
 
-    sparta::collection::PipelineCollector pc("testPipe", 0, root_node.getClock(), &root_node);
+    sparta::collection::PipelineCollector pc(prefix, heartbeat, root_node.getClock(), &root_node);
+    pc.setCompression(compress);
+    EXPECT_EQUAL(pc.isCompressed(), compress);
 
     sched.finalize();
 
@@ -123,19 +236,109 @@ int main()
 
     pc.printMap();
 
-    sched.run(100000);
-    pc.stopCollection();
-    sched.run(100000);
-    pc.startCollection(&root_node);
-    sched.run(100000);
+    if(cycles > 0) {
+        sched.run(cycles);
+        pc.stopCollection();
+        sched.run(cycles);
+        pc.startCollection(&root_node);
+        sched.run(cycles);
+    }
 
     pc.stopCollection(&root_node);
     pc.destroy();
 
     root_node.enterTeardown();
     root_clks.enterTeardown();
+}
+
+// A compressed pipeout reads back the same as an uncompressed one
+void testCompressedPipeout()
+{
+    auto plain = sparta::pipeViewer::Reader::construct<RecordingCallback>("testPipeHeartbeat", "testPipeHeartbeat");
+    auto compressed = sparta::pipeViewer::Reader::construct<RecordingCallback>("testPipeCompressed",
+                                                                               "testPipeCompressed");
+    EXPECT_EQUAL(plain.getVersion(), sparta::pipeViewer::Outputter::UNCOMPRESSED_FILE_VERSION);
+    EXPECT_EQUAL(compressed.getVersion(), sparta::pipeViewer::Outputter::COMPRESSED_FILE_VERSION);
+    EXPECT_EQUAL(compressed.getCycleFirst(), plain.getCycleFirst());
+    EXPECT_EQUAL(compressed.getCycleLast(), plain.getCycleLast());
+    EXPECT_EQUAL(compressed.getChunkSize(), plain.getChunkSize());
+    EXPECT_TRUE(fileSize("testPipeCompressedrecord.bin") * 4 < fileSize("testPipeHeartbeatrecord.bin"));
+    EXPECT_TRUE(fileSize("testPipeCompressedchunk.bin") > 20 * sizeof(chunk_index_t));
+
+    // The whole file, and windows starting inside it
+    const uint64_t last = plain.getCycleLast();
+    const uint64_t chunk = plain.getChunkSize();
+    for(const auto & [start, end] : {std::make_pair(uint64_t(0), last + 1),
+                                     std::make_pair(chunk * 3 + 17, chunk * 7),
+                                     std::make_pair(last / 4, last / 4 + 1),
+                                     std::make_pair(last - chunk / 2, last + 1)})
+    {
+        const auto expected = readWindow("testPipeHeartbeat", start, end);
+        EXPECT_TRUE(expected.second > 0);
+        const auto actual = readWindow("testPipeCompressed", start, end);
+        EXPECT_EQUAL(actual.second, expected.second);
+        EXPECT_TRUE(actual.first == expected.first);
+
+        // Memory-mapped reads see the same records
+        for(const std::string prefix : {"testPipeHeartbeat", "testPipeCompressed"}) {
+            const auto mapped = readWindow(prefix, start, end, true);
+            EXPECT_EQUAL(mapped.second, expected.second);
+            EXPECT_TRUE(mapped.first == expected.first);
+        }
+    }
+}
+
+// A pipeout with no records can be opened, and a memory-mapped reader
+// maps the records once they are written
+void testEmptyPipeout()
+{
+    EXPECT_EQUAL(fileSize("testPipeEmptyrecord.bin"), 0);
+    for(const bool memory_map : {false, true}) {
+        EXPECT_EQUAL(readWindow("testPipeEmpty", 0, 1000, memory_map).second, 0);
+    }
+
+    const std::vector<std::string> suffixes = {"record.bin", "index.bin", "map.dat", "data.dat",
+                                               "string_map.dat", "display_format.dat", "location.dat",
+                                               "clock.dat"};
+    for(const auto & suffix : suffixes) {
+        std::filesystem::copy_file("testPipeEmpty" + suffix, "testPipeGrowing" + suffix,
+                                   std::filesystem::copy_options::overwrite_existing);
+    }
+    // The callback names locations from the collection copied in below
+    sparta::pipeViewer::Reader reader("testPipeGrowing", std::make_unique<RecordingCallback>("testPipeHeartbeat"),
+                                      true);
+    reader.getWindow(0, 1000);
+    EXPECT_EQUAL(reader.getCallbackAs<RecordingCallback>().num_records, 0);
+
+    // The same collection, now with its records written
+    for(const auto & suffix : suffixes) {
+        std::filesystem::copy_file("testPipeHeartbeat" + suffix, "testPipeGrowing" + suffix,
+                                   std::filesystem::copy_options::overwrite_existing);
+    }
+    EXPECT_TRUE(reader.isUpdated());
+    sparta::pipeViewer::Reader complete("testPipeHeartbeat",
+                                        std::make_unique<RecordingCallback>("testPipeHeartbeat"));
+    EXPECT_EQUAL(reader.getCycleFirst(), complete.getCycleFirst());
+    const uint64_t last = reader.getCycleLast();
+    EXPECT_TRUE(last > 0);
+    reader.getWindow(0, last + 1);
+
+    // An updated reader leaves off a partial heartbeat at the end of
+    // the record file, so it can find a few less
+    const auto expected = readWindow("testPipeHeartbeat", 0, last + 1);
+    EXPECT_TRUE(reader.getCallbackAs<RecordingCallback>().num_records > 0);
+    EXPECT_TRUE(reader.getCallbackAs<RecordingCallback>().num_records <= expected.second);
+}
+
+int main()
+{
+    runCollection("testPipe", 0, false);
+    runCollection("testPipeHeartbeat", 5000, false);
+    runCollection("testPipeCompressed", 5000, true);
+    testCompressedPipeout();
+    runCollection("testPipeEmpty", 5000, false, 0);
+    testEmptyPipeout();
 
     REPORT_ERROR;
     return ERROR_CODE;
-
 }
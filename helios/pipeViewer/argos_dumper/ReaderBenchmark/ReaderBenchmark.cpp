@@ -0,0 +1,248 @@
+#include "transactiondb/src/Reader.hpp"
+#include "transactiondb/src/PipelineDataCallback.hpp"
+#include "transactiondb/src/TransactionDatabaseInterface.hpp"
+#include "sparta/pipeViewer/Outputter.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string_view>
+
+/**
+ * \file ReaderBenchmark.cpp
+ * \brief Times loading windows of a synthetic pipeViewer database
+ * through the stream and memory-mapped Reader paths, and scrolling
+ * through it with the TransactionDatabaseInterface
+ *
+ * Usage: ./ReaderBenchmark [num_transactions [num_loader_threads]]
+ *
+ * Writes a database of num_transactions (default 100M, several GB)
+ * annotation and pair records with the Outputter, then reads it all
+ * in pipeViewer-sized windows, and reads some random windows, with
+ * each Reader path.  Both paths must see the same records.  Then
+ * scrolls through it with one loader thread and with
+ * num_loader_threads (default 4); both must see the same transactions.
+ */
+
+TEST_INIT
+
+namespace
+{
+    constexpr uint64_t HEARTBEAT = 1000;
+    constexpr uint64_t WINDOW = 10 * HEARTBEAT;
+    constexpr uint32_t NUM_LOCATIONS = 64;
+    constexpr uint32_t NUM_RANDOM_WINDOWS = 100;
+    constexpr uint64_t SCROLL_STEP = 5 * HEARTBEAT;
+    constexpr uint32_t NUM_SCROLL_QUERIES = 200;
+    const std::string PREFIX = "reader_benchmark_";
+
+    // Hashes everything the Reader passes along
+    class HashCallback : public sparta::pipeViewer::PipelineDataCallback
+    {
+    public:
+        void foundInstRecord(const instruction_t* r) override { add_(r); }
+        void foundMemRecord(const memoryoperation_t* r) override { add_(r); }
+        void foundAnnotationRecord(const annotation_t* r) override {
+            add_(r);
+            mix_(std::hash<std::string_view>()(r->annt));
+        }
+        void foundPairRecord(const pair_t* r) override {
+            add_(r);
+            for(const auto & str : r->stringVector) {
+                mix_(std::hash<std::string_view>()(str));
+            }
+        }
+
+        uint64_t hash = 0;
+        uint64_t num_records = 0;
+
+    private:
+        void mix_(uint64_t val) {
+            hash = (hash ^ val) * 0x100000001b3ull;
+        }
+
+        void add_(const transaction_t* r) {
+            mix_(r->transaction_ID);
+            mix_(r->time_Start);
+            mix_(r->time_End);
+            mix_(r->location_ID);
+            ++num_records;
+        }
+    };
+
+    // Writes num_transactions records ending in order, about four per
+    // tick; half annotations and half pairs.  Like collected records,
+    // none spans a heartbeat.
+    void writeDatabase(uint64_t num_transactions)
+    {
+        sparta::pipeViewer::Outputter out(PREFIX, HEARTBEAT);
+
+        pair_t pairt;
+        pairt.flags = is_Pair;
+        pairt.pairId = 1;
+        pairt.length = 4;
+        pairt.nameVector = {"uid", "pc", "unit", "mnemonic"};
+        pairt.sizeOfVector = {sizeof(uint64_t), sizeof(uint64_t), sizeof(uint8_t), 0};
+        pairt.delimVector = {sparta::PairFormatter::DECIMAL, sparta::PairFormatter::HEX,
+                             sparta::PairFormatter::DECIMAL, sparta::PairFormatter::DECIMAL};
+        pairt.valueVector.resize(4);
+        pairt.stringVector.resize(4);
+        const char * const units[] = {"ALU", "FPU", "LSU"};
+        const char * const mnemonics[] = {"add", "ld", "st", "fmadd.d", "bne"};
+
+        annotation_t annt;
+        annt.flags = is_Annotation;
+
+        uint64_t next_index = 0;
+        for(uint64_t i = 0; i < num_transactions; ++i)
+        {
+            const uint64_t end = i / 4 + 1;
+            // Records ending on a heartbeat belong to the chunk before it
+            while(end > next_index) {
+                out.writeIndex();
+                next_index += HEARTBEAT;
+            }
+
+            transaction_t & trans = (i % 2) ? static_cast<transaction_t&>(pairt) : annt;
+            trans.time_End = end;
+            trans.time_Start = std::max(end - std::min<uint64_t>(end, 1 + i % 7),
+                                        (end - 1) / HEARTBEAT * HEARTBEAT);
+            trans.transaction_ID = i;
+            trans.display_ID = i & 0xfff;
+
+            if(i % 2) {
+                pairt.location_ID = NUM_LOCATIONS + (i / 2) % NUM_LOCATIONS;
+                pairt.valueVector[0] = {i, true};
+                pairt.valueVector[1] = {0x10000 + i * 4, true};
+                pairt.valueVector[2] = {i % 3, true};
+                pairt.stringVector[2] = units[i % 3];
+                pairt.valueVector[3] = {0, false};
+                pairt.stringVector[3] = mnemonics[i % 5];
+                out.writeTransaction(pairt);
+            }
+            else {
+                annt.location_ID = (i / 2) % NUM_LOCATIONS;
+                annt.annt = "uid " + std::to_string(i) + " " + mnemonics[i % 5];
+                annt.length = annt.annt.size();
+                out.writeTransaction(annt);
+            }
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    struct Result
+    {
+        uint64_t hash = 0;
+        uint64_t num_records = 0;
+        uint64_t random_hash = 0;
+        double load_seconds = 0;
+        double random_seconds = 0;
+    };
+
+    // Loads the whole database window by window, then some random
+    // windows, like scrolling around in pipeViewer
+    Result readDatabase(bool memory_map)
+    {
+        Result res;
+        sparta::pipeViewer::Reader reader(PREFIX, std::make_unique<HashCallback>(), memory_map);
+        auto & cb = reader.getCallbackAs<HashCallback>();
+        const uint64_t last = reader.getCycleLast();
+
+        Clock::time_point start = Clock::now();
+        // The last transactions end at last + 1
+        for(uint64_t tick = 0; tick <= last + 1; tick += WINDOW) {
+            reader.getWindow(tick, tick + WINDOW);
+        }
+        res.load_seconds = secondsSince(start);
+        res.hash = cb.hash;
+        res.num_records = cb.num_records;
+
+        cb.hash = 0;
+        std::mt19937_64 rng(1234);
+        start = Clock::now();
+        for(uint32_t i = 0; i < NUM_RANDOM_WINDOWS; ++i) {
+            const uint64_t tick = rng() % (last + 1);
+            reader.getWindow(tick, tick + WINDOW);
+        }
+        res.random_seconds = secondsSince(start);
+        res.random_hash = cb.hash;
+        return res;
+    }
+
+    using TransactionDB = sparta::pipeViewer::TransactionDatabaseInterface;
+
+    // Hashes the transaction at each location on each tick of a query
+    void hashTick(void* user_data, uint64_t tick, TransactionDB::const_interval_idx* content,
+                  const TransactionDB::Transaction* transactions, uint32_t num_locations)
+    {
+        uint64_t & hash = *static_cast<uint64_t*>(user_data);
+        hash = (hash ^ tick) * 0x100000001b3ull;
+        for(uint32_t loc = 0; content && loc < num_locations; ++loc) {
+            if(content[loc] != TransactionDB::NO_TRANSACTION) {
+                hash = (hash ^ transactions[content[loc]].transaction_ID) * 0x100000001b3ull;
+            }
+        }
+    }
+
+    // Scrolls through the database a screen at a time, like pipeViewer,
+    // with the given number of loader threads.  Returns the time taken
+    // and a hash of everything queried.
+    std::pair<double, uint64_t> scrollDatabase(uint32_t num_loader_threads)
+    {
+        TransactionDB db(PREFIX, 2 * NUM_LOCATIONS, false, num_loader_threads);
+        const uint64_t last = db.getFileEnd();
+        uint64_t hash = 0;
+        const Clock::time_point start = Clock::now();
+        for(uint32_t i = 0; i < NUM_SCROLL_QUERIES; ++i) {
+            const uint64_t tick = (i * SCROLL_STEP) % last;
+            db.query(tick, tick + 2 * SCROLL_STEP, hashTick, &hash);
+        }
+        return {secondsSince(start), hash};
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    const uint64_t num_transactions = (argc > 1) ? std::strtoull(argv[1], nullptr, 0) : 100000000;
+    const uint32_t num_loader_threads = (argc > 2) ? std::strtoul(argv[2], nullptr, 0) : 4;
+
+    Clock::time_point start = Clock::now();
+    writeDatabase(num_transactions);
+    std::cout << "Wrote " << num_transactions << " transactions in "
+              << secondsSince(start) << " s" << std::endl;
+
+    const Result streamed = readDatabase(false);
+    const Result mapped = readDatabase(true);
+
+    // The windows are heartbeat aligned, so each record is read once
+    EXPECT_EQUAL(streamed.num_records, num_transactions);
+    EXPECT_EQUAL(mapped.num_records, streamed.num_records);
+    EXPECT_EQUAL(mapped.hash, streamed.hash);
+    EXPECT_EQUAL(mapped.random_hash, streamed.random_hash);
+
+    std::cout << "Records read:    " << streamed.num_records << "\n"
+              << "Full load:       stream " << streamed.load_seconds << " s, mmap "
+              << mapped.load_seconds << " s (" << streamed.load_seconds / mapped.load_seconds << "x)\n"
+              << NUM_RANDOM_WINDOWS << " windows:    stream " << streamed.random_seconds << " s, mmap "
+              << mapped.random_seconds << " s (" << streamed.random_seconds / mapped.random_seconds << "x)"
+              << std::endl;
+
+    const auto one_loader = scrollDatabase(1);
+    const auto loaders = scrollDatabase(num_loader_threads);
+    EXPECT_EQUAL(loaders.second, one_loader.second);
+
+    std::cout << NUM_SCROLL_QUERIES << " scrolls:    1 loader " << one_loader.first << " s, "
+              << num_loader_threads << " loaders " << loaders.first << " s ("
+              << one_loader.first / loaders.first << "x)" << std::endl;
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
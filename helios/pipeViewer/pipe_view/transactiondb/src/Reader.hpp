@@ -8,17 +8,28 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
 #include <locale>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
 
 #include "PipelineDataCallback.hpp"
 #include "sparta/utils/SpartaException.hpp"
@@ -114,7 +125,8 @@ namespace sparta::pipeViewer {
                     std::ifstream fstream_;
 
                 public:
-                    FileStream(std::string&& filename, const std::ios_base::openmode mode) :
+                    FileStream(std::string&& filename, const std::ios_base::openmode mode,
+                               const bool allow_empty = false) :
                         filename_(std::move(filename)),
                         mode_(mode),
                         fstream_(filename_, mode)
@@ -122,7 +134,7 @@ namespace sparta::pipeViewer {
                         //Make sure the file opened correctly!
                         sparta_assert(fstream_.is_open(),
                                       "Failed to open file " << filename_);
-                        sparta_assert(fstream_.peek() != std::ifstream::traits_type::eof(),
+                        sparta_assert(allow_empty || fstream_.peek() != std::ifstream::traits_type::eof(),
                                       filename_ << " is empty. Did Argos database collection complete?");
                     }
 
@@ -198,6 +210,344 @@ namespace sparta::pipeViewer {
                     }
             };
 
+            /**
+             * \class RecordFile
+             * \brief The record file, read through a stream, a memory map
+             * or, for a compressed pipeout, its chunk index
+             *
+             * Positions are always positions in the uncompressed
+             * records, so the rest of the Reader reads every kind of
+             * file the same way.  Finding the chunk for a position is a
+             * binary search of the chunk index, and only the chunk being
+             * read is kept decompressed.  A memory-mapped file is read
+             * in place: view() returns a pointer into the mapping (or
+             * into the current chunk) instead of copying.  Failed reads
+             * behave like they do on an std::ifstream.
+             */
+            class RecordFile : public FileStream {
+                public:
+                    using FileStream::FileStream;
+
+                    /**
+                     * \brief Read the record file through the chunk index
+                     * in \a filename
+                     */
+                    inline void openChunkIndex(std::string&& filename) {
+                        chunk_filename_ = std::move(filename);
+                        chunked_ = true;
+                        pos_ = 0;
+                        failed_ = false;
+                        resetData_();
+                        loadChunkIndex_();
+                    }
+
+                    /**
+                     * \brief Read the record file through a read-only
+                     * memory map of the whole file
+                     *
+                     * An empty file cannot be mapped, so it is read through
+                     * the stream until reopen() finds that it has grown.
+                     */
+                    inline void memoryMap() {
+                        map_requested_ = true;
+                        const int64_t size = FileStream::size();
+                        if(size == 0) {
+                            return;
+                        }
+                        const int fd = ::open(getFilename().c_str(), O_RDONLY);
+                        if(fd < 0) {
+                            throw sparta::SpartaException("Failed to open ") << getFilename()
+                                << " for memory mapping: " << std::strerror(errno);
+                        }
+                        void* const addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                        ::close(fd);
+                        if(addr == MAP_FAILED) {
+                            throw sparta::SpartaException("Failed to memory map ") << getFilename()
+                                << ": " << std::strerror(errno);
+                        }
+                        if(!map_ && !chunked_) {
+                            // Carry on from where the stream was reading
+                            const std::ifstream::pos_type stream_pos = FileStream::tellg();
+                            pos_ = stream_pos < 0 ? 0 : static_cast<uint64_t>(stream_pos);
+                            failed_ = false;
+                        }
+                        map_ = MappedFile(static_cast<const char*>(addr), Unmapper{static_cast<size_t>(size)});
+                        map_size_ = size;
+                        if(!chunked_) {
+                            size_ = map_size_;
+                        }
+                        resetData_();
+                    }
+
+                    //! Is the record file memory mapped?
+                    //! \note Not until it is non-empty
+                    inline bool isMemoryMapped() const {
+                        return map_ != nullptr;
+                    }
+
+                    /**
+                     * \brief Read \a num_bytes in place
+                     * \return A pointer to the bytes, valid until the next
+                     * read, or nullptr if they could not be read
+                     *
+                     * Bytes in the memory map or the current chunk are not
+                     * copied.  Anything else is read into a buffer.
+                     */
+                    inline const char* view(const size_t num_bytes) {
+                        if(buffered_() && !failed_ && loadData_() && pos_ + num_bytes <= data_end_) {
+                            const char* const data = currentData_() + (pos_ - data_begin_);
+                            pos_ += num_bytes;
+                            gcount_ = num_bytes;
+                            return data;
+                        }
+                        scratch_.resize(num_bytes);
+                        return read(scratch_.data(), num_bytes) ? scratch_.data() : nullptr;
+                    }
+
+                    inline bool read(char* const buf, const size_t num_bytes) {
+                        if(!buffered_()) {
+                            return FileStream::read(buf, num_bytes);
+                        }
+                        gcount_ = 0;
+                        if(failed_) {
+                            return false;
+                        }
+                        while(static_cast<size_t>(gcount_) < num_bytes) {
+                            if(!loadData_()) {
+                                failed_ = true;
+                                return false;
+                            }
+                            const size_t count = std::min<uint64_t>(num_bytes - gcount_, data_end_ - pos_);
+                            std::memcpy(buf + gcount_, currentData_() + (pos_ - data_begin_), count);
+                            gcount_ += count;
+                            pos_ += count;
+                        }
+                        return true;
+                    }
+
+                    template<typename T>
+                    inline bool read(T* const buf, const size_t num_bytes) {
+                        return read(reinterpret_cast<char* const>(buf), num_bytes);
+                    }
+
+                    template<typename T>
+                    inline bool read(T* const buf) {
+                        return read(buf, sizeof(T));
+                    }
+
+                    template<typename T>
+                    inline bool read(T& buf) {
+                        return read(&buf);
+                    }
+
+                    inline bool seekg(const std::ifstream::pos_type pos) {
+                        if(!buffered_()) {
+                            return FileStream::seekg(pos);
+                        }
+                        if(failed_) {
+                            return false;
+                        }
+                        pos_ = pos;
+                        return true;
+                    }
+
+                    inline bool seekg(const std::ifstream::off_type pos, const std::ios::seekdir dir) {
+                        if(!buffered_()) {
+                            return FileStream::seekg(pos, dir);
+                        }
+                        if(dir == std::ios::beg) {
+                            return seekg(std::ifstream::pos_type(pos));
+                        }
+                        return seekg(std::ifstream::pos_type((dir == std::ios::cur ? pos_ : size_) + pos));
+                    }
+
+                    inline std::ifstream::pos_type tellg() {
+                        if(!buffered_()) {
+                            return FileStream::tellg();
+                        }
+                        return failed_ ? std::ifstream::pos_type(-1) : std::ifstream::pos_type(pos_);
+                    }
+
+                    inline std::streamsize gcount() const {
+                        return buffered_() ? gcount_ : FileStream::gcount();
+                    }
+
+                    inline bool good() const {
+                        return buffered_() ? !failed_ : FileStream::good();
+                    }
+
+                    inline void reopen() {
+                        FileStream::reopen();
+                        if(map_requested_) {
+                            memoryMap();
+                        }
+                        if(chunked_) {
+                            loadChunkIndex_();
+                        }
+                    }
+
+                    inline void clear() {
+                        FileStream::clear();
+                        failed_ = false;
+                    }
+
+                    //! Size of the (uncompressed) records
+                    inline int64_t size() {
+                        if(!chunked_) {
+                            return FileStream::size();
+                        }
+                        loadChunkIndex_();
+                        return size_;
+                    }
+
+                    /**
+                     * \brief Hint that the records in [begin, end) will be
+                     * read soon, so that a memory-mapped file can start
+                     * paging them in
+                     */
+                    inline void willNeed(uint64_t begin, uint64_t end) {
+                        if(!map_ || begin >= end || begin >= size_) {
+                            return;
+                        }
+                        if(chunked_) {
+                            const chunk_index_t& last = chunks_[findChunk_(std::min(end, size_) - 1)];
+                            begin = chunks_[findChunk_(begin)].file_pos;
+                            end = last.file_pos + last.compressed_size;
+                        }
+                        static const uint64_t page_size = ::sysconf(_SC_PAGESIZE);
+                        begin -= begin % page_size;
+                        end = std::min<uint64_t>(end, map_size_);
+                        ::madvise(const_cast<char*>(map_.get()) + begin, end - begin, MADV_WILLNEED);
+                    }
+
+                    inline operator bool() const {
+                        return good();
+                    }
+
+                private:
+                    //! Unmaps a memory-mapped file
+                    struct Unmapper {
+                        size_t size;
+                        void operator()(const char* addr) const {
+                            ::munmap(const_cast<char*>(addr), size);
+                        }
+                    };
+                    using MappedFile = std::unique_ptr<const char, Unmapper>;
+
+                    //! Are reads served from memory rather than the stream?
+                    inline bool buffered_() const {
+                        return chunked_ || map_;
+                    }
+
+                    //! The records in [data_begin_, data_end_)
+                    inline const char* currentData_() const {
+                        return chunked_ ? chunk_data_.data() : map_.get();
+                    }
+
+                    //! Forgets which records are in memory
+                    inline void resetData_() {
+                        data_begin_ = 0;
+                        data_end_ = 0;
+                    }
+
+                    //! Reads any chunk index entries written since the last load
+                    inline void loadChunkIndex_() {
+                        struct stat stat_result;
+                        if(stat(chunk_filename_.c_str(), &stat_result) != 0) {
+                            throw sparta::SpartaException("Failed to open chunk index ") << chunk_filename_;
+                        }
+                        const size_t num_chunks = stat_result.st_size / sizeof(chunk_index_t);
+                        if(num_chunks == chunks_.size()) {
+                            return;
+                        }
+
+                        std::ifstream chunk_file(chunk_filename_, std::fstream::in | std::fstream::binary);
+                        sparta_assert(chunk_file.is_open(), "Failed to open chunk index " << chunk_filename_);
+                        chunks_.resize(num_chunks);
+                        chunk_file.read(reinterpret_cast<char*>(chunks_.data()), num_chunks * sizeof(chunk_index_t));
+                        sparta_assert(chunk_file, "Failed to read chunk index " << chunk_filename_);
+                        size_ = chunks_.empty() ? 0 : chunks_.back().record_pos + chunks_.back().size;
+                        resetData_();
+                    }
+
+                    //! Index of the chunk holding \a pos
+                    //! \pre pos < size_
+                    inline size_t findChunk_(const uint64_t pos) const {
+                        const auto it = std::upper_bound(chunks_.begin(), chunks_.end(), pos,
+                                                         [](const uint64_t pos, const chunk_index_t& chunk) {
+                                                             return pos < chunk.record_pos;
+                                                         });
+                        sparta_assert(it != chunks_.begin());
+                        return std::distance(chunks_.begin(), it) - 1;
+                    }
+
+                    /**
+                     * \brief Makes sure the records at pos_ are in memory
+                     * \return false if pos_ is past the end of the records
+                     */
+                    inline bool loadData_() {
+                        if(pos_ >= data_begin_ && pos_ < data_end_) {
+                            return true;
+                        }
+                        if(pos_ >= size_) {
+                            return false;
+                        }
+                        if(!chunked_) {
+                            data_begin_ = 0;
+                            data_end_ = size_;
+                            return true;
+                        }
+
+                        const size_t idx = findChunk_(pos_);
+                        const chunk_index_t& chunk = chunks_[idx];
+
+                        const char* compressed = nullptr;
+                        if(map_) {
+                            sparta_assert(chunk.file_pos + chunk.compressed_size <= map_size_,
+                                          "The chunk at " << chunk.file_pos << " is past the end of "
+                                          << getFilename());
+                            compressed = map_.get() + chunk.file_pos;
+                        }
+                        else {
+                            scratch_.resize(chunk.compressed_size);
+                            fstream_.clear();
+                            fstream_.seekg(chunk.file_pos);
+                            fstream_.read(scratch_.data(), scratch_.size());
+                            sparta_assert(static_cast<uint64_t>(fstream_.gcount()) == chunk.compressed_size,
+                                          "Failed to read the chunk at " << chunk.file_pos << " of " << getFilename());
+                            compressed = scratch_.data();
+                        }
+
+                        chunk_data_.resize(chunk.size);
+                        uLongf size = chunk.size;
+                        const int ret = uncompress(reinterpret_cast<Bytef*>(chunk_data_.data()), &size,
+                                                   reinterpret_cast<const Bytef*>(compressed),
+                                                   chunk.compressed_size);
+                        if(ret != Z_OK || size != chunk.size) {
+                            throw sparta::SpartaException("Failed to decompress the chunk at ")
+                                << chunk.file_pos << " of " << getFilename() << ": zlib error " << ret;
+                        }
+                        data_begin_ = chunk.record_pos;
+                        data_end_ = chunk.record_pos + chunk.size;
+                        return true;
+                    }
+
+                    bool chunked_ = false;             //!< Is the file read through a chunk index?
+                    std::string chunk_filename_;       //!< The chunk index file
+                    std::vector<chunk_index_t> chunks_; //!< The chunk index, in record order
+                    std::string chunk_data_;           //!< The chunk in memory, decompressed
+                    bool map_requested_ = false;       //!< Should the file be memory mapped?
+                    MappedFile map_{nullptr, Unmapper{0}}; //!< The memory-mapped record file
+                    uint64_t map_size_ = 0;            //!< Size of map_
+                    uint64_t data_begin_ = 0;          //!< First record position in memory
+                    uint64_t data_end_ = 0;            //!< End of the record positions in memory
+                    std::string scratch_;              //!< Buffer for data that cannot be viewed in place
+                    uint64_t pos_ = 0;                 //!< Read position in the records
+                    uint64_t size_ = 0;                //!< Size of the records
+                    std::streamsize gcount_ = 0;       //!< Bytes read by the last read
+                    bool failed_ = false;              //!< Did a read or seek fail?
+            };
+
             /**
              * \class ColonDelimitedFile
              * \brief Class that knows how to read ':'-delimited files used by the Argos pair format
@@ -359,8 +709,9 @@ namespace sparta::pipeViewer {
                             }
                     };
 
-                    explicit ColonDelimitedFile(std::string&& filename, std::ios_base::openmode mode = std::ios_base::in) :
-                        FileStream(std::move(filename), mode)
+                    explicit ColonDelimitedFile(std::string&& filename, std::ios_base::openmode mode = std::ios_base::in,
+                                                const bool allow_empty = false) :
+                        FileStream(std::move(filename), mode, allow_empty)
                     {
                         fstream_.imbue(std::locale(std::locale(), new FileLineCType));
                     }
@@ -471,9 +822,20 @@ namespace sparta::pipeViewer {
             }
 
             inline std::string readAnnotation_(const uint16_t length) {
-                std::string annt_buf(length, '\0');
-                record_file_.read(annt_buf.data(), length);
-                return annt_buf;
+                const char* const annt = record_file_.view(length);
+                return annt ? std::string(annt, length) : std::string(length, '\0');
+            }
+
+            /**
+             * \brief Read the rest of a record whose transaction_t part has
+             * already been read
+             */
+            template<typename RecordT>
+            inline void readRecordTail_(RecordT& record) {
+                static_assert(std::is_base_of_v<transaction_t, RecordT> &&
+                              std::is_trivially_copyable_v<RecordT>);
+                record_file_.read(reinterpret_cast<char*>(&record) + sizeof(transaction_t),
+                                  sizeof(RecordT) - sizeof(transaction_t));
             }
 
             inline void acquireLock_() {
@@ -492,8 +854,14 @@ namespace sparta::pipeViewer {
                 acquireLock_();
                 record_file_.seekg(0, std::ios::beg);
                 transaction_t transaction;
-                record_file_.read(transaction);
+                const bool found = record_file_.read(transaction);
                 clearLock();
+                if(!found)
+                {
+                    // No records yet
+                    record_file_.clear();
+                    return 0;
+                }
                 return transaction.time_Start;
             }
 
@@ -549,7 +917,9 @@ namespace sparta::pipeViewer {
              */
             template<bool CountRecords = false>
             inline size_t readRecords_(const std::fstream::pos_type end_pos, const uint64_t start, const uint64_t end) {
-                sparta_assert(version_ == 2, "Only version 2 is currenly supported");
+                sparta_assert(version_ == Outputter::UNCOMPRESSED_FILE_VERSION ||
+                              version_ == Outputter::COMPRESSED_FILE_VERSION,
+                              "Only versions 2 and 3 are currently supported");
                 return readRecordVersion_<CountRecords>(end_pos, start, end);
             }
 
@@ -557,9 +927,12 @@ namespace sparta::pipeViewer {
              * \brief Read a single record at \a pos and increment pos
              */
             inline void readRecord_(const uint64_t start, const uint64_t end) {
+                // Records are not aligned in the file, so copy the fixed
+                // part out of the (possibly mapped) file
                 transaction_t transaction;
-                record_file_.read(transaction);
-                sparta_assert(record_file_.good(), "Previous read of the argos DB failed");
+                const char* const rec = record_file_.view(sizeof(transaction_t));
+                sparta_assert(rec != nullptr, "Previous read of the argos DB failed");
+                std::memcpy(&transaction, rec, sizeof(transaction_t));
 
                 switch (transaction.flags & TYPE_MASK)
                 {
@@ -599,8 +972,8 @@ namespace sparta::pipeViewer {
                     case is_Instruction:
                     {
                         instruction_t inst;
-                        record_file_.seekg(-sizeof(transaction_t), std::ios::cur);
-                        record_file_.read(inst);
+                        static_cast<transaction_t&>(inst) = transaction;
+                        readRecordTail_(inst);
 
                         READER_DBG_MSG("found inst. start: " << inst.time_Start << " end: " << inst.time_End);
 
@@ -610,8 +983,8 @@ namespace sparta::pipeViewer {
                     case is_MemoryOperation:
                     {
                         memoryoperation_t memop;
-                        record_file_.seekg(-sizeof(transaction_t), std::ios::cur);
-                        record_file_.read(memop);
+                        static_cast<transaction_t&>(memop) = transaction;
+                        readRecordTail_(memop);
 
                         READER_DBG_MSG("found inst. start: " << memop.time_Start << " end: " << memop.time_End);
 
@@ -625,7 +998,11 @@ namespace sparta::pipeViewer {
                     // and In-memory data structures and rebuild the pair
                     // record one by one.
                     case is_Pair : {
-                        pair_t pairt(std::move(transaction));
+                        // Reuse the vectors of the last pair read
+                        pair_t& pairt = pair_;
+                        static_cast<transaction_t&>(pairt) = transaction;
+                        pairt.valueVector.clear();
+                        pairt.stringVector.clear();
 
                         // The loc_map is an In-memory Map which contains a mapping
                         // of Location ID to Pair ID.
@@ -694,23 +1071,23 @@ namespace sparta::pipeViewer {
                                     } else {
                                         const auto& format_str = pairt.delimVector[i];
 
-                                        std::ios_base::fmtflags format_flags = std::ios::dec;
-                                        std::string_view fmt_prefix = "";
+                                        // Room for a prefix and 22 octal digits
+                                        char int_str[32];
+                                        char* int_str_end = int_str;
+                                        int base = 10;
 
                                         if(format_str == PairFormatter::HEX) {
-                                            format_flags = std::ios::hex;
-                                            fmt_prefix = "0x";
+                                            base = 16;
+                                            *int_str_end++ = '0';
+                                            *int_str_end++ = 'x';
                                         }
                                         else if(format_str == PairFormatter::OCTAL) {
-                                            format_flags = std::ios::oct;
-                                            fmt_prefix = "0";
+                                            base = 8;
+                                            *int_str_end++ = '0';
                                         }
 
-                                        std::ostringstream int_str;
-                                        int_str << fmt_prefix;
-                                        int_str.setf(format_flags, std::ios::basefield);
-                                        int_str << int_value;
-                                        pairt.stringVector.emplace_back(int_str.str());
+                                        int_str_end = std::to_chars(int_str_end, std::end(int_str), int_value, base).ptr;
+                                        pairt.stringVector.emplace_back(int_str, int_str_end);
                                     }
                                 }
                             }
@@ -718,10 +1095,7 @@ namespace sparta::pipeViewer {
                                 // Type 1 = string
                                 uint16_t annotationLength;
                                 record_file_.read(annotationLength);
-
-                                std::string annot_str(annotationLength, '\0');
-                                record_file_.read(annot_str.data(), annotationLength);
-                                pairt.stringVector.emplace_back(std::move(annot_str));
+                                pairt.stringVector.emplace_back(readAnnotation_(annotationLength));
 
                                 // This bool value describes if this field has a string-only value.
                                 // String only values are those values which are stored in database as
@@ -751,6 +1125,70 @@ namespace sparta::pipeViewer {
                 }
             }
 
+            /**
+             * \brief (Re)read the pair description files from the start.
+             * Pair types are added to them as a collection runs.
+             */
+            inline void readPairFiles_()
+            {
+                for(ColonDelimitedFile * file : {&map_file_, &data_file_, &display_file_, &string_file_})
+                {
+                    file->clear();
+                    file->seekg(0, std::ios::beg);
+                }
+                loc_map_.clear();
+                map_.clear();
+                stringMap_.clear();
+
+                // Building the In-Memory LocationID -> PairID Lookup structure
+                // from the map_file_ which contains the same.
+                // We read this map_file_ when the Reader is constructed,
+                // and again as the database grows, and store all the relationships
+                // in an unordered_map called loc_map. When we read each Pair Record,
+                // we quickly do a lookup with the Location ID
+                // of the record in this map, and retrieve the Pair ID of that record,
+                // so that we can go ahead and get all the information
+                // about its name strings and sizeof and pair length from other data structures.
+                //The fields in the file are separated by ":"
+
+                // Read through the whole map File
+                map_file_.processInto(loc_map_);
+
+                // Building the In-memory Pair Lookup structure, such that,
+                // in future when reading back record from transaction file,
+                // we can use this structure to know about the length, name strings
+                // and sizeof the values
+                // for that paritcular pair, instead of using a file on disk for this.
+                // We read through the Data file, and populate this structure.
+                //The fields in the file are separated by ":"
+
+                data_file_.processWith([&](auto& strm) {
+                    uint16_t unique_id;
+                    strm >> unique_id;
+
+                    pair_struct pStruct(strm);
+
+                    //Finally, when we have completely parsed one line of this file,
+                    // it means we have complete knowledge of one pair type.
+                    // We then insert this pair into out Lookup structure.
+                    map_.emplace(unique_id, pStruct);
+                });
+
+                display_file_.processWith([&](auto& strm) {
+                    uint16_t pairId;
+                    strm >> pairId;
+
+                    auto& fmt_vec = map_.at(pairId).formats;
+
+                    while(!strm.eof()) {
+                        strm >> fmt_vec;
+                    }
+                });
+
+                // Read every line of the String Map file
+                string_file_.processInto(stringMap_);
+            }
+
             inline void checkIndexUpdates_()
             {
                 const auto index_size = index_file_.size();
@@ -769,7 +1207,11 @@ namespace sparta::pipeViewer {
                     index_file_.reopen();
                     map_file_.reopen();
                     data_file_.reopen();
+                    display_file_.reopen();
+                    string_file_.reopen();
+                    readPairFiles_();
 
+                    const bool had_records = size_of_record_file_ != 0;
                     size_of_index_file_ = index_size;
 
                     if(record_remainder != 0)
@@ -781,6 +1223,10 @@ namespace sparta::pipeViewer {
                         size_of_record_file_ = record_size;
                     }
 
+                    if(!had_records)
+                    {
+                        lowest_cycle_ = findCycleFirst_();
+                    }
                     highest_cycle_ = findCycleLast_();
 
                     file_updated_ = true;
@@ -791,15 +1237,20 @@ namespace sparta::pipeViewer {
              * \brief Construct a Reader
              * \param filename the name of the record file
              * \param cd a pointer to for the PipelineDataCallback to use.
+             * \param memory_map Memory map the record file and read records
+             * in place, instead of reading them through a file stream
              */
-            Reader(std::string filepath, std::unique_ptr<PipelineDataCallback>&& data_callback) :
+            Reader(std::string filepath, std::unique_ptr<PipelineDataCallback>&& data_callback,
+                   const bool memory_map = false) :
                 filepath_(std::move(filepath)),
-                record_file_(filepath_ + "record.bin", std::fstream::in | std::fstream::binary ),
+                // A database with no records yet has empty record and
+                // pair files, but always has an index header
+                record_file_(filepath_ + "record.bin", std::fstream::in | std::fstream::binary, true),
                 index_file_(filepath_ + "index.bin", std::fstream::in | std::fstream::binary),
-                map_file_(filepath_ + "map.dat", std::fstream::in),
-                data_file_(filepath_ + "data.dat", std::fstream::in),
-                string_file_(filepath_ + "string_map.dat", std::fstream::in),
-                display_file_(filepath_ + "display_format.dat", std::fstream::in),
+                map_file_(filepath_ + "map.dat", std::fstream::in, true),
+                data_file_(filepath_ + "data.dat", std::fstream::in, true),
+                string_file_(filepath_ + "string_map.dat", std::fstream::in, true),
+                display_file_(filepath_ + "display_format.dat", std::fstream::in, true),
                 data_callback_(std::move(data_callback)),
                 size_of_index_file_(0),
                 size_of_record_file_(0),
@@ -861,6 +1312,15 @@ namespace sparta::pipeViewer {
                               "Pipeout database \"" << filepath_ << "\" had a heartbeat of 0. This "
                               "would be too slow to actually load");
 
+                if(memory_map) {
+                    record_file_.memoryMap();
+                }
+
+                // Compressed record files are read through their chunk index
+                if(version_ == Outputter::COMPRESSED_FILE_VERSION) {
+                    record_file_.openChunkIndex(filepath_ + "chunk.bin");
+                }
+
                 //Determine the size of our index file
                 index_file_.seekg(0, std::fstream::end);
                 size_of_index_file_ = index_file_.tellg();
@@ -872,53 +1332,7 @@ namespace sparta::pipeViewer {
                 lowest_cycle_ = findCycleFirst_();
                 highest_cycle_ = findCycleLast_();
 
-                // Building the In-Memory LocationID -> PairID Lookup structure
-                // from the map_file_ which contains the same.
-                // We read this map_file_ just once during the construction
-                // of the Reader Class and store all the relationships
-                // in an unordered_map called loc_map. When we read each Pair Record,
-                // we quickly do a lookup with the Location ID
-                // of the record in this map, and retrieve the Pair ID of that record,
-                // so that we can go ahead and get all the information
-                // about its name strings and sizeof and pair length from other data structures.
-                //The fields in the file are separated by ":"
-
-                // Read through the whole map File
-                map_file_.processInto(loc_map_);
-
-                // Building the In-memory Pair Lookup structure, such that,
-                // in future when reading back record from transaction file,
-                // we can use this structure to know about the length, name strings
-                // and sizeof the values
-                // for that paritcular pair, instead of using a file on disk for this.
-                // We read through the Data file just once, and populate this structure.
-                //The fields in the file are separated by ":"
-
-                data_file_.processWith([&](auto& strm) {
-                    uint16_t unique_id;
-                    strm >> unique_id;
-
-                    pair_struct pStruct(strm);
-
-                    //Finally, when we have completely parsed one line of this file,
-                    // it means we have complete knowledge of one pair type.
-                    // We then insert this pair into out Lookup structure.
-                    map_.emplace(unique_id, pStruct);
-                });
-
-                display_file_.processWith([&](auto& strm) {
-                    uint16_t pairId;
-                    strm >> pairId;
-
-                    auto& fmt_vec = map_.at(pairId).formats;
-
-                    while(!strm.eof()) {
-                        strm >> fmt_vec;
-                    }
-                });
-
-                // Read every line of the String Map file
-                string_file_.processInto(stringMap_);
+                readPairFiles_();
             }
 
             Reader(Reader&& rhs) = default;
@@ -982,6 +1396,8 @@ namespace sparta::pipeViewer {
 
                 READER_LOG_MSG("start_pos: " << read_pos << " end_pos: " << end_pos);
 
+                record_file_.willNeed(static_cast<std::streamoff>(read_pos), static_cast<std::streamoff>(end_pos));
+
                 //Make sure we have not passed the end position, also make sure we
                 //are not at -1 bc that means we reached the end of the file!
                 //As we read records. Read each as a transaction.
@@ -1127,7 +1543,7 @@ namespace sparta::pipeViewer {
 
         private:
             const std::string filepath_; /*!< Path to this file */
-            FileStream record_file_; /*!< The record file stream */
+            RecordFile record_file_; /*!< The record file stream */
             FileStream index_file_;  /*!< The index file stream */
             ColonDelimitedFile map_file_;    /*!< The map file stream */
             ColonDelimitedFile data_file_;   /*!< The data file stream */
@@ -1141,6 +1557,7 @@ namespace sparta::pipeViewer {
             int64_t size_of_record_file_; /*!< The total byte size of the record file */
             uint64_t lowest_cycle_; /*!< The lowest cycle in the file. */
             uint64_t highest_cycle_; /*!< The highest cycle in the file. */
+            pair_t pair_; /*!< The last pair record read, kept for its vectors */
             bool lock_; /*!< A tool used too assert that this file Reader is not thread safe.*/
             bool file_updated_; /*!< Set to true when the open database has changed */
             // In-memory data structure to hold the mapping of Location ID
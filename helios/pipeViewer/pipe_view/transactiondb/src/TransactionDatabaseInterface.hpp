@@ -14,9 +14,16 @@
 #include <numeric>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <list>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <exception>
+#include <algorithm>
 #include <ctime>
 
 #include "TransactionInterval.hpp"
@@ -47,15 +54,27 @@ public:
     static constexpr interval_idx NO_TRANSACTION = 0xffffffff;
 
     /*!
-     * \brief Stop after exceeding this threshold.
-     * A low threshold is required for testing the sliding window algorithm
+     * \brief Default byte budget of the node cache. Least recently used nodes
+     * are evicted past this threshold.
+     * A low threshold is required for testing the eviction policy
      */
     //static constexpr uint64_t MEMORY_THRESHOLD_BYTES = 1000000000; // 1 GB
     //static constexpr uint64_t MEMORY_THRESHOLD_BYTES = 100000000; // 100 MB
     static constexpr uint64_t MEMORY_THRESHOLD_BYTES = 500000000; // 500 MB
 
     /*!
-     * \brief Background thread sleep period between checks
+     * \brief Number of loader threads to use when 0 is given to the
+     * constructor: half the hardware threads, between 1 and this
+     */
+    static constexpr uint32_t MAX_DEFAULT_LOADER_THREADS = 8;
+
+    /*!
+     * \brief Number of independently locked shards in the node cache
+     */
+    static constexpr uint32_t NODE_CACHE_SHARDS = 16;
+
+    /*!
+     * \brief Background thread sleep period between checks for DB updates
      */
     static constexpr uint32_t BACKGROUND_THREAD_SLEEP_MS = 100;
 
@@ -136,13 +155,11 @@ private:
          */
         std::vector<Transaction> all_intervals_;
 
-        bool should_del_; //!< Should this node be deleted when next possible
-
         const uint64_t start_inclusive;
         const uint64_t end_exclusive;
         const uint32_t num_locations;
         uint64_t transaction_bytes_; //!< Bytes used for transactions
-        volatile bool complete_; //!< Has this node been completely populated
+        std::atomic<bool> complete_; //!< Has this node been completely populated
 
         /*!
          * \brief Transaction pointers per location for each relevant tick
@@ -162,10 +179,17 @@ private:
         uint32_t overwrites;
 
         /*!
-         * \brief Acquired when this block is being populated. To read it, this
-         * mutex must acquired
+         * \brief Exception thrown while loading this node, if any. Rethrown to
+         * anyone waiting for it to complete
+         */
+        std::exception_ptr load_error_;
+
+        /*!
+         * \brief Guards completion of this node. A node is populated by one
+         * loader thread and only read once it is complete
          */
-        mutable std::mutex loading_mutex_;
+        mutable std::mutex complete_mutex_;
+        mutable std::condition_variable complete_cv_;
 
     public:
 
@@ -174,7 +198,6 @@ private:
          * \param num_locations Number of locations to support. Must be > 0
          */
         Node(const uint64_t start_inc, const uint64_t size, const uint32_t _num_locations) :
-            should_del_(false),
             start_inclusive(start_inc),
             end_exclusive(start_inc + size),
             num_locations(_num_locations),
@@ -184,7 +207,6 @@ private:
             overwrites(0)
         {
             sparta_assert(size > 0);
-            loading_mutex_.lock();
             sparta_assert(num_locations > 0,
                               "A transaction database node requires a location count of 1 or more");
             all_intervals_.reserve(512);
@@ -194,28 +216,6 @@ private:
             sparseness--;
         }
 
-        /*!
-         * \brief Destructor
-         */
-        ~Node()
-        {
-            if(!complete_){
-                // Someone else may be manipulating this. so wait for it
-                loading_mutex_.lock();
-            }
-            loading_mutex_.unlock();
-        }
-
-        /*!
-         * \brief Gets the mutex associated with loading data into this node.
-         * \note To load data into this node or read data from it, the mutex
-         * must be held. This allows node loading from a background thread while
-         * the forground thread queries the entire transaction database. Only
-         * when data is requested from a node (or it must be deleted), does the
-         * foreground thread have to wait for this mutex
-         */
-        std::mutex& getMutex() { return loading_mutex_; }
-
         /*!
          * \brief Dumps the content of this node where each row is a TickData
          * \param location_start First location to show for each row.
@@ -309,23 +309,51 @@ private:
         }
 
         /*!
-         * \brief Mark this node as completed and release the loading mutex.
-         * The thread that constructs this node must do this
+         * \brief Mark this node as completed and wake anyone waiting for it.
+         * The thread that populates this node must do this
+         * \param load_error Exception thrown while loading, if any. Waiters
+         * will rethrow it
          */
-        void markComplete() {
-            complete_ = true;
-            loading_mutex_.unlock();
+        void markComplete(std::exception_ptr load_error = nullptr) {
+            {
+                std::lock_guard<std::mutex> lock(complete_mutex_);
+                load_error_ = load_error;
+                complete_ = true;
+            }
+            complete_cv_.notify_all();
         }
 
         /*!
-         * \brief Is this node fully loaded. If false,  it means that it has not
-         * been loaded or there was an error loading it.
-         * \nhote This is NOT a worker-thread synchronization mechanism
+         * \brief Block until this node is complete
+         * \throw Rethrows the exception thrown while loading this node, if any
+         */
+        void waitComplete() const {
+            std::unique_lock<std::mutex> lock(complete_mutex_);
+            complete_cv_.wait(lock, [this]{ return complete_.load(); });
+            if(load_error_){
+                std::rethrow_exception(load_error_);
+            }
+        }
+
+        /*!
+         * \brief Is this node done loading. If false, it is still waiting to
+         * be loaded or being loaded
+         * \note This is NOT a worker-thread synchronization mechanism. Use
+         * waitComplete before reading the node
          */
         bool isComplete() const {
             return complete_;
         }
 
+        /*!
+         * \brief Did loading this node fail
+         * \pre isComplete()
+         */
+        bool hasLoadError() const {
+            std::lock_guard<std::mutex> lock(complete_mutex_);
+            return load_error_ != nullptr;
+        }
+
         /*!
          * \brief Add a new transaction to this node
          * \param time_Start inclusive start tick
@@ -548,14 +576,17 @@ private:
 
         std::string stringize() const {
             std::ostringstream ss;
-            ss << "<Node [" << start_inclusive << ',' << end_exclusive << ") trans="
-                << all_intervals_.size();
-            if(should_del_){
-                ss << " deleteme";
-            }
+            ss << "<Node [" << start_inclusive << ',' << end_exclusive << ")";
             if(false == complete_){
-                ss << " loading incomplete";
+                // Contents are still being written by a loader thread
+                ss << " loading incomplete>";
+                return ss.str();
             }
+            if(load_error_){
+                ss << " load failed>";
+                return ss.str();
+            }
+            ss << " trans=" << all_intervals_.size();
             ss << ' ' << "tdatas:" << tick_content.size();
             ss << ' ' << "sparse:" << sparseness << "(" << std::setprecision(4) << 100.*float(sparseness)/(end_exclusive-start_inclusive) << "%)";
             ss << ' ' << "overwr:" << overwrites;
@@ -563,26 +594,6 @@ private:
             return ss.str();
         }
 
-        /*!
-         * \brief Flags this node for deletion. Node can then be freed within a
-         * query or by a worker thread if needed
-         */
-        void flagForDeletion() {
-            should_del_ = true;
-        }
-
-        /*!
-         * \brief Should this node be deleted when convenient?
-         * \return True if this block is not currently being loaded and was
-         * flagged for deletion
-         */
-        bool canDelete() const {
-            if(complete_){
-                return should_del_;
-            }
-            return false;
-        }
-
         /*!
          * \brief Gets an iterator pointing to the TickData associated witih an
          * absolute tick number of the nearest earlier TickData for that tick
@@ -639,9 +650,206 @@ private:
     };
 
 
+    using NodePtr = std::shared_ptr<Node>;
+
+    /*!
+     * \brief Cache of nodes keyed by node index (start tick / node size)
+     *
+     * Nodes are spread over independently locked shards so that loader
+     * threads finishing nodes do not contend with each other or with a
+     * query. Each shard keeps its nodes in least recently used order and
+     * evicts from the cold end once it holds more than its share of the
+     * byte budget. Consecutive nodes land in different shards, so the nodes
+     * of one query are spread evenly. Nodes are shared, so an evicted node
+     * stays valid for whoever still holds it.
+     */
+    class NodeCache
+    {
+        struct Entry {
+            uint64_t idx;
+            NodePtr node;
+            uint64_t bytes; //!< Bytes accounted for this node. 0 until it is loaded
+        };
+
+        struct Shard {
+            mutable std::mutex mutex;
+            std::list<Entry> lru; //!< Most recently used first
+            std::unordered_map<uint64_t, std::list<Entry>::iterator> entries;
+            uint64_t bytes = 0;
+        };
+
+    public:
+
+        /*!
+         * \brief Constructor
+         * \param budget_bytes Bytes of loaded nodes to hold before evicting
+         * \param num_shards Number of independently locked shards. Must be > 0
+         */
+        NodeCache(const uint64_t budget_bytes, const uint32_t num_shards) :
+            shard_budget_(std::max<uint64_t>(budget_bytes / std::max<uint32_t>(num_shards, 1), 1)),
+            shards_(num_shards)
+        {
+            sparta_assert(num_shards > 0, "A node cache requires 1 or more shards");
+        }
+
+        /*!
+         * \brief Gets the node at a node index and marks it most recently used
+         * \return nullptr if that node is not cached
+         */
+        NodePtr find(const uint64_t idx)
+        {
+            Shard& shard = getShard_(idx);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            const auto itr = shard.entries.find(idx);
+            if(itr == shard.entries.end()){
+                return nullptr;
+            }
+            shard.lru.splice(shard.lru.begin(), shard.lru, itr->second);
+            return itr->second->node;
+        }
+
+        /*!
+         * \brief Is the node at a node index cached. Does not mark it used
+         */
+        bool contains(const uint64_t idx) const
+        {
+            const Shard& shard = getShard_(idx);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return shard.entries.count(idx) != 0;
+        }
+
+        /*!
+         * \brief Adds a node that is about to be loaded
+         * \param most_recent Insert as most recently used. Otherwise the node
+         * is inserted as least recently used so that it is the first to go
+         * (e.g. prefetched nodes nobody has asked for yet)
+         */
+        void insert(const uint64_t idx, const NodePtr& node, const bool most_recent)
+        {
+            Shard& shard = getShard_(idx);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            sparta_assert(shard.entries.count(idx) == 0,
+                          "Node " << idx << " is already in the node cache");
+            const auto pos = most_recent ? shard.lru.begin() : shard.lru.end();
+            shard.entries.emplace(idx, shard.lru.insert(pos, Entry{idx, node, 0}));
+        }
+
+        /*!
+         * \brief Accounts for a node that finished loading, then evicts least
+         * recently used nodes until its shard is within budget. Nodes still
+         * loading and the node just loaded are never evicted.
+         * \note Nodes no longer cached (e.g. after a clear) are ignored
+         */
+        void nodeLoaded(const uint64_t idx, const NodePtr& node)
+        {
+            Shard& shard = getShard_(idx);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            const auto itr = shard.entries.find(idx);
+            if(itr == shard.entries.end() || itr->second->node != node){
+                return;
+            }
+            itr->second->bytes = node->getSizeInBytes();
+            shard.bytes += itr->second->bytes;
+
+            auto victim = shard.lru.end();
+            while(shard.bytes > shard_budget_ && victim != shard.lru.begin()){
+                --victim;
+                if(victim->bytes == 0 || victim->node == node){
+                    continue;
+                }
+                shard.bytes -= victim->bytes;
+                shard.entries.erase(victim->idx);
+                victim = shard.lru.erase(victim);
+            }
+        }
+
+        /*!
+         * \brief Removes the node at a node index if it is still \a node
+         * (e.g. a node whose load was cancelled or failed)
+         */
+        void erase(const uint64_t idx, const NodePtr& node)
+        {
+            Shard& shard = getShard_(idx);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            const auto itr = shard.entries.find(idx);
+            if(itr != shard.entries.end() && itr->second->node == node){
+                shard.bytes -= itr->second->bytes;
+                shard.lru.erase(itr->second);
+                shard.entries.erase(itr);
+            }
+        }
+
+        /*!
+         * \brief Removes all nodes
+         */
+        void clear()
+        {
+            for(Shard& shard : shards_){
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.entries.clear();
+                shard.lru.clear();
+                shard.bytes = 0;
+            }
+        }
+
+        /*!
+         * \brief Bytes used by the loaded nodes in this cache
+         */
+        uint64_t getSizeInBytes() const
+        {
+            uint64_t bytes = 0;
+            for(const Shard& shard : shards_){
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                bytes += shard.bytes;
+            }
+            return bytes;
+        }
+
+        /*!
+         * \brief Byte budget of this cache
+         */
+        uint64_t getBudget() const {
+            return shard_budget_ * shards_.size();
+        }
+
+        /*!
+         * \brief Gets all cached nodes, including those still loading, in
+         * tick order
+         */
+        std::vector<NodePtr> getNodes() const
+        {
+            std::vector<NodePtr> nodes;
+            for(const Shard& shard : shards_){
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                for(const Entry& entry : shard.lru){
+                    nodes.emplace_back(entry.node);
+                }
+            }
+            std::sort(nodes.begin(), nodes.end(),
+                      [](const NodePtr& a, const NodePtr& b) {
+                          return a->getStartInclusive() < b->getStartInclusive();
+                      });
+            return nodes;
+        }
+
+    private:
+
+        Shard& getShard_(const uint64_t idx) {
+            return shards_[idx % shards_.size()];
+        }
+
+        const Shard& getShard_(const uint64_t idx) const {
+            return shards_[idx % shards_.size()];
+        }
+
+        const uint64_t shard_budget_; //!< Byte budget of each shard
+        std::vector<Shard> shards_;
+    };
+
+
     /*!
      * \brief Manages pipeViewer reader callbacks and dumps transaction data into an
-     * ordered list of nodes
+     * set of nodes
      */
     class SmartReader
     {
@@ -737,7 +945,8 @@ private:
             };
 
             /*!
-             * \brief Reader used to get intervals from the event file
+             * \brief Reader used to get intervals from the event file.  The
+             * record file is memory mapped and records are decoded in place.
              */
             Reader event_reader_;
 
@@ -755,7 +964,7 @@ private:
              * \post Handle to pipeViewer database identified by \a file_prefix is open
              */
             explicit SmartReader(const std::string& file_prefix) :
-                event_reader_(Reader::construct<SmartReaderCallback>(file_prefix)),
+                event_reader_(file_prefix, std::make_unique<SmartReaderCallback>(), true),
                 reader(event_reader_)
             {;}
 
@@ -816,36 +1025,48 @@ private:
                 event_reader_.ackUpdated();
                 unlock();
             }
+
+            /*!
+             * \brief Picks up any data appended to the database since it was
+             * opened or last refreshed
+             */
+            void refresh()
+            {
+                lock();
+                if(event_reader_.isUpdated()){
+                    event_reader_.ackUpdated();
+                }
+                unlock();
+            }
     };
 
+    /*!
+     * \brief Reader for the database metadata and for polling for updates.
+     * Loader threads have their own readers
+     */
     SmartReader smart_reader_;
 
     /*!
-     * \brief Type for Node list. This must be a list so that objects are
-     * perserved
+     * \brief Request to load one heartbeat chunk into some of its nodes
      */
-    using node_list_t = std::list<Node>;
-
-    using node_iterator_t = node_list_t::iterator;
-    using node_const_iterator_t = node_list_t::const_iterator;
+    struct LoadJob {
+        uint64_t chunk_start = 0;
+        std::vector<NodePtr> nodes; //!< Incomplete nodes within the chunk
+        bool prefetch = false; //!< Speculative. Dropped if still queued at the next query
+    };
 
     const std::string file_prefix_; //!< Database filename prefix
 
     const uint32_t num_locations_; //!< Number of locations in the database
 
-    /*!
-     * \brief Data nodes currently help in this class
-     * \warning This must be a list type
-     */
-    node_list_t nodes_;
-
     /*!
      * \brief Currently within a query?
      */
     bool in_query_;
 
     /*!
-     * \brief Currently loaded window
+     * \brief Node-aligned range of the last tracked query. Queries with
+     * modify_tracking=false must be inside it
      */
     Window window_;
 
@@ -866,24 +1087,63 @@ private:
     uint64_t node_size_; //!< Size of a node in this window
 
     /*!
-     * \brief Background loader thread
+     * \brief Loaded and loading nodes
+     */
+    NodeCache nodes_;
+
+    /*!
+     * \brief One reader per loader thread so that chunks are decoded
+     * independently
      */
-    std::thread background_loader_;
+    std::vector<std::unique_ptr<SmartReader>> loader_readers_;
 
     /*!
-     * \brief Mutex that must be locked when manipulating the node list and window
+     * \brief Loader threads, each decoding one chunk at a time from
+     * load_queue_
      */
-    mutable std::recursive_mutex node_list_mutex_;
+    std::vector<std::thread> loaders_;
+
+    /*!
+     * \brief Chunks waiting for a loader thread. Loads needed by a query are
+     * queued in front, prefetches at the back
+     */
+    std::deque<LoadJob> load_queue_;
+
+    /*!
+     * \brief Guards load_queue_ and loaders_should_exit_
+     */
+    std::mutex load_queue_mutex_;
+
+    /*!
+     * \brief Signaled when load_queue_ gets work or the loaders should exit
+     */
+    std::condition_variable load_queue_cv_;
+
+    /*!
+     * \brief Should the loader threads exit?
+     */
+    bool loaders_should_exit_;
+
+    /*!
+     * \brief Background thread polling for database updates
+     */
+    std::thread background_thread_;
+
+    /*!
+     * \brief Mutex that must be locked when querying or when changing the
+     * window or the file range
+     */
+    mutable std::recursive_mutex window_mutex_;
 
     /*!
      * \brief Should the background thread exit?
      */
-    volatile bool background_thread_should_exit_;
+    std::atomic<bool> background_thread_should_exit_;
 
     /*!
      * \brief Is this interface in verbose mode
      */
-    bool verbose_;
+    std::atomic<bool> verbose_;
 
     /*!
      * \brief Is this interface polling for database updates
@@ -922,10 +1182,17 @@ public:
      * \brief Constructor
      * \param file_prefix Path and prefix of database files
      * \param num_locations Number of locations in the tree
+     * \param update_enabled Poll the database for updates
+     * \param num_loader_threads Number of threads loading nodes. 0 picks a
+     * default based on the number of hardware threads
+     * \param memory_budget_bytes Bytes of loaded nodes to hold before least
+     * recently used nodes are evicted
      */
     TransactionDatabaseInterface(const std::string& file_prefix,
                                  const uint32_t num_locations,
-                                 const bool update_enabled = false) :
+                                 const bool update_enabled = false,
+                                 const uint32_t num_loader_threads = 0,
+                                 const uint64_t memory_budget_bytes = MEMORY_THRESHOLD_BYTES) :
         smart_reader_(file_prefix),
         file_prefix_(file_prefix),
         num_locations_(num_locations),
@@ -936,6 +1203,8 @@ public:
         end_tick_(smart_reader_.reader.getCycleLast()),
         chunk_size_(smart_reader_.reader.getChunkSize()),
         node_size_(0),
+        nodes_(memory_budget_bytes, NODE_CACHE_SHARDS),
+        loaders_should_exit_(false),
         background_thread_should_exit_(false),
         verbose_(false),
         update_enabled_(update_enabled),
@@ -966,11 +1235,19 @@ public:
         // This is just a waste of time whenever the user wants to start at a non-zero tick and
         // because of how close construction of this class tends to be to its usage, there is almost
         // no opportunity to preload data.
-        //uint64_t load_end = std::min(start_tick_+1000, end_tick_);
-        //load_(start_tick_, load_end);
 
-        // Start background thread
-        background_loader_ = std::thread(std::bind(&TransactionDatabaseInterface::backgroundLoader_, this));
+        // Open every reader before starting any thread so that a database
+        // that cannot be opened throws from here
+        const uint32_t num_loaders = (num_loader_threads > 0) ? num_loader_threads : getDefaultLoaderThreads();
+        for(uint32_t i = 0; i < num_loaders; ++i){
+            loader_readers_.emplace_back(std::make_unique<SmartReader>(file_prefix));
+        }
+
+        // Start loader and background threads
+        for(uint32_t i = 0; i < num_loaders; ++i){
+            loaders_.emplace_back(&TransactionDatabaseInterface::loaderThread_, this, i);
+        }
+        background_thread_ = std::thread(&TransactionDatabaseInterface::backgroundThread_, this);
     }
 
     /*!
@@ -979,11 +1256,27 @@ public:
     ~TransactionDatabaseInterface()
     {
         background_thread_should_exit_ = true;
-        if(background_loader_.get_id() != std::thread::id()){
-            background_loader_.join();
+        {
+            std::lock_guard<std::mutex> lock(load_queue_mutex_);
+            loaders_should_exit_ = true;
+        }
+        load_queue_cv_.notify_all();
+        for(auto& loader : loaders_){
+            loader.join();
+        }
+        if(background_thread_.joinable()){
+            background_thread_.join();
         }
     }
 
+    /*!
+     * \brief Number of loader threads used when none is given to the
+     * constructor
+     */
+    static uint32_t getDefaultLoaderThreads() {
+        return std::clamp(std::thread::hardware_concurrency() / 2, 1u, MAX_DEFAULT_LOADER_THREADS);
+    }
+
     /*!
      * \brief Sets the current verbose logging state of this interface
      * \param verbose New verbose logging state
@@ -1005,6 +1298,16 @@ public:
      */
     uint64_t getChunkSize() const { return chunk_size_; }
 
+    /*!
+     * \brief Gets the number of threads loading nodes
+     */
+    uint32_t getNumLoaderThreads() const { return loaders_.size(); }
+
+    /*!
+     * \brief Gets the byte budget for loaded nodes
+     */
+    uint64_t getMemoryBudget() const { return nodes_.getBudget(); }
+
     /*!
      * \brief Resets any temporary query state.
      * \note this is mainly a debugging feature
@@ -1037,11 +1340,12 @@ public:
      * necessary data
      */
     void unload() {
-        std::lock_guard<std::recursive_mutex> lock(node_list_mutex_);
+        std::lock_guard<std::recursive_mutex> lock(window_mutex_);
 
         window_.start = 0;
         window_.end = 0;
 
+        cancelLoads_(false);
         nodes_.clear();
     }
 
@@ -1060,15 +1364,13 @@ public:
      * forwarded
      * \param modify_tracking Treat the current query as the new query range.
      * Normally, the last query is used to predict the next data that will be
-     * needed. If a small query is made after a large query (and inside that
-     * previous query's range), some data from the large query may be dropped in
-     * the background. Normally these large queries should have their data held
-     * in memory because the next query will tend to be that range shifted by a
-     * few ticks in either direction. To preven small queries within these
-     * ranges from breaking this prediction, modify_tracking can be set to false
-     * Data outside this new range may be unloaded and replaced with data closer
-     * to one endpoint of the range. If false, data will NOT be loaded or
-     * unloaded, but the queried range must be a subset of the prior query range.
+     * needed, and the nodes on either side of it are prefetched. If a small
+     * query is made after a large query (and inside that previous query's
+     * range), the prefetching would move to around the small query. Normally
+     * the next query will tend to be the large query's range shifted by a few
+     * ticks in either direction. To prevent small queries within these ranges
+     * from breaking this prediction, modify_tracking can be set to false, in
+     * which case the queried range must be a subset of the prior query range.
      * \pre Must not be call from within a callback of another query.
      */
     void query(const uint64_t _start_inclusive,
@@ -1077,7 +1379,7 @@ public:
                void* user_data=nullptr,
                const bool modify_tracking=true)
     {
-        std::lock_guard<std::recursive_mutex> lock(node_list_mutex_);
+        std::lock_guard<std::recursive_mutex> lock(window_mutex_);
 
         sparta_assert(_end_inclusive >= _start_inclusive,
                           "end point in query must be >= start point");
@@ -1113,60 +1415,60 @@ public:
         // Set in query after all non-fatal exceptions
         in_query_ = true;
 
+        // Prefetches still queued were guesses based on the last query. Drop
+        // them so that this query's nodes are loaded first
+        cancelLoads_(true);
+
+        const uint64_t first_node = start_inclusive / node_size_;
+        const uint64_t end_node = (end_exclusive + node_size_ - 1) / node_size_;
+        const std::vector<NodePtr> nodes = requestNodes_(first_node, end_node, false);
+
         if(modify_tracking){
             // Store this latest query for later use. Ensure this is modified and
-            // read only with node_list_mutex acquired
+            // read only with window_mutex_ acquired
             last_query_.start = start_inclusive;
             last_query_.end = end_exclusive;
-
-            // Ensure that necessary data is loaded immediately.
-            if(start_inclusive < window_.start || end_exclusive > window_.end) {
-
-                load_(start_inclusive,
-                      end_exclusive); // exclusive end
-            }
+            window_.start = first_node * node_size_;
+            window_.end = end_node * node_size_;
         }
+        prefetch_();
 
         uint64_t t = _start_inclusive;
-        node_iterator_t itr = findNode(t);
-
-        if(itr != nodes_.end()){
-            // Now make some callbacks with no data for the start of the
-            // requested range up to the first block found
-            while(t < itr->getStartInclusive()){
-                cb(user_data, t, nullptr, nullptr, 0);
-                ++t;
-            }
+        sparta_assert(!nodes.empty());
 
-            //itr->dumpContent(std::cout, 890, 905, 0);
+        // Now make some callbacks with no data for the start of the
+        // requested range up to the first block found
+        while(t < nodes.front()->getStartInclusive()){
+            cb(user_data, t, nullptr, nullptr, 0);
+            ++t;
         }
 
-        for(; itr != nodes_.end(); ++itr){
-            //std::cout << "Looking at node " << itr->stringize() << std::endl;
+        for(const NodePtr& node : nodes){
+            //std::cout << "Looking at node " << node->stringize() << std::endl;
             // Assuming exclusive right endpoint of transactions
 
-            if(itr->getStartInclusive() <= t){
+            if(node->getStartInclusive() <= t){
                 // Calculate limit for iterating in this node
-                const uint64_t endpoint_exclusive = std::min(itr->getEndExclusive(), end_exclusive);
+                const uint64_t endpoint_exclusive = std::min(node->getEndExclusive(), end_exclusive);
 
                 // Iterate through necessary ticks in this node.
                 // Wait for it to be loaded first
-                if(itr->getMutex().try_lock() == false){
-                    std::cout << "*** Waiting for node to finish loading..." << itr->stringize() << std::endl;
-                    itr->getMutex().lock();
+                if(verbose_ && !node->isComplete()){
+                    std::cout << "(main) Waiting for node to finish loading..." << node->stringize() << std::endl;
                 }
+                node->waitComplete();
 
-                auto tick_itr = itr->getTickData(t);
-                const auto tick_itr_end = itr->getTickDataEnd();
+                auto tick_itr = node->getTickData(t);
+                const auto tick_itr_end = node->getTickDataEnd();
                 sparta_assert(tick_itr != tick_itr_end);
                 const Node::TickData* td = &(*tick_itr);
-                sparta_assert(td->tick_offset + itr->getStartInclusive() <= t);
-                while(t < endpoint_exclusive && tick_itr != itr->getTickDataEnd()){
-                    if(t > tick_itr->tick_offset + itr->getStartInclusive()){
+                sparta_assert(td->tick_offset + node->getStartInclusive() <= t);
+                while(t < endpoint_exclusive && tick_itr != node->getTickDataEnd()){
+                    if(t > tick_itr->tick_offset + node->getStartInclusive()){
                         // Current callback tick has passed this tick iterator.
                         tick_itr++;
                     }
-                    if(tick_itr != tick_itr_end && tick_itr->tick_offset + itr->getStartInclusive() <= t){
+                    if(tick_itr != tick_itr_end && tick_itr->tick_offset + node->getStartInclusive() <= t){
                         // Current callback tick has caught up with the tick iterator. Point
                         // "td" to the current iterator's TickData because it is at or before
                         // the current callback time (t)
@@ -1179,25 +1481,23 @@ public:
                     //for(uint32_t loc = 0; loc < num_locations_; loc++){
                     //    interval_idx idx = td->data[loc];
                     //    if(idx != NO_TRANSACTION){
-                    //        const Transaction* trans = &itr->getIntervals()[idx];
+                    //        const Transaction* trans = &node->getIntervals()[idx];
                     //        sparta_assert(trans->getLeft() <= t && trans->getRight() > t);
                     //    }
                     //}
 
-                    cb(user_data, t, td->data.data(), &itr->getIntervals()[0], num_locations_);
+                    cb(user_data, t, td->data.data(), &node->getIntervals()[0], num_locations_);
                     ++t;
                 }
 
                 // Finish up callbacks with null data because there is no more tick data in this node
-                if(tick_itr == itr->getTickDataEnd()){
+                if(tick_itr == node->getTickDataEnd()){
                     while(t < endpoint_exclusive){
                         cb(user_data, t, nullptr, nullptr, 0);
                         ++t;
                     }
                 }
 
-                itr->getMutex().unlock();
-
                 // Has t passed the end time of the query within the file range?
                 // Note that the query endpoint is inclusive, so t must get to end_exclusive
                 if(t >= end_exclusive){
@@ -1213,22 +1513,20 @@ public:
 
                     in_query_ = false;
 
-                    verifyValidWindow_(); // Check that the window was properly updated
-
                     return; // Done
                 }
 
                 // Falling through to here meant that iteration reached the end
                 // of this node
-                sparta_assert(t == itr->getEndExclusive());
+                sparta_assert(t == node->getEndExclusive());
             }else{
                 in_query_ = false;
 
-                // This probably indicates that window was wrong and something
-                // should have been loaded for this query.
+                // This probably indicates that a node is missing from the
+                // requested range
                 sparta_assert(false,
                                   "Exceeded end of blocks at " << t << " where block start is "
-                                  << itr->getStartInclusive());
+                                  << node->getStartInclusive());
             }
         }
 
@@ -1254,7 +1552,7 @@ public:
         // This can only happen if update_enabled_ == true
         if(update_enabled_)
         {
-            std::lock_guard<std::recursive_mutex> lock(node_list_mutex_);
+            std::lock_guard<std::recursive_mutex> lock(window_mutex_);
         }
         return end_tick_;
     }
@@ -1278,11 +1576,9 @@ public:
     }
 
     std::ostream& writeNodeStates(std::ostream& o) const {
-        std::lock_guard<std::recursive_mutex> lock(node_list_mutex_);
-
         uint32_t idx = 0;
-        for(const auto& n : nodes_){
-            o << std::setw(5) << idx << ' ' << n.stringize() << std::endl;
+        for(const auto& n : nodes_.getNodes()){
+            o << std::setw(5) << idx << ' ' << n->stringize() << std::endl;
             ++idx;
         }
         return o;
@@ -1298,34 +1594,32 @@ public:
                             const uint32_t location_start = 0,
                             const uint32_t location_end = 0,
                             const uint32_t tick_entry_limit = 0) const {
-        uint32_t idx = 0;
-        for(const auto& n : nodes_){
-            if(idx == node_idx){
-                return n.getContentString(location_start, location_end, tick_entry_limit);
-            }
-            ++idx;
+        const std::vector<NodePtr> nodes = nodes_.getNodes();
+        if(node_idx >= nodes.size()){
+            return "";
+        }
+        const NodePtr& n = nodes[node_idx];
+        if(!n->isComplete() || n->hasLoadError()){
+            return n->stringize();
         }
-        return "";
+        return n->getContentString(location_start, location_end, tick_entry_limit);
     }
 
     std::string stringize() const {
-        std::lock_guard<std::recursive_mutex> lock(node_list_mutex_);
+        std::lock_guard<std::recursive_mutex> lock(window_mutex_);
 
         std::ostringstream ss;
         ss << "<TransactionDatabase \"" << file_prefix_
             << "\" total=[" << start_tick_ << ','
             << end_tick_ << ") window=[" << window_.start << ',' << window_.end << ") "
             << "lastq=[" << last_query_.start << "," << last_query_.end << ") "
+            << "loaders=" << loaders_.size() << ' '
             << std::fixed << getSizeInBytes()/1000000000.0 << " GB>";
         return ss.str();
     }
 
     uint64_t getSizeInBytes() const {
-        std::lock_guard<std::recursive_mutex> lock(node_list_mutex_);
-        return std::accumulate(nodes_.begin(),
-                               nodes_.end(),
-                               0,
-                               [](const uint64_t sum, const Node& n){ return sum + n.getSizeInBytes(); });
+        return nodes_.getSizeInBytes();
     }
 
     bool isFileUpdated(const bool force = false)
@@ -1356,14 +1650,14 @@ public:
 
     bool updateReady()
     {
-        std::lock_guard<std::recursive_mutex> lock(node_list_mutex_);
+        std::lock_guard<std::recursive_mutex> lock(window_mutex_);
 
         return update_ready_ > 0;
     }
 
     void ackUpdate()
     {
-        std::lock_guard<std::recursive_mutex> lock(node_list_mutex_);
+        std::lock_guard<std::recursive_mutex> lock(window_mutex_);
 
         if(update_ready_ > 0)
         {
@@ -1373,528 +1667,240 @@ public:
 
     void enableUpdate()
     {
-        std::lock_guard<std::recursive_mutex> lock(node_list_mutex_);
+        std::lock_guard<std::recursive_mutex> lock(window_mutex_);
 
         update_enabled_ = true;
     }
 
     void disableUpdate()
     {
-        std::lock_guard<std::recursive_mutex> lock(node_list_mutex_);
+        std::lock_guard<std::recursive_mutex> lock(window_mutex_);
 
         update_enabled_ = false;
     }
 
     void forceUpdate()
     {
-        std::lock_guard<std::recursive_mutex> lock(node_list_mutex_);
+        std::lock_guard<std::recursive_mutex> lock(window_mutex_);
 
         if(isFileUpdated(true))
         {
-            end_tick_ = smart_reader_.reader.getCycleLast();
-            unload();
+            reloadUpdatedFile_();
         }
     }
 
 private:
 
     /*!
-     * \brief Backround thread loader
+     * \brief Background thread polling for database updates
      */
-    void backgroundLoader_() {
-        // NOTE: cannot perform this check immediately since the background_loader_ object might not
-        // be complete
-        //// Ensue that this function is called only in the background loader thread
-        //sparta_assert(background_loader_.get_id() == std::this_thread::get_id(),
-        //            background_loader_.get_id() << " != " std::this_thread::get_id());
-
+    void backgroundThread_() {
         while(true) {
             std::this_thread::sleep_for(std::chrono::milliseconds(BACKGROUND_THREAD_SLEEP_MS));
             if(background_thread_should_exit_){
                 return; // End of thread
             }
 
-            if(node_list_mutex_.try_lock()){
-                bool needs_update = false;
+            if(window_mutex_.try_lock()){
                 if(update_enabled_ && isFileUpdated())
                 {
-                    end_tick_ = smart_reader_.reader.getCycleLast();
-                    unload();
-                    needs_update = true;
-                }
-
-                try{
-                    sparta_assert(window_.start % node_size_ == 0);
-                    sparta_assert(window_.end % node_size_ == 0);
-
-                    // Pick an end to load on based on how close the last
-                    // query window was to the loaded window edges
-                    const uint64_t low_distance = (last_query_.start <= start_tick_) ? 0 : last_query_.start - window_.start;
-                    const uint64_t high_distance = (last_query_.end >= end_tick_) ? 0 : window_.end - last_query_.end;
-
-                    // Did we hit the memory ceiling for this window. If so, loading new nodes will
-                    // be prevented unless there is a significant imbalance in the window size
-                    // around the last query.
-                    // Note that we're guaranteed to contain all necessary data from the last query
-                    // in the window because that is handled in the foreground. Background loading
-                    // (here) is for additional window loading only
-                    const bool hit_memory_ceiling = getSizeInBytes() >= MEMORY_THRESHOLD_BYTES;
-
-                    static constexpr uint64_t INVALID_NODE = std::numeric_limits<uint64_t>::max();
-                    uint64_t load_node_pos = INVALID_NODE;
-                    const uint64_t low_pos = window_.start - node_size_;
-                    const uint64_t high_pos = window_.end;
-                    const bool low_limited = window_.start <= start_tick_; // No more to load on the low-end, window reached start_tick
-                    const bool high_limited = window_.end >= end_tick_; // No more to load on the high-end, window reached end_tick
-                    if(low_distance < high_distance && !low_limited){
-                        // Closer to low side and there is data to load here
-                        // If we hit the memory ceiling, ensure that loading on the low-end of the
-                        // window (and evicting the high end) will not make the high-end closer to
-                        // the last query end and cause a ping-pong loading effect.
-                        if(!hit_memory_ceiling || (low_distance + node_size_ < high_distance)){
-                            load_node_pos = low_pos;
-                        }
-                    }else if(high_distance > 0 && !high_limited){
-                        // Closer on high side and there is data to load here
-                        // If we hit the memory ceiling, ensure that loading on the high-end of the
-                        // window (and evicting the low end) will not make the low-end closer to the
-                        // last query start and cause a ping-pong loading effect.
-                        if(!hit_memory_ceiling || (high_distance + node_size_ < low_distance)){
-                            load_node_pos = high_pos;
-                        }
-                    }
-
-                    //int64_t dist_diff;
-                    //if(high_distance == ~(uint64_t)0){
-                    //    if(low_distance == ~(uint64_t)0){
-                    //        dist_diff = 0; // Full file is loaded. Do not evict anything
-                    //    }else{
-                    //        dist_diff = low_distance; // window reaches upper limit. Difference is lower_distance
-                    //    }
-                    //}else if(low_distance == ~(uint64_t)0){
-                    //    dist_diff = high_distance;
-                    //}else{
-                    //  dist_diff = std::abs(((int64_t)high_distance) - ((int64_t)low_distance));
-                    //}
-                    const int64_t dist_diff = std::abs(static_cast<int64_t>(high_distance) -
-                                                       static_cast<int64_t>(low_distance));
-
-                    if(load_node_pos < INVALID_NODE){
-                        // Check whether it is feasible to add more nodes
-                        if(hit_memory_ceiling){
-                            // Exceeded memory threshold. May need to load new
-                            // blocks, but others must be dropped first. Determine which
-                            // to add and which can be dropped. First, a switch cannot be made
-                            // unless one side is much further from the last query than the other.
-                            // Otherwise, the extra node will be moved from the low to high end
-                            // every time.
-
-                            //std::cout << "|<--" << low_distance << "--[" << last_query_.start << ", "
-                            //    << last_query_.end << "]--" << high_distance << "-->|      (dist_diff="
-                            //    << dist_diff << ")" << std::endl;
-
-                            if(nodes_.size() == 1 ||
-                                dist_diff <= static_cast<int64_t>(node_size_)){
-                                // Cannot possibly drop anything and maintain window, so cannot load anything new
-                                load_node_pos = INVALID_NODE;
-                            }else{
-                                //if(verbose_){
-                                //    std::cout << "(background)" << window_.start << "|<--" << low_distance << "--[" << last_query_.start << ", "
-                                //        << last_query_.end << "]--" << high_distance << "-->|" << window_.end << "   (dist_diff="
-                                //        << dist_diff << ")" << std::endl;
-                                //}
-                                // See if the opposite block is outside of the query range
-                                if(load_node_pos == low_pos && (!high_limited || high_distance >= 2*node_size_)){
-                                    // Get opposite node
-                                    const node_iterator_t delitr = findNode(window_.end - 1);
-                                    if(nodes_.end() != delitr){
-                                        if(delitr->isComplete() && delitr->getStartInclusive() >= last_query_.end){
-                                            if(verbose_){
-                                                std::cout << "(background) removing node:"
-                                                    << delitr->stringize() << std::endl;
-                                            }
-                                            window_.end = delitr->getStartInclusive(); // Move end lower
-                                            nodes_.erase(delitr);
-                                        }else{
-                                            if(verbose_){
-                                                std::cout << "(background) want to slide left, but cannot delete "
-                                                    << delitr->stringize() << std::endl;
-                                            }
-                                            load_node_pos = INVALID_NODE; // Cannot delete this node
-                                        }
-                                    }else{
-                                        if(verbose_){
-                                            std::cout << "(background) want to slide left, but cannot find node containing "
-                                                    << window_.end - 1 << std::endl;
-                                        }
-                                        load_node_pos = INVALID_NODE; // Cannot delete this node
-                                    }
-                                }else if(!low_limited || low_distance >= 2*node_size_){ // given: load_node_pos == high_pos
-                                    const node_iterator_t delitr = findNode(window_.start);
-                                    if(nodes_.end() != delitr){
-                                        if(delitr->isComplete() && delitr->getEndExclusive() <= last_query_.start){
-                                            if(verbose_){
-                                                std::cout << "(background) removing node:"
-                                                    << delitr->stringize() << std::endl;
-                                            }
-                                            window_.start = delitr->getEndExclusive(); // Move start higher
-                                            nodes_.erase(delitr);
-                                        }else{
-                                            if(verbose_){
-                                                std::cout << "(background) want to slide right, but cannot delete "
-                                                    << delitr->stringize() << std::endl;
-                                            }
-                                            load_node_pos = INVALID_NODE; // Cannot delete this node
-                                        }
-                                    }else{
-                                        if(verbose_){
-                                            std::cout << "(background) want to slide right, but cannot find node containing "
-                                                    << window_.start << std::endl;
-                                        }
-                                        load_node_pos = INVALID_NODE; // Cannot delete this node
-                                    }
-                                }else{
-                                    load_node_pos = INVALID_NODE;
-                                }
-                            }
-                        }
-                    }
-
-                    if(load_node_pos < INVALID_NODE){
-                        if(verbose_){
-                            std::cout << "(background) memory use is " << getSizeInBytes() / 1000000000.0 << " GB" << std::endl;
-                        }
-
-                        const node_iterator_t itr = findNode(load_node_pos);
-
-                        nodes_.emplace(itr, load_node_pos, node_size_, num_locations_);
-                        Node& added = *std::prev(itr);
-                        if(verbose_){
-                            std::cout << "(background) inserting Node  @ " << load_node_pos << " size " << node_size_ << std::endl;
-                        }
-
-                        // Update window to contain this new node
-                        if(window_.start > load_node_pos){
-                            window_.start = load_node_pos;
-                        }
-
-                        if(window_.end < load_node_pos + node_size_){
-                            window_.end = load_node_pos + node_size_;
-                        }
-
-                        // Defferred read to avoid walking over the same chunks when
-                        const uint64_t chunk_start = chunk_size_ * (load_node_pos/chunk_size_);
-                        if(verbose_){
-                            std::cout << "(background) loading <CHUNK> @ " << chunk_start << " size " << chunk_size_ << std::endl;
-                        }
-
-                        node_list_mutex_.unlock();
-
-                        std::vector<Node*> added_nodes{&added};
-                        smart_reader_.lock();
-
-                        double t_start = 0;
-                        if(verbose_){
-                            t_start = sparta::TimeManager::getTimeManager().getAbsoluteSeconds();
-                        }
-
-                        smart_reader_.loadDataToNodes(chunk_start, chunk_start + chunk_size_, &added_nodes);
-                        if(verbose_){
-                            const auto t_delta = sparta::TimeManager::getTimeManager().getAbsoluteSeconds() - t_start;
-                            std::cout << "(background)    took " << t_delta << " seconds" << std::endl;
-                        }
-
-                        added.markComplete();
-                        if(verbose_){
-                            std::cout << "(background) marking complete: " << added.stringize() << std::endl;
-                        }
-
-                        smart_reader_.unlock();
-
-                        node_list_mutex_.lock();
-
-                        if(verbose_){
-                            std::cout << "(background) transactiondb: " << stringize() << std::endl;
-                            std::cout << "(background) " << window_.start << "|<--" << low_distance << "--[" << last_query_.start << ", "
-                                        << last_query_.end << "]--" << high_distance << "-->|" << window_.end << "   (dist_diff="
-                                        << dist_diff << ")" << std::endl;
-                        }
-                    }
-                }catch(...){
-                    node_list_mutex_.unlock();
-                    throw;
-                }
-
-                verifyValidWindow_();
-
-                if(update_enabled_ && needs_update)
-                {
+                    reloadUpdatedFile_();
                     update_ready_++;
                 }
-
-                node_list_mutex_.unlock();
+                window_mutex_.unlock();
             }
         }
     }
 
     /*!
-     * \brief
-     * \pre Requiresthe node_list_mutex_
+     * \brief Picks up the new end of an updated database and drops all
+     * nodes, which may be missing the new data
+     * \pre Requires the window_mutex_
      */
-    void verifyValidWindow_()
+    void reloadUpdatedFile_()
     {
-        // Verify that the update algorithm updated the window range correctly
-        if(nodes_.size() > 1){
-            sparta_assert(nodes_.begin()->getStartInclusive() == window_.start);
-            sparta_assert(nodes_.rbegin()->getEndExclusive() == window_.end);
+        end_tick_ = smart_reader_.reader.getCycleLast();
+        unload();
+
+        // Loads already running finish with the old data, but their nodes are
+        // no longer cached
+        for(auto& reader : loader_readers_){
+            reader->refresh();
         }
     }
 
     /*!
-     * \brief Loads data necessary to populate the given range
+     * \brief Loader thread. Decodes queued chunks into their nodes with its
+     * own reader
      */
-    void load_(const uint64_t start_inclusive, const uint64_t end_exclusive)
+    void loaderThread_(const uint32_t loader_idx)
     {
-        if(verbose_){
-            std::cout << "(main) Attempting to load [" << start_inclusive << ", "
-                      << end_exclusive << ")" << std::endl;
-        }
-
-        std::lock_guard<std::recursive_mutex> lock(node_list_mutex_);
-
-        sparta_assert(start_inclusive >= start_tick_);
-        sparta_assert(end_exclusive <= end_tick_);
-
-        // Find nodes. Round down to nearest chunk to start
-        //uint64_t chunk_start = uint64_t(start_inclusive / chunk_size_) * chunk_size_;
-        const uint64_t load_start = uint64_t(start_inclusive / node_size_) * node_size_;
-
-        // cur_pos is current loading tick. It increases in multiples of
-        // chunk_size_. As loaded chunks are encountered or new chunks are loaded,
-        // cur_pos is increased.
-        uint64_t cur_pos = load_start;
-
-        //std::cout << "Loading [" << start_inclusive << "," << end_exclusive << ")"
-        //    << " => starting with "<<  chunk_start << std::endl;
-
-        // This scope block ensures we don't try to reuse itr after we're finished with it
+        SmartReader& reader = *loader_readers_[loader_idx];
+        while(true)
         {
-            // Flag any nodes before the load range for deletion
-            node_iterator_t itr = nodes_.begin();
-            if(itr != nodes_.end()){
-                // Window begins where there is valid data
-                window_.start = itr->getStartInclusive();
-                for(; itr != nodes_.end(); ++itr) {
-                    if(itr->getEndExclusive() <= cur_pos){
-                        if(verbose_){
-                            std::cout << "(main) Flagging for deletion: " << itr->stringize() << std::endl;
-                        }
-                        itr->flagForDeletion();
-                    }else{
-                        // Stop walking through these nodes because this one is after
-                        // (or overlaps) the current load position
-                        break;
-                    }
+            LoadJob job;
+            {
+                std::unique_lock<std::mutex> lock(load_queue_mutex_);
+                load_queue_cv_.wait(lock, [this]{ return loaders_should_exit_ || !load_queue_.empty(); });
+                if(loaders_should_exit_){
+                    return; // End of thread
                 }
-            }else{
-                // Window begins where data will first be loaded
-                window_.start = cur_pos;
+                job = std::move(load_queue_.front());
+                load_queue_.pop_front();
             }
 
-            // Insert nodes until cur_pos reaches the end of the range
-            std::vector<uint64_t> chunks_to_read; // Chunks containing newly created nodes
-            std::vector<Node*> added_nodes;
-            while(cur_pos < end_exclusive){
-
-                // Incomplete nodes are ok. Just don't read their data
-                //// Check for incomplete (BAD) nodes.
-                //// These can occur if an exception occurs during loading
-                //if(itr != nodes_.end() && itr->isComplete() == false){
-                //    // Remove this incomplete node
-                //    std::cerr << "Incomplete node encountered: " << itr->stringize()
-                //        << ", removing and reloading." << std::endl;
-                //    node_iterator_t temp = itr;
-                //    ++itr; // Move to next, allowing a replacement to be added
-                //    nodes_.erase(temp);
-                //}
-
-                // Add or skip the current element
-                if(itr == nodes_.end() ||
-                    cur_pos < itr->getStartInclusive()){
-                    // Assuming exclusive right endpoint of transactions
-                    //nodes_.emplace(itr, Node(cur_pos, chunk_size_, num_locations_));
-                    sparta_assert(cur_pos % node_size_ == 0);
-                    const auto new_itr = nodes_.emplace(itr, cur_pos, node_size_, num_locations_);
-                    added_nodes.push_back(&*(new_itr));
-                    if(verbose_) {
-                        std::cout << "(main)  Inserting Node  @ " << cur_pos << " size " << node_size_ << std::endl;
-                    }
-
-                    // Update window
-                    if(window_.start > cur_pos){
-                        window_.start = cur_pos;
-                    }
-
-                    // Defferred read to avoid walking over the same chunks when
-                    const uint64_t chunk_start = chunk_size_ * (cur_pos/chunk_size_);
-                    if(chunks_to_read.size() == 0 or chunks_to_read[chunks_to_read.size() - 1] != chunk_start){
-                        chunks_to_read.push_back(chunk_start);
-                    }
-                }else{
-                    if(verbose_){
-                        std::cout << "(main) Skipping insertion @ " << cur_pos << " ended="
-                            << (itr==nodes_.end()) << ", node start=" << itr->getStartInclusive() << std::endl;
-                    }
-                    ++itr;
-                }
-                cur_pos += node_size_;
+            double t_start = 0;
+            if(verbose_){
+                std::cout << "(loader " << loader_idx << ") loading <CHUNK> @ " << job.chunk_start
+                          << " size " << chunk_size_ << " into " << job.nodes.size() << " nodes"
+                          << (job.prefetch ? " (prefetch)" : "") << std::endl;
+                t_start = sparta::TimeManager::getTimeManager().getAbsoluteSeconds();
             }
 
-            smart_reader_.lock();
-
-            // Load the chunks which broadcast to 1 or more Nodes
-            // Because node_size_ is an even division of chunk_size_, only the chunk
-            // at chunk_start must be read
-            for(uint64_t chunk_start : chunks_to_read) {
-                double t_start = 0;
-                if(verbose_){
-                    std::cout << "(main) Loading <CHUNK> @ " << chunk_start << " size " << chunk_start + chunk_size_ << std::endl;
-                    t_start = sparta::TimeManager::getTimeManager().getAbsoluteSeconds();
-                }
-                smart_reader_.loadDataToNodes(chunk_start, chunk_start + chunk_size_, &added_nodes);
-                if(verbose_){
-                    auto t_delta = sparta::TimeManager::getTimeManager().getAbsoluteSeconds() - t_start;
-                    std::cout << "(main)    took " << t_delta << " seconds" << std::endl;
-                }
+            std::vector<Node*> load_to;
+            for(const NodePtr& node : job.nodes){
+                load_to.push_back(node.get());
             }
 
-            // Mark fully loaded, newly constructed nodes as valid
-            for(auto& n : added_nodes){
-                n->markComplete();
-                if(verbose_){
-                    std::cout << "(main) marking complete: " << n->stringize() << std::endl;
-                }
+            std::exception_ptr load_error;
+            reader.lock();
+            try{
+                reader.loadDataToNodes(job.chunk_start, job.chunk_start + chunk_size_, &load_to);
+            }catch(...){
+                load_error = std::current_exception();
+                reader.resetQueryState();
             }
-
-            smart_reader_.unlock();
+            reader.unlock();
 
             if(verbose_){
-                std::cout << "(main) Added nodes marked as complete" << std::endl;
+                const auto t_delta = sparta::TimeManager::getTimeManager().getAbsoluteSeconds() - t_start;
+                std::cout << "(loader " << loader_idx << ")    took " << t_delta << " seconds" << std::endl;
             }
 
-            // Walk through nodes out of the load range and flag them for deletion
-            if(itr != nodes_.end()) {
-                if(cur_pos == itr->getStartInclusive()) {
-                    // Contiguous nodes, flag for deletion
-
-                    for(; itr != nodes_.end(); ++itr) {
-                        if(verbose_) {
-                            std::cout << "(main) Flagging for deletion: " << itr->stringize() << std::endl;
-                        }
-                        itr->flagForDeletion();
-                        cur_pos = itr->getEndExclusive();
-                    }
+            for(const NodePtr& node : job.nodes){
+                const uint64_t idx = node->getStartInclusive() / node_size_;
+                if(load_error){
+                    // Drop the node so that the next query retries it
+                    nodes_.erase(idx, node);
                 }
-                else{
-                    // Non-contiguous nodes. Gaps are not allowed. Remove immediately
-                    if(verbose_) {
-                        while(itr != nodes_.end()) {
-                            std::cout << "(main) Erasing non-contiguous node following data: "
-                                      << itr->stringize() << std::endl;
-                            itr = nodes_.erase(itr);
-                        }
-                    }
-                    else {
-                        // Use the range erase method if we don't need to print any messages
-                        nodes_.erase(itr, nodes_.end());
-                    }
+                node->markComplete(load_error);
+                if(!load_error){
+                    nodes_.nodeLoaded(idx, node);
                 }
             }
-            // We should be done with itr now, so we don't bother updating it in the above block
         }
+    }
 
-        // New cur pos at the end of the data
-        window_.end = cur_pos;
-
-        // Verify window endpoints surround load endpoints
-        sparta_assert(window_.start <= start_inclusive);
-        sparta_assert(window_.end >= end_exclusive);
-
-        // Clean up deleted nodes for now. Result must be a contiguous series of
-        // nodes, implying that cleanup can only remove from the ends.
-        // Also adjusts window_
-        //
-        // This will be done by a thread later and controlled by a memory and
-        // idle threshold
-        node_iterator_t n = nodes_.begin();
-        bool keeper_encountered = false; // Have any nodes been kept yet?
-        while(n != nodes_.end()){
-            if(n->canDelete()){
-                // Encountered a node flagged for deletion
-                if(verbose_){
-                    std::cout << "(main) CAN delete node " << n->stringize() << std::endl;
-                }
-                if(keeper_encountered){
-                    // Move window end to beginning of this node
-                    // This should be hit on the first node after a stream of 1
-                    // or more nodes that were kept (not deleted)
-                    if(window_.end > n->getStartInclusive()){
-                        window_.end = n->getStartInclusive();
-                    }
+    /*!
+     * \brief Gets the nodes in a range of node indices, creating and queuing
+     * loads for any that are not cached
+     * \param first_node Index of the first node
+     * \param end_node Exclusive index of the last node
+     * \param prefetch Speculative load. Nodes are only created, and are
+     * queued behind all other loads as the first candidates for eviction
+     * \return The nodes in the range, in order. Empty if \a prefetch
+     * \pre Requires the window_mutex_
+     */
+    std::vector<NodePtr> requestNodes_(const uint64_t first_node, const uint64_t end_node, const bool prefetch)
+    {
+        std::vector<NodePtr> nodes;
+        std::vector<LoadJob> jobs;
+        for(uint64_t idx = first_node; idx < end_node; ++idx){
+            NodePtr node;
+            if(prefetch){
+                if(nodes_.contains(idx)){
+                    continue;
                 }
-
-                const node_iterator_t temp = n;
-                ++n;
-                nodes_.erase(temp);
             }else{
+                node = nodes_.find(idx);
+            }
+
+            if(!node){
+                node = std::make_shared<Node>(idx * node_size_, node_size_, num_locations_);
+                nodes_.insert(idx, node, !prefetch);
                 if(verbose_){
-                    std::cout << "(main) can NOT delete node " << n->stringize() << std::endl;
+                    std::cout << "(main) Inserting Node  @ " << idx * node_size_ << " size " << node_size_
+                              << (prefetch ? " (prefetch)" : "") << std::endl;
                 }
-                // Encountered first node that will be kept in the list
-                if(!keeper_encountered){
-                    // This is the first node to keep.
-                    // Move window start to start of this node
-                    window_.start = n->getStartInclusive();
+
+                // Because node_size_ is an even division of chunk_size_, only
+                // the chunk containing a node must be read to load it
+                const uint64_t chunk_start = chunk_size_ * (idx * node_size_ / chunk_size_);
+                if(jobs.empty() || jobs.back().chunk_start != chunk_start){
+                    jobs.emplace_back();
+                    jobs.back().chunk_start = chunk_start;
+                    jobs.back().prefetch = prefetch;
                 }
+                jobs.back().nodes.emplace_back(node);
+            }
 
-                ++n;
-                keeper_encountered = true;
+            if(!prefetch){
+                nodes.emplace_back(std::move(node));
             }
         }
 
-        // In the case where this happens (whicih it really shouldn't), reset
-        // the window so the next load will be forced to load everything
-        if(nodes_.size() == 0){
-            window_.start = 0;
-            window_.end = 0;
+        if(!jobs.empty()){
+            {
+                std::lock_guard<std::mutex> lock(load_queue_mutex_);
+                if(prefetch){
+                    load_queue_.insert(load_queue_.end(),
+                                       std::make_move_iterator(jobs.begin()),
+                                       std::make_move_iterator(jobs.end()));
+                }else{
+                    load_queue_.insert(load_queue_.begin(),
+                                       std::make_move_iterator(jobs.begin()),
+                                       std::make_move_iterator(jobs.end()));
+                }
+            }
+            load_queue_cv_.notify_all();
         }
+        return nodes;
+    }
 
-        if(verbose_){
-            std::cout << "(main) transactiondb: " << stringize() << std::endl;
-            std::cout << "(main) " << window_.start << "|<--" << " ... " << "--[" << last_query_.start << ", "
-                        << last_query_.end << "]--" << " ... " << "-->|" << window_.end << std::endl;
+    /*!
+     * \brief Queues loads of the nodes on either side of the last query, on
+     * the guess that the next query will be that range shifted a bit. As
+     * much as the last query spans, and at least one heartbeat, is
+     * prefetched on each side
+     * \pre Requires the window_mutex_
+     */
+    void prefetch_()
+    {
+        if(last_query_.end <= last_query_.start){
+            return;
         }
+
+        const uint64_t first_node = last_query_.start / node_size_;
+        const uint64_t end_node = (last_query_.end + node_size_ - 1) / node_size_;
+        const uint64_t span = std::max(end_node - first_node, chunk_size_ / node_size_);
+        const uint64_t file_first_node = start_tick_ / node_size_;
+        const uint64_t file_end_node = (end_tick_ + node_size_ - 1) / node_size_;
+
+        // Scrolling forward is the common case, so load ahead first
+        requestNodes_(end_node, std::min(end_node + span, file_end_node), true);
+        requestNodes_(std::max(first_node, file_first_node + span) - span, first_node, true);
     }
 
     /*!
-     * \brief Finds first node containing tick or, if no nodes contain tick, the
-     * first node node after the tick.
+     * \brief Drops loads that no loader thread has started and removes their
+     * nodes from the cache
+     * \param prefetch_only Only drop prefetches
+     * \pre Requires the window_mutex_
      */
-    node_iterator_t findNode(const uint64_t tick)
+    void cancelLoads_(const bool prefetch_only)
     {
-        node_iterator_t n = nodes_.begin();
-        if(n == nodes_.end()){
-            return n;
-        }
-        if(n->getStartInclusive() > tick){
-            return nodes_.begin();
-        }
-        for(; n != nodes_.end(); ++n){
-            if(n->getEndExclusive() > tick){
-                return n;
+        std::lock_guard<std::mutex> lock(load_queue_mutex_);
+        auto itr = load_queue_.begin();
+        while(itr != load_queue_.end()){
+            if(!prefetch_only || itr->prefetch){
+                for(const NodePtr& node : itr->nodes){
+                    nodes_.erase(node->getStartInclusive() / node_size_, node);
+                }
+                itr = load_queue_.erase(itr);
+            }else{
+                ++itr;
             }
         }
-        return nodes_.end();
     }
 };
 
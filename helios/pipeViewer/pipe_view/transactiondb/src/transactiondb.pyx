@@ -23,7 +23,7 @@ cdef extern from "TransactionDatabaseInterface.hpp" namespace "sparta::pipeViewe
     ##                                    uint32_t content_len)
 
     cdef cppclass c_TransactionDatabaseInterface "sparta::pipeViewer::TransactionDatabaseInterface":
-        c_TransactionDatabaseInterface(string, uint32_t, bint) except +IOError # Can throw if file not opened
+        c_TransactionDatabaseInterface(string, uint32_t, bint, uint32_t) except +IOError # Can throw if file not opened
 
         void unload()
         void resetQueryState()
@@ -375,9 +375,11 @@ cdef class TransactionDatabase:
         self.__cached_annotations = {}
         self.__trans_proxy = Transaction(None, True) # Create a Proxy
 
-    def __init__(self, filename, num_locs, update_enabled):
+    def __init__(self, filename, num_locs, update_enabled, num_loader_threads=0):
         """
         Create a c_TransactionDatabaseInterface* based on the chosen filename
+        num_loader_threads: Number of threads loading data in the background.
+        0 picks a default based on the number of hardware threads
         """
         if not isinstance(filename, (str, unicode)):
             raise TypeError('filename must be a str, is type {0}'.format(type(filename)))
@@ -386,7 +388,7 @@ cdef class TransactionDatabase:
         cdef uint32_t c_num_locs = num_locs
         cdef char* c_str = <bytes><str>filename
         cdef string c_s = filename.encode('utf-8')
-        self.__window = new c_TransactionDatabaseInterface(c_s, num_locs, update_enabled)
+        self.__window = new c_TransactionDatabaseInterface(c_s, num_locs, update_enabled, num_loader_threads)
 
     def __dealloc__(self):
         self._destroy()
@@ -0,0 +1,39 @@
+#!/bin/sh
+
+# Times the core example with pipeline collection (-z), written on the
+# simulation thread and with --pipeline-writer-thread, and checks that
+# both write the same pipeout files.  A run without collection is timed
+# for reference.
+#
+# Usage: ./pipeout_writer_benchmark.sh [INSTRUCTIONS]   (default 1M)
+
+set -e
+
+INSTS=${1:-1M}
+OUT=pipeout_bench
+
+rm -rf $OUT
+mkdir -p $OUT/sync $OUT/thread
+
+# Runs the example with the given arguments and prints the wall time
+timed_run() {
+    label=$1
+    shift
+    start=$(date +%s.%N)
+    ./sparta_core_example -i $INSTS "$@" > $OUT/$label.out
+    end=$(date +%s.%N)
+    echo "$start $end" | awk -v label="$label" '{ printf "%-22s %8.3f s\n", label, $2 - $1 }'
+}
+
+timed_run no_collection
+timed_run collection -z $OUT/sync/
+timed_run collection_thread -z $OUT/thread/ --pipeline-writer-thread
+
+# Everything but the run information (which has the date) must match
+for f in $OUT/sync/*; do
+    name=$(basename $f)
+    if [ "$name" != "simulation.info" ]; then
+        cmp $f $OUT/thread/$name || exit 1
+    fi
+done
+echo "Pipeout files match"
@@ -33,7 +33,9 @@ public:
                     const std::set<std::string>& pipeline_enabled_node_names,
                     uint64_t pipeline_heartbeat,
                     bool multiple_triggers,
-                    sparta::Clock * clk, sparta::RootTreeNode * rtn) :
+                    sparta::Clock * clk, sparta::RootTreeNode * rtn,
+                    bool background_writer = false,
+                    bool compress = false) :
         pipeline_collection_path_(pipeline_collection_path),
         pipeline_enabled_node_names_(pipeline_enabled_node_names),
         pipeline_heartbeat_(pipeline_heartbeat),
@@ -46,6 +48,8 @@ public:
                                                             pipeline_heartbeat_,
                                                             clk_,
                                                             root_));
+        pipeline_collector_->setBackgroundWriter(background_writer);
+        pipeline_collector_->setCompression(compress);
 
     }
 
@@ -632,6 +632,18 @@ public:
      */
     std::string pipeline_collection_file_prefix = NoPipelineCollectionStr;
 
+    /*!
+     * Write the pipeline collection record and index files from a
+     * background thread (--pipeline-writer-thread)
+     */
+    bool pipeline_writer_thread = false;
+
+    /*!
+     * Write the pipeline collection record file as compressed chunks
+     * (--pipeline-compress)
+     */
+    bool pipeline_compress = false;
+
     /*!
      * Additional report descriptions
      */
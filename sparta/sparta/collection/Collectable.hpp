@@ -12,6 +12,10 @@
 #include <algorithm>
 #include <sstream>
 #include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <streambuf>
 #include <type_traits>
 #include <iomanip>
 
@@ -30,6 +34,47 @@ namespace sparta{
     namespace collection
     {
 
+        /**
+         * \class AnnotationStream
+         * \brief An std::ostream that appends to a std::string it is
+         *        given, so that one string's storage can be reused for
+         *        every annotation
+         */
+        class AnnotationStream : private std::streambuf, public std::ostream
+        {
+        public:
+            AnnotationStream() : std::ostream(this) {}
+
+            //! Append to \a str until told otherwise, with the
+            //! formatting of a new stream
+            void setString(std::string * str) {
+                str_ = str;
+                clear();
+                flags(std::ios_base::dec | std::ios_base::skipws);
+                fill(' ');
+                precision(6);
+                width(0);
+            }
+
+        private:
+            using int_type = std::streambuf::int_type;
+            using traits_type = std::streambuf::traits_type;
+
+            int_type overflow(int_type c) override {
+                if(c != traits_type::eof()) {
+                    str_->push_back(traits_type::to_char_type(c));
+                }
+                return c;
+            }
+
+            std::streamsize xsputn(const char * s, std::streamsize n) override {
+                str_->append(s, n);
+                return n;
+            }
+
+            std::string * str_ = nullptr;
+        };
+
         /**
          * \class Collectable
          * \brief Class used to either manually or auto-collect an Annotation String
@@ -43,6 +88,16 @@ namespace sparta{
          *  constructed with a collected_object.  If no object is
          *  provided, it assumes a manual collection and the
          *  scheduling phase is ignored.
+         *
+         *  By default, every collection formats the value with
+         *  operator<< to see whether the annotation changed.  For
+         *  values collected every cycle that rarely change, call
+         *  setCompareByValue() or setFingerprint() before collection
+         *  starts: changes are then found by comparing the values (or
+         *  their fingerprints), and a value is only formatted when its
+         *  record is written, into a string kept by the Collectable.
+         *  The pipeout is the same either way, as long as equal values
+         *  (or fingerprints) mean equal annotations.
          */
 
         template<typename DataT, SchedulingPhase collection_phase = SchedulingPhase::Collection, typename = void>
@@ -51,6 +106,10 @@ namespace sparta{
         public:
             static constexpr uint64_t BAD_DISPLAY_ID = 0x1000;
 
+            //! Returns a value that differs whenever the annotations
+            //! of two values would (see setFingerprint)
+            using FingerprintFunc = std::function<uint64_t(const DataT &)>;
+
             /**
              * \brief Construct the Collectable, no data object associated, part of a group
              * \param parent A pointer to a parent treenode.  Must not be null
@@ -146,20 +205,66 @@ namespace sparta{
              * \param val The value to initial the record with
              */
             void initialize(const DataT & val) {
+                if(lazy_annot_) {
+                    setCurrentValue_(val);
+                    return;
+                }
                 std::ostringstream ss;
                 ss << val;
                 prev_annot_ = ss.str();
             }
 
+            /**
+             * \brief Detect changes by comparing collected values with
+             *        DataT::operator== instead of formatting them
+             *
+             * Only correct if equal values always have the same
+             * annotation.  For a pointer, that means the pointer itself
+             * is compared, not what it points to; use setFingerprint
+             * for those.
+             *
+             * \pre Collection has not started
+             */
+            void setCompareByValue()
+            {
+                enableLazyAnnotation_();
+                lazy_annot_->same_value = [](const DataT & a, const DataT & b) { return a == b; };
+                lazy_annot_->fingerprint = nullptr;
+            }
+
+            /**
+             * \brief Detect changes by comparing a fingerprint of the
+             *        collected values instead of formatting them
+             * \param fingerprint Called once per collection.  Must return
+             *                    different values for values whose
+             *                    annotations differ.
+             *
+             * \pre Collection has not started
+             */
+            void setFingerprint(const FingerprintFunc & fingerprint)
+            {
+                sparta_assert(fingerprint != nullptr,
+                              "Null fingerprint function given to " << getLocation());
+                enableLazyAnnotation_();
+                lazy_annot_->fingerprint = fingerprint;
+                lazy_annot_->same_value = nullptr;
+            }
+
             //! Explicitly/manually collect a value for this collectable, ignoring
             //! what the Collectable is currently pointing to.
             void collect(const DataT & val)
             {
                 if(SPARTA_EXPECT_FALSE(isCollected()))
                 {
+                    if(lazy_annot_) {
+                        collectLazy_(val);
+                        return;
+                    }
+
                     std::ostringstream ss;
                     ss << val;
-                    if((ss.str() != prev_annot_) && !record_closed_)
+                    std::string annot = ss.str();
+                    if((annot != prev_annot_) && !record_closed_)
                     {
                         // Close the old record (if there is one)
                         closeRecord();
@@ -167,7 +272,7 @@ namespace sparta{
 
                     // Remember the new string for a new record and start
                     // a new record if not empty.
-                    prev_annot_ = ss.str();
+                    prev_annot_ = std::move(annot);
                     if(!prev_annot_.empty() && record_closed_) {
                         startNewRecord_();
                         record_closed_ = false;
@@ -242,6 +347,9 @@ namespace sparta{
                 {
                     if(!record_closed_ && writeRecord_(simulation_ending)) {
                         prev_annot_.clear();
+                        if(lazy_annot_) {
+                            lazy_annot_->cur_value.reset();
+                        }
                     }
                     record_closed_ = true;
                 }
@@ -275,6 +383,15 @@ namespace sparta{
                     return false;
                 }
 
+                // Lazily annotated records are opened before the value
+                // is formatted; empty ones are never written
+                if(lazy_annot_) {
+                    formatAnnotation_();
+                    if(prev_annot_.empty()) {
+                        return false;
+                    }
+                }
+
                 // Set a new transaction ID since we're starting anew
                 argos_record_.transaction_ID = pipeline_col_->getUniqueTransactionId();
 
@@ -307,6 +424,76 @@ namespace sparta{
                 argos_record_.time_Start = pipeline_col_->getScheduler()->getCurrentTick();
             }
 
+            //! Switch to comparing values rather than annotations
+            void enableLazyAnnotation_()
+            {
+                static_assert(std::is_copy_constructible<DataT>::value && std::is_copy_assignable<DataT>::value,
+                              "Collectable change detection by value needs a copyable DataT");
+                sparta_assert(!isCollected() && record_closed_,
+                              "Change detection must be chosen before collection starts on "
+                              << getLocation());
+                // Kept out of line so Collectables that never opt in
+                // stay small
+                lazy_annot_.reset(new LazyAnnotation);
+                if(collected_object_) {
+                    setCurrentValue_(*collected_object_);
+                }
+            }
+
+            //! Remember \a val as the value of the current record; its
+            //! annotation is formatted when needed
+            void setCurrentValue_(const DataT & val)
+            {
+                if constexpr (std::is_copy_constructible<DataT>::value && std::is_copy_assignable<DataT>::value) {
+                    lazy_annot_->cur_value = val;
+                    if(lazy_annot_->fingerprint) {
+                        lazy_annot_->cur_fingerprint = lazy_annot_->fingerprint(val);
+                    }
+                    lazy_annot_->annot_stale = true;
+                }
+            }
+
+            //! collect() for setCompareByValue/setFingerprint
+            void collectLazy_(const DataT & val)
+            {
+                LazyAnnotation & lazy = *lazy_annot_;
+                bool changed = !lazy.cur_value.has_value();
+                if(!changed) {
+                    changed = lazy.fingerprint ? (lazy.fingerprint(val) != lazy.cur_fingerprint) :
+                        !lazy.same_value(val, *lazy.cur_value);
+                }
+
+                if(changed) {
+                    if(!record_closed_) {
+                        // Close the old record (if there is one)
+                        closeRecord();
+                    }
+                    setCurrentValue_(val);
+                }
+
+                // Unlike the default path, the record is opened even if
+                // the annotation turns out to be empty; writeRecord_
+                // drops it
+                if(record_closed_) {
+                    startNewRecord_();
+                    record_closed_ = false;
+                }
+            }
+
+            //! Format the current value into prev_annot_, if not already
+            void formatAnnotation_()
+            {
+                LazyAnnotation & lazy = *lazy_annot_;
+                if(lazy.annot_stale) {
+                    prev_annot_.clear();
+                    if(lazy.cur_value.has_value()) {
+                        lazy.annot_stream.setString(&prev_annot_);
+                        lazy.annot_stream << *lazy.cur_value;
+                    }
+                    lazy.annot_stale = false;
+                }
+            }
+
             //! Virtual method called by CollectableTreeNode when
             //! collection is enabled on the TreeNode
             void setCollecting_(bool collect, Collector * collector) override final
@@ -315,6 +502,9 @@ namespace sparta{
                 sparta_assert(pipeline_col_ != nullptr,
                             "Collectables can only added to PipelineCollectors... for now");
 
+                if(lazy_annot_) {
+                    formatAnnotation_();
+                }
                 if(collect && !prev_annot_.empty()) {
                     // Set the start time for this transaction to be
                     // moment collection is enabled.
@@ -353,6 +543,22 @@ namespace sparta{
             // annotation_t struct holds a pointer to this
             std::string prev_annot_;
 
+            // For setCompareByValue/setFingerprint: the value of the
+            // current record, its fingerprint, and whether prev_annot_
+            // still needs to be formatted from it
+            struct LazyAnnotation
+            {
+                std::optional<DataT> cur_value;
+                uint64_t cur_fingerprint = 0;
+                bool annot_stale = false;
+                bool (*same_value)(const DataT &, const DataT &) = nullptr;
+                FingerprintFunc fingerprint;
+                AnnotationStream annot_stream;
+            };
+
+            // Only allocated once one of them is called
+            std::unique_ptr<LazyAnnotation> lazy_annot_;
+
             // Ze Collec-tor
             PipelineCollector * pipeline_col_ = nullptr;
 
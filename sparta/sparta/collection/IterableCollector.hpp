@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -70,6 +71,7 @@ class IterableCollector : public CollectableTreeNode
 {
 public:
     typedef typename IterableType::size_type size_type;
+    typedef typename std::iterator_traits<typename IterableType::iterator>::value_type value_type;
 
     /**
      * \brief constructor
@@ -263,6 +265,28 @@ public:
         auto_collect_ = false;
     }
 
+    /**
+     * \brief Detect changes in each position with operator== on the
+     *        elements instead of formatting them every collection
+     * \see Collectable::setCompareByValue
+     */
+    void setCompareByValue() {
+        for (auto & position : positions_) {
+            position->setCompareByValue();
+        }
+    }
+
+    /**
+     * \brief Detect changes in each position with a fingerprint of the
+     *        elements instead of formatting them every collection
+     * \see Collectable::setFingerprint
+     */
+    void setFingerprint(const std::function<uint64_t(const value_type &)> & fingerprint) {
+        for (auto & position : positions_) {
+            position->setFingerprint(fingerprint);
+        }
+    }
+
     //! \brief Perform a collection, then close the records in the future
     //! \param duration The time to close the records, 0 is not allowed
     void collectWithDuration(sparta::Clock::Cycle duration) {
@@ -280,7 +304,7 @@ public:
     }
 
 private:
-    typedef Collectable<typename std::iterator_traits<typename IterableType::iterator>::value_type> CollectableT;
+    typedef Collectable<value_type> CollectableT;
     // Standard walk of iterable types
     void collectImpl_(const IterableType * iterable_object, std::false_type)
     {
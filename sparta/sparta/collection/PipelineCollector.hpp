@@ -345,7 +345,10 @@ namespace collection
             if(collection_active_ == false)
             {
                 // Create the outputter used for writing transactions to disk.
-                writer_.reset(new pipeViewer::Outputter(filepath_, heartbeat_interval_));
+                writer_.reset(new pipeViewer::Outputter(filepath_, heartbeat_interval_, background_writer_,
+                                                        pipeViewer::Outputter::DEFAULT_BLOCK_BYTES,
+                                                        pipeViewer::Outputter::DEFAULT_MAX_BLOCKS,
+                                                        compress_));
 
                 // We need to write an index on the start BEFORE any transactions have been written.
                 writer_->writeIndex();
@@ -571,6 +574,39 @@ namespace collection
             return filepath_;
         }
 
+        /**
+         * \brief Write the record and index files from a background
+         *        thread (see pipeViewer::Outputter).  The files are the
+         *        same either way.
+         * \pre Collection is not active
+         */
+        void setBackgroundWriter(bool background_writer) {
+            sparta_assert(!collection_active_,
+                          "The pipeline collection writer can only be changed while collection is not active");
+            background_writer_ = background_writer;
+        }
+
+        //! \return true if a background thread writes the pipeout
+        bool hasBackgroundWriter() const {
+            return background_writer_;
+        }
+
+        /**
+         * \brief Write the record file as compressed chunks with a
+         *        chunk index (see pipeViewer::Outputter)
+         * \pre Collection is not active
+         */
+        void setCompression(bool compress) {
+            sparta_assert(!collection_active_,
+                          "Pipeline collection compression can only be changed while collection is not active");
+            compress_ = compress;
+        }
+
+        //! \return true if the record file is written compressed
+        bool isCompressed() const {
+            return compress_;
+        }
+
         //! \return the scheduler for this collector
         Scheduler* getScheduler() const {
             return scheduler_;
@@ -619,6 +655,12 @@ namespace collection
         //! transactions to physical disk.
         std::unique_ptr<pipeViewer::Outputter> writer_;
 
+        //! Should writer_ write from a background thread?
+        bool background_writer_ = false;
+
+        //! Should writer_ compress the record file?
+        bool compress_ = false;
+
         //! A pointer to the root sparta TreeNode of the
         //! simulation. Important for writing the location map file.
         std::unique_ptr<pipeViewer::LocationFileWriter> location_writer_;
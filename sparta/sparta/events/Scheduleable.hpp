@@ -207,9 +207,6 @@ namespace sparta
 
         /*! \brief Return true if this scheduleable was scheduled at all
          * \return true if scheduled at all
-         *
-         * This is an expensive call as it searches all time quantums
-         * for instances of this Scheduleable object.  Use with care.
          */
         bool isScheduled() const {
             return scheduler_->isScheduled(this);
@@ -511,6 +508,39 @@ namespace sparta
         //! per tick)
         const bool is_unique_event_ = false;
 
+        /**
+         * \brief Scheduler bookkeeping: the number of times this
+         *        Scheduleable is outstanding on the Scheduler and
+         *        where it was most recently placed.
+         *
+         * The location is only valid if quantum is not nullptr.  It
+         * allows the Scheduler to query and cancel a Scheduleable
+         * without searching.  This information is never copied with
+         * the Scheduleable.
+         */
+        struct SchedulerLocation
+        {
+            SchedulerLocation() = default;
+            SchedulerLocation(const SchedulerLocation &) noexcept {}
+            SchedulerLocation & operator=(const SchedulerLocation &) noexcept { return *this; }
+
+            //! Forget everything -- the Scheduler dropped all events
+            void reset() {
+                num_outstanding = 0;
+                quantum = nullptr;
+                group = 0;
+                slot = 0;
+            }
+
+            uint32_t num_outstanding = 0; //!< Number of times scheduled, not fired/cancelled
+            void   * quantum = nullptr;   //!< Opaque Scheduler time quantum
+            uint32_t group = 0;           //!< Firing group in the quantum
+            uint32_t slot = 0;            //!< Slot in the firing group
+        };
+
+        //! Maintained by the Scheduler
+        mutable SchedulerLocation sched_location_;
+
     };//End class Scheduleable
 
 
@@ -9,6 +9,8 @@
 #include <math.h>
 #include <list>
 #include <cstring>
+#include <memory>
+#include <type_traits>
 #include <unordered_map>
 
 #include "sparta/utils/StaticInit.hpp"
@@ -153,6 +155,10 @@ namespace sparta
          *
          * Allocated line is dirty by default. An ArchData should not allocate
          * a line being read if the initial value is known.
+         *
+         * An allocated line's data can be shared with checkpoint storage (see
+         * share and restoreShared) instead of copied. The line then copies
+         * its data before the next write, so the shared copy never changes.
          */
         class Line
         {
@@ -214,6 +220,7 @@ namespace sparta
             void updateFrom(const Line& other)
             {
                 sparta_assert(size_ == other.size_);
+                unshare_(false);
                 memcpy(data_, other.data_, size_);
                 dirty_ = true;
             }
@@ -233,6 +240,7 @@ namespace sparta
              * \param initial_val_size Bytes to use of \a initial value
              */
             void fillWithInitial(uint64_t initial, uint32_t initial_val_size) {
+                unshare_(false);
                 ArchData::fillValue(data_, size_, initial, initial_val_size, 0);
             }
 
@@ -247,6 +255,7 @@ namespace sparta
              */
             template <typename StorageT>
             void restore(StorageT& in) {
+                unshare_(false);
                 in.copyLineBytes((char*)data_, size_);
                 dirty_ = false;
             }
@@ -266,6 +275,58 @@ namespace sparta
                 dirty_ = false;
             }
 
+            /*!
+             * \brief Store data to output buffer by sharing this line's data
+             * with it instead of copying it. This line copies its data before
+             * the next write to it.
+             * \param out Output buffer. Must support shareLineBytes
+             *
+             * Lines whose data is part of a pool or has been handed out by
+             * getRawDataPtr cannot be shared, so these are copied as in save.
+             *
+             * \post dirty flag cleared for this line
+             */
+            template <typename StorageT>
+            void share(StorageT& out) {
+                if(!canShare_()){
+                    save(out);
+                    return;
+                }
+                out.shareLineBytes(alloc_data_, size_);
+                shared_ = true;
+                dirty_ = false;
+            }
+
+            /*!
+             * \brief Restore data from input buffer by sharing its data
+             * instead of copying it. This line copies the data before the
+             * next write to it.
+             * \param in Input buffer. Must support getSharedLineBytes
+             *
+             * Lines which cannot be shared (see share) are copied as in restore.
+             *
+             * \post dirty flag cleared for this line
+             */
+            template <typename StorageT>
+            void restoreShared(StorageT& in) {
+                if(!canShare_()){
+                    restore(in);
+                    return;
+                }
+                alloc_data_ = in.getSharedLineBytes(size_);
+                data_ = alloc_data_.get();
+                shared_ = true;
+                dirty_ = false;
+            }
+
+            /*!
+             * \brief Is this line's data currently shared with checkpoint
+             * storage (i.e. will the next write to it copy the data first)
+             */
+            bool isShared() const {
+                return shared_ && alloc_data_.use_count() > 1;
+            }
+
             /*!
              * \brief Index of this line (typically offset/line_size)
              */
@@ -357,6 +418,7 @@ namespace sparta
                               "Write on ArchData::line offset 0x" << std::hex
                               << loc << " with size " << std::dec << sizeof(T) << " B");
 
+                unshare_(true);
                 uint8_t* d = data_ + loc;
 
                 dirty_ = true;
@@ -372,11 +434,12 @@ namespace sparta
              * object
              * \note offset+size must be <= the size of this line
              */
-            void write(offset_type offset, offset_type size, const uint8_t* data) const {
+            void write(offset_type offset, offset_type size, const uint8_t* data) {
                 sparta_assert(offset + size <= size_,
                               "Read on ArchData::line offset 0x" << std::hex
                               << offset << " with size " << std::dec << size << " B");
 
+                unshare_(true);
                 memcpy(data_ + offset, data, size);
                 dirty_ = true;
             }
@@ -399,18 +462,53 @@ namespace sparta
             /*!
              * \brief return the raw data pointer for this line for direct read and
              * write. No error checking is performed. Should be used with care.
+             * \note Since writes through this pointer cannot be seen, this
+             * line's data is never shared with checkpoint storage afterward
              */
-            uint8_t* getRawDataPtr(const offset_type offset) { return (data_ + offset); }
+            uint8_t* getRawDataPtr(const offset_type offset) {
+                unshare_(true);
+                exposed_ = true;
+                return (data_ + offset);
+            }
 
         private:
 
+            //! Can this line's data be shared with checkpoint storage
+            bool canShare_() const {
+                return !is_pool_ && !exposed_;
+            }
+
+            /*!
+             * \brief Gives this line its own copy of its data if it is shared
+             * with checkpoint storage. Must be called before any change to the
+             * data
+             * \param keep_data Copy the current data. If false, caller is about
+             * to overwrite all of it
+             */
+            void unshare_(bool keep_data) {
+                if(__builtin_expect(shared_, 0)){
+                    // Nothing else holds the data once the storage is gone
+                    if(alloc_data_.use_count() > 1){
+                        std::shared_ptr<uint8_t[]> data(new uint8_t[size_]);
+                        if(keep_data){
+                            memcpy(data.get(), data_, size_);
+                        }
+                        alloc_data_ = std::move(data);
+                        data_ = alloc_data_.get();
+                    }
+                    shared_ = false;
+                }
+            }
+
             line_idx_type idx_;  //!< Index of this line
             offset_type offset_; //!< Offset into owning ArchData
             offset_type size_;   //!< Size of this line
             bool is_pool_;       //!< Is this line's data part of a pool? If not, it is owned by this object
             mutable bool dirty_; //!< Is this line dirty. Mutable so that read methods can be const
+            bool shared_ = false;  //!< Was alloc_data_ shared with checkpoint storage since the last write
+            bool exposed_ = false; //!< Was a pointer to the data handed out by getRawDataPtr
             uint8_t * data_ = nullptr;   //!< Pointer to either the allocated memory or a pool
-            std::unique_ptr<uint8_t[]> alloc_data_;      //!< Data held by this line. Always allocated
+            std::shared_ptr<uint8_t[]> alloc_data_;      //!< Data held by this line if not in a pool. May be shared with checkpoint storage
 
         }; // class Line
 
@@ -955,6 +1053,22 @@ namespace sparta
         //! @{
         ////////////////////////////////////////////////////////////////////////
 
+        /*!
+         * \brief Does checkpoint storage type StorageT support sharing line
+         * data (shareLineBytes and getSharedLineBytes) instead of copying it.
+         *
+         * Lines of ArchDatas which can free their lines are shared with such
+         * storage if its canShareLines() is true: nothing may hold pointers into those lines' data, so a
+         * line can copy its data on the next write instead of at checkpoint
+         * time. This makes a snapshot cost a reference per line rather than
+         * a copy of all data.
+         */
+        template <typename StorageT, typename=void>
+        struct SharesLineData : std::false_type {};
+
+        template <typename StorageT>
+        struct SharesLineData<StorageT, std::void_t<decltype(&StorageT::getSharedLineBytes)>> : std::true_type {};
+
         /*!
          * \brief Writes checkpointing data from this ArchData to a stream
          * \post All lines flagged as not dirty
@@ -969,7 +1083,7 @@ namespace sparta
                 Line* ln = *itr;
                 if(ln != nullptr && ln->isDirty()){
                     out.beginLine(ln->getIdx());
-                    ln->save(out);
+                    saveLine_(*ln, out);
                 }
             }
             out.endArchData();
@@ -989,7 +1103,7 @@ namespace sparta
                 Line* ln = *itr;
                 if(ln != nullptr){
                     out.beginLine(ln->getIdx());
-                    ln->save(out);
+                    saveLine_(*ln, out);
                 }
             }
             out.endArchData();
@@ -1014,7 +1128,7 @@ namespace sparta
                     break; // Done with this ArchData
                 }
                 Line& ln = getLine(ln_idx * line_size_);
-                ln.restore(in);
+                restoreLine_(ln, in);
             }
         }
 
@@ -1033,6 +1147,34 @@ namespace sparta
             restore(in);
         }
 
+    private:
+
+        //! Saves one line, sharing its data with the storage if possible
+        template <typename StorageT>
+        void saveLine_(Line& ln, StorageT& out) {
+            if constexpr (SharesLineData<StorageT>::value){
+                if(can_free_lines_ && out.canShareLines()){
+                    ln.share(out);
+                    return;
+                }
+            }
+            ln.save(out);
+        }
+
+        //! Restores one line, sharing the storage's data if possible
+        template <typename StorageT>
+        void restoreLine_(Line& ln, StorageT& in) {
+            if constexpr (SharesLineData<StorageT>::value){
+                if(can_free_lines_ && in.canShareLines()){
+                    ln.restoreShared(in);
+                    return;
+                }
+            }
+            ln.restore(in);
+        }
+
+    public:
+
         ////////////////////////////////////////////////////////////////////////
         //! @}
 
@@ -0,0 +1,306 @@
+// <PartitionedScheduler> -*- C++ -*-
+
+/**
+ * \file PartitionedScheduler.hpp
+ * \brief Runs several Schedulers (partitions) on their own threads in
+ *        lock-step windows
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sparta/kernel/Scheduler.hpp"
+
+namespace sparta
+{
+
+/**
+ * \class PartitionLink
+ * \brief A one-way connection that carries data sent on one
+ *        Scheduler to another, with a fixed minimum latency
+ *
+ * Data sent on the link while the sender's partition is running is
+ * buffered by the link.  It is handed to the receiving Scheduler by
+ * deliver(), which the PartitionedScheduler calls between windows
+ * while no partition is running.  Links whose buffer can be read while
+ * the sender adds to it (isConcurrent()) are instead delivered by the
+ * receiving partition's thread at the start of each of its windows.
+ *
+ * The link registers itself with the receiving Scheduler on
+ * construction and removes itself on destruction.  The receiving
+ * Scheduler must outlive the link.
+ *
+ * Cross-partition DataOutPort to DataInPort and SyncOutPort to
+ * SyncInPort bindings create these (see DataOutPort::bind and
+ * SyncOutPort::bind).
+ */
+class PartitionLink
+{
+public:
+
+    /**
+     * \brief Create a link and register it with the receiver
+     * \param sender   The Scheduler sending on this link
+     * \param receiver The Scheduler this link delivers to
+     * \param latency  Fewest ticks between a send and its delivery.
+     *                 Must be nonzero
+     * \param name     Describes the link in error messages
+     */
+    PartitionLink(const Scheduler * sender, Scheduler * receiver,
+                  Scheduler::Tick latency, const std::string & name);
+
+    //! Remove this link from the receiving Scheduler
+    virtual ~PartitionLink();
+
+    PartitionLink(const PartitionLink &) = delete;
+    PartitionLink & operator=(const PartitionLink &) = delete;
+
+    //! The Scheduler sending on this link
+    const Scheduler * getSender() const {
+        return sender_;
+    }
+
+    //! The Scheduler this link delivers to
+    Scheduler * getReceiver() const {
+        return receiver_;
+    }
+
+    //! Fewest ticks between a send and its delivery
+    Scheduler::Tick getLatency() const {
+        return latency_;
+    }
+
+    //! Name of the link
+    const std::string & getName() const {
+        return name_;
+    }
+
+    /**
+     * \brief Schedule everything sent before the receiving Scheduler's
+     *        current tick on the receiving Scheduler, in the order it
+     *        was sent
+     *
+     * \pre The receiver is not running.  Unless isConcurrent(), the
+     *      sender is not running either.
+     */
+    virtual void deliver() = 0;
+
+    /**
+     * \brief Is anything sent on this link not yet delivered?
+     * \pre Neither the sender nor the receiver is running
+     */
+    virtual bool hasPending() const = 0;
+
+    /**
+     * \brief Can deliver() be called while the sender is running?
+     *
+     * If so, the receiving partition's thread delivers the link at the
+     * start of each window instead of the PartitionedScheduler doing it
+     * between windows.
+     */
+    virtual bool isConcurrent() const {
+        return false;
+    }
+
+private:
+    const Scheduler * const sender_;
+    Scheduler * const receiver_;
+    const Scheduler::Tick latency_;
+    const std::string name_;
+};
+
+/**
+ * \class PartitionedScheduler
+ * \brief Runs a simulation split into partitions, each with its own
+ *        Scheduler and host thread
+ *
+ * Each partition (for example, the subtree of one core) uses clocks
+ * from its own Scheduler.  Partitions communicate only through
+ * PartitionLinks, which DataOutPort::bind creates when the two bound
+ * ports are on different Schedulers.  Every such link must have a
+ * latency: a DataInPort receiving from another partition must have a
+ * nonzero delay.
+ *
+ * The partitions advance in windows no longer than the lookahead,
+ * which is the smallest latency of any link between them.  Anything
+ * sent during a window is therefore delivered no earlier than the
+ * start of the next one, so each partition can run its window without
+ * looking at the others (conservative synchronization).  Between
+ * windows, the links are delivered in a fixed order: by receiving
+ * partition, then in the order the links were created.  Concurrent
+ * links (PartitionLink::isConcurrent) are delivered after those, in
+ * the order they were created, by the receiving partition's thread.
+ * A simulation runs the same way each time regardless of thread
+ * timing.
+ *
+ * With a single partition, run() simply runs that Scheduler.
+ *
+ * \code
+ * sparta::Scheduler sched0, sched1;
+ * sparta::Clock clk0("clk0", &sched0), clk1("clk1", &sched1);
+ * sparta::RootTreeNode rtn0, rtn1;
+ * rtn0.setClock(&clk0);
+ * rtn1.setClock(&clk1);
+ * // ... build a core under each root; bind ports across them with
+ * //     DataInPorts that have a delay ...
+ *
+ * sparta::PartitionedScheduler psched;
+ * psched.addPartition(&sched0);
+ * psched.addPartition(&sched1);
+ * psched.finalize();
+ * psched.run();
+ * \endcode
+ *
+ * Model code in different partitions runs at the same time.  Anything
+ * shared between partitions (object allocators, log destinations,
+ * etc) must be safe to use from several threads.
+ */
+class PartitionedScheduler
+{
+public:
+
+    //! Typedef for our Tick type
+    using Tick = Scheduler::Tick;
+
+    PartitionedScheduler() = default;
+
+    //! Releases the partitions, which can then join another
+    //! PartitionedScheduler
+    ~PartitionedScheduler();
+
+    PartitionedScheduler(const PartitionedScheduler &) = delete;
+    PartitionedScheduler & operator=(const PartitionedScheduler &) = delete;
+
+    /**
+     * \brief Add a partition
+     * \param sched The partition's Scheduler
+     * \return The partition's index
+     *
+     * \pre finalize() has not been called
+     */
+    uint32_t addPartition(Scheduler * sched);
+
+    /**
+     * \brief Finalize the partitions' Schedulers and determine the
+     *        lookahead
+     *
+     * \throw SpartaException if a partition receives data over a link
+     *        from a Scheduler that is not one of the partitions, or if
+     *        the partitions are not all at the same tick
+     */
+    void finalize();
+
+    //! Has finalize() been called?
+    bool isFinalized() const {
+        return finalized_;
+    }
+
+    //! Number of partitions
+    uint32_t getNumPartitions() const {
+        return partitions_.size();
+    }
+
+    //! Scheduler of the given partition
+    Scheduler * getPartition(uint32_t idx) const {
+        return partitions_.at(idx);
+    }
+
+    /**
+     * \brief The longest window, in ticks: the smallest latency of any
+     *        link between partitions
+     * \return Scheduler::INDEFINITE if the partitions do not
+     *         communicate
+     * \pre isFinalized()
+     */
+    Tick getLookahead() const {
+        sparta_assert(finalized_);
+        return lookahead_;
+    }
+
+    //! Number of windows run so far
+    uint64_t getNumWindows() const {
+        return num_windows_;
+    }
+
+    /**
+     * \brief Run all partitions
+     * \param num_ticks    The most number of ticks to advance
+     * \param exacting_run Run to exactly \a num_ticks
+     *
+     * Same meaning as Scheduler::run.  Partitions stop together, at the
+     * end of a window: when none has continuing events left (unless
+     * \a exacting_run), when \a num_ticks have elapsed, or when any
+     * partition's Scheduler was stopped during the window.  Partitions
+     * that do not communicate are simply each run as by
+     * Scheduler::run.
+     *
+     * An exception thrown in a partition is rethrown here once all
+     * partitions have stopped.  If several partitions throw in the
+     * same window, the one from the lowest numbered partition is
+     * rethrown.
+     *
+     * \pre isFinalized()
+     */
+    void run(Tick num_ticks = Scheduler::INDEFINITE, bool exacting_run = false);
+
+private:
+
+    //! Run every partition for num_ticks, partition 0 on this thread
+    //! and the others on the workers
+    void runWindow_(Tick num_ticks, bool exacting_run);
+
+    //! Run one partition for the current window, catching anything it
+    //! throws
+    void runPartition_(uint32_t idx);
+
+    //! Body of the worker thread for the given partition
+    void workerLoop_(uint32_t idx);
+
+    //! Start/stop the worker threads
+    void startWorkers_();
+    void stopWorkers_();
+
+    //! Deliver every link into each partition, in partition order.
+    //! Concurrent links are only included if \a all.
+    void deliverLinks_(bool all);
+
+    //! Deliver the concurrent links into one partition
+    void deliverConcurrentLinks_(uint32_t idx);
+
+    //! Rethrow the first exception caught in a partition
+    void rethrowPartitionException_();
+
+    std::vector<Scheduler*> partitions_;
+
+    Tick lookahead_ = Scheduler::INDEFINITE;
+    bool finalized_ = false;
+    uint64_t num_windows_ = 0;
+
+    //! Worker threads, one for each partition except the first
+    std::vector<std::thread> workers_;
+
+    //! Length and kind of the current window
+    Tick window_ticks_ = 0;
+    bool window_exacting_ = true;
+
+    //! Incremented to start a window; workers wait for it to change
+    std::atomic<uint64_t> window_start_count_{0};
+
+    //! Workers finished with the current window
+    std::atomic<uint32_t> workers_done_{0};
+
+    //! Set before the last window_start_count_ increment to stop the
+    //! workers
+    bool quit_ = false;
+
+    //! Exceptions thrown in each partition during the last window
+    std::vector<std::exception_ptr> partition_errors_;
+};
+
+} // namespace sparta
@@ -18,16 +18,18 @@
 #include <vector>
 #include <chrono>
 #include <mutex>
+#include <atomic>
 #include <array>
 #include <memory>
 #include <algorithm>
 #include <limits>
 #include <list>
 #include <ostream>
+#include <unordered_map>
 
 #include "sparta/utils/Colors.hpp"
 #include "sparta/kernel/SpartaHandler.hpp"
-#include "sparta/kernel/ObjectAllocator.hpp"
+#include "sparta/kernel/SlabObjectAllocator.hpp"
 #include "sparta/simulation/RootTreeNode.hpp"
 #include "sparta/log/MessageSource.hpp"
 #include "sparta/statistics/StatisticDef.hpp"
@@ -38,6 +40,7 @@
 #include "sparta/utils/ValidValue.hpp"
 #include "sparta/statistics/CounterBase.hpp"
 #include "sparta/utils/SpartaAssert.hpp"
+#include "sparta/utils/BoundedMPSCQueue.hpp"
 
 #ifdef SYSTEMC_SUPPORT
 #include "sparta/log/NotificationSource.hpp"
@@ -63,6 +66,8 @@ namespace sparta {
     class PhasedPayloadEvent;
     class EventSet;
     class GlobalEventProxy;
+    class PartitionLink;
+    class PartitionedScheduler;
 }
 
 namespace sparta
@@ -197,6 +202,32 @@ public:
     //! Typedef for our unit of time.
     typedef uint64_t Tick;
 
+    /**
+     * \brief The data structure used to hold future tick quanta
+     *
+     * - LINKED_LIST: A sorted singly-linked list of tick quanta.
+     *   Insertion walks the list from the current quantum, which is
+     *   very fast for events scheduled now or on the next tick.
+     *
+     * - TIMING_WHEEL: A calendar queue.  Tick quanta within the
+     *   wheel's horizon are indexed by bucket for O(1) insertion;
+     *   quanta beyond the horizon are kept on an overflow heap and
+     *   moved onto the wheel as simulation time approaches them.
+     *   Use this when models routinely schedule events far into
+     *   the future (tens to hundreds of cycles).
+     */
+    enum class TickQuantumBackend {
+        LINKED_LIST,
+        TIMING_WHEEL
+    };
+
+    //! Number of buckets in the timing wheel (must be a power of 2)
+    static constexpr uint32_t TIMING_WHEEL_NUM_BUCKETS = 1024;
+
+    //! Default bucket width of the timing wheel, as a power of 2 in
+    //! ticks.  1024 ticks is roughly one cycle of a 1GHz clock.
+    static constexpr uint32_t TIMING_WHEEL_DEFAULT_BUCKET_SHIFT = 10;
+
 private:
 
     /**
@@ -251,7 +282,8 @@ private:
          * tick groups)
          */
         TickQuantum(uint32_t num_firing_groups) :
-            groups(num_firing_groups)
+            groups(num_firing_groups),
+            occupied_groups((num_firing_groups + 63) / 64, 0)
         { }
 
         /**
@@ -264,34 +296,77 @@ private:
             sparta_assert(firing_group > 0);
             sparta_assert(firing_group < groups.size());
             groups[firing_group].addScheduleable(scheduleable);
-            first_group_idx = std::min(first_group_idx, firing_group);
+            markOccupied(firing_group);
         }
 
-        void addEventIfNotScheduled(uint32_t firing_group, Scheduleable * scheduleable) {
+        /**
+         * \brief Add an event to the timequantum if not already in the group
+         * \return true if the event was added
+         */
+        bool addEventIfNotScheduled(uint32_t firing_group, Scheduleable * scheduleable) {
             sparta_assert(firing_group > 0);
             sparta_assert(firing_group < groups.size());
             auto & grp = groups[firing_group];
             const auto grp_size = grp.size();
             for(uint32_t idx = 0; idx < grp_size; ++idx) {
                 if(grp[idx] == scheduleable) {
-                    return;
+                    return false;
                 }
             }
             grp.addScheduleable(scheduleable);
-            first_group_idx = std::min(first_group_idx, firing_group);
+            markOccupied(firing_group);
+            return true;
+        }
+
+        //! Note that the given firing group has events
+        void markOccupied(uint32_t firing_group) {
+            occupied_groups[firing_group >> 6] |= (1ull << (firing_group & 63));
+        }
+
+        //! Note that the given firing group is empty
+        void clearOccupied(uint32_t firing_group) {
+            occupied_groups[firing_group >> 6] &= ~(1ull << (firing_group & 63));
+        }
+
+        //! Forget all firing groups (they must all be cleared)
+        void clearAllOccupied() {
+            std::fill(occupied_groups.begin(), occupied_groups.end(), 0);
+        }
+
+        /**
+         * \brief Find the first firing group with events at or after
+         *        the given one
+         * \param from The firing group to start looking at
+         * \return The firing group, or groups.size() if there is none
+         */
+        uint32_t nextOccupiedGroup(uint32_t from) const {
+            uint32_t word = from >> 6;
+            if(word >= occupied_groups.size()) {
+                return groups.size();
+            }
+            uint64_t bits = occupied_groups[word] & (~0ull << (from & 63));
+            while(bits == 0) {
+                if(++word == occupied_groups.size()) {
+                    return groups.size();
+                }
+                bits = occupied_groups[word];
+            }
+            return (word << 6) | __builtin_ctzll(bits);
         }
 
         Tick               tick = 0; //!< The tick this quantum represents
         ScheduleableGroups groups;   //!< The list of firing groups. This is indexed by dag_group+1
-        uint32_t first_group_idx = std::numeric_limits<uint32_t>::max(); //!< The first group idx with events
+        std::vector<uint64_t> occupied_groups; //!< Bitmap of the firing groups with events
         TickQuantum * next = nullptr;
     };
 
     //! The current time quantum
     TickQuantum * current_tick_quantum_ = nullptr;
 
-    //! The ObjectAllocator used to create time quantum structures
-    ObjectAllocator<TickQuantum> tick_quantum_allocator_;
+    //! The allocator used to create time quantum structures.  Freed
+    //! quanta keep their (already sized) firing groups and the most
+    //! recently freed one is reused first.
+    SlabObjectAllocator<TickQuantum> tick_quantum_allocator_;
 
     //! return whether the watchdog has fired
     bool watchdogExpired_() const
@@ -362,6 +437,20 @@ public:
      */
     Scheduler(const std::string& name, GlobalTreeNode* search_scope);
 
+    /*!
+     * \brief Construct with a name, a global search scope, and the
+     *        data structure used to hold future tick quanta
+     * \param name Name of this scheduler node.
+     * \param search_scope Scope in which this global scheduler node will exist
+     * \param backend The tick quantum backend to use
+     * \param wheel_bucket_shift Bucket width (log2 of ticks) of the
+     *                           timing wheel.  Ignored for
+     *                           TickQuantumBackend::LINKED_LIST
+     */
+    Scheduler(const std::string& name, GlobalTreeNode* search_scope,
+              TickQuantumBackend backend,
+              uint32_t wheel_bucket_shift = TIMING_WHEEL_DEFAULT_BUCKET_SHIFT);
+
     //! Dey-stroy
     ~Scheduler();
 
@@ -372,9 +461,9 @@ public:
     //! Register a clock with this Scheduler
     //! \param clk Pointer to a sparta::Clock to be registered
     //!
-    //! The purpose of registering the Clock is to allow the Scheduler
-    //! to update the elapsed cycles in that Clock instead of having
-    //! the Clock calculate that value over and over again.
+    //! Registration only tracks which Clocks run on this Scheduler.
+    //! Clocks derive their elapsed cycles from getElapsedTicks() on
+    //! demand, so nothing is done to them as time advances.
     void registerClock(sparta::Clock *clk);
 
     //! Deregister a clock from this Scheduler
@@ -510,6 +599,10 @@ public:
      * will be queued up and scheduled at the schedulers first convenience. The
      * delay parameter is relative to the time when the event is actually being
      * scheduled.
+     *
+     * Events are handed to the main thread through a bounded lock-free
+     * queue; this call does not take a lock or allocate unless that queue
+     * is full.
      */
     void scheduleAsyncEvent(Scheduleable *sched, Scheduler::Tick delay);
 
@@ -524,7 +617,7 @@ public:
      * in the future.  The function does *not* do a full blown
      * Scheduleable class compare, but rather a pointer comparison.
      *
-     * This function is expensive and should be used with caution.
+     * This is a constant-time lookup.
      */
     bool isScheduled(const Scheduleable * scheduleable) const;
 
@@ -539,7 +632,9 @@ public:
      * function does *not* do a full blown Scheduleable class compare,
      * but rather a pointer comparison.
      *
-     * This function is rather inefficient for rel_times that are pretty large.
+     * This is a constant-time lookup unless the Scheduleable is
+     * scheduled more than once, in which case the time quantum at
+     * rel_time is searched.
      */
     bool isScheduled(const Scheduleable * scheduleable, Tick rel_time) const;
 
@@ -548,8 +643,9 @@ public:
      * \brief Cancel the given Scheduleable if on the Scheduler
      * \param scheduleable The Scheduleable to cancel (remove)
      *
-     * Will search in all time quantums for the given Scheduleable
-     * instance and cancel it everywhere found.
+     * Cancels the given Scheduleable everywhere it is found.  This is
+     * a constant-time operation if the Scheduleable is scheduled
+     * once; otherwise all time quantums are searched.
      */
     void cancelEvent(const Scheduleable * scheduleable);
 
@@ -571,6 +667,25 @@ public:
      */
     void cancelAsyncEvent(Scheduleable *scheduleable);
 
+    /**
+     * \brief Links carrying data into this Scheduler from other
+     *        Schedulers, in the order they were created
+     *
+     * These are only delivered when the Scheduler is run as a
+     * partition of a sparta::PartitionedScheduler.
+     */
+    const std::vector<PartitionLink*> & getInboundLinks() const {
+        return inbound_links_;
+    }
+
+    /**
+     * \brief The PartitionedScheduler this Scheduler is a partition
+     *        of, or nullptr if it is not one
+     */
+    const PartitionedScheduler * getPartitionedScheduler() const {
+        return partitioned_scheduler_;
+    }
+
     ////////////////////////////////////////////////////////////////////////
     //! @}
 
@@ -787,6 +902,11 @@ public:
         return events_fired_;
     }
 
+    //! \return The data structure used to hold future tick quanta
+    TickQuantumBackend getTickQuantumBackend() const noexcept {
+        return tick_quantum_backend_;
+    }
+
     /**
      * \brief Returns the Tick quantum where the next continuing event resides
      *
@@ -900,6 +1020,12 @@ private:
     // The startup event adds itself to internal structures
     friend class StartupEvent;
 
+    // Links register with their receiving Scheduler
+    friend class PartitionLink;
+
+    // Runs this Scheduler as one of its partitions
+    friend class PartitionedScheduler;
+
     /**
      * \brief A temporary queue used for "cranking" the simulation
      * \param event_del The event delegate to call
@@ -927,6 +1053,121 @@ private:
      */
     TickQuantum* determineTickQuantum_(Tick rel_time);
 
+    /*!
+     * \brief Find the tick quantum for the given absolute tick
+     * \param index_time The absolute tick to look for
+     * \return The TickQuantum or nullptr if there is none
+     */
+    TickQuantum* findTickQuantum_(Tick index_time) const;
+
+    /*!
+     * \brief Call the given function on every outstanding tick
+     *        quantum, including those on the timing wheel's overflow
+     *        heap
+     */
+    template<class FuncT>
+    void forEachTickQuantum_(FuncT func) const
+    {
+        for(TickQuantum * rit = current_tick_quantum_; rit != nullptr; rit = rit->next) {
+            func(rit);
+        }
+        for(TickQuantum * rit : wheel_overflow_heap_) {
+            func(rit);
+        }
+    }
+
+    //! \name Scheduleable location tracking
+    //! @{
+    ////////////////////////////////////////////////////////////////////////
+
+    //! Record that scheduleable was just appended to the given group
+    void trackScheduled_(const Scheduleable * scheduleable, TickQuantum * tq, uint32_t group);
+
+    //! Update the bookkeeping of the event that just fired in the
+    //! given slot
+    void trackFired_(TickQuantum * tq, uint32_t group, uint32_t slot);
+
+    //! Has the event in the given slot already been fired?
+    bool isFired_(const TickQuantum * tq, uint32_t group, uint32_t slot) const {
+        return running_ && (tq == current_tick_quantum_) &&
+            (group == current_group_firing_) && (slot < current_event_firing_);
+    }
+
+    //! Replace the event in the given slot with cancelled_event_
+    void cancelAt_(TickQuantum * tq, uint32_t group, uint32_t slot);
+
+    ////////////////////////////////////////////////////////////////////////
+    //! @}
+
+    //! \name Timing wheel support
+    //! @{
+    ////////////////////////////////////////////////////////////////////////
+
+    //! A bucket in the timing wheel.  Tick quanta in a bucket are a
+    //! contiguous run of the tick quantum list
+    struct WheelBucket {
+        TickQuantum * first = nullptr;
+        TickQuantum * last  = nullptr;
+    };
+
+    //! Bucket index of the given absolute tick
+    uint32_t wheelBucketIdx_(Tick index_time) const {
+        return (index_time >> wheel_bucket_shift_) & (TIMING_WHEEL_NUM_BUCKETS - 1);
+    }
+
+    //! The first tick beyond the wheel's reach
+    Tick wheelHorizon_() const {
+        return wheel_base_ + (Tick(TIMING_WHEEL_NUM_BUCKETS) << wheel_bucket_shift_);
+    }
+
+    //! Ordering of the overflow heap (earliest tick on top)
+    static bool laterTickQuantum_(const TickQuantum * a, const TickQuantum * b) {
+        return a->tick > b->tick;
+    }
+
+    //! Find or create the tick quantum for index_time using the wheel
+    TickQuantum* determineWheelTickQuantum_(Tick index_time);
+
+    //! Link a new tick quantum into the wheel and the quantum list
+    void linkWheelTickQuantum_(TickQuantum * tq);
+
+    //! The last quantum of the closest non-empty bucket before
+    //! bucket_idx, or nullptr if none
+    TickQuantum* wheelPredecessor_(uint32_t bucket_idx) const;
+
+    //! Remove the head of the quantum list from the wheel
+    void unlinkWheelHead_(TickQuantum * tq);
+
+    //! Slide the wheel to the given tick and pull in overflow quanta
+    void advanceWheel_(Tick index_time);
+
+    //! Empty the wheel (the quanta themselves are not freed)
+    void clearWheel_();
+
+    //! Which data structure holds future tick quanta
+    const TickQuantumBackend tick_quantum_backend_;
+
+    //! The bucket width (log2 of ticks) of the timing wheel
+    const uint32_t wheel_bucket_shift_;
+
+    //! The wheel's buckets
+    std::vector<WheelBucket> wheel_buckets_;
+
+    //! One bit per bucket; set if the bucket holds a tick quantum
+    std::array<uint64_t, TIMING_WHEEL_NUM_BUCKETS / 64> wheel_occupancy_{};
+
+    //! The first tick covered by the wheel (aligned to a bucket)
+    Tick wheel_base_ = 0;
+
+    //! Min-heap of tick quanta beyond the wheel's horizon
+    std::vector<TickQuantum*> wheel_overflow_heap_;
+
+    //! Lookup of the tick quanta on the overflow heap
+    std::unordered_map<Tick, TickQuantum*> wheel_overflow_quanta_;
+
+    ////////////////////////////////////////////////////////////////////////
+    //! @}
+
     //! The DAG used for grouping
     std::unique_ptr<DAG> dag_;
 
@@ -946,6 +1187,17 @@ private:
     //! Are we at the very first tick?
     bool first_tick_ = true;
 
+    //! Is this Scheduler one of several run by a
+    //! PartitionedScheduler?  If so, the PartitionedScheduler
+    //! pauses/unpauses the SleeperThread instead of run()
+    bool partitioned_ = false;
+
+    //! The PartitionedScheduler this Scheduler was added to, if any
+    const PartitionedScheduler * partitioned_scheduler_ = nullptr;
+
+    //! Links delivering into this Scheduler from other Schedulers
+    std::vector<PartitionLink*> inbound_links_;
+
     //! The current time of the scheduler
     Tick current_tick_ = 0; //init tick 0
 
@@ -976,8 +1228,7 @@ private:
     //! A list of events that are zero priority to be fired
     std::vector<SpartaHandler> startup_events_;
 
-    //! A vector of associated clocks with this scheduler.  Do not
-    //! make this a std::set -- iteration is 120x slower
+    //! A vector of associated clocks with this scheduler
     std::vector<sparta::Clock*> registered_clocks_;
 
     //! The current dag group priority being fired.
@@ -1063,6 +1314,13 @@ private:
     uint64_t        wall_time_ = 0;
     ReadOnlyCounter wall_time_cnt_;
 
+    //! Most time quanta outstanding at once (from tick_quantum_allocator_)
+    ReadOnlyCounter tick_quanta_peak_cnt_;
+
+    //! Empty firing groups jumped over while running time quanta
+    uint64_t        empty_groups_skipped_ = 0;
+    ReadOnlyCounter empty_groups_skipped_cnt_;
+
 public:
     /**
      * \brief Get the raw pointer of "global" PhasedPayloadEvent inside sparta::Scheduler
@@ -1090,8 +1348,10 @@ private:
     void fireGlobalEvent_(const GlobalEventProxy &);
 
     struct AsyncEventInfo {
-        AsyncEventInfo(Scheduleable *sched, Scheduler::Tick tick)
-            : sched(sched), tick(tick) { }
+        AsyncEventInfo() = default;
+
+        AsyncEventInfo(Scheduleable *sched, Scheduler::Tick tick, uint64_t queue_tail = 0)
+            : sched(sched), tick(tick), queue_tail(queue_tail) { }
 
         AsyncEventInfo(Scheduleable *sched)
             : AsyncEventInfo(sched, 0) { }
@@ -1103,16 +1363,54 @@ private:
 
         Scheduleable *sched = nullptr;
         Scheduler::Tick tick = 0;
-    };
-
-    //! Hint that there are events on async_event_list_ ready to be scheduled
-    volatile bool async_event_list_empty_hint_ = true;
 
-    //! Queue of asynchronous events that have not yet been scheduled
-    std::list<AsyncEventInfo> async_event_list_;
+        //! For async_event_overflow_ entries: async_event_queue_'s
+        //! tail when the event was added.  The producer's earlier
+        //! events in the queue are all before it.
+        uint64_t queue_tail = 0;
+    };
 
-    //! Lock protecting async_event_list_ and async_event_list_empty_hint_
-    std::mutex async_event_list_mutex_;
+    //! Number of asynchronous events that can be waiting in
+    //! async_event_queue_ before producers fall back to
+    //! async_event_overflow_
+    static constexpr size_t ASYNC_EVENT_QUEUE_CAPACITY = 4096;
+
+    //! Move everything from async_event_queue_ and
+    //! async_event_overflow_ onto async_event_staged_, except overflow
+    //! events whose producer may have earlier events still in the
+    //! queue.  Main thread only.
+    void collectAsyncEvents_();
+
+    //! Schedule all waiting asynchronous events.  Main thread only.
+    void scheduleAsyncEvents_();
+
+    //! Hint that there are asynchronous events ready to be
+    //! scheduled.  Cleared by the main thread before it collects
+    //! events; set by producers after they queue one.
+    std::atomic<bool> async_event_list_empty_hint_{true};
+
+    //! Lock-free queue of asynchronous events that have not yet been
+    //! scheduled.  Any thread produces, the main thread consumes.
+    utils::BoundedMPSCQueue<AsyncEventInfo> async_event_queue_{ASYNC_EVENT_QUEUE_CAPACITY};
+
+    //! Events that did not fit in async_event_queue_.  Once this is
+    //! non-empty, all producers add to it (keeping each producer's
+    //! events in order) until the main thread empties it.  An event
+    //! here is only collected once the queue has been drained up to
+    //! its queue_tail.
+    std::vector<AsyncEventInfo> async_event_overflow_;
+
+    //! Number of events in async_event_overflow_, readable without
+    //! the lock
+    std::atomic<uint32_t> async_event_overflow_size_{0};
+
+    //! Lock protecting async_event_overflow_
+    std::mutex async_event_overflow_mutex_;
+
+    //! Events collected off the queue by the main thread (see
+    //! cancelAsyncEvent) that are not scheduled yet.  Main thread
+    //! only.
+    std::vector<AsyncEventInfo> async_event_staged_;
 
     //! Broadcast a notification when something is scheuled.  This is
     //! only useful for the SysC adapter and not compiled in for
@@ -0,0 +1,180 @@
+// <SlabObjectAllocator.hpp> -*- C++ -*-
+
+
+/**
+ * \file   SlabObjectAllocator.hpp
+ *
+ * \brief  File that defines the SlabObjectAllocator class
+ */
+
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace sparta
+{
+    /**
+     * \class SlabObjectAllocator
+     * \brief A drop-in replacement for ObjectAllocator that keeps its
+     *        objects in contiguous chunks
+     * \tparam ObjT The object to allocate
+     *
+     * Like ObjectAllocator, objects are constructed the first time
+     * they are handed out and are then recycled as-is: free() does
+     * not destroy an object and create() does not reconstruct a
+     * recycled one.  Objects are only destroyed by clear() or the
+     * destructor.
+     *
+     * Differences from ObjectAllocator:
+     *
+     *  - Objects live in chunks of \a objs_per_chunk slots, not in
+     *    separate heap blocks
+     *  - Freed objects are kept on an intrusive LIFO list threaded
+     *    through the slots, so the most recently freed (cache-warm)
+     *    object is reused first and free() never allocates
+     *  - The allocator can be pre-warmed to a high-water mark
+     *  - It counts objects allocated, in use, and peak in use
+     */
+    template<typename ObjT>
+    class SlabObjectAllocator
+    {
+        struct Slot
+        {
+            Slot * next_free = nullptr;
+            alignas(ObjT) unsigned char storage[sizeof(ObjT)];
+
+            ObjT * object() {
+                return std::launder(reinterpret_cast<ObjT*>(storage));
+            }
+        };
+
+        static Slot * slotOf_(ObjT * obj) {
+            return reinterpret_cast<Slot*>(reinterpret_cast<unsigned char*>(obj) -
+                                           offsetof(Slot, storage));
+        }
+
+    public:
+        //! Allocation statistics
+        struct Stats
+        {
+            uint64_t allocated   = 0; //!< Objects constructed
+            uint64_t in_use      = 0; //!< Objects handed out and not freed
+            uint64_t peak_in_use = 0; //!< Most objects ever in use at once
+            uint64_t chunks      = 0; //!< Chunks of storage allocated
+        };
+
+        /**
+         * \brief Create the allocator
+         * \param objs_per_chunk Number of objects each chunk holds
+         */
+        explicit SlabObjectAllocator(uint32_t objs_per_chunk = 64) :
+            objs_per_chunk_(objs_per_chunk)
+        {
+            sparta_assert(objs_per_chunk_ > 0);
+        }
+
+        ~SlabObjectAllocator() {
+            clear();
+        }
+
+        SlabObjectAllocator(const SlabObjectAllocator &) = delete;
+        SlabObjectAllocator & operator=(const SlabObjectAllocator &) = delete;
+
+        /**
+         * \brief Get an object, constructing one with the given
+         *        arguments only if none are free
+         */
+        template<typename... Args>
+        ObjT * create(Args&&... args)
+        {
+            ObjT * obj = nullptr;
+            if(free_head_ != nullptr) {
+                Slot * slot = free_head_;
+                free_head_ = slot->next_free;
+                slot->next_free = nullptr;
+                obj = slot->object();
+            }
+            else {
+                obj = construct_(std::forward<Args>(args)...);
+            }
+            if(++stats_.in_use > stats_.peak_in_use) {
+                stats_.peak_in_use = stats_.in_use;
+            }
+            return obj;
+        }
+
+        //! Return an object for reuse.  It is not destroyed.
+        void free(ObjT * obj)
+        {
+            sparta_assert(stats_.in_use > 0);
+            Slot * slot = slotOf_(obj);
+            slot->next_free = free_head_;
+            free_head_ = slot;
+            --stats_.in_use;
+        }
+
+        /**
+         * \brief Construct objects until at least \a count are
+         *        allocated, and put the new ones on the free list
+         * \param count The high-water mark to reach
+         * \param args  Constructor arguments for the new objects
+         */
+        template<typename... Args>
+        void prewarm(uint64_t count, const Args&... args)
+        {
+            while(stats_.allocated < count) {
+                Slot * slot = slotOf_(construct_(args...));
+                slot->next_free = free_head_;
+                free_head_ = slot;
+            }
+        }
+
+        //! Destroy all objects and release all storage.  Any object
+        //! still in use is invalidated.
+        void clear()
+        {
+            uint64_t remaining = stats_.allocated;
+            for(auto & chunk : chunks_) {
+                for(uint32_t i = 0; i < objs_per_chunk_ && remaining > 0; ++i, --remaining) {
+                    chunk[i].object()->~ObjT();
+                }
+            }
+            chunks_.clear();
+            free_head_ = nullptr;
+            next_unused_ = objs_per_chunk_;
+            stats_ = Stats();
+        }
+
+        const Stats & getStats() const {
+            return stats_;
+        }
+
+    private:
+        template<typename... Args>
+        ObjT * construct_(Args&&... args)
+        {
+            if(next_unused_ == objs_per_chunk_) {
+                chunks_.emplace_back(new Slot[objs_per_chunk_]);
+                ++stats_.chunks;
+                next_unused_ = 0;
+            }
+            Slot & slot = chunks_.back()[next_unused_];
+            ObjT * obj = new (slot.storage) ObjT(std::forward<Args>(args)...);
+            ++next_unused_;
+            ++stats_.allocated;
+            return obj;
+        }
+
+        const uint32_t objs_per_chunk_;
+        std::vector<std::unique_ptr<Slot[]>> chunks_;
+        uint32_t next_unused_ = objs_per_chunk_; //!< Next unconstructed slot in the last chunk
+        Slot * free_head_ = nullptr;
+        Stats stats_;
+    };
+}
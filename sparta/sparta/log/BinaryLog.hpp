@@ -0,0 +1,237 @@
+// <BinaryLog> -*- C++ -*-
+
+/*!
+ * \file BinaryLog.hpp
+ * \brief Compact binary log format: the formatter that writes it, and a
+ * reader and filter for decoding it after the fact (see sparta_log_decode)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sparta/log/Destination.hpp"
+#include "sparta/log/MessageInfo.hpp"
+#include "sparta/simulation/TreeNode.hpp"
+
+namespace sparta
+{
+    namespace log
+    {
+        /*!
+         * \brief Formatter writing messages in a compact binary form, chosen
+         * for log files ending in ".log.bin".
+         *
+         * Locations and categories are written once, the first time they are
+         * seen, and referred to by ID after that. Each message record holds
+         * those IDs, the tick, the origin's cycle, wall time, thread and
+         * sequence number, and the raw content bytes. Nothing is converted to
+         * text and the stream is not flushed per message.
+         *
+         * The location of a node is only computed the first time it logs once
+         * its tree is built, so the cost of a message is mostly copying its
+         * content.
+         *
+         * Use BinaryLogReader or the sparta_log_decode tool to turn the file
+         * back into any of the text formats.
+         *
+         * File layout (integers are LEB128 varints unless noted):
+         * \verbatim
+         * "SPRTBLOG" <version: 1 byte>
+         * records:
+         *   'H' <len> <bytes>            header text (SimulationInfo)
+         *   'L' <len> <bytes>            define the next location ID
+         *   'C' <len> <bytes>            define the next category ID
+         *   'M' <location ID> <category ID> <sim time> <cycle + 1, or 0 if no clock>
+         *       <wall time: 8-byte double> <thread ID> <sequence number>
+         *       <len> <content bytes>
+         * \endverbatim
+         */
+        class BinaryFormatter : public Formatter
+        {
+        public:
+
+            //! Identifies a binary log file
+            static constexpr char MAGIC[] = "SPRTBLOG";
+
+            //! Format version written after MAGIC
+            static constexpr uint8_t VERSION = 1;
+
+            //! Record type tags
+            enum RecordType : char {
+                RECORD_HEADER   = 'H',
+                RECORD_LOCATION = 'L',
+                RECORD_CATEGORY = 'C',
+                RECORD_MESSAGE  = 'M'
+            };
+
+            //! Writes the file identifier to the stream
+            BinaryFormatter(std::ostream& stream);
+
+            void write(const sparta::log::Message& msg) override;
+
+            void writeHeader(const SimulationInfo& sim_info) override;
+
+        private:
+
+            //! ID of a built node's location. Looks the location up only the
+            //! first time a node is seen
+            uint32_t getLocationID_(const TreeNode& origin);
+
+            //! ID of a location, defining it if new
+            uint32_t internLocation_(const std::string& location);
+
+            //! ID of an (interned) category, defining it if new
+            uint32_t getCategoryID_(const std::string* category);
+
+            //! Write a record holding just a string
+            void writeString_(RecordType type, const std::string& str);
+
+            std::unordered_map<TreeNode::node_uid_type, uint32_t> node_location_ids_;
+            std::unordered_map<std::string, uint32_t> location_ids_;
+            std::unordered_map<const std::string*, uint32_t> category_ids_;
+            std::vector<char> record_; //!< Record being assembled
+        };
+
+        /*!
+         * \brief Reads back a log written by BinaryFormatter
+         *
+         * \code
+         * std::ifstream in("out.log.bin", std::ios::binary);
+         * sparta::log::BinaryLogReader reader(in);
+         * sparta::log::DefaultFormatter fmt(std::cout);
+         * std::cout << reader.getHeader();
+         * while(reader.next()){
+         *     fmt.writeFields(reader.getMessage());
+         * }
+         * \endcode
+         */
+        class BinaryLogReader
+        {
+        public:
+
+            /*!
+             * \brief Construct on an open stream positioned at the start of a
+             * binary log
+             * \throw SpartaException if the stream does not hold a binary log
+             */
+            BinaryLogReader(std::istream& in);
+
+            /*!
+             * \brief Read the next message
+             * \return false at the end of the log
+             * \throw SpartaException if the log is malformed or truncated
+             * within a record
+             */
+            bool next();
+
+            /*!
+             * \brief The message last read by next(). Only valid until next()
+             * is called again
+             */
+            const MessageFields& getMessage() const {
+                return fields_;
+            }
+
+            //! Location ID of the message last read
+            uint32_t getLocationID() const {
+                return location_id_;
+            }
+
+            //! Category ID of the message last read
+            uint32_t getCategoryID() const {
+                return category_id_;
+            }
+
+            //! Locations defined so far, indexed by location ID
+            const std::vector<std::string>& getLocations() const {
+                return locations_;
+            }
+
+            //! Categories defined so far, indexed by category ID
+            const std::vector<std::string>& getCategories() const {
+                return categories_;
+            }
+
+            /*!
+             * \brief Header text (SimulationInfo written as '#' comments), as
+             * it appears at the top of a text log
+             */
+            const std::string& getHeader() const {
+                return header_;
+            }
+
+        private:
+
+            std::istream& in_;
+            std::string header_;
+            std::vector<std::string> locations_;
+            std::vector<std::string> categories_;
+            std::string content_;
+            MessageFields fields_;
+            uint32_t location_id_ = 0;
+            uint32_t category_id_ = 0;
+        };
+
+        /*!
+         * \brief Selects messages read from a binary log by location, category
+         * and tick range. An empty filter selects everything.
+         */
+        class BinaryLogFilter
+        {
+        public:
+
+            /*!
+             * \brief Select messages from nodes matching a location pattern
+             * (glob-like, as in --log) or from their subtrees. Messages
+             * matching any added pattern are selected.
+             */
+            void addLocation(const std::string& pattern) {
+                location_patterns_.emplace_back(pattern);
+                location_matches_.clear();
+            }
+
+            /*!
+             * \brief Select messages whose category matches a pattern.
+             * Messages matching any added pattern are selected.
+             */
+            void addCategory(const std::string& pattern) {
+                category_patterns_.emplace_back(pattern);
+                category_matches_.clear();
+            }
+
+            //! Select messages logged in [start, end] (ticks)
+            void setTickRange(sim_time_type start, sim_time_type end) {
+                start_ = start;
+                end_ = end;
+            }
+
+            //! Is the last message read by reader selected?
+            bool matches(const BinaryLogReader& reader);
+
+        private:
+
+            //! Does the pattern match the location or one of its ancestors?
+            bool matchesLocation_(const std::string& location) const;
+
+            //! Does the category match one of the category patterns?
+            bool matchesCategory_(const std::string& category) const;
+
+            std::vector<std::string> location_patterns_;
+            std::vector<std::string> category_patterns_;
+            sim_time_type start_ = 0;
+            sim_time_type end_ = std::numeric_limits<sim_time_type>::max();
+
+            //! Results by location/category ID: 0 = unknown, 1 = no, 2 = yes
+            std::vector<uint8_t> location_matches_;
+            std::vector<uint8_t> category_matches_;
+        };
+
+    } // namespace log
+} // namespace sparta
@@ -2,8 +2,12 @@
 
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <exception>
 #include <iostream>
 #include <string>
 #include <ostream>
@@ -13,6 +17,9 @@
 #include <mutex>
 #include <functional>
 #include <memory>
+#include <streambuf>
+#include <thread>
+#include <type_traits>
 #include <typeinfo>
 #include <utility>
 #include <vector>
@@ -29,6 +36,24 @@ namespace sparta
 {
     namespace log
     {
+        /*!
+         * \brief Prefix on a destination filename which selects an
+         * AsyncDestination for that file (e.g. "async:out.log.basic")
+         */
+        static constexpr const char* ASYNC_DEST_PREFIX = "async:";
+
+        /*!
+         * \brief Returns the filename named by a file destination string,
+         * without any ASYNC_DEST_PREFIX
+         */
+        inline std::string getDestinationFilename(const std::string& dest) {
+            const std::string prefix(ASYNC_DEST_PREFIX);
+            if(dest.compare(0, prefix.size(), prefix) == 0){
+                return dest.substr(prefix.size());
+            }
+            return dest;
+        }
+
         /*!
          * \brief Generic Logging destination stream interface which writes
          * sparta::log::Message structures to some output [file]stream. Subclasses
@@ -151,6 +176,15 @@ namespace sparta
              */
             virtual std::string stringize(bool pretty=false) const = 0;
 
+            /*!
+             * \brief Write out any messages this destination is holding
+             * and flush the underlying stream. Blocks until done.
+             *
+             * Destinations which write through on every message have
+             * nothing to do here
+             */
+            virtual void flush() {}
+
             //! \note This method IS thread-safe
             void write(const sparta::log::Message& msg) {
                 std::lock_guard<std::mutex> lock(write_mutex_);
@@ -264,6 +298,17 @@ namespace sparta
              */
             virtual void write(const sparta::log::Message& msg) = 0;
 
+            /*!
+             * \brief Write a message which has already left the simulation
+             * (e.g. one read back from a binary log). Does not flush.
+             * \throw SpartaException if this formatter does not support it
+             */
+            virtual void writeFields(const MessageFields& fields) {
+                (void) fields;
+                throw SpartaException("This log formatter cannot write messages read back from a log: ")
+                    << demangle(typeid(*this).name());
+            }
+
             /*!
              * \brief Write a header to a newly-opened report
              */
@@ -281,6 +326,12 @@ namespace sparta
              * extension field
              */
             static const Info* FORMATTERS;
+
+            /*!
+             * \brief Find the entry in FORMATTERS whose extension ends the
+             * given filename, or the default entry if none does
+             */
+            static const Info* findInfo(const std::string& filename);
         };
 
         //! \brief Formatter that writes all message information
@@ -295,11 +346,15 @@ namespace sparta
              * message
              */
             void write(const sparta::log::Message& msg) override {
-                // Replace any \n's with nothing
-                stream_ << msg.info << copyWithReplace(msg.content, '\n', "") << std::endl;
+                writeFields(MessageFields(msg.info, msg.info.origin.getLocation(), msg.content));
                 stream_.flush();
             }
 
+            void writeFields(const MessageFields& fields) override {
+                // Replace any \n's with nothing
+                stream_ << fields << copyWithReplace(*fields.content, '\n', "") << '\n';
+            }
+
             void writeHeader(const SimulationInfo& sim_info) override {
                 sim_info.write(stream_, "#", "\n");
                 stream_.flush();
@@ -319,7 +374,12 @@ namespace sparta
             /*!
              * \brief Writes a moderate amount of info to output stream
              */
-            void write(const sparta::log::Message& msg) override;
+            void write(const sparta::log::Message& msg) override {
+                writeFields(MessageFields(msg.info, msg.info.origin.getLocation(), msg.content));
+                stream_.flush();
+            }
+
+            void writeFields(const MessageFields& fields) override;
 
             void writeHeader(const SimulationInfo& sim_info) override {
                 sim_info.write(stream_, "#", "\n");
@@ -338,12 +398,16 @@ namespace sparta
             { }
 
             void write(const sparta::log::Message& msg) override {
-                stream_ << msg.info.origin.getLocation() << ": "
-                        << *msg.info.category << ": "
-                        << copyWithReplace(msg.content, '\n', "") << std::endl;
+                writeFields(MessageFields(msg.info, msg.info.origin.getLocation(), msg.content));
                 stream_.flush();
             }
 
+            void writeFields(const MessageFields& fields) override {
+                stream_ << *fields.location << ": "
+                        << *fields.category << ": "
+                        << copyWithReplace(*fields.content, '\n', "") << '\n';
+            }
+
             void writeHeader(const SimulationInfo& sim_info) override {
                 sim_info.write(stream_, "#", "\n");
                 stream_.flush();
@@ -364,6 +428,10 @@ namespace sparta
                 stream_.flush();
             }
 
+            void writeFields(const MessageFields& fields) override {
+                stream_ << copyWithReplace(*fields.content, '\n', "") << '\n';
+            }
+
             void writeHeader(const SimulationInfo& sim_info) override {
                 sim_info.write(stream_, "#", "\n");
                 stream_.flush();
@@ -430,6 +498,10 @@ namespace sparta
                 return ss.str();
             }
 
+            void flush() override {
+                stream_.flush();
+            }
+
         private:
 
             virtual void write_(const sparta::log::Message& msg) override {
@@ -474,18 +546,7 @@ namespace sparta
                 // Throw on write errors
                 stream_.exceptions(std::ostream::eofbit | std::ostream::badbit | std::ostream::failbit | std::ostream::goodbit);
 
-                fmtinfo_ = Formatter::FORMATTERS;
-                while(true){
-                    if(nullptr == fmtinfo_->extension){
-                        break; // End of the list. Use this formatter
-                    }
-                    std::string ext = fmtinfo_->extension;
-                    size_t pos = filename.find(ext);
-                    if(pos != std::string::npos && pos == filename.size() - ext.size()){
-                        break; // Use this fmtinfo_->factory to construct
-                    }
-                    ++fmtinfo_;
-                }
+                fmtinfo_ = Formatter::findInfo(filename);
                 if(nullptr == fmtinfo_){
                     throw SpartaException("No formatters defined in FORMATTERS ")
                         << "list for file-based destination instance. "
@@ -497,8 +558,10 @@ namespace sparta
                 formatter_->writeHeader(SimulationInfo::getInstance());
             }
 
+            //! Also matches the filename with an ASYNC_DEST_PREFIX so that a
+            //! file is only ever opened by one destination
             virtual bool compareStrings(const std::string& filename) const override {
-                return filename == filename_;
+                return getDestinationFilename(filename) == filename_;
             }
 
             // From TreeNode
@@ -519,6 +582,12 @@ namespace sparta
                 return ss.str();
             }
 
+            //! Formatters which buffer (e.g. the binary formatter) rely on
+            //! this to get everything to disk
+            void flush() override {
+                stream_.flush();
+            }
+
         private:
 
             virtual void write_(const sparta::log::Message& msg) override {
@@ -526,6 +595,149 @@ namespace sparta
             };
         };
 
+        /*!
+         * \brief Destination that writes to a file from a background
+         * thread.
+         *
+         * Messages are formatted when they are logged, as with
+         * DestinationInstance<std::string> (the format is chosen by file
+         * extension in the same way), but into an in-memory batch instead
+         * of the file. Full batches go to a writer thread through a bounded
+         * queue of recycled buffers and are written in large chunks. The
+         * file is flushed only every flush interval, when flush() is called
+         * (see DestinationManager::flushDestinations) and when the
+         * destination is destroyed. If the writer falls behind by more
+         * than the queue holds, logging blocks until it catches up;
+         * messages are never dropped.
+         *
+         * Messages are written in the order they were logged, so each
+         * MessageSource's messages appear in order.
+         *
+         * Created by DestinationManager for filenames prefixed with
+         * ASYNC_DEST_PREFIX. The prefixed and unprefixed names refer to the
+         * same destination; whichever is used first decides whether the
+         * file is written asynchronously.
+         *
+         * Write errors in the writer thread are reported by throwing from
+         * the next write or flush.
+         */
+        class AsyncDestination : public Destination
+        {
+        public:
+
+            //! Default size of a batch before it is handed to the writer
+            static constexpr size_t DEFAULT_BATCH_BYTES = 64 * 1024;
+
+            //! Default number of full batches that can wait for the writer
+            static constexpr uint32_t DEFAULT_MAX_BATCHES = 16;
+
+            /*!
+             * \brief Opens the file and starts the writer thread
+             * \param filename File to write. Format is based on extension
+             * \param flush_interval Longest time a message is held before
+             * being written and flushed. Must be nonzero
+             * \param batch_bytes Size at which a batch is handed to the
+             * writer
+             * \param max_batches Full batches which can wait for the writer
+             * before logging blocks
+             */
+            AsyncDestination(const std::string& filename,
+                             std::chrono::milliseconds flush_interval = getDefaultFlushInterval(),
+                             size_t batch_bytes = DEFAULT_BATCH_BYTES,
+                             uint32_t max_batches = DEFAULT_MAX_BATCHES);
+
+            //! Writes out everything still held, then stops the writer
+            ~AsyncDestination();
+
+            virtual bool compareStrings(const std::string& filename) const override {
+                return getDestinationFilename(filename) == filename_;
+            }
+
+            virtual std::string stringize(bool pretty=false) const override;
+
+            void flush() override;
+
+            //! Number of batches handed to the file so far
+            uint64_t getNumBatchesWritten() const;
+
+            /*!
+             * \brief Sets the flush interval of AsyncDestinations
+             * constructed from now on without an explicit interval
+             */
+            static void setDefaultFlushInterval(std::chrono::milliseconds interval);
+
+            //! Gets the default flush interval (1 second unless set)
+            static std::chrono::milliseconds getDefaultFlushInterval() {
+                return default_flush_interval_;
+            }
+
+        private:
+
+            //! streambuf appending everything written to a string
+            class AppendBuf_ : public std::streambuf
+            {
+            public:
+                explicit AppendBuf_(std::string& target) : target_(target) {}
+
+            protected:
+                int_type overflow(int_type ch) override {
+                    if(!traits_type::eq_int_type(ch, traits_type::eof())){
+                        target_.push_back(traits_type::to_char_type(ch));
+                    }
+                    return traits_type::not_eof(ch);
+                }
+
+                std::streamsize xsputn(const char* s, std::streamsize n) override {
+                    target_.append(s, n);
+                    return n;
+                }
+
+            private:
+                std::string& target_;
+            };
+
+            virtual void write_(const sparta::log::Message& msg) override;
+
+            //! Moves the batch being filled onto the queue for the writer
+            //! \pre mutex_ is held
+            void queuePending_();
+
+            //! Throws if the writer thread failed to write
+            //! \pre mutex_ is held
+            void checkWriterError_() const;
+
+            //! Body of the writer thread
+            void writerLoop_();
+
+            const std::string filename_;
+            std::ofstream stream_;
+            const Formatter::Info* fmtinfo_;
+            const std::chrono::milliseconds flush_interval_;
+            const size_t batch_bytes_;
+            const uint32_t max_batches_;
+
+            mutable std::mutex mutex_;             //!< Guards everything below
+            std::condition_variable writer_cv_;    //!< Wakes the writer
+            std::condition_variable producer_cv_;  //!< Wakes loggers waiting on the writer
+            std::string pending_;                  //!< Batch being filled
+            std::deque<std::string> full_;         //!< Batches waiting for the writer
+            std::vector<std::string> spare_;       //!< Written batches kept for their capacity
+            uint64_t num_queued_ = 0;              //!< Batches ever queued
+            uint64_t num_written_ = 0;             //!< Batches ever written
+            uint64_t num_flushed_ = 0;             //!< Batches written and flushed
+            uint64_t flush_target_ = 0;            //!< Batches flush() is waiting to see flushed
+            bool stop_ = false;                    //!< Writer should drain and exit
+            std::exception_ptr writer_error_;      //!< Failure in the writer thread
+
+            AppendBuf_ buf_{pending_};
+            std::ostream fmt_stream_{&buf_};       //!< Stream the formatter writes to
+            std::unique_ptr<Formatter> formatter_;
+
+            std::thread writer_;
+
+            static std::chrono::milliseconds default_flush_interval_;
+        };
+
 
         /*!
          * \brief Manages a set of destinations representing files or streams.
@@ -579,22 +791,53 @@ namespace sparta
             //! createDestination overload for handling const char[] strings
             template <std::size_t N>
             static Destination* createDestination(const char (&arg)[N]) {
-                return new DestinationInstance<std::string>(arg);
+                return createFileDestination(arg);
             }
 
             //! createDestination overload for handling char* strings
             static Destination* createDestination(const char *& arg) {
-                return new DestinationInstance<std::string>(arg);
+                return createFileDestination(arg);
             }
 
             template <class DestT>
             static Destination* createDestination(const DestT& arg) {
-                return new DestinationInstance<DestT>(arg);
+                if constexpr (std::is_same<DestT, std::string>::value) {
+                    return createFileDestination(arg);
+                } else {
+                    return new DestinationInstance<DestT>(arg);
+                }
             }
 
             template <class DestT>
             static Destination* createDestination(DestT& arg) {
-                return new DestinationInstance<DestT>(arg);
+                if constexpr (std::is_same<std::remove_const_t<DestT>, std::string>::value) {
+                    return createFileDestination(arg);
+                } else {
+                    return new DestinationInstance<DestT>(arg);
+                }
+            }
+
+            /*!
+             * \brief Creates the destination for a filename: an
+             * AsyncDestination if it starts with ASYNC_DEST_PREFIX,
+             * otherwise a DestinationInstance<std::string>
+             */
+            static Destination* createFileDestination(const std::string& dest) {
+                const std::string filename = getDestinationFilename(dest);
+                if(filename.size() != dest.size()){
+                    return new AsyncDestination(filename);
+                }
+                return new DestinationInstance<std::string>(filename);
+            }
+
+            /*!
+             * \brief Flushes every destination. Blocks until any messages
+             * held by asynchronous destinations are written out
+             */
+            static void flushDestinations() {
+                for(auto& d : dests_){
+                    d->flush();
+                }
             }
 
             /*!
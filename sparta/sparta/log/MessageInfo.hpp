@@ -47,6 +47,40 @@ class TreeNode;
 
         static constexpr const char* INFO_DELIMITER = " ";
 
+        /*!
+         * \brief Everything the log formatters write about a message, with
+         * the origin node and its clock already resolved.
+         *
+         * This is what a message looks like once it has left the simulation
+         * (e.g. when read back from a binary log). The strings are not owned
+         * and must outlive this object.
+         */
+        struct MessageFields
+        {
+            //! Empty fields, to be filled in
+            MessageFields() = default;
+
+            /*!
+             * \brief Resolve a message's fields at the time it is logged
+             * \param info Message information
+             * \param location Location of info.origin
+             * \param content Message content
+             */
+            MessageFields(const MessageInfo& info,
+                          const std::string& location,
+                          const std::string& content);
+
+            sim_time_type sim_time = 0;                //!< Simulator timestamp
+            bool has_cycle = false;                    //!< Did the origin have a clock?
+            uint64_t cycle = 0;                        //!< Cycle of the origin's clock (if has_cycle)
+            MessageInfo::wall_time_type wall_time = 0; //!< Timestamp in wall-clock time
+            thread_id_type thread_id = 0;              //!< Thread ID of source
+            seq_num_type seq_num = 0;                  //!< Sequence number of message within thread
+            const std::string* location = nullptr;     //!< Location of the node the message came from
+            const std::string* category = nullptr;     //!< Category of the message
+            const std::string* content = nullptr;      //!< Message content
+        };
+
         /*!
          * \brief ostream insertion operator for serializing MessageInfo.
          *
@@ -54,6 +88,12 @@ class TreeNode;
          */
         std::ostream& operator<<(std::ostream& o, const MessageInfo& info);
 
+        /*!
+         * \brief Writes the message information (not the content) of
+         * MessageFields exactly as operator<< writes a MessageInfo
+         */
+        std::ostream& operator<<(std::ostream& o, const MessageFields& fields);
+
     } // namespace log
 } // namespace sparta
 
@@ -7,14 +7,21 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <unordered_set>
 #include <unordered_map>
 #include <tuple>
 #include <iomanip>
 #include <sstream>
 #include <limits>
+#include <vector>
 
 #include "sparta/pipeViewer/transaction_structures.hpp"
 #include "sparta/utils/SpartaException.hpp"
@@ -39,6 +46,21 @@ namespace sparta::pipeViewer
      * (Note) the last entry in the index file will always point to the last record
      * written to file.
      *
+     * With a background writer, the record and index data are appended
+     * to large in-memory blocks instead of being written as they come.
+     * Full blocks go to a writer thread through a bounded queue of
+     * recycled blocks.  If the writer falls behind by more than the
+     * queue holds, the simulation waits for it; nothing is dropped.  The
+     * files are the same, byte for byte, as without the writer.  Errors
+     * in the writer thread are thrown from the next block handed to it.
+     *
+     * With compression, the record file is written as zlib-compressed
+     * chunks, one per index interval (or per block_bytes of records,
+     * whichever comes first), and a chunk index (chunk.bin) maps record
+     * positions to chunks.  Positions in the index file stay positions
+     * in the uncompressed records, so pipeViewer::Reader can still find
+     * the records for a tick with a binary search.  Chunks are
+     * compressed by the background writer when there is one.
      */
     class Outputter
     {
@@ -62,26 +84,83 @@ namespace sparta::pipeViewer
             writeData_(ss, &data, sizeof(T));
         }
 
+        /**
+         * \brief Write data to the record file, or to the current block
+         *        with a background writer
+         */
+        void writeRecord_(const char* const data, const std::size_t size)
+        {
+            if(buffered_) {
+                block_.records.append(data, size);
+                if(SPARTA_EXPECT_FALSE(!compress_ && block_.records.size() >= block_bytes_)) {
+                    queueBlock_();
+                }
+            }
+            else {
+                record_file_.write(data, size);
+            }
+            record_pos_ += size;
+        }
+
+        template<typename T>
+        void writeRecord_(const T* const data, const std::size_t size = sizeof(T))
+        {
+            writeRecord_(reinterpret_cast<const char* const>(data), size);
+        }
+
+        template<typename T>
+        void writeRecord_(const T& data)
+        {
+            writeRecord_(&data, sizeof(T));
+        }
+
     public:
 
+        //! Size of a block handed to the background writer
+        static constexpr std::size_t DEFAULT_BLOCK_BYTES = 4 * 1024 * 1024;
+
+        //! Number of full blocks that can wait for the background writer
+        static constexpr uint32_t DEFAULT_MAX_BLOCKS = 4;
+
         /*!
-         * \brief File format version written by this outputter.
+         * \brief Newest file format version written by this outputter.
          * This must be incremented on any change to the transaction type
          * \note If you are incrementing this, be sure pipeViewer::Reader is up to
          * date and backward compatible
          */
-        static constexpr uint32_t FILE_VERSION = 2;
+        static constexpr uint32_t FILE_VERSION = 3;
+
+        //! Version written for compressed pipeouts
+        static constexpr uint32_t COMPRESSED_FILE_VERSION = 3;
+
+        //! Version written for uncompressed pipeouts, which older
+        //! readers can still load
+        static constexpr uint32_t UNCOMPRESSED_FILE_VERSION = 2;
 
         /**
          * \brief Construct an Outputter
          * \param file_path the path to the folder to store output files.
          * \param interval The number of cycles between indexes
+         * \param background_writer Write the record and index files from
+         *                          a background thread
+         * \param block_bytes Size at which a block is handed to the
+         *                    background writer
+         * \param max_blocks Full blocks which can wait for the
+         *                   background writer before writing blocks
+         * \param compress Write the record file as compressed chunks.
+         *                 With compression, block_bytes also bounds
+         *                 the uncompressed size of a chunk.
          */
-        Outputter(const std::string& filepath, const uint64_t interval);
+        Outputter(const std::string& filepath, const uint64_t interval,
+                  bool background_writer = false,
+                  std::size_t block_bytes = DEFAULT_BLOCK_BYTES,
+                  uint32_t max_blocks = DEFAULT_MAX_BLOCKS,
+                  bool compress = false);
 
         /**
          * \brief Close the Record file and the index file.
          * also writes an index pointing to the end of the record file.
+         * With a background writer, waits for it to write everything.
          */
         virtual ~Outputter();
 
@@ -92,12 +171,16 @@ namespace sparta::pipeViewer
         template<class R_Type>
         void writeTransaction(const R_Type& dat)
         {
-            last_record_pos_ = record_file_.tellp();
+            // Keep records whole within a chunk
+            if(SPARTA_EXPECT_FALSE(compress_ && block_.records.size() >= block_bytes_)) {
+                endChunk_();
+            }
+            last_record_pos_ = record_pos_;
 #ifdef PIPELINE_DBG
             std::cout << "writing transaction at: " << last_record_pos_ << " TMST: "
                       << dat.time_Start << " TMEN: " << dat.time_End <<  std::endl;
 #endif
-            writeData_(record_file_, dat);
+            writeRecord_(dat);
         }
 
         /**
@@ -105,15 +188,95 @@ namespace sparta::pipeViewer
          * This method will likely be set to run on the schedular on a given interval.
          */
         void writeIndex();
+
+        //! Is a background thread writing the record and index files?
+        bool hasBackgroundWriter() const {
+            return background_;
+        }
+
+        //! Is the record file written as compressed chunks?
+        bool isCompressed() const {
+            return compress_;
+        }
+
+        //! Number of blocks the background writer has written so far
+        uint64_t getNumBlocksWritten() const;
+
     private:
+
+        //! Record and index data for the background writer
+        struct Block
+        {
+            std::string records;
+            std::string index;
+        };
+
+        //! Hands the current block to the background writer, waiting
+        //! if it is too far behind
+        void queueBlock_();
+
+        //! Ends the current chunk of a compressed record file
+        void endChunk_();
+
+        //! Writes a block to the files, compressing its records into
+        //! a chunk if compression is on
+        void writeBlock_(const Block& block);
+
+        //! Throws if the background writer failed to write
+        //! \pre mutex_ is held
+        void checkWriterError_() const;
+
+        //! Body of the background writer thread
+        void writerLoop_();
+
         std::ofstream record_file_; /*!< The record file contains the actual transaction data */
         std::ofstream index_file_; /*!< The file stream for index file being created */
         std::ofstream map_file_; /*!< The file stream for map file which maps Location ID to Pair ID */
         std::ofstream data_file_;/*! The file stream for data file which contains Name, Size, Pair number */
         std::ofstream string_file_;/*! The file stream for string_map file which has the String representation */
         std::ofstream display_format_file_;
+        std::ofstream chunk_file_; /*!< The chunk index of a compressed record file */
 
         uint64_t last_record_pos_; /*!< A pointer to the last record written */
+        uint64_t record_pos_ = 0;  /*!< Size of the record file once everything is written */
+
+        const bool background_;         //!< Is there a background writer?
+        const bool compress_;           //!< Are records written as compressed chunks?
+        const bool buffered_;           //!< Are records collected in block_?
+        const std::size_t block_bytes_; //!< Size at which a block is queued
+        const uint32_t max_blocks_;     //!< Full blocks that can be queued
+        Block block_;                   //!< Block being filled
+
+        // Used by whichever thread writes the blocks
+        std::string compressed_;        //!< Compression buffer
+        chunk_index_t chunk_;           //!< Position of the next chunk
+
+        mutable std::mutex mutex_;             //!< Guards everything below
+        std::condition_variable writer_cv_;    //!< Wakes the writer
+        std::condition_variable producer_cv_;  //!< Wakes the simulation waiting on the writer
+        std::deque<Block> full_;               //!< Blocks waiting for the writer
+        std::vector<Block> spare_;             //!< Written blocks kept for their capacity
+        uint64_t num_written_ = 0;             //!< Blocks written
+        bool stop_ = false;                    //!< Writer should drain and exit
+        std::exception_ptr writer_error_;      //!< Failure in the writer thread
+
+        std::thread writer_;
+
+        // Unique location ids of the pair records written
+        std::unordered_set<uint32_t> loc_id_set_;
+
+        // Unique pair ids of the pair records written
+        std::unordered_set<uint16_t> pair_id_set_;
+
+        using multiIndex = std::tuple<uint64_t, uint64_t, uint64_t>;
+
+        // An Unordered Map with a Tuple of 3 Integers as Key and a String as Value.
+        // This map is used to store the String mappings from the Intermediate Integer values.
+        // We use integers as this makes the database smaller and also very fast to write to Binary File.
+        // The first Integer in the May Key is the unique Pair they bleong to.
+        // The Second Integer is the Field number they belong to.
+        // The Third Integer is the actual Integral value which corresponds to the String value.
+        std::unordered_map<multiIndex, std::string, hashtuple::hash<multiIndex>> string_map_;
     };
 
     /*!
@@ -127,8 +290,8 @@ namespace sparta::pipeViewer
     {
 
         writeTransaction<transaction_t>(static_cast<transaction_t>(dat));
-        writeData_(record_file_, dat.length);
-        writeData_(record_file_, dat.annt.data(), dat.length);
+        writeRecord_(dat.length);
+        writeRecord_(dat.annt.data(), dat.length);
     }
 
     /*!
@@ -137,30 +300,14 @@ namespace sparta::pipeViewer
     template<>
     inline void Outputter::writeTransaction(const pair_t & dat){
 
-        // A static Unordered Set which contains unique location id of the records.
-        static std::unordered_set<uint32_t> locIDSet;
-
-        // A static Unordered Set which contains unique pair id of the records.
-        static std::unordered_set<uint16_t> pairIDSet;
-
-        using multiIndex = std::tuple<uint64_t, uint64_t, uint64_t>;
-
-        // A static Unordered Map with a Tuple of 3 Integers as Key and a String as Value.
-        // This map is used to store the String mappings from the Intermediate Integer values.
-        // We use integers as this makes the database smaller and also very fast to write to Binary File.
-        // The first Integer in the May Key is the unique Pair they bleong to.
-        // The Second Integer is the Field number they belong to.
-        // The Third Integer is the actual Integral value which corresponds to the String value.
-        static std::unordered_map<multiIndex, std::string, hashtuple::hash<multiIndex>> stringMap;
-
         // If we find a Location ID that we have not seen before, we store it in the Location ID set.
-        if(locIDSet.emplace(dat.location_ID).second) {
+        if(loc_id_set_.emplace(dat.location_ID).second) {
             // We add the Location Id followed by the Pair Id of that record in the map file.
             map_file_ << dat.location_ID << ':' << dat.pairId << '\n';
         }
 
         // If we find a Pair ID we have not seen before, we store it in the Pair ID set.
-        if(pairIDSet.emplace(dat.pairId).second) {
+        if(pair_id_set_.emplace(dat.pairId).second) {
             // We write the Pair ID to the data file followed by the Number of pairs
             // this kind of pair collectable contains.
             // The first pair of every pair record is its PairID, so we do not add that to the database.
@@ -178,16 +325,15 @@ namespace sparta::pipeViewer
 
                     // We write the Value for field "i" and only write as much Bytes
                     // as it needs to by checking Sizes[i].
-                    writeData_(record_file_,
-                               &dat.valueVector[i].first,
-                               dat.sizeOfVector[i]);
+                    writeRecord_(&dat.valueVector[i].first,
+                                 dat.sizeOfVector[i]);
 
                     // We check if the value at field "i" has any String Representation.
                     // If it has, then its corresponding string vector field will not be empty.
                     if(!dat.stringVector[i].empty()){
                         // We check if we have seen this exact pair, field and value before or not.
                         if(const auto& [val, str] = std::tie(dat.valueVector[i].first, dat.stringVector[i]);
-                           stringMap.try_emplace(std::make_tuple(dat.pairId, i, val), str).second) {
+                           string_map_.try_emplace(std::make_tuple(dat.pairId, i, val), str).second) {
                             // We add this mapping into out String Map file which we will
                             // use when reading back from the database.
                             string_file_ << dat.pairId
@@ -205,8 +351,8 @@ namespace sparta::pipeViewer
                     // as it needs to by checking Sizes[i].
                     const auto& str = dat.stringVector[i];
                     const uint16_t length = str.size();
-                    writeData_(record_file_, length);
-                    writeData_(record_file_, str.data(), length);
+                    writeRecord_(length);
+                    writeRecord_(str.data(), length);
                 }
             }
             data_file_ << '\n';
@@ -229,16 +375,15 @@ namespace sparta::pipeViewer
                 if(dat.valueVector[i].second){
                     // We write the Value for field "i" and only write as much Bytes
                     // as it needs to by checking Sizes[i].
-                    writeData_(record_file_,
-                               &dat.valueVector[i].first,
-                               dat.sizeOfVector[i]);
+                    writeRecord_(&dat.valueVector[i].first,
+                                 dat.sizeOfVector[i]);
 
                     // We check if the value at field "i" has any String Representation.
                     // If it has, then its corresponding string vector field will not be empty.
                     if(!dat.stringVector[i].empty()){
                         // We check if we have seen this exact pair, field and value before or not.
                         if(const auto& [val, str] = std::tie(dat.valueVector[i].first, dat.stringVector[i]);
-                           stringMap.try_emplace(std::make_tuple(dat.pairId, i, val), str).second) {
+                           string_map_.try_emplace(std::make_tuple(dat.pairId, i, val), str).second) {
                             // We add this mapping into out String Map file which we will
                             // use when reading back from the database.
                             string_file_ << dat.pairId
@@ -253,8 +398,8 @@ namespace sparta::pipeViewer
                     // as it needs to by checking Sizes[i].
                     const auto& str = dat.stringVector[i];
                     const uint16_t length = str.size();
-                    writeData_(record_file_, length);
-                    writeData_(record_file_, str.data(), length);
+                    writeRecord_(length);
+                    writeRecord_(str.data(), length);
                 }
             }
         }
@@ -25,6 +25,21 @@ static constexpr std::string_view HEADER_PREFIX = "sparta_pipeout_version:";
 static constexpr int VERSION_LENGTH = 4;
 static constexpr size_t HEADER_SIZE = HEADER_PREFIX.size() + VERSION_LENGTH + 1; // prefix + number + newline
 
+/*!
+ * \brief An entry in the chunk index (chunk.bin) of a compressed pipeout
+ *
+ * The record file of a compressed pipeout is a series of chunks, each
+ * a zlib stream holding whole records.  Positions in the index file
+ * are positions in the uncompressed records; the chunk index maps them
+ * to the chunk holding them.
+ */
+struct chunk_index_t {
+    uint64_t record_pos = 0;      //! Uncompressed position of the chunk's first record
+    uint64_t file_pos = 0;        //! Position of the chunk in the record file
+    uint64_t size = 0;            //! Uncompressed size of the chunk
+    uint64_t compressed_size = 0; //! Size of the chunk in the record file
+};
+
 /*!
  * \brief Generic transaction event, packed for density on disk
  * \warning Since this is written as a chunk, it is endian-dependent and
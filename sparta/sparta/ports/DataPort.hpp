@@ -9,10 +9,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <memory>
 #include <set>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "sparta/ports/Port.hpp"
+#include "sparta/kernel/PartitionedScheduler.hpp"
 #include "sparta/utils/DataContainer.hpp"
 #include "sparta/events/EventSet.hpp"
 #include "sparta/events/PayloadEvent.hpp"
@@ -31,6 +36,47 @@ namespace sparta
     template<class DataT>
     class DataInPort;
 
+    /**
+     * \class DataBatchView
+     * \brief A read-only view of a contiguous batch of data sent
+     *        with DataOutPort::sendBatch
+     *
+     * Can be made from a pointer and a count, or implicitly from any
+     * contiguous container with data() and size() (std::vector,
+     * std::array, etc).  The view does not own the data.
+     */
+    template<class DataT>
+    class DataBatchView
+    {
+    public:
+        //! View count items starting at data
+        DataBatchView(const DataT * data, size_t count) :
+            data_(data), size_(count)
+        {}
+
+        //! View a contiguous container
+        template<class ContainerT,
+                 typename = decltype(std::declval<const ContainerT &>().data())>
+        DataBatchView(const ContainerT & container) :
+            DataBatchView(container.data(), container.size())
+        {}
+
+        const DataT * begin() const { return data_; }
+        const DataT * end()   const { return data_ + size_; }
+        const DataT * data()  const { return data_; }
+        size_t size()         const { return size_; }
+        bool empty()          const { return size_ == 0; }
+
+        const DataT & operator[](size_t idx) const {
+            sparta_assert(idx < size_, "DataBatchView index out of range: " << idx);
+            return data_[idx];
+        }
+
+    private:
+        const DataT * data_ = nullptr;
+        size_t size_ = 0;
+    };
+
     /**
      * \class DataOutPort
      *
@@ -111,6 +157,13 @@ namespace sparta
          * DataInPort, but the DataInPort knows \b nothing about the DataOutPort.  This is a
          * uni-directional binding.  For a complete binding, use the sparta::bind
          * global method.
+         *
+         * If the DataInPort's clock is on a different Scheduler, the
+         * two ports are in different partitions of a
+         * sparta::PartitionedScheduler.  Data sent to that DataInPort
+         * goes over a PartitionLink and is delivered between windows;
+         * the DataInPort must have a delay.  isDriven and cancel do
+         * not see data in flight to another partition.
          */
         void bind(Port * in) override
         {
@@ -119,6 +172,17 @@ namespace sparta
                 throw SpartaException("ERROR: Attempt to bind DataInPort of a disparate types: '" +
                                     in->getLocation() + "' to '" + getLocation() + "'");
             }
+            if(SPARTA_EXPECT_FALSE(inp->getClock()->getScheduler() != getClock()->getScheduler()))
+            {
+                if(inp->getPortDelay() == 0) {
+                    throw SpartaException("ERROR: DataInPort '" + in->getLocation() +
+                                          "' is on a different Scheduler than DataOutPort '" +
+                                          getLocation() + "' and must have a delay to be bound to it");
+                }
+                OutPort::bind(in);
+                partition_links_.emplace_back(inp->createPartitionLink_(this));
+                return;
+            }
             OutPort::bind(in);
             bound_in_ports_.push_back(inp);
         }
@@ -144,11 +208,48 @@ namespace sparta
          */
         void send(const DataT & dat, sparta::Clock::Cycle rel_time = 0)
         {
-            sparta_assert(!bound_in_ports_.empty(),
+            sparta_assert(!bound_in_ports_.empty() || !partition_links_.empty(),
                           "ERROR! Attempt to send data on unbound port: " << getLocation());
             for(DataInPort<DataT>* itr : bound_in_ports_) {
                 itr->send_(dat, rel_time);
             }
+            for(auto & link : partition_links_) {
+                link->send(dat, rel_time);
+            }
+        }
+
+        /**
+         * \brief Send a batch of data to bound receivers
+         * \param batch    The data to send, in order
+         * \param rel_time The relative time for sending
+         *
+         * Equivalent to calling send() on each item in order with the
+         * same rel_time, but each bound DataInPort schedules a single
+         * event for the whole batch instead of one per item.  Bound
+         * DataInPorts see the same data at the same time and in the
+         * same order as they would with individual sends.
+         *
+         * \code
+         * std::array<Inst, 8> fetched = ...;
+         * out_port->sendBatch(fetched, 1);
+         * \endcode
+         *
+         * See DataInPort::registerConsumerBatchHandler for how the
+         * receiver can take the batch as a whole.
+         */
+        void sendBatch(const DataBatchView<DataT> & batch, sparta::Clock::Cycle rel_time = 0)
+        {
+            sparta_assert(!bound_in_ports_.empty() || !partition_links_.empty(),
+                          "ERROR! Attempt to send data on unbound port: " << getLocation());
+            if(SPARTA_EXPECT_FALSE(batch.empty())) {
+                return;
+            }
+            for(DataInPort<DataT>* itr : bound_in_ports_) {
+                itr->sendBatch_(batch, rel_time);
+            }
+            for(auto & link : partition_links_) {
+                link->sendBatch(batch, rel_time);
+            }
         }
 
         /*! \brief Determine if this DataOutPort has any connected
@@ -238,6 +339,9 @@ namespace sparta
     private:
         //! The bound DataIn ports
         std::vector <DataInPort<DataT>*> bound_in_ports_;
+
+        //! Links to bound DataIn ports in other partitions
+        std::vector<std::unique_ptr<typename DataInPort<DataT>::PartitionLink_>> partition_links_;
     };
 
     /**
@@ -290,6 +394,13 @@ namespace sparta
         // Pipeline collection type
         typedef collection::Collectable<DataT> CollectorType;
 
+        // A batch sent with DataOutPort::sendBatch while it is in
+        // flight.  items is mutable so a scheduled batch can be
+        // cleared on delivery and trimmed by cancelIf.
+        struct DataBatch_ {
+            mutable std::vector<DataT> items;
+        };
+
     public:
 
         //! Expected typedef for DataT
@@ -321,6 +432,9 @@ namespace sparta
             user_payload_delivery_.reset(new PhasedPayloadEvent<DataT>(&data_in_port_events_, name + "_forward_event",
                                                                        delivery_phase,
                                                                        CREATE_SPARTA_HANDLER_WITH_DATA(DataInPort<DataT>, receivePortData_, DataT)));
+            batch_payload_delivery_.reset(new PhasedPayloadEvent<DataBatch_>(&data_in_port_events_, name + "_forward_batch_event",
+                                                                             delivery_phase,
+                                                                             CREATE_SPARTA_HANDLER_WITH_DATA(DataInPort<DataT>, receivePortBatch_, DataBatch_)));
         }
 
         /**
@@ -376,6 +490,35 @@ namespace sparta
         void setContinuing(bool continuing) override final {
             Port::setContinuing(continuing);
             user_payload_delivery_->getScheduleable().setContinuing(continuing);
+            batch_payload_delivery_->getScheduleable().setContinuing(continuing);
+        }
+
+        /**
+         * \brief Register a handler that takes batches sent with
+         *        DataOutPort::sendBatch as a whole
+         * \param handler Handler taking a
+         *                const sparta::DataBatchView<DataT> &
+         *
+         * Without one, each item of a batch is handed to the handler
+         * given to registerConsumerHandler, in order, as if it had
+         * been sent on its own.  With one, the batch handler is
+         * called once per batch instead, and the port's data (see
+         * DataContainer) is the last item of the batch.  Data sent
+         * with DataOutPort::send still goes to the regular handler.
+         *
+         * The view is only valid for the duration of the call.
+         */
+        void registerConsumerBatchHandler(const SpartaHandler & handler)
+        {
+            sparta_assert(handler.argCount() == 1,
+                          "DataInPort: " << getName()
+                          << ": The batch handler associated with the DataInPort must take one argument: "
+                          << handler.getName());
+            sparta_assert(!batch_consumer_handler_,
+                          "Only one batch handler is supported on this port: " << getName() <<
+                          " \n\tCurrent registered handler: " << batch_consumer_handler_.getName() <<
+                          " \n\tTrying to register: " << handler.getName());
+            batch_consumer_handler_ = handler;
         }
 
         /*!
@@ -388,7 +531,8 @@ namespace sparta
          *       this function will always return false.
          */
         bool isDriven(Clock::Cycle rel_cycle) const override {
-            return user_payload_delivery_->isScheduled(rel_cycle);
+            return user_payload_delivery_->isScheduled(rel_cycle) ||
+                batch_payload_delivery_->isScheduled(rel_cycle);
         }
 
         /*! \brief Is this Port driven at all?
@@ -397,7 +541,8 @@ namespace sparta
          *       this function will always return false.
          */
         bool isDriven() const override {
-            return user_payload_delivery_->isScheduled();
+            return user_payload_delivery_->isScheduled() ||
+                batch_payload_delivery_->isScheduled();
         }
 
         /**
@@ -407,9 +552,11 @@ namespace sparta
          * This method will cancel all scheduled deliveries of
          * previously sent data on the bound DataOutPorts.  Data
          * already delivered on this DataInPort will not be cleared.
+         * Each item of a canceled batch counts as one payload.
          */
         uint32_t cancel() {
-           return user_payload_delivery_->cancel();
+            return user_payload_delivery_->cancel() +
+                cancelBatchItemsIf_([](const DataT &) { return true; });
         }
 
         /**
@@ -420,10 +567,13 @@ namespace sparta
          * This function does a raw '==' comparison between the
          * criteria and the stashed payloads in flight.  If match, the
          * payload is squashed before the InPort receives it and the
-         * event unscheduled (if scheduled).
+         * event unscheduled (if scheduled).  Matching items are
+         * removed from batches in flight; the rest of the batch is
+         * still delivered.
          */
         uint32_t cancelIf(const DataT & criteria) {
-            return user_payload_delivery_->cancelIf(criteria);
+            return user_payload_delivery_->cancelIf(criteria) +
+                cancelBatchItemsIf_([&criteria](const DataT & dat) { return dat == criteria; });
         }
 
         /**
@@ -434,10 +584,11 @@ namespace sparta
          * This function allows a user to define his/her own
          * comparison operation outside of a direct operator==
          * comparison.  See sparta::PhasedPayloadEvent::cancelIf for an
-         * example.
+         * example.  Matching items are removed from batches in flight.
          */
         uint32_t cancelIf(std::function<bool(const DataT &)> compare) {
-            return user_payload_delivery_->cancelIf(compare);
+            return user_payload_delivery_->cancelIf(compare) +
+                cancelBatchItemsIf_(compare);
         }
 
         /*!
@@ -470,6 +621,7 @@ namespace sparta
                         << handler.getName());
             handler_name_ = getName() + "<DataInPort>[" + handler.getName() + "]";
             user_payload_delivery_->getScheduleable().setLabel(handler_name_.c_str());
+            batch_payload_delivery_->getScheduleable().setLabel(handler_name_.c_str());
         }
 
         void bind_(Port * outp) override final
@@ -487,6 +639,94 @@ namespace sparta
         //! The DataOutPort will send the transaction over as well as bind
         friend class DataOutPort<DataT>;
 
+        /*!
+         * \brief Carries data to this port from a DataOutPort on
+         *        another Scheduler (see PartitionedScheduler)
+         *
+         * Sends are buffered on the sender's thread with the tick
+         * they are due, and scheduled on this port's events by
+         * deliver() between windows.  A send is delivered at the same
+         * tick, and handled the same way, as it would be if both ports
+         * were on one Scheduler.
+         */
+        class PartitionLink_ final : public PartitionLink
+        {
+        public:
+            PartitionLink_(DataInPort * inp, const DataOutPort<DataT> * outp) :
+                PartitionLink(outp->getClock()->getScheduler(), inp->scheduler_,
+                              inp->receiver_clock_->getTick(inp->port_delay_),
+                              outp->getLocation() + " -> " + inp->getLocation()),
+                inp_(inp)
+            {}
+
+            void send(const DataT & dat, sparta::Clock::Cycle rel_time)
+            {
+                sends_.emplace_back(Send_{deliveryTick_(rel_time), 0});
+                items_.emplace_back(dat);
+            }
+
+            void sendBatch(const DataBatchView<DataT> & batch, sparta::Clock::Cycle rel_time)
+            {
+                sends_.emplace_back(Send_{deliveryTick_(rel_time), static_cast<uint32_t>(batch.size())});
+                items_.insert(items_.end(), batch.begin(), batch.end());
+            }
+
+            void deliver() override
+            {
+                Scheduler * receiver = getReceiver();
+                const Scheduler::Tick now = receiver->getCurrentTick();
+                auto item = items_.begin();
+                for(const Send_ & snd : sends_)
+                {
+                    sparta_assert(snd.tick >= now,
+                                  "Data on '" << getName() << "' arrived late: due at tick "
+                                  << snd.tick << " but the receiver is at tick " << now);
+                    if(snd.batch_size == 0) {
+                        inp_->user_payload_delivery_->preparePayload(*item)->
+                            scheduleRelativeTick(snd.tick - now, receiver);
+                        ++item;
+                    }
+                    else {
+                        inp_->batch_staging_.items.assign(item, item + snd.batch_size);
+                        ScheduleableHandle batch_delivery =
+                            inp_->batch_payload_delivery_->preparePayload(inp_->batch_staging_);
+                        batch_delivery->setGroupID(inp_->user_payload_delivery_->getScheduleable().getGroupID());
+                        batch_delivery->scheduleRelativeTick(snd.tick - now, receiver);
+                        item += snd.batch_size;
+                    }
+                }
+                sends_.clear();
+                items_.clear();
+            }
+
+            bool hasPending() const override {
+                return !sends_.empty();
+            }
+
+        private:
+            //! Tick a send made now on the sender is due, as computed
+            //! by send_ on a shared Scheduler
+            Scheduler::Tick deliveryTick_(sparta::Clock::Cycle rel_time) const {
+                const uint32_t total_delay = rel_time + inp_->port_delay_;
+                return getSender()->getCurrentTick() + inp_->receiver_clock_->getTick(Clock::Cycle(total_delay));
+            }
+
+            struct Send_ {
+                Scheduler::Tick tick;
+                uint32_t batch_size; //!< 0 for a single item from send()
+            };
+
+            DataInPort * const inp_;
+            std::vector<Send_> sends_;
+            std::vector<DataT> items_; //!< Data of all sends, in order
+        };
+
+        //! Called by DataOutPort::bind for a DataOutPort on another
+        //! Scheduler
+        std::unique_ptr<PartitionLink_> createPartitionLink_(const DataOutPort<DataT> * outp) {
+            return std::unique_ptr<PartitionLink_>(new PartitionLink_(this, outp));
+        }
+
         /*!
          * \brief Called by DataOutPort, send the data across (schedule event)
          * \param dat The Data to send over
@@ -518,12 +758,70 @@ namespace sparta
             user_payload_delivery_->preparePayload(dat)->schedule(total_delay, receiver_clock_);
         }
 
+        /*!
+         * \brief Called by DataOutPort, send a batch across in one event
+         * \param batch The data to send over
+         * \param rel_time The relative time to schedule into the future
+         *
+         * Same rules as send_.  The batch event is scheduled in the
+         * precedence group of the single-item event so that, within a
+         * cycle, batches and single items are delivered in the order
+         * they were sent and with the same precedence against other
+         * events.
+         */
+        void sendBatch_(const DataBatchView<DataT> & batch, sparta::Clock::Cycle rel_time)
+        {
+            const uint32_t total_delay = rel_time + port_delay_;
+
+            if(SPARTA_EXPECT_FALSE(total_delay == 0))
+            {
+                checkSchedulerPhaseForZeroCycleDelivery_(user_payload_delivery_->getSchedulingPhase());
+                if(user_payload_delivery_->getSchedulingPhase() == scheduler_->getCurrentSchedulingPhase()) {
+                    deliverBatch_(batch);
+                    return;
+                }
+            }
+
+            // Reuse the staging buffer's capacity; the proxy's copy
+            // reuses its own capacity too
+            batch_staging_.items.assign(batch.begin(), batch.end());
+            ScheduleableHandle batch_delivery = batch_payload_delivery_->preparePayload(batch_staging_);
+            batch_delivery->setGroupID(user_payload_delivery_->getScheduleable().getGroupID());
+            batch_delivery->schedule(total_delay, receiver_clock_);
+        }
+
+        //! Remove items matching compare from all batches in flight,
+        //! canceling batches that end up empty.  Returns the number
+        //! of items removed.
+        template<class CompareT>
+        uint32_t cancelBatchItemsIf_(const CompareT & compare)
+        {
+            uint32_t cancel_cnt = 0;
+            batch_payload_delivery_->cancelIf([&](const DataBatch_ & dat_batch) -> bool {
+                auto & items = dat_batch.items;
+                const auto new_end = std::remove_if(items.begin(), items.end(), compare);
+                cancel_cnt += std::distance(new_end, items.end());
+                items.erase(new_end, items.end());
+                return items.empty();
+            });
+            return cancel_cnt;
+        }
+
         //! Event Set for this port
         sparta::EventSet data_in_port_events_;
 
         //! The User-specified delivery notification
         std::unique_ptr<PhasedPayloadEvent<DataT>> user_payload_delivery_;
 
+        //! Delivery of batches from DataOutPort::sendBatch
+        std::unique_ptr<PhasedPayloadEvent<DataBatch_>> batch_payload_delivery_;
+
+        //! Staging area for a batch being scheduled
+        DataBatch_ batch_staging_;
+
+        //! Handler that takes a batch as a whole (optional)
+        SpartaHandler batch_consumer_handler_{"data_in_port_null_batch_handler"};
+
         //! The handler name for scheduler debug
         std::string handler_name_;
 
@@ -547,6 +845,45 @@ namespace sparta
             }
         }
 
+        //! Batch receiving point
+        void receivePortBatch_(const DataBatch_ & dat_batch)
+        {
+            if constexpr (std::is_same<DataT, bool>::value) {
+                // std::vector<bool> isn't contiguous
+                std::unique_ptr<bool[]> bits(new bool[dat_batch.items.size()]);
+                std::copy(dat_batch.items.begin(), dat_batch.items.end(), bits.get());
+                deliverBatch_(DataBatchView<DataT>(bits.get(), dat_batch.items.size()));
+            }
+            else {
+                deliverBatch_(DataBatchView<DataT>(dat_batch.items));
+            }
+            // Don't hold on to the data until the proxy is reused
+            dat_batch.items.clear();
+        }
+
+        //! Hand a batch to the batch handler, or item by item to the
+        //! regular handler
+        void deliverBatch_(const DataBatchView<DataT> & batch)
+        {
+            if(batch_consumer_handler_)
+            {
+                DataContainer<DataT>::setData_(batch[batch.size() - 1]);
+                batch_consumer_handler_((const void*)&batch);
+                if(SPARTA_EXPECT_FALSE(collector_ != nullptr)) {
+                    if(SPARTA_EXPECT_FALSE(collector_->isCollected())) {
+                        for(const DataT & dat : batch) {
+                            collector_->collect(dat);
+                        }
+                    }
+                }
+            }
+            else {
+                for(const DataT & dat : batch) {
+                    receivePortData_(dat);
+                }
+            }
+        }
+
         //! This port's additional delay for receiving the data
         const Clock::Cycle port_delay_;
     };
@@ -66,16 +66,47 @@
  *    For zero-cycle connections, we don't allow one in-flight request in
  *    sync-port since we're trying to deliver the data on the same cycle it
  *    was sent.
+ *
+ * Connections between Schedulers:
+ *
+ *    A SyncOutPort and SyncInPort can be on different Schedulers that are
+ *    partitions of one sparta::PartitionedScheduler, e.g. to cut a model
+ *    at an interconnect.  The SyncInPort must have a port delay; it is
+ *    the latency of the link between the partitions.  Data is passed from
+ *    the sender's thread to the receiver's through a lock-free ring and
+ *    arrives on the same tick as it would on a single Scheduler, slides
+ *    included.
+ *
+ *    The sender can't look at the receiver's ready state, so the
+ *    receiver sends it back through a second ring, along with a credit
+ *    for each item delivered.  The sender applies these a port delay
+ *    after the receiver's tick: not-ready driven on cycle M takes effect
+ *    for the sender one port delay after M rather than on M+1, and the
+ *    sender counts the requests in flight itself (sent minus credits).
+ *    Otherwise isReady() is as above.  Data that arrives while the
+ *    receiver is not ready waits in the SyncInPort instead of
+ *    recirculating and is delivered in order, one per cycle, once ready
+ *    is driven again.
+ *
+ *    None of this depends on thread timing, so such a model runs the same
+ *    way every time.
  */
 
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <mutex>
+
 #include "sparta/simulation/TreeNode.hpp"
 #include "sparta/utils/DataContainer.hpp"
+#include "sparta/utils/SPSCQueue.hpp"
 #include "sparta/collection/DelayedCollectable.hpp"
+#include "sparta/kernel/PartitionedScheduler.hpp"
 #include "sparta/ports/Port.hpp"
 #include "sparta/events/Precedence.hpp"
 #include "sparta/events/EventSet.hpp"
+#include "sparta/events/PhasedUniqueEvent.hpp"
 
 namespace sparta
 {
@@ -142,6 +173,12 @@ namespace sparta
          * \brief Bind to an SyncInPort
          * \param in The SyncInPort to bind to. The data and event types must be the
          * same
+         *
+         * If the SyncInPort's clock is on a different Scheduler, the
+         * two ports are in different partitions of a
+         * sparta::PartitionedScheduler (see "Connections between
+         * Schedulers" in SyncPort.hpp).  The SyncInPort must have a
+         * port delay.
          */
         void bind(Port * in) override
         {
@@ -150,6 +187,12 @@ namespace sparta
                 throw SpartaException("ERROR: Attempt to bind SyncInPort of a disparate types: '" +
                                       in->getLocation() + "' to '" + getLocation() + "'");
             }
+            const bool cross_scheduler = (clk_->getScheduler() != inp->scheduler_);
+            if(SPARTA_EXPECT_FALSE(cross_scheduler && inp->receive_delay_ticks_ == 0)) {
+                throw SpartaException("ERROR: SyncInPort '" + in->getLocation() +
+                                      "' is on a different Scheduler than SyncOutPort '" +
+                                      getLocation() + "' and must have a delay to be bound to it");
+            }
 
             // Sync ports only support one binding for now.
             sparta_assert(sync_in_port_ == 0, "Multiple bind attempts on port:" << getLocation());
@@ -159,6 +202,10 @@ namespace sparta
             OutPort::bind(in);
 
             bound_in_ports_.push_back(inp);
+
+            if(SPARTA_EXPECT_FALSE(cross_scheduler)) {
+                inp->createPartitionLinks_(this, clk_);
+            }
         }
 
         //! Promote base class bind method for references
@@ -178,6 +225,9 @@ namespace sparta
          * the port becomes ready again.
          * Hence this method cannot be used to check if setReady has been called in
          * the current cycle.
+         *
+         * If the SyncInPort is on another Scheduler, setReady takes effect
+         * here one port delay after it was called.
          */
         bool isReady() const {
             sparta_assert(sync_in_port_ != 0, "isReady() check on unbound port:" << getLocation());
@@ -441,6 +491,10 @@ namespace sparta
                                  (&sync_port_events_, name + "_forward_event",
                                   delivery_phase,
                                   CREATE_SPARTA_HANDLER_WITH_DATA(SyncInPort<DataT>, forwardData_, DataT)));
+            backlog_event_.reset(new PhasedUniqueEvent
+                                 (&sync_port_events_, name + "_backlog_event",
+                                  delivery_phase,
+                                  CREATE_SPARTA_HANDLER(SyncInPort<DataT>, deliverBacklog_)));
         }
 
         //! No making copies
@@ -508,7 +562,7 @@ namespace sparta
             Scheduler::Tick num_delay_ticks =
                 computeSendToReceiveTickDelay_(send_clk, rel_cycle, false, prev_data_arrival_tick_);
 
-            sparta::Scheduler::Tick current_tick = scheduler_->getCurrentTick();
+            sparta::Scheduler::Tick current_tick = send_clk->currentTick();
             sparta::Scheduler::Tick abs_scheduled_tick = num_delay_ticks + current_tick;
 
             bool is_already_driven =
@@ -528,7 +582,7 @@ namespace sparta
             Scheduler::Tick num_delay_ticks =
                 computeSendToReceiveTickDelay_(send_clk, 0, false, prev_data_arrival_tick_);
 
-            sparta::Scheduler::Tick current_tick = scheduler_->getCurrentTick();
+            sparta::Scheduler::Tick current_tick = send_clk->currentTick();
             sparta::Scheduler::Tick abs_scheduled_tick = num_delay_ticks + current_tick;
 
             bool is_already_driven =
@@ -603,6 +657,9 @@ namespace sparta
             sparta_assert(scheduler_->getCurrentTick() == 0); //sched init 0
             cur_is_ready_ = is_ready;
             prev_is_ready_ = is_ready;
+            if(credit_link_) {
+                credit_link_->setInitialReady(is_ready);
+            }
         }
 
         /*!
@@ -616,7 +673,8 @@ namespace sparta
          * delivered. 
          * 
          * \param is_ready New state of the input port communicated to the connected
-         *                 output port in 1 clock cycle.
+         *                 output port in 1 clock cycle (one port delay if
+         *                 the SyncOutPort is on another Scheduler).
          */
         void setReady(bool is_ready) {
             if (SPARTA_EXPECT_FALSE(info_logger_)) {
@@ -628,6 +686,9 @@ namespace sparta
                 set_ready_tick_ = cur_tick;
                 prev_is_ready_ = cur_is_ready_;
                 cur_is_ready_ = is_ready;
+                if (SPARTA_EXPECT_FALSE(credit_link_ != nullptr) && is_ready != prev_is_ready_) {
+                    credit_link_->send(cur_tick, is_ready, 0);
+                }
             } else {
                 sparta_assert(cur_tick == set_ready_tick_,
                               "Unexpected set-ready in the past for: " << getLocation());
@@ -650,6 +711,7 @@ namespace sparta
         void setContinuing(bool continuing) final {
             Port::setContinuing(continuing);
             forward_event_->setContinuing(continuing);
+            backlog_event_->setContinuing(continuing);
         }
 
         /**
@@ -735,6 +797,8 @@ namespace sparta
                 if(consumer->getSchedulingPhase() == forward_event_->getSchedulingPhase()) {
                     forward_event_->getScheduleable().precedes(consumer, "Port::bind(" + getName() + "->" + outp->getName() + "),'"
                                                                + consumer->getLabel() + "' is registered driver");
+                    backlog_event_->precedes(consumer, "Port::bind(" + getName() + "->" + outp->getName() + "),'"
+                                             + consumer->getLabel() + "' is registered driver");
                 }
             }
         }
@@ -786,7 +850,24 @@ namespace sparta
             // data to ourself until the owner is ready to accept.
             sparta_assert(num_in_flight_ > 0);
             num_in_flight_--;
-            if (getLatchedReady_(cur_tick) == false) {
+            if (SPARTA_EXPECT_FALSE(credit_link_ != nullptr)) {
+                // From another Scheduler.  The sender doesn't know about
+                // the data waiting here, so it can't be recirculated
+                // through send_; hold it in order instead.
+                if (!backlog_.empty() || !getLatchedReady_(cur_tick) || last_delivery_tick_ == cur_tick) {
+                    if (SPARTA_EXPECT_FALSE(info_logger_)) {
+                        info_logger_ << "HOLDING @" << receiver_clock_->currentCycle()
+                                     << "(" << backlog_.size() << ") "
+                                     << " # " << dat;
+                    }
+                    backlog_.emplace_back(dat);
+                    backlog_event_->schedule(1);
+                }
+                else {
+                    deliverData_(dat);
+                }
+            }
+            else if (getLatchedReady_(cur_tick) == false) {
                 if (SPARTA_EXPECT_FALSE(info_logger_)) {
                     info_logger_ << "RESENDING @" << receiver_clock_->currentCycle()
                                  << "(" << num_in_flight_ << ") "
@@ -801,25 +882,54 @@ namespace sparta
 
             // Else, forward the data to the original handler
             else {
-                DataContainer<DataT>::setData_(dat);
+                deliverData_(dat);
+            }
+        }
 
-                // Always call the consumer_handler BEFORE scheduling
-                // listeners.
-                if(SPARTA_EXPECT_TRUE(explicit_consumer_handler_)) {
-                    explicit_consumer_handler_((const void*)&dat);
-                }
+        //! Hand the data to the consumer
+        void deliverData_(const DataT & dat)
+        {
+            DataContainer<DataT>::setData_(dat);
 
-                // Show the data that has arrived on this OutPort that
-                // the receiver now sees
-                if(SPARTA_EXPECT_FALSE(collector_ != nullptr)) {
-                    collector_->collectWithDuration(dat, 1);
-                }
+            // Always call the consumer_handler BEFORE scheduling
+            // listeners.
+            if(SPARTA_EXPECT_TRUE(explicit_consumer_handler_)) {
+                explicit_consumer_handler_((const void*)&dat);
+            }
 
-                if (SPARTA_EXPECT_FALSE(info_logger_)) {
-                    info_logger_ << "DELIVERING @" << receiver_clock_->currentCycle()
-                                 << "(" << num_in_flight_ << ") "
-                                 << " # " << dat;
-                }
+            // Show the data that has arrived on this OutPort that
+            // the receiver now sees
+            if(SPARTA_EXPECT_FALSE(collector_ != nullptr)) {
+                collector_->collectWithDuration(dat, 1);
+            }
+
+            if (SPARTA_EXPECT_FALSE(info_logger_)) {
+                info_logger_ << "DELIVERING @" << receiver_clock_->currentCycle()
+                             << "(" << num_in_flight_ << ") "
+                             << " # " << dat;
+            }
+
+            if (SPARTA_EXPECT_FALSE(credit_link_ != nullptr)) {
+                last_delivery_tick_ = scheduler_->getCurrentTick();
+                credit_link_->send(last_delivery_tick_, cur_is_ready_, 1);
+            }
+        }
+
+        /*!
+         * Deliver the oldest data held while not ready (data from
+         * another Scheduler only).  Tries again each cycle until all of
+         * it has been delivered.
+         */
+        void deliverBacklog_()
+        {
+            const Scheduler::Tick cur_tick = scheduler_->getCurrentTick();
+            if (!backlog_.empty() && getLatchedReady_(cur_tick) && last_delivery_tick_ != cur_tick) {
+                const DataT dat = std::move(backlog_.front());
+                backlog_.pop_front();
+                deliverData_(dat);
+            }
+            if (!backlog_.empty()) {
+                backlog_event_->schedule(1);
             }
         }
 
@@ -829,6 +939,9 @@ namespace sparta
         //! Typedef for vector of callbacks
         std::unique_ptr<PhasedPayloadEvent<DataT>> forward_event_;
 
+        //! Delivers data held while not ready (see deliverBacklog_)
+        std::unique_ptr<PhasedUniqueEvent> backlog_event_;
+
         //! Allow SyncOutPort::bind to set precedence on the internal forwarding event
         friend void SyncOutPort<DataT>::bind(Port * in);
 
@@ -859,13 +972,22 @@ namespace sparta
                 calculateClockCrossingDelay(send_clk->currentTick(), send_clk, receive_delay_ticks_, receiver_clock_);
 
             sparta::Scheduler::Tick cur_tick =
-                scheduler_->getCurrentTick();
+                send_clk->currentTick();
 
             sparta::Scheduler::Tick abs_scheduled_tick =
                 num_delay_ticks + cur_tick;
 
             bool retval = (abs_scheduled_tick > prev_data_arrival_tick_ || prev_data_arrival_tick_ == PREV_DATA_ARRIVAL_TICK_INIT);
 
+            // On another Scheduler, go by what the receiver has told
+            // the sender so far
+            if (SPARTA_EXPECT_FALSE(credit_link_ != nullptr)) {
+                if (!credit_link_->isReady(cur_tick) && credit_link_->getNumInFlight() > 0) {
+                    retval = false;
+                }
+                return retval;
+            }
+
             sparta_assert(cur_tick >= set_ready_tick_, "Someone drove setReady() in the future in" << getLocation());
 
             // Check for sync-port ready/valid backpressure and override
@@ -913,7 +1035,7 @@ namespace sparta
             Scheduler::Tick num_delay_ticks =
                 calculateClockCrossingDelay(send_clk->getTick(send_delay_cycles), send_clk, receive_delay_ticks_, receiver_clock_);
 
-            sparta::Scheduler::Tick current_tick       = scheduler_->getCurrentTick();
+            sparta::Scheduler::Tick current_tick       = send_clk->currentTick();
             sparta::Scheduler::Tick abs_scheduled_tick = num_delay_ticks + current_tick;
 
             // Slide pushes this send out past the previous arrival,
@@ -994,14 +1116,16 @@ namespace sparta
             Scheduler::Tick num_delay_ticks =
                 computeSendToReceiveTickDelay_(send_clk, send_delay_cycles, allow_slide, prev_data_arrival_tick_);
 
-            sparta::Scheduler::Tick current_tick = scheduler_->getCurrentTick();
+            sparta::Scheduler::Tick current_tick = send_clk->currentTick();
             sparta::Scheduler::Tick abs_scheduled_tick = num_delay_ticks + current_tick;
 
             // Underlying assumption is that all destinations get their
             // event at the same time.
             sparta_assert((abs_scheduled_tick % receiver_clock_->getPeriod()) == 0, "Failed posedge check in:" << getLocation()); // posedge check
 
-            if (SPARTA_EXPECT_FALSE(info_logger_)) {
+            // From another Scheduler, this runs on the sender's thread,
+            // so receive_ logs it on this port's thread instead
+            if (SPARTA_EXPECT_FALSE(info_logger_) && data_link_ == nullptr) {
                 info_logger_ << "RECEIVE SCHEDULED @" << receiver_clock_->getCycle(abs_scheduled_tick)
                              << "(" << num_in_flight_ << ") "
                              << " # " << dat;
@@ -1017,6 +1141,12 @@ namespace sparta
 
             prev_data_arrival_tick_ = abs_scheduled_tick;
 
+            if (SPARTA_EXPECT_FALSE(data_link_ != nullptr)) {
+                data_link_->send(dat, current_tick, abs_scheduled_tick);
+                credit_link_->countSend();
+                return num_delay_ticks;
+            }
+
             if(num_delay_ticks == 0) {
                 checkSchedulerPhaseForZeroCycleDelivery_(forward_event_->getSchedulingPhase());
             }
@@ -1029,7 +1159,254 @@ namespace sparta
 
             return num_delay_ticks;
         }
-        
+
+        /*!
+         * \brief One direction of a connection between Schedulers: a
+         *        lock-free ring from the producing thread to the
+         *        consuming one
+         *
+         * If the ring fills up, the producer moves to a locked overflow
+         * queue and stays on it until the consumer has emptied it, so
+         * entries stay in order.
+         */
+        template<class EntryT>
+        class Channel_
+        {
+        public:
+            explicit Channel_(size_t capacity) : ring_(capacity) {}
+
+            //! Called by the producer
+            void push(EntryT && entry)
+            {
+                if (SPARTA_EXPECT_TRUE(!overflowing_.load(std::memory_order_acquire)) &&
+                    ring_.tryPush(std::move(entry))) {
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(overflow_mutex_);
+                overflow_.emplace_back(std::move(entry));
+                overflowing_.store(true, std::memory_order_release);
+            }
+
+            /*!
+             * \brief Called by the consumer: hand entries to \a consume,
+             *        oldest first, until \a ready returns false for one
+             */
+            template<class ReadyT, class ConsumeT>
+            void drain(ReadyT ready, ConsumeT consume)
+            {
+                if (!drainRing_(ready, consume) || !overflowing_.load(std::memory_order_acquire)) {
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(overflow_mutex_);
+                // The ring may have been added to just before the
+                // producer started overflowing
+                if (!drainRing_(ready, consume)) {
+                    return;
+                }
+                while (!overflow_.empty() && ready(overflow_.front())) {
+                    consume(overflow_.front());
+                    overflow_.pop_front();
+                }
+                if (overflow_.empty()) {
+                    overflowing_.store(false, std::memory_order_release);
+                }
+            }
+
+            //! Is anything waiting?  Exact only if the producer is not
+            //! running
+            bool empty() const {
+                return ring_.empty() && !overflowing_.load(std::memory_order_acquire);
+            }
+
+        private:
+            //! \return false if stopped by \a ready
+            template<class ReadyT, class ConsumeT>
+            bool drainRing_(ReadyT & ready, ConsumeT & consume)
+            {
+                while (EntryT * entry = ring_.front()) {
+                    if (!ready(*entry)) {
+                        return false;
+                    }
+                    consume(*entry);
+                    ring_.pop();
+                }
+                return true;
+            }
+
+            utils::SPSCQueue<EntryT> ring_;
+            std::atomic<bool> overflowing_{false};
+            std::mutex overflow_mutex_;
+            std::deque<EntryT> overflow_;
+        };
+
+        //! Ring size for a Channel_: a little over two windows' worth
+        //! of one entry per cycle
+        static size_t channelCapacity_(Scheduler::Tick latency, Scheduler::Tick period) {
+            size_t capacity = 16;
+            while (capacity < 2 * (latency / period + 2)) {
+                capacity <<= 1;
+            }
+            return capacity;
+        }
+
+        /*!
+         * \brief Carries data to this port from a SyncOutPort on
+         *        another Scheduler (see PartitionedScheduler)
+         *
+         * The sender computes each arrival tick as send_ would on a
+         * single Scheduler.  The receiving partition's thread schedules
+         * everything sent before its window starts, while the sender
+         * may already be adding more.
+         */
+        class DataLink_ final : public PartitionLink
+        {
+        public:
+            DataLink_(SyncInPort * inp, const SyncOutPort<DataT> * outp, const Clock * send_clk) :
+                PartitionLink(send_clk->getScheduler(), inp->scheduler_, inp->receive_delay_ticks_,
+                              outp->getLocation() + " -> " + inp->getLocation()),
+                inp_(inp),
+                channel_(channelCapacity_(inp->receive_delay_ticks_, send_clk->getPeriod()))
+            {}
+
+            //! Called on the sender's thread
+            void send(const DataT & dat, Scheduler::Tick send_tick, Scheduler::Tick arrival_tick) {
+                channel_.push(Send_{dat, send_tick, arrival_tick});
+            }
+
+            void deliver() override
+            {
+                const Scheduler::Tick now = getReceiver()->getCurrentTick();
+                channel_.drain([now](const Send_ & snd) { return snd.send_tick < now; },
+                               [this](const Send_ & snd) { inp_->receive_(snd.dat, snd.arrival_tick); });
+            }
+
+            bool hasPending() const override {
+                return !channel_.empty();
+            }
+
+            bool isConcurrent() const override {
+                return true;
+            }
+
+        private:
+            struct Send_ {
+                DataT dat{};
+                Scheduler::Tick send_tick = 0;
+                Scheduler::Tick arrival_tick = 0;
+            };
+
+            SyncInPort * const inp_;
+            Channel_<Send_> channel_;
+        };
+
+        /*!
+         * \brief Carries the ready state and credits of this port back to
+         *        a SyncOutPort on another Scheduler
+         *
+         * Also keeps the sender's view of this port, which is only
+         * touched on the sender's thread.  An update made on this
+         * port's tick T is applied once the sender reaches T plus the
+         * port delay, whether by deliver() or by the sender asking.
+         */
+        class CreditLink_ final : public PartitionLink
+        {
+        public:
+            CreditLink_(SyncInPort * inp, const SyncOutPort<DataT> * outp, const Clock * send_clk) :
+                PartitionLink(inp->scheduler_, send_clk->getScheduler(), inp->receive_delay_ticks_,
+                              inp->getLocation() + " -> " + outp->getLocation() + " (credits)"),
+                channel_(channelCapacity_(inp->receive_delay_ticks_, inp->receiver_clock_->getPeriod())),
+                is_ready_(inp->cur_is_ready_)
+            {}
+
+            //! Called on the receiver's thread
+            void send(Scheduler::Tick tick, bool is_ready, uint32_t num_credits) {
+                channel_.push(Credit_{tick, is_ready, num_credits});
+            }
+
+            void deliver() override {
+                update_(getReceiver()->getCurrentTick());
+            }
+
+            //! Credits only change the sender's view of the port and never
+            //! schedule anything, so they don't hold up the end of a run
+            bool hasPending() const override {
+                return false;
+            }
+
+            bool isConcurrent() const override {
+                return true;
+            }
+
+            //! Is the port ready, as the sender sees it at \a now?
+            bool isReady(Scheduler::Tick now) {
+                update_(now);
+                return is_ready_;
+            }
+
+            //! Sends not yet credited back
+            uint64_t getNumInFlight() const {
+                return num_in_flight_;
+            }
+
+            void countSend() {
+                ++num_in_flight_;
+            }
+
+            void setInitialReady(bool is_ready) {
+                is_ready_ = is_ready;
+            }
+
+        private:
+            struct Credit_ {
+                Scheduler::Tick tick = 0;
+                bool is_ready = true;
+                uint32_t num_credits = 0;
+            };
+
+            void update_(Scheduler::Tick now)
+            {
+                const Scheduler::Tick latency = getLatency();
+                channel_.drain([now, latency](const Credit_ & crd) { return crd.tick + latency <= now; },
+                               [this](const Credit_ & crd) {
+                                   is_ready_ = crd.is_ready;
+                                   sparta_assert(num_in_flight_ >= crd.num_credits);
+                                   num_in_flight_ -= crd.num_credits;
+                               });
+            }
+
+            Channel_<Credit_> channel_;
+            bool is_ready_;
+            uint64_t num_in_flight_ = 0;
+        };
+
+        //! Called by SyncOutPort::bind for a SyncOutPort on another
+        //! Scheduler
+        void createPartitionLinks_(const SyncOutPort<DataT> * outp, const Clock * send_clk) {
+            sparta_assert(data_link_ == nullptr,
+                          "Multiple bind attempts from another Scheduler on port:" << getLocation());
+            data_link_.reset(new DataLink_(this, outp, send_clk));
+            credit_link_.reset(new CreditLink_(this, outp, send_clk));
+        }
+
+        //! Called on this port's thread by DataLink_::deliver
+        void receive_(const DataT & dat, Scheduler::Tick arrival_tick)
+        {
+            const Scheduler::Tick now = scheduler_->getCurrentTick();
+            sparta_assert(arrival_tick >= now,
+                          "Data on '" << data_link_->getName() << "' arrived late: due at tick "
+                          << arrival_tick << " but the receiver is at tick " << now);
+            if (SPARTA_EXPECT_FALSE(info_logger_)) {
+                info_logger_ << "RECEIVE SCHEDULED @" << receiver_clock_->getCycle(arrival_tick)
+                             << "(" << num_in_flight_ << ") "
+                             << " # " << dat;
+            }
+            forward_event_->preparePayload(dat)->scheduleRelativeTick(arrival_tick - now, scheduler_);
+            num_in_flight_++;
+
+            if (SPARTA_EXPECT_TRUE(is_continuing_)) {
+                scheduler_->kickTheDog();
+            }
+        }
 
     private:
 
@@ -1065,6 +1442,15 @@ namespace sparta
 
         /// loggers
         sparta::log::MessageSource info_logger_;
+
+        //! Links to and from a SyncOutPort on another Scheduler
+        std::unique_ptr<DataLink_> data_link_;
+        std::unique_ptr<CreditLink_> credit_link_;
+
+        //! Data from another Scheduler waiting for the port to be ready,
+        //! and the last tick data was delivered
+        std::deque<DataT> backlog_;
+        Scheduler::Tick last_delivery_tick_ = PREV_DATA_ARRIVAL_TICK_INIT;
     };
 }
 
@@ -70,7 +70,6 @@ namespace sparta
             bool valid;
             bool to_validate;
             DataT data;
-            std::list<uint32_t>::iterator list_pointer;
             uint64_t age_abs_id = 0; // Absolute ID of all allocations
             uint32_t age_rel_id = 0; // Relative ID of current allocations
         };
@@ -92,8 +91,93 @@ namespace sparta
         //! Typedef for size_type
         typedef uint32_t size_type;
 
-        //! Typedef for a list of indexes in age order.
-        typedef std::list<uint32_t>        AgedList;
+        /**
+         * \brief The valid indexes of an aged Array in age order,
+         *        youngest first.
+         *
+         * This is a view of the age links the Array keeps alongside
+         * its entries.  It does not copy them, and it stays current as
+         * the Array is written and erased.
+         */
+        class AgedList
+        {
+        public:
+            //! Forward iterator over the indexes, youngest to oldest
+            class const_iterator : public utils::IteratorTraits<std::forward_iterator_tag, uint32_t>
+            {
+            public:
+                const_iterator() = default;
+
+                uint32_t operator*() const {
+                    return idx_;
+                }
+
+                const_iterator & operator++() {
+                    idx_ = array_->age_links_[idx_].older;
+                    return *this;
+                }
+
+                const_iterator operator++(int) {
+                    const_iterator old_iter(*this);
+                    operator++();
+                    return old_iter;
+                }
+
+                bool operator==(const const_iterator & rhs) const {
+                    return (idx_ == rhs.idx_) && (array_ == rhs.array_);
+                }
+
+                bool operator!=(const const_iterator & rhs) const {
+                    return !operator==(rhs);
+                }
+
+            private:
+                friend AgedList;
+
+                const_iterator(const FullArrayType * array, uint32_t idx) :
+                    array_(array), idx_(idx)
+                {}
+
+                const FullArrayType * array_ = nullptr;
+                uint32_t idx_ = 0;
+            };
+
+            typedef const_iterator iterator;
+
+            explicit AgedList(const FullArrayType * array) : array_(array) { }
+
+            const_iterator begin() const {
+                return const_iterator(array_, array_->youngest_index_);
+            }
+
+            const_iterator end() const {
+                return const_iterator(array_, array_->invalid_entry_);
+            }
+
+            //! \return The number of valid indexes
+            uint32_t size() const {
+                return array_->num_valid_;
+            }
+
+            bool empty() const {
+                return (size() == 0);
+            }
+
+            //! \return The youngest index
+            uint32_t front() const {
+                sparta_assert(!empty());
+                return array_->youngest_index_;
+            }
+
+            //! \return The oldest index
+            uint32_t back() const {
+                sparta_assert(!empty());
+                return array_->oldest_index_;
+            }
+
+        private:
+            const FullArrayType * array_ = nullptr;
+        };
 
         /**
          * \brief An iterator struct for this array.
@@ -539,7 +623,7 @@ namespace sparta
          * \return true if valid.
          */
         bool isValid(const uint32_t idx) const {
-            return valid_index_set_.find(idx) != valid_index_set_.end();
+            return (idx < num_entries_) && valid_indexes_[idx];
         }
 
         /**
@@ -568,8 +652,8 @@ namespace sparta
          * \param nth Is the nth oldest entry you are looking for.
          * nth=0 is the oldest entry, nth = 1 is the second oldest, etc..
          * \return the index of the nth oldest entry.
-         * \warning this method may be expensive for larger nth values. Low values
-         * should be very quick.
+         * \warning this method walks the age order from the nearer end, so it
+         * may be expensive for nth values far from either end.
          *
          * \note This method is only accessible if the template parameter
          *       FullArrayType == AGED
@@ -586,17 +670,7 @@ namespace sparta
             constexpr bool is_circular = false;
             constexpr bool is_aged_walk = true;
 
-            // Since our data_list_ always adds new items to the
-            // front.  The oldest data is actually kept at the end of
-            // the list.  We can iterate from the end to find the nth
-            // oldest item.
-            auto it = aged_list_.rbegin();
-            uint32_t idx = invalid_entry_;
-            for(uint32_t i = 0; i <= nth; ++i)
-            {
-                idx = *it;
-                ++it;
-            }
+            const uint32_t idx = getNthOldestIndex_(nth);
             // Double check that we are returning the user a valid
             // index.  We have failed if it isn't.
             sparta_assert(isValid(idx));
@@ -608,7 +682,8 @@ namespace sparta
          * \param nth Is the nth youngest entry to be found. nth=0 is
          *            the youngest, nth=1 is the second youngest, etc.
          * \return the index of the nth youngest index.
-         * \warning this method may get expensive for larger nth values.
+         * \warning this method walks the age order from the nearer end, so it
+         * may be expensive for nth values far from either end.
          *
          * \note This method is only accessible if the template parameter
          *       FullArrayType == AGED.
@@ -624,14 +699,7 @@ namespace sparta
             constexpr bool is_circular = false;
             constexpr bool is_aged_walk = true;
 
-            // Define idx, and set it to a value surely beyond the bounds of our array.
-            uint32_t idx = invalid_entry_;
-            auto it = aged_list_.begin();
-            for(uint32_t i = 0; i <= nth; ++i)
-            {
-                idx = *it;
-                ++it;
-            }
+            const uint32_t idx = getNthOldestIndex_(num_valid_ - 1 - nth);
             // Make sure we found something valid.
             sparta_assert(isValid(idx));
             return const_iterator(this, idx, is_aged, is_circular, is_aged_walk);
@@ -641,14 +709,23 @@ namespace sparta
          * \brief Sets the input argument to the index containing the
          *  location of the next oldest item after input argument.
          *  If the input argument is the youngest index, we return false.
+         *  If it is not a valid index, it is set to the oldest index.
          */
         bool getNextOldestIndex(uint32_t & prev_idx) const {
-            auto it = std::find(aged_list_.begin(), aged_list_.end(), prev_idx);
-            if(it == aged_list_.begin()) {
+            sparta_assert(ArrayT == ArrayType::AGED,
+                          "Only AgedArray types have public member function getNextOldestIndex");
+            if(!isValid(prev_idx)) {
+                if(num_valid_ == 0) {
+                    return false;
+                }
+                prev_idx = oldest_index_;
+                return true;
+            }
+            const uint32_t younger = age_links_[prev_idx].younger;
+            if(younger == invalid_entry_) {
                 return false;
             }
-            --it;
-            prev_idx = *it;
+            prev_idx = younger;
             return true;
         }
 
@@ -660,6 +737,9 @@ namespace sparta
             sparta_assert(ArrayT == ArrayType::AGED,
                           "Only AgedArray types provides age information");
             sparta_assert(isValid(idx));
+            if(relative_ages_stale_) {
+                updateRelativeAge_();
+            }
             return array_[idx].age_rel_id;
         }
 
@@ -727,10 +807,8 @@ namespace sparta
 
             if constexpr (ArrayT == ArrayType::AGED)
             {
-                // Remove the index from our aged list.
-                aged_list_.erase(array_[idx].list_pointer);
-                // Update the relative age IDs
-                updateRelativeAge_();
+                // Remove the index from the age order.
+                unlinkAge_(idx);
             }
 
             // Update occupancy counter.
@@ -739,7 +817,7 @@ namespace sparta
                 utilization_->setValue(num_valid_);
             }
             array_[idx].~ArrayPosition();
-            valid_index_set_.erase(idx);
+            valid_indexes_[idx] = false;
         }
 
         /**
@@ -747,11 +825,16 @@ namespace sparta
          */
         void clear()
         {
-            std::for_each(valid_index_set_.begin(), valid_index_set_.end(), [this](const auto index){
-                array_[index].~ArrayPosition();
-            });
-            valid_index_set_.clear();
-            aged_list_.clear();
+            for(uint32_t idx = 0; idx < num_entries_; ++idx)
+            {
+                if(valid_indexes_[idx]) {
+                    array_[idx].~ArrayPosition();
+                    valid_indexes_[idx] = false;
+                }
+            }
+            oldest_index_ = invalid_entry_;
+            youngest_index_ = invalid_entry_;
+            relative_ages_stale_ = false;
             num_valid_ = 0;
             if(utilization_)
             {
@@ -902,28 +985,81 @@ namespace sparta
         /**
          * \brief Update the relative age information for each entry. This is useful
          * for the users to know the age of an entry. Age information has to be
-         * updated for all entries at once. But only needs to be updated when any
-         * entry is deallocated.
+         * updated for all entries at once, but only when an entry other than
+         * the youngest has been deallocated, so it is done on demand by getAge.
          */
-        void updateRelativeAge_()
+        void updateRelativeAge_() const
         {
             sparta_assert(ArrayT == ArrayType::AGED);
 
-            // Since our data_list_ always adds new items to the
-            // front.  The oldest data is actually kept at the end of
-            // the list.  We can iterate from the end to find the nth
-            // oldest item.
-            auto it = aged_list_.rbegin();
-            uint32_t idx = invalid_entry_;
-            const uint32_t size = aged_list_.size();
-            for(uint32_t i = 0; i < size; ++i)
+            uint32_t idx = oldest_index_;
+            for(uint32_t i = 0; i < num_valid_; ++i)
             {
-                idx = *it;
-                ++it;
                 // Double check that it's a valid index.
                 sparta_assert(isValid(idx));
                 // Upate the relaive age ID
                 array_[idx].age_rel_id = i;
+                idx = age_links_[idx].younger;
+            }
+            relative_ages_stale_ = false;
+        }
+
+        /**
+         * \brief Find the nth oldest valid index by walking the age
+         * links from whichever end of the age order is closer.
+         */
+        uint32_t getNthOldestIndex_(uint32_t nth) const
+        {
+            uint32_t idx;
+            if(nth <= num_valid_ / 2) {
+                idx = oldest_index_;
+                for(; nth > 0; --nth) {
+                    idx = age_links_[idx].younger;
+                }
+            }
+            else {
+                idx = youngest_index_;
+                for(uint32_t i = num_valid_ - 1 - nth; i > 0; --i) {
+                    idx = age_links_[idx].older;
+                }
+            }
+            return idx;
+        }
+
+        //! Make a newly written index the youngest in the age order
+        void linkYoungest_(const uint32_t idx)
+        {
+            age_links_[idx] = {youngest_index_, invalid_entry_};
+            if(youngest_index_ != invalid_entry_) {
+                age_links_[youngest_index_].younger = idx;
+            }
+            else {
+                oldest_index_ = idx;
+            }
+            youngest_index_ = idx;
+
+            if(!relative_ages_stale_) {
+                array_[idx].age_rel_id = num_valid_ - 1;
+            }
+        }
+
+        //! Remove an index from the age order
+        void unlinkAge_(const uint32_t idx)
+        {
+            const AgeLink_ & link = age_links_[idx];
+            if(link.older != invalid_entry_) {
+                age_links_[link.older].younger = link.younger;
+            }
+            else {
+                oldest_index_ = link.younger;
+            }
+            if(link.younger != invalid_entry_) {
+                age_links_[link.younger].older = link.older;
+                // Everything younger than idx just got a little older
+                relative_ages_stale_ = true;
+            }
+            else {
+                youngest_index_ = link.older;
             }
         }
 
@@ -938,14 +1074,14 @@ namespace sparta
             {
                 --num_valid_;
                 if constexpr (ArrayT == ArrayType::AGED) {
-                    aged_list_.erase(array_[idx].list_pointer);
+                    unlinkAge_(idx);
                 }
             }
 
             // Since we are not timed. Write the data and validate it,
             // then do pipeline collection.
             new (array_.get() + idx) ArrayPosition(std::forward<U>(dat));
-            valid_index_set_.insert(idx);
+            valid_indexes_[idx] = true;
 
             // Timestamp the entry in the array, for fast age comparison between two indexes.
             array_[idx].age_abs_id = next_age_abs_id_;
@@ -958,12 +1094,9 @@ namespace sparta
             // Maintain our age order if we are an aged array.
             if constexpr (ArrayT == ArrayType::AGED)
             {
-                // To maintain aged items, add the index to the front
-                // of a list.
-                aged_list_.push_front(idx);
-                array_[idx].list_pointer = aged_list_.begin();
-                // Update the relative age IDs
-                updateRelativeAge_();
+                // To maintain aged items, link the index in as the
+                // youngest.
+                linkYoungest_(idx);
             }
 
             // Update occupancy counter.
@@ -992,11 +1125,26 @@ namespace sparta
         // invalid data.
         std::unique_ptr<ArrayPosition[], DeleteToFree_> array_ = nullptr;
 
-        // Set to hold valid indexes at a time
-        std::unordered_set<uint32_t> valid_index_set_ {};
+        // Which indexes are valid
+        std::vector<bool> valid_indexes_;
+
+        // The age order is a doubly linked list threaded through a
+        // flat vector indexed like the array, so writing and erasing
+        // entries never allocates.
+        struct AgeLink_ {
+            uint32_t older;
+            uint32_t younger;
+        };
+        std::vector<AgeLink_> age_links_;
+        uint32_t oldest_index_{invalid_entry_};
+        uint32_t youngest_index_{invalid_entry_};
+
+        // Set when an erase leaves the age_rel_id of some entries out
+        // of date.  They are recomputed when next asked for.
+        mutable bool relative_ages_stale_ = false;
 
         // The aged list.
-        AgedList aged_list_;
+        AgedList aged_list_{this};
         AgedArrayCollectorProxy aged_array_col_{this};
 
         // A counter used to assign a unique age id to every newly
@@ -1033,6 +1181,10 @@ namespace sparta
         // Set up some vector's of a default size
         // to work as the underlying implementation structures of our array.
         array_.reset(static_cast<ArrayPosition *>(malloc(sizeof(ArrayPosition) * num_entries_)));
+        valid_indexes_.resize(num_entries_, false);
+        if constexpr (ArrayT == ArrayType::AGED) {
+            age_links_.resize(num_entries_);
+        }
 
         if((num_entries > 0) && statset)
         {
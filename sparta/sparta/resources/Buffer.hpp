@@ -153,7 +153,7 @@ namespace sparta
              */
             uint32_t getIndex_() const {
                 if(buffer_entry_ == nullptr) {
-                    return attached_buffer_->capacity();
+                    return attached_buffer_->endIndex_();
                 }
                 return buffer_entry_->physical_idx;
             }
@@ -268,14 +268,7 @@ namespace sparta
             BufferIterator & operator++() {
                 sparta_assert(attached_buffer_, "The iterator is not attached to a buffer. Was it initialized?");
                 if(isValid()) {
-                    uint32_t idx = buffer_entry_->physical_idx;
-                    ++idx;
-                    if(attached_buffer_->isValid(idx)) {
-                        buffer_entry_ = attached_buffer_->buffer_map_[idx];
-                    }
-                    else {
-                        buffer_entry_ = nullptr;
-                    }
+                    buffer_entry_ = attached_buffer_->nextEntry_(buffer_entry_->physical_idx);
                 } else {
                     sparta_assert(attached_buffer_->numFree() > 0, "Incrementing the iterator to entry that is not valid");
                 }
@@ -294,18 +287,12 @@ namespace sparta
             {
                 sparta_assert(attached_buffer_, "The iterator is not attached to a buffer. Was it initialized?");
                 if(isValid()) {
-                    uint32_t idx = buffer_entry_->physical_idx;
-                    --idx;
-                    if(attached_buffer_->isValid(idx)) {
-                        buffer_entry_ = attached_buffer_->buffer_map_[idx];
-                    }
-                    else {
-                        sparta_assert(idx < attached_buffer_->capacity(), "Decrementing the iterator results in buffer underrun");
-                        buffer_entry_ = nullptr;
-                    }
+                    DataPointerType prev = attached_buffer_->prevEntry_(buffer_entry_->physical_idx);
+                    sparta_assert(prev != nullptr, "Decrementing the iterator results in buffer underrun");
+                    buffer_entry_ = prev;
                 }
                 else if (attached_buffer_->size()) {
-                    buffer_entry_ = attached_buffer_->buffer_map_[attached_buffer_->size()-1];
+                    buffer_entry_ = attached_buffer_->lastEntry_();
                 }
                 return *this;
             }
@@ -420,7 +407,7 @@ namespace sparta
          */
         const value_type & read(uint32_t idx) const {
             sparta_assert(isValid(idx));
-            return *(buffer_map_[idx]->data);
+            return *(buffer_map_[slotOf_(idx)]->data);
         }
 
         /**
@@ -429,6 +416,9 @@ namespace sparta
          */
         const value_type & read(const const_iterator & entry) const
         {
+            if(SPARTA_EXPECT_FALSE(gap_tolerant_)) {
+                return *(entrySlot_(entry)->data);
+            }
             return read(entry.getIndex_());
         }
 
@@ -438,7 +428,7 @@ namespace sparta
          */
         const value_type & read(const const_reverse_iterator & entry) const
         {
-            return read(entry.base().getIndex_());
+            return read(entry.base());
         }
 
         /**
@@ -449,7 +439,7 @@ namespace sparta
          */
         value_type & access(uint32_t idx) {
             sparta_assert(isValid(idx));
-            return *(buffer_map_[idx]->data);
+            return *(buffer_map_[slotOf_(idx)]->data);
         }
 
         /**
@@ -457,6 +447,9 @@ namespace sparta
          * \param entry the BufferIterator to read from.
          */
         value_type & access(const const_iterator & entry) {
+            if(SPARTA_EXPECT_FALSE(gap_tolerant_)) {
+                return *(entrySlot_(entry)->data);
+            }
             return access(entry.getIndex_());
         }
 
@@ -465,7 +458,7 @@ namespace sparta
          * \param entry the BufferIterator to read from.
          */
         value_type & access(const const_reverse_iterator & entry) {
-            return access(entry.base().getIndex_());
+            return access(entry.base());
         }
 
         /**
@@ -475,7 +468,7 @@ namespace sparta
          */
         value_type & accessBack() {
             sparta_assert(isValid(num_valid_ - 1));
-            return *(buffer_map_[num_valid_ - 1]->data);
+            return *(lastEntry_()->data);
         }
 
         /**
@@ -581,25 +574,25 @@ namespace sparta
         //! Do an insert before a BufferIterator see insert method above
         iterator insert(const const_iterator & entry, const value_type& dat)
         {
-            return insert(entry.getIndex_(), dat);
+            return insert(logicalIndex_(entry), dat);
         }
 
         //! Do an insert before a BufferIterator see insert method above
         iterator insert(const const_iterator & entry, value_type&& dat)
         {
-            return insert(entry.getIndex_(), std::move(dat));
+            return insert(logicalIndex_(entry), std::move(dat));
         }
 
         //! Do an insert before a BufferIterator see insert method above
         iterator insert(const const_reverse_iterator & entry, const value_type& dat)
         {
-            return insert(entry.base().getIndex_(), dat);
+            return insert(logicalIndex_(entry.base()), dat);
         }
 
         //! Do an insert before a BufferIterator see insert method above
         iterator insert(const const_reverse_iterator & entry, value_type&& dat)
         {
-            return insert(entry.base().getIndex_(), std::move(dat));
+            return insert(logicalIndex_(entry.base()), std::move(dat));
         }
 
         /**
@@ -621,6 +614,11 @@ namespace sparta
             // Make sure we are invalidating an already valid object.
             sparta_assert(idx < size(), "Cannot erase an index that is not already valid");
 
+            if(SPARTA_EXPECT_FALSE(gap_tolerant_)) {
+                eraseSlot_(slotOf_(idx));
+                return;
+            }
+
             // Do the invalidation immediately
             // 1. Move the free space pointer to the erased position.
             // 2. Call the DataT's destructor
@@ -643,18 +641,12 @@ namespace sparta
                 sparta_assert(i + 1 < num_entries_);
                 buffer_map_[i] = buffer_map_[i + 1];
                 buffer_map_[i]->physical_idx = i;
-
-                // Shift the indexes in the address map.
-                address_map_[i] = address_map_[i + 1];
                 ++i;
             }
 
             // the entry at the old num_valid_ in the map now points to nullptr
             buffer_map_[top_idx_of_buffer] = nullptr;
 
-            // Remove this entry of the address map as it becomes a free position.
-            address_map_.erase(top_idx_of_buffer);
-
             // update counts.
             --num_valid_;
             updateUtilizationCounters_();
@@ -667,6 +659,10 @@ namespace sparta
         void erase(const const_iterator& entry)
         {
             sparta_assert(entry.attached_buffer_ == this, "Cannot erase an entry created by another Buffer");
+            if(SPARTA_EXPECT_FALSE(gap_tolerant_)) {
+                eraseSlot_(entrySlot_(entry)->physical_idx);
+                return;
+            }
             // erase the index in the actual buffer.
             erase(entry.getIndex_());
         }
@@ -677,9 +673,7 @@ namespace sparta
          */
         void erase(const const_reverse_iterator& entry)
         {
-            sparta_assert(entry.base().attached_buffer_ == this, "Cannot erase an entry created by another Buffer");
-            // erase the index in the actual buffer.
-            erase(entry.base().getIndex_());
+            erase(entry.base());
         }
 
         /**
@@ -704,7 +698,9 @@ namespace sparta
             free_position_ = &data_pool_[0];
             first_position_ = &data_pool_[0];
             validator_->clear();
-            address_map_.clear();
+            first_slot_ = 0;
+            end_slot_ = 0;
+            std::fill(occupied_.begin(), occupied_.end(), 0);
             updateUtilizationCounters_();
         }
 
@@ -738,8 +734,8 @@ namespace sparta
          */
         iterator begin(){
             if(size()) {
-                sparta_assert(buffer_map_[0]);
-                return iterator(this, buffer_map_[0]);
+                sparta_assert(buffer_map_[first_slot_]);
+                return iterator(this, buffer_map_[first_slot_]);
             }
             return end();
         }
@@ -756,7 +752,7 @@ namespace sparta
          */
         const_iterator begin() const {
             if(size()) {
-                return const_iterator(this, buffer_map_[0]);
+                return const_iterator(this, buffer_map_[first_slot_]);
             }
             return end();
         }
@@ -806,6 +802,44 @@ namespace sparta
             resize_delta_ = resize_delta;
         }
 
+        /**
+         * \brief Makes erase constant time by leaving holes where
+         *  entries were erased and compacting the Buffer lazily.
+         *
+         *  Entries are kept in an array of twice the Buffer's capacity.
+         *  Erasing the first or last entry just moves the bounds of
+         *  the occupied slots and erasing one in the middle leaves a
+         *  hole, so entries are never shifted on erase.  The entries
+         *  are compacted when push_back runs out of slots at the end
+         *  of the array (at most once every capacity() appends) and
+         *  on insert.  read(idx) and access(idx) skip holes using a
+         *  bitmap of occupied slots.
+         *
+         *  Suited to ROB-like Buffers which append at the back and
+         *  erase mostly from the front or back.  Iteration order,
+         *  indexing and BufferIterator validity are as before, though
+         *  the physical index of an entry is no longer its logical
+         *  index.
+         */
+        void makeGapTolerant() {
+            if(gap_tolerant_) {
+                return;
+            }
+            gap_tolerant_ = true;
+            buffer_map_.resize(2 * num_entries_, nullptr);
+            occupied_.assign((buffer_map_.size() + 63) / 64, 0);
+            first_slot_ = 0;
+            end_slot_ = num_valid_;
+            for(uint32_t i = 0; i < num_valid_; ++i) {
+                setOccupied_(i);
+            }
+        }
+
+        //! Was makeGapTolerant called?
+        bool isGapTolerant() const {
+            return gap_tolerant_;
+        }
+
     private:
 
         typedef std::vector<DataPointer>  DataPool;
@@ -862,6 +896,157 @@ namespace sparta
             }
         }
 
+        //! The index of an end iterator, past any slot
+        uint32_t endIndex_() const {
+            return gap_tolerant_ ? static_cast<uint32_t>(buffer_map_.size()) : capacity();
+        }
+
+        //! The entry after the one in the given slot, or nullptr at the end
+        DataPointer * nextEntry_(uint32_t slot) const {
+            if(SPARTA_EXPECT_FALSE(gap_tolerant_)) {
+                slot = nextSlot_(slot);
+                return (slot < end_slot_) ? buffer_map_[slot] : nullptr;
+            }
+            return isValid(slot + 1) ? buffer_map_[slot + 1] : nullptr;
+        }
+
+        //! The entry before the one in the given slot, or nullptr at the beginning
+        DataPointer * prevEntry_(uint32_t slot) const {
+            if(slot <= first_slot_) {
+                return nullptr;
+            }
+            return buffer_map_[gap_tolerant_ ? prevSlot_(slot) : slot - 1];
+        }
+
+        //! The last entry. The Buffer must not be empty
+        DataPointer * lastEntry_() const {
+            return buffer_map_[(gap_tolerant_ ? end_slot_ : num_valid_) - 1];
+        }
+
+        //! The slot holding the entry at the given logical index
+        uint32_t slotOf_(uint32_t idx) const {
+            if(SPARTA_EXPECT_FALSE(gap_tolerant_)) {
+                if(end_slot_ - first_slot_ == num_valid_) {
+                    return first_slot_ + idx;
+                }
+                return selectSlot_(idx);
+            }
+            return idx;
+        }
+
+        //! The logical index of an iterator's entry. Compacts a gap tolerant Buffer
+        uint32_t logicalIndex_(const const_iterator & entry) {
+            if(SPARTA_EXPECT_FALSE(gap_tolerant_)) {
+                compact_();
+            }
+            return entry.getIndex_();
+        }
+
+        //! The entry of a valid iterator in a gap tolerant Buffer
+        const DataPointer * entrySlot_(const const_iterator & entry) const {
+            sparta_assert(entry.isValid(), "Buffer '" << getName() << "': iterator is not valid");
+            return entry.buffer_entry_;
+        }
+
+        void setOccupied_(uint32_t slot) {
+            occupied_[slot >> 6] |= (uint64_t(1) << (slot & 63));
+        }
+
+        //! The first occupied slot after the given one, or end_slot_
+        uint32_t nextSlot_(uint32_t slot) const {
+            ++slot;
+            if(slot >= end_slot_) {
+                return end_slot_;
+            }
+            // end_slot_ - 1 is occupied, so this stops before it
+            uint32_t word = slot >> 6;
+            uint64_t bits = occupied_[word] & (~uint64_t(0) << (slot & 63));
+            while(bits == 0) {
+                bits = occupied_[++word];
+            }
+            return (word << 6) + __builtin_ctzll(bits);
+        }
+
+        //! The last occupied slot before the given one, which must be after first_slot_
+        uint32_t prevSlot_(uint32_t slot) const {
+            --slot;
+            // first_slot_ is occupied, so this stops at it
+            uint32_t word = slot >> 6;
+            uint64_t bits = occupied_[word] & (~uint64_t(0) >> (63 - (slot & 63)));
+            while(bits == 0) {
+                bits = occupied_[--word];
+            }
+            return (word << 6) + 63 - __builtin_clzll(bits);
+        }
+
+        //! The slot of the idx'th occupied slot
+        uint32_t selectSlot_(uint32_t idx) const {
+            // Slots before first_slot_ are clear, so count from its word
+            uint32_t word = first_slot_ >> 6;
+            while(true) {
+                uint64_t bits = occupied_[word];
+                const uint32_t count = __builtin_popcountll(bits);
+                if(idx < count) {
+                    for(; idx > 0; --idx) {
+                        bits &= bits - 1;
+                    }
+                    return (word << 6) + __builtin_ctzll(bits);
+                }
+                idx -= count;
+                ++word;
+            }
+        }
+
+        //! Erase the entry in the given slot of a gap tolerant Buffer
+        void eraseSlot_(uint32_t slot)
+        {
+            DataPointer * erased = buffer_map_[slot];
+            sparta_assert(erased != nullptr);
+            erased->data->~value_type();
+            erased->next_free = free_position_;
+            free_position_ = erased;
+            validator_->detachDataPointer(erased);
+
+            buffer_map_[slot] = nullptr;
+            occupied_[slot >> 6] &= ~(uint64_t(1) << (slot & 63));
+            --num_valid_;
+            if(num_valid_ == 0) {
+                first_slot_ = 0;
+                end_slot_ = 0;
+            }
+            else if(slot == first_slot_) {
+                first_slot_ = nextSlot_(slot);
+            }
+            else if(slot + 1 == end_slot_) {
+                end_slot_ = prevSlot_(slot) + 1;
+            }
+            updateUtilizationCounters_();
+        }
+
+        //! Move the entries of a gap tolerant Buffer to the first slots, in order
+        void compact_()
+        {
+            if(first_slot_ == 0 && end_slot_ == num_valid_) {
+                return;
+            }
+            uint32_t dst = 0;
+            for(uint32_t slot = first_slot_; slot < end_slot_; ++slot) {
+                DataPointer * dp = buffer_map_[slot];
+                if(dp) {
+                    buffer_map_[slot] = nullptr;
+                    buffer_map_[dst] = dp;
+                    dp->physical_idx = dst;
+                    ++dst;
+                }
+            }
+            first_slot_ = 0;
+            end_slot_ = num_valid_;
+            std::fill(occupied_.begin(), occupied_.end(), 0);
+            for(uint32_t i = 0; i < num_valid_; ++i) {
+                setOccupied_(i);
+            }
+        }
+
         /**
          * \brief Resize the buffer_map_ and data_pool_.
          *  This method is used to resize and repopulate
@@ -878,11 +1063,28 @@ namespace sparta
                 return;
             }
 
-            // Resize the buffer_map_ with the amount provided by user.
-            buffer_map_.resize(buffer_map_.capacity() + resize_delta_);
+            // Remember where each entry is in the data_pool_ so they can
+            // be relinked once it moves
+            if(gap_tolerant_) {
+                compact_();
+            }
+            std::vector<uint32_t> pool_indexes(num_valid_);
+            for(uint32_t i = 0; i < num_valid_; ++i) {
+                pool_indexes[i] = static_cast<uint32_t>(buffer_map_[i] - &data_pool_[0]);
+            }
 
-            // The number of entries the buffer can hold is its capacity.
-            num_entries_ = buffer_map_.capacity();
+            if(gap_tolerant_) {
+                num_entries_ += resize_delta_;
+                buffer_map_.resize(2 * num_entries_, nullptr);
+                occupied_.resize((buffer_map_.size() + 63) / 64, 0);
+            }
+            else {
+                // Resize the buffer_map_ with the amount provided by user.
+                buffer_map_.resize(buffer_map_.capacity() + resize_delta_);
+
+                // The number of entries the buffer can hold is its capacity.
+                num_entries_ = buffer_map_.capacity();
+            }
 
             // Resize the data_pool_ to twice the capacity of the buffer_map_.
             data_pool_.resize(num_entries_ * 2);
@@ -909,7 +1111,8 @@ namespace sparta
 
             // Make all the pointers in buffer_map_ point to the appropriate indexes.
             for(uint32_t i = 0; i < num_valid_; ++i) {
-                buffer_map_[i] = &data_pool_[address_map_[i]];
+                buffer_map_[i] = &data_pool_[pool_indexes[i]];
+                buffer_map_[i]->physical_idx = i;
             }
 
             // Resize the validator vector and relink the validator data pool.
@@ -926,21 +1129,26 @@ namespace sparta
             }
             sparta_assert(numFree(), "Buffer exhausted");
             sparta_assert(free_position_ != nullptr);
+
+            uint32_t slot = num_valid_;
+            if(SPARTA_EXPECT_FALSE(gap_tolerant_)) {
+                if(end_slot_ == buffer_map_.size()) {
+                    compact_();
+                }
+                slot = end_slot_++;
+                setOccupied_(slot);
+            }
+
             free_position_->allocate(std::forward<U>(dat));
-            free_position_->physical_idx = num_valid_;
+            free_position_->physical_idx = slot;
 
             // Create the entry to be returned.
             iterator entry(this, free_position_);
 
             // Do the append now.  We can do this with different logic
             // that does not require a process.
-            buffer_map_[num_valid_] = free_position_;
+            buffer_map_[slot] = free_position_;
 
-            // Store the index in the data_pool_ to which current
-            // free_position_ points to. We need to relink all these
-            // pointers once the data_pool_ resizes.
-            address_map_[num_valid_] =
-                static_cast<uint32_t>(free_position_ - &data_pool_[0]);
             //Mark this data pointer as valid
             validator_->attachDataPointer(free_position_);
             ++num_valid_;
@@ -961,6 +1169,12 @@ namespace sparta
             sparta_assert(idx <= num_valid_, "Buffer '" << getName()
                           << "': Cannot insert before a non valid index");
             sparta_assert(free_position_ != nullptr);
+            if(SPARTA_EXPECT_FALSE(gap_tolerant_)) {
+                // Entries are shifted up to make room, so close the holes first
+                compact_();
+                setOccupied_(num_valid_);
+                ++end_slot_;
+            }
             free_position_->allocate(std::forward<U>(dat));
             free_position_->physical_idx = idx;
 
@@ -977,19 +1191,10 @@ namespace sparta
                 //assert that we are not going to do an invalid read.
                 buffer_map_[i] = buffer_map_[i - 1];
                 buffer_map_[i]->physical_idx = i ;
-
-                // Shift the indexes in the map.
-                address_map_[i] = address_map_[i - 1];
                 --i;
             }
 
             buffer_map_[idx] = free_position_;
-
-            // Store the index in the data_pool_ to which current
-            // free_position_ points to. We need to relink all these
-            // pointers once the data_pool_ resizes.
-            address_map_[num_valid_] =
-                static_cast<uint32_t>(free_position_ - &data_pool_[0]);
             ++num_valid_;
             free_position_ = free_position_->next_free;
             updateUtilizationCounters_();
@@ -1024,8 +1229,17 @@ namespace sparta
         //  The additional amount of entries the vector must allocate when resizing.
         sparta::utils::ValidValue<uint32_t> resize_delta_;
 
-        //! A map which holds indexes from buffer_map_ to indexes in data_pool_.
-        std::unordered_map<uint32_t, uint32_t> address_map_;
+        //! Flag which tells various methods if erase leaves holes in buffer_map_
+        bool gap_tolerant_ {false};
+
+        //! First slot of buffer_map_ holding an entry. Always 0 unless gap tolerant
+        size_type first_slot_ = 0;
+
+        //! One past the last slot of buffer_map_ holding an entry, when gap tolerant
+        size_type end_slot_ = 0;
+
+        //! Bitmap of the slots of buffer_map_ holding an entry, when gap tolerant
+        std::vector<uint64_t> occupied_;
     };
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -1081,13 +1295,18 @@ namespace sparta
         collector_(std::move(rval.collector_)),
         is_infinite_mode_(rval.is_infinite_mode_),
         resize_delta_(std::move(rval.resize_delta_)),
-        address_map_(std::move(rval.address_map_)){
+        gap_tolerant_(rval.gap_tolerant_),
+        first_slot_(rval.first_slot_),
+        end_slot_(rval.end_slot_),
+        occupied_(std::move(rval.occupied_)){
         rval.clk_ = nullptr;
         rval.num_entries_ = 0;
         rval.data_pool_size_ = 0;
         rval.free_position_ = nullptr;
         rval.first_position_ = nullptr;
         rval.num_valid_ = 0;
+        rval.first_slot_ = 0;
+        rval.end_slot_ = 0;
         rval.utilization_ = nullptr;
         rval.collector_ = nullptr;
         validator_->validator_ = std::move(rval.validator_->validator_);
@@ -9,8 +9,10 @@
 #pragma once
 
 #include <list>
+#include <set>
 #include <algorithm>
 #include <functional>
+#include <iterator>
 
 #include "sparta/utils/SpartaAssert.hpp"
 #include "sparta/utils/FastList.hpp"
@@ -18,6 +20,14 @@
 namespace sparta
 {
 
+    /**
+     * \brief The container backing a PriorityQueue
+     */
+    enum class PriorityQueueBackend {
+        LIST, //!< Sorted list: O(n) insert, O(1) pop
+        TREE  //!< Balanced tree (std::multiset): O(log n) insert, O(1) pop
+    };
+
     /**
      * \class PriorityQueue
      * \brief A data structure that allows pushing/emplacing into it
@@ -25,6 +35,7 @@ namespace sparta
      * \tparam DataT The data to be contained and sorted
      * \tparam SortingAlgorithmT The sorting algorithm to use
      * \tparam bounded_cnt The max number of elements in this PriorityQueue
+     * \tparam backend The container backing the queue
      *
      * The PriorityQueue can be used by picking algorithms in a model
      * where more than one entry of a block is ready (for whatever
@@ -49,31 +60,116 @@ namespace sparta
      * bounded_cnt. This also improves the performance of the
      * PriorityQueue (uses sparta::utils::FastList).
      *
+     * By default the queue is a sorted list, so insertion scans the
+     * list for the insertion point.  For queues holding more than a
+     * few dozen entries, PriorityQueueBackend::TREE keeps the entries
+     * in a balanced tree instead, making insertion O(log n).  The API
+     * is the same, with these differences:
+     *
+     *  - Entries cannot be modified through iterators
+     *  - Entries pushed with forceFront stay ahead of all inserted
+     *    entries until they are popped or removed
+     *  - remove() expects entries which compare equal to also be
+     *    ordered the same by the sorting algorithm
+     *  - The sorting algorithm must not change the order of entries
+     *    already in the queue
      */
     template <class DataT,
               class SortingAlgorithmT = std::less<DataT>,
-              size_t bounded_cnt=0>
+              size_t bounded_cnt=0,
+              PriorityQueueBackend backend = PriorityQueueBackend::LIST>
     class PriorityQueue
     {
     private:
-        using PQueueType =
+        static constexpr bool is_tree_ = (backend == PriorityQueueBackend::TREE);
+
+        /**
+         * \brief An entry in the tree. Forced entries are ordered before
+         *        the rest, the most recently forced first.
+         */
+        struct TreeEntry_
+        {
+            DataT data;
+            uint64_t force_seq; //!< 0 if not forced
+        };
+
+        struct TreeCompare_
+        {
+            bool operator()(const TreeEntry_ & a, const TreeEntry_ & b) const {
+                if(SPARTA_EXPECT_FALSE(a.force_seq != 0 || b.force_seq != 0)) {
+                    return a.force_seq > b.force_seq;
+                }
+                return sort_alg(a.data, b.data);
+            }
+            SortingAlgorithmT sort_alg;
+        };
+
+        using TreeType = std::multiset<TreeEntry_, TreeCompare_>;
+
+        /**
+         * \brief Iterates over the data in the tree
+         */
+        class TreeIterator_
+        {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type        = DataT;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const DataT *;
+            using reference         = const DataT &;
+
+            TreeIterator_() = default;
+            explicit TreeIterator_(typename TreeType::const_iterator it) : it_(it) {}
+
+            reference operator*()  const { return it_->data; }
+            pointer   operator->() const { return &it_->data; }
+
+            TreeIterator_ & operator++() { ++it_; return *this; }
+            TreeIterator_   operator++(int) { TreeIterator_ tmp(*this); ++it_; return tmp; }
+            TreeIterator_ & operator--() { --it_; return *this; }
+            TreeIterator_   operator--(int) { TreeIterator_ tmp(*this); --it_; return tmp; }
+
+            bool operator==(const TreeIterator_ & rhs) const { return it_ == rhs.it_; }
+            bool operator!=(const TreeIterator_ & rhs) const { return it_ != rhs.it_; }
+
+            //! The underlying tree iterator
+            typename TreeType::const_iterator base() const { return it_; }
+
+        private:
+            typename TreeType::const_iterator it_;
+        };
+
+        using ListType =
             typename std::conditional<bounded_cnt == 0,
                                       std::list<DataT>,
                                       utils::FastList<DataT>>::type;
 
+        using PQueueType =
+            typename std::conditional<is_tree_, TreeType, ListType>::type;
+
+        static PQueueType makeQueue_(const SortingAlgorithmT & sort_alg) {
+            if constexpr (is_tree_) {
+                return PQueueType(TreeCompare_{sort_alg});
+            } else {
+                return PQueueType(bounded_cnt);
+            }
+        }
+
     public:
 
         // For collection
         using size_type      = size_t;
-        using iterator       = typename PQueueType::iterator;
-        using const_iterator = typename PQueueType::const_iterator;
+        using iterator       = typename std::conditional<is_tree_, TreeIterator_,
+                                                         typename ListType::iterator>::type;
+        using const_iterator = typename std::conditional<is_tree_, TreeIterator_,
+                                                         typename ListType::const_iterator>::type;
 
         /**
          * \brief Create a priority queue with a default instance of the
          *        sorting algorithm
          */
         PriorityQueue() :
-            priority_items_(bounded_cnt)
+            priority_items_(makeQueue_(SortingAlgorithmT()))
         {}
 
         /**
@@ -82,7 +178,7 @@ namespace sparta
          * \param sort_alg Reference to the sorting algorithm instance
          */
         PriorityQueue(const SortingAlgorithmT & sort_alg) :
-            priority_items_(bounded_cnt),
+            priority_items_(makeQueue_(sort_alg)),
             sort_alg_(sort_alg)
         {}
 
@@ -93,15 +189,22 @@ namespace sparta
          */
         void insert(const DataT & data)
         {
-            const auto eit = priority_items_.end();
-            for(auto it = priority_items_.begin(); it != eit; ++it)
-            {
-                if(sort_alg_(data, *it)) {
-                    priority_items_.insert(it, data);
-                    return;
+            if constexpr (is_tree_) {
+                checkBound_();
+                // Equal entries are inserted after the existing ones, as
+                // with the list
+                priority_items_.insert(TreeEntry_{data, 0});
+            } else {
+                const auto eit = priority_items_.end();
+                for(auto it = priority_items_.begin(); it != eit; ++it)
+                {
+                    if(sort_alg_(data, *it)) {
+                        priority_items_.insert(it, data);
+                        return;
+                    }
                 }
+                priority_items_.emplace_back(data);
             }
-            priority_items_.emplace_back(data);
         }
 
         //! Get the number of items in the queue
@@ -117,19 +220,31 @@ namespace sparta
         //! Get the first element in the queue
         const DataT & top() const {
             sparta_assert(false == empty(), "Grabbing top from an empty queue");
-            return priority_items_.front();
+            if constexpr (is_tree_) {
+                return priority_items_.begin()->data;
+            } else {
+                return priority_items_.front();
+            }
         }
 
         //! Get the last element (lowest priority) in the queue
         const DataT & back() const {
             sparta_assert(false == empty(), "Grabbing back from an empty queue");
-            return priority_items_.back();
+            if constexpr (is_tree_) {
+                return priority_items_.rbegin()->data;
+            } else {
+                return priority_items_.back();
+            }
         }
 
         //! Pop the front of the queue (highest priority)
         void pop() {
             sparta_assert(false == empty(), "Popping on an empty priority queue");
-            priority_items_.pop_front();
+            if constexpr (is_tree_) {
+                priority_items_.erase(priority_items_.begin());
+            } else {
+                priority_items_.pop_front();
+            }
         }
 
         //! Clear the entire queue
@@ -139,12 +254,28 @@ namespace sparta
 
         //! Remove the item from the queue
         void remove(const DataT & data) {
-            priority_items_.remove(data);
+            if constexpr (is_tree_) {
+                // Forced entries are at the front, out of sorted order
+                auto it = priority_items_.begin();
+                while(it != priority_items_.end() && it->force_seq != 0) {
+                    it = (it->data == data) ? priority_items_.erase(it) : std::next(it);
+                }
+                auto range = priority_items_.equal_range(TreeEntry_{data, 0});
+                for(it = range.first; it != range.second;) {
+                    it = (it->data == data) ? priority_items_.erase(it) : std::next(it);
+                }
+            } else {
+                priority_items_.remove(data);
+            }
         }
 
         //! Erase the item from the queue (const_iterator/iterator)
         void erase(const const_iterator & it) {
-            priority_items_.erase(it);
+            if constexpr (is_tree_) {
+                priority_items_.erase(it.base());
+            } else {
+                priority_items_.erase(it);
+            }
         }
 
         /**
@@ -159,30 +290,46 @@ namespace sparta
          * _must be handled_ immediately.
          */
         void forceFront(const DataT & data) {
-            priority_items_.emplace_front(data);
+            if constexpr (is_tree_) {
+                checkBound_();
+                priority_items_.insert(TreeEntry_{data, ++force_seq_});
+            } else {
+                priority_items_.emplace_front(data);
+            }
         }
 
         /*! \defgroup iteration Iteration Support */
         /**@{*/
         //! Iterator to beginning of the queue -- highest priority
-        iterator        begin()       { return priority_items_.begin(); }
+        iterator        begin()       { return iterator(priority_items_.begin()); }
 
         //! Const Iterator to beginning of the queue -- highest priority
-        const_iterator  begin() const { return priority_items_.begin(); }
+        const_iterator  begin() const { return const_iterator(priority_items_.begin()); }
 
         //! Iterator to end of the queue -- end priority
-        iterator        end()       { return priority_items_.end(); }
+        iterator        end()       { return iterator(priority_items_.end()); }
 
         //! Const Iterator to end of the queue -- end priority
-        const_iterator  end() const { return priority_items_.end(); }
+        const_iterator  end() const { return const_iterator(priority_items_.end()); }
         /**@}*/
 
     private:
 
+        //! Bounded trees are checked on insertion; FastList checks itself
+        void checkBound_() const {
+            if constexpr (bounded_cnt != 0) {
+                sparta_assert(priority_items_.size() < bounded_cnt,
+                              "PriorityQueue is full (" << bounded_cnt << " entries)");
+            }
+        }
+
         //! The internal queue
         PQueueType        priority_items_;
 
         //! Copy of the sorting algorithm
         SortingAlgorithmT sort_alg_;
+
+        //! Sequence number of the last entry forced to the front of a tree
+        uint64_t force_seq_ = 0;
     };
 }
@@ -9,14 +9,16 @@
 
 #include <vector>
 #include <cinttypes>
+#include <functional>
+#include <limits>
 #include <string>
 #include <map>
-#include <list>
 
 #include "sparta/simulation/ParameterSet.hpp"
 #include "sparta/simulation/Unit.hpp"
 #include "sparta/simulation/TreeNode.hpp"
 #include "sparta/events/PayloadEvent.hpp"
+#include "sparta/utils/WideBitMask.hpp"
 
 namespace sparta
 {
@@ -48,7 +50,7 @@ namespace sparta
         static constexpr uint32_t INVALID_LATENCY = static_cast<uint32_t>(-1);
         static constexpr uint32_t MAX_REGISTERS   = 512;
 
-        using RegisterBitMask = std::bitset<MAX_REGISTERS>;
+        using RegisterBitMask = utils::WideBitMask<MAX_REGISTERS>;
 
         //! \brief Name of this resource. Required by sparta::ResourceFactory
         static const char name[];
@@ -156,10 +158,15 @@ namespace sparta
         using UnitIDToSBVs = std::vector<std::vector<ScoreboardView *>>;
         UnitIDToSBVs unit_id_to_scoreboard_views_;
 
-        // Producer UnitID to consumer ScoreboardViews
-        using ConsumerSBV = std::tuple<ScoreboardView *, ForwardingLatency>;
-        using ConsumerSBVs = std::vector<ConsumerSBV>;
-        using ProducerToConsumerSBVs = std::vector<ConsumerSBVs>;
+        // Producer UnitID to consumer ScoreboardViews, grouped by
+        // forwarding latency so one event can update every view in a
+        // group
+        struct ConsumerSBVs {
+            ForwardingLatency              latency;
+            std::vector<ScoreboardView *> views;
+        };
+        using ConsumerSBVGroups = std::vector<ConsumerSBVs>;
+        using ProducerToConsumerSBVs = std::vector<ConsumerSBVGroups>;
         ProducerToConsumerSBVs producer_to_consumer_scoreboard_views_;
 
         // Unit ID count
@@ -171,12 +178,12 @@ namespace sparta
             UnitID    producer;
         };
 
-        // PayloadEvent used to deliver the Scoreboard contents to the views
+        // PayloadEvent used to deliver the Scoreboard contents to a
+        // group of views of the producer with the same latency
         struct ScoreboardViewUpdate
         {
-            ScoreboardUpdate first;
-            ScoreboardView *second;
-            bool is_canceled;
+            ScoreboardUpdate update;
+            uint32_t         consumer_group;
         };
         sparta::PayloadEvent<ScoreboardViewUpdate, sparta::SchedulingPhase::Update> scoreboard_view_updates_;
         void deliverScoreboardUpdate_(const ScoreboardViewUpdate &);
@@ -196,6 +203,33 @@ namespace sparta
         //! Typedef for the callbacks
         using ReadinessCallback = std::function<void(const Scoreboard::RegisterBitMask&)>;
 
+        /**
+         * \brief Identifies a registered ready callback so that it can
+         *        be cleared without searching for it
+         */
+        class CallbackHandle
+        {
+        public:
+            CallbackHandle() = default;
+
+            //! \return true if this handle was returned by registerReadyCallback
+            bool isValid() const {
+                return index_ != INVALID_INDEX;
+            }
+
+        private:
+            friend ScoreboardView;
+
+            static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+            CallbackHandle(uint32_t index, uint32_t generation) :
+                index_(index), generation_(generation)
+            {}
+
+            uint32_t index_ = INVALID_INDEX;
+            uint32_t generation_ = 0;
+        };
+
         /**
          * \brief Create a ScoreboardView
          *
@@ -219,21 +253,38 @@ namespace sparta
          *
          * After a scoreboard update and the new bits are a match for
          * the registered bits, the callback will be called and
-         * cleared from the Scoreboard.
+         * cleared from the Scoreboard.  Callbacks made ready by the
+         * same update are called in the order they were registered.
+         *
+         * \return A handle that can be given to clearCallback
          */
-        void registerReadyCallback(const Scoreboard::RegisterBitMask & bits,
-                                   const Scoreboard::InstID inst_id,
-                                   const ReadinessCallback & callback);
+        CallbackHandle registerReadyCallback(const Scoreboard::RegisterBitMask & bits,
+                                             const Scoreboard::InstID inst_id,
+                                             const ReadinessCallback & callback);
 
         /**
          * \brief On a flush any registered callback needs to be "forgotten"
          *
          * \param unique_id The unique ID to find and flush
          *
-         * Clears ready callbacks
+         * Clears ready callbacks.  This looks at every registered
+         * callback; prefer clearCallback if the handle is at hand.
          */
         void clearCallbacks(const Scoreboard::InstID inst_id);
 
+        /**
+         * \brief Forget a single registered callback
+         *
+         * \param handle The handle returned when it was registered
+         * \return true if the callback was still waiting
+         */
+        bool clearCallback(const CallbackHandle & handle);
+
+        //! \return The number of callbacks waiting for their bits
+        uint32_t getNumReadyCallbacks() const {
+            return num_waiters_;
+        }
+
         /**
          * \brief See if the given bits are set
          * \param bits Bits to check
@@ -241,7 +292,7 @@ namespace sparta
          */
         bool isSet(const Scoreboard::RegisterBitMask & bits) const
         {
-            return bits == (local_ready_mask_ & bits);
+            return local_ready_mask_.containsAll(bits);
         }
 
         /**
@@ -288,26 +339,58 @@ namespace sparta
         //! Pointer to the master scoreboard
         Scoreboard * master_scoreboard_ = nullptr;
 
-        struct CallbackData
+        // A registered callback.  Rather than testing every waiter
+        // against the ready mask on each update, each register keeps
+        // a list of the waiters needing it, and each waiter counts the
+        // registers it still needs.  An update only touches the
+        // waiters of the registers it changes.
+        struct Waiter
         {
-            CallbackData(const Scoreboard::RegisterBitMask & bv,
-                         const Scoreboard::InstID iid,
-                         const ReadinessCallback & cb,
-                         sparta::Clock::Cycle cyc) :
-                needed_bits(bv), inst_id(iid), callback(cb), registered_time(cyc)
-
-            {}
-
-            CallbackData(CallbackData&&) = default;
+            ReadinessCallback    callback;
+            Scoreboard::InstID   inst_id = 0;
+            sparta::Clock::Cycle registered_time = 0;
+            uint64_t             sequence = 0;   // Registration order
+            uint32_t             remaining = 0;  // Needed registers not ready
+            uint32_t             generation = 0; // Bumped when the slot is freed
+            bool                 in_use = false;
+        };
 
-            const Scoreboard::RegisterBitMask needed_bits;
-            const Scoreboard::InstID          inst_id;
-            ReadinessCallback                 callback;
-            sparta::Clock::Cycle              registered_time;
+        // A reference to a waiter, stale once the waiter's generation moves on
+        struct WaiterRef
+        {
+            uint32_t index;
+            uint32_t generation;
         };
 
-        using ReadinessCallbacks = std::list<CallbackData>;
-        ReadinessCallbacks ready_callbacks_;
+        bool isCurrent_(const WaiterRef & ref) const {
+            return waiters_[ref.index].generation == ref.generation;
+        }
+
+        template<class FuncT>
+        void forEachWaiter_(uint32_t reg, FuncT && func);
+        void pruneWaiters_(std::vector<WaiterRef> & refs);
+        void releaseWaiter_(uint32_t index);
+        void callReadyWaiters_(std::vector<WaiterRef> & ready,
+                               const Scoreboard::RegisterBitMask & bits);
+        void takeReadyAtRegistration_(std::vector<WaiterRef> & ready);
+
+        // Waiters are pooled; freed slots are reused
+        std::vector<Waiter>   waiters_;
+        std::vector<uint32_t> free_waiters_;
+        uint32_t              num_waiters_ = 0;
+        uint64_t              next_sequence_ = 0;
+
+        // Per register, the waiters that need it.  Stale references
+        // are dropped as the lists are walked.
+        std::vector<std::vector<WaiterRef>> register_waiters_;
+
+        // Waiters whose registers were all ready when they were
+        // registered; they are called on the next update, or on the
+        // current one if a callback registered them
+        std::vector<WaiterRef> ready_at_registration_;
+
+        // Scratch list of waiters made ready by an update
+        std::vector<WaiterRef> ready_scratch_;
 
         const sparta::Clock * clock_;
         const Scoreboard::UnitID unit_id_;
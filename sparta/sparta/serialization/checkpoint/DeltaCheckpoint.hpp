@@ -5,6 +5,8 @@
 #include <iostream>
 #include <sstream>
 #include <stack>
+#include <vector>
+#include <zlib.h>
 
 #include "sparta/simulation/TreeNode.hpp"
 #include "sparta/functional/ArchData.hpp"
@@ -20,14 +22,371 @@ namespace sparta::serialization::checkpoint
 {
     namespace storage
     {
+        /*!
+         * \brief zlib-compressed storage implementation
+         *
+         * Lines are encoded as they are written and the encoding is compressed
+         * as one zlib stream, which endCheckpoint finishes. Runs of
+         * zero-filled lines and runs of lines identical to the last line
+         * stored before them are stored as run-length markers instead of line
+         * data. Loading decompresses the stream as lines are read, so the
+         * data is never held uncompressed all at once.
+         *
+         * Encoding, with each field in host byte order:
+         * \li 'L' idx size data: one line
+         * \li 'Z' idx size count: count zero-filled lines at idx, idx+1, ...
+         * \li 'R' idx size count: count lines at idx, idx+1, ... each equal
+         * to the last 'L' line of this ArchData
+         * \li 'E': end of this ArchData
+         */
+        class CompressedStorage
+        {
+        public:
+
+            //! zlib compression level. Checkpoints are taken in the middle of
+            //! simulation, so favor speed
+            static constexpr int COMPRESSION_LEVEL = Z_BEST_SPEED;
+
+            CompressedStorage() = default;
+
+            CompressedStorage(const CompressedStorage&) = delete;
+            CompressedStorage& operator=(const CompressedStorage&) = delete;
+
+            ~CompressedStorage() {
+                endStream_();
+            }
+
+            void dump(std::ostream& o) const {
+                o << "\nCompressed data: " << std::dec << getCompressedSize() << " bytes holding "
+                  << getUncompressedSize() << " bytes of lines";
+            }
+
+            uint32_t getSize() const {
+                return sizeof(decltype(*this)) + compressed_.size();
+            }
+
+            //! Bytes of line data stored, as if not compressed
+            uint64_t getUncompressedSize() const {
+                return line_bytes_;
+            }
+
+            //! Bytes of compressed data
+            uint64_t getCompressedSize() const {
+                return compressed_.size();
+            }
+
+            void prepareForLoad() {
+                sparta_assert(finished_,
+                              "Cannot load checkpoint data from a CompressedStorage before endCheckpoint");
+                beginStream_(false);
+                strm_->next_in = reinterpret_cast<Bytef*>(compressed_.data());
+                strm_->avail_in = compressed_.size();
+                read_bytes_ = 0;
+                run_count_ = 0;
+                past_end_ = false;
+            }
+
+            void beginLine(ArchData::line_idx_type idx) {
+                sparta_assert(idx != ArchData::INVALID_LINE_IDX,
+                              "Cannot begin line with INVALID_LINE_IDX index");
+                next_idx_ = idx;
+            }
+
+            void writeLineBytes(const char* data, size_t size) {
+                sparta_assert(!finished_,
+                              "Cannot write lines to a CompressedStorage after endCheckpoint");
+                sparta_assert(next_idx_ != ArchData::INVALID_LINE_IDX,
+                              "Cannot write line bytes with INVALID_LINE_IDX index");
+                line_bytes_ += size;
+
+                // memcmp against itself shifted by one byte checks all bytes
+                const bool zero = (data[0] == 0) && (::memcmp(data, data + 1, size - 1) == 0);
+                const bool repeat = !zero && (last_line_ != nullptr) && (size == last_line_size_)
+                    && (::memcmp(data, last_line_, size) == 0);
+
+                if(run_count_ > 0){
+                    if(next_idx_ == run_idx_ + run_count_ && size == run_size_
+                       && (run_kind_ == 'Z' ? zero : repeat)){
+                        ++run_count_;
+                        next_idx_ = ArchData::INVALID_LINE_IDX;
+                        return;
+                    }
+                    writeRun_();
+                }
+
+                if(zero || repeat){
+                    run_kind_ = zero ? 'Z' : 'R';
+                    run_idx_ = next_idx_;
+                    run_size_ = size;
+                    run_count_ = 1;
+                }else{
+                    put_('L');
+                    put_(next_idx_);
+                    put_(static_cast<uint32_t>(size));
+                    pending_.insert(pending_.end(), data, data + size);
+                    last_line_ = data; // Unchanged until this checkpoint is stored
+                    last_line_size_ = size;
+                    flushIfFull_();
+                }
+                next_idx_ = ArchData::INVALID_LINE_IDX;
+            }
+
+            /*!
+             * \brief Signals end of this checkpoint's data for one ArchData
+             */
+            void endArchData() {
+                if(run_count_ > 0){
+                    writeRun_();
+                }
+                put_('E');
+                last_line_ = nullptr;
+                flushIfFull_();
+            }
+
+            /*!
+             * \brief Signals the end of all data in this checkpoint. Finishes
+             * the compressed stream
+             */
+            void endCheckpoint() {
+                sparta_assert(!finished_,
+                              "endCheckpoint called twice on a CompressedStorage");
+                raw_size_ = raw_written_ + pending_.size();
+                deflate_(Z_FINISH);
+                endStream_();
+                compressed_.resize(compressed_used_);
+                compressed_.shrink_to_fit();
+                std::vector<char>().swap(pending_);
+                finished_ = true;
+            }
+
+            /*!
+             * \brief Is the reading state of this storage good? (i.e. haven't tried
+             * to read past the end of the data)
+             */
+            bool good() const {
+                return !past_end_;
+            }
+
+            /*!
+             * \brief Restore next line. Return ArchData::INVALID_LINE_IDX on
+             * end of data.
+             */
+            ArchData::line_idx_type getNextRestoreLine() {
+                if(run_count_ > 0){
+                    --run_count_;
+                    cur_kind_ = run_kind_;
+                    cur_size_ = run_size_;
+                    return run_idx_++;
+                }
+                if(read_bytes_ == raw_size_){
+                    past_end_ = true;
+                    throw SpartaException("Failed to restore a checkpoint because ")
+                        << "caller tried to keep getting next line even after "
+                        "reaching the end of the restore data";
+                }
+
+                char ctrl;
+                get_(ctrl);
+                if(ctrl == 'E'){
+                    return ArchData::INVALID_LINE_IDX; // Done with this ArchData
+                }
+                ArchData::line_idx_type idx;
+                get_(idx);
+                get_(cur_size_);
+                cur_kind_ = ctrl;
+                if(ctrl == 'L'){
+                    return idx;
+                }
+                if(ctrl != 'Z' && ctrl != 'R'){
+                    throw SpartaException("Failed to restore a checkpoint because a '")
+                        << ctrl << "' control character was found where an 'L', 'Z', 'R', or 'E' was expected";
+                }
+                get_(run_count_);
+                sparta_assert(run_count_ > 0, "Found empty run of lines in compressed checkpoint data");
+                run_kind_ = ctrl;
+                run_size_ = cur_size_;
+                run_idx_ = idx + 1;
+                --run_count_;
+                return idx;
+            }
+
+            /*!
+             * \brief Read bytes for the current line
+             */
+            void copyLineBytes(char* buf, uint32_t size) {
+                sparta_assert(size == cur_size_,
+                              "Attempted to restore checkpoint data for a line where the "
+                              "data was " << cur_size_ << " bytes but the loader requested "
+                              << size << " bytes. The sizes must match up or something is "
+                              "wrong");
+                switch(cur_kind_){
+                    case 'L':
+                        read_(buf, size);
+                        last_line_copy_.assign(buf, buf + size);
+                        break;
+                    case 'Z':
+                        ::memset(buf, 0, size);
+                        break;
+                    case 'R':
+                        sparta_assert(last_line_copy_.size() == size,
+                                      "Found repeated line in compressed checkpoint data without a line to repeat");
+                        ::memcpy(buf, last_line_copy_.data(), size);
+                        break;
+                    default:
+                        throw SpartaException("Attempted to copy line bytes without a current line");
+                }
+            }
+
+        private:
+
+            //! Uncompressed bytes to collect before compressing them
+            static constexpr size_t FLUSH_BYTES = 64 * 1024;
+
+            template <typename T>
+            void put_(const T& val) {
+                const char* bytes = reinterpret_cast<const char*>(&val);
+                pending_.insert(pending_.end(), bytes, bytes + sizeof(T));
+            }
+
+            template <typename T>
+            void get_(T& val) {
+                read_(reinterpret_cast<char*>(&val), sizeof(T));
+            }
+
+            void writeRun_() {
+                put_(run_kind_);
+                put_(run_idx_);
+                put_(run_size_);
+                put_(run_count_);
+                run_count_ = 0;
+            }
+
+            void flushIfFull_() {
+                if(pending_.size() >= FLUSH_BYTES){
+                    deflate_(Z_NO_FLUSH);
+                }
+            }
+
+            //! Starts a deflate (or inflate) stream, reusing the current one
+            void beginStream_(bool deflating) {
+                if(strm_ != nullptr){
+                    sparta_assert(deflating == deflating_);
+                    if(deflating){
+                        ::deflateReset(strm_.get());
+                    }else{
+                        ::inflateReset(strm_.get());
+                    }
+                    return;
+                }
+                strm_.reset(new z_stream());
+                deflating_ = deflating;
+                const int ret = deflating ? ::deflateInit(strm_.get(), COMPRESSION_LEVEL)
+                                          : ::inflateInit(strm_.get());
+                if(ret != Z_OK){
+                    strm_.reset();
+                    throw SpartaException("Failed to initialize zlib stream for checkpoint data: ") << ret;
+                }
+            }
+
+            //! Frees the zlib stream and its buffers
+            void endStream_() {
+                if(strm_ != nullptr){
+                    if(deflating_){
+                        ::deflateEnd(strm_.get());
+                    }else{
+                        ::inflateEnd(strm_.get());
+                    }
+                    strm_.reset();
+                }
+            }
+
+            //! Compresses the pending bytes onto compressed_
+            void deflate_(int flush) {
+                if(strm_ == nullptr){
+                    beginStream_(true);
+                }
+                strm_->next_in = reinterpret_cast<Bytef*>(pending_.data());
+                strm_->avail_in = pending_.size();
+                int ret;
+                do{
+                    if(compressed_.size() - compressed_used_ < FLUSH_BYTES / 4){
+                        compressed_.resize(compressed_used_ + FLUSH_BYTES / 2);
+                    }
+                    strm_->next_out = reinterpret_cast<Bytef*>(compressed_.data() + compressed_used_);
+                    strm_->avail_out = compressed_.size() - compressed_used_;
+                    ret = ::deflate(strm_.get(), flush);
+                    sparta_assert(ret != Z_STREAM_ERROR, "zlib failed to compress checkpoint data");
+                    compressed_used_ = compressed_.size() - strm_->avail_out;
+                }while(strm_->avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+                raw_written_ += pending_.size();
+                pending_.clear();
+            }
+
+            //! Decompresses the next size bytes of the stream into buf
+            void read_(char* buf, size_t size) {
+                sparta_assert(read_bytes_ + size <= raw_size_,
+                              "Attempted to read past the end of compressed checkpoint data");
+                strm_->next_out = reinterpret_cast<Bytef*>(buf);
+                strm_->avail_out = size;
+                while(strm_->avail_out > 0){
+                    const int ret = ::inflate(strm_.get(), Z_NO_FLUSH);
+                    if(ret != Z_OK && !(ret == Z_STREAM_END && strm_->avail_out == 0)){
+                        throw SpartaException("Failed to decompress checkpoint data: zlib error ") << ret;
+                    }
+                }
+                read_bytes_ += size;
+                if(read_bytes_ == raw_size_){
+                    endStream_(); // Don't hold the inflate buffers once loaded
+                }
+            }
+
+            std::vector<char> compressed_; //!< Compressed stream. Only [0, compressed_used_) is valid until finished
+            size_t compressed_used_ = 0;
+            std::vector<char> pending_;    //!< Encoded bytes not yet compressed
+            uint64_t raw_written_ = 0;     //!< Encoded bytes compressed so far
+            uint64_t raw_size_ = 0;        //!< Total encoded bytes, known once finished
+            uint64_t line_bytes_ = 0;      //!< Bytes of line data stored
+            bool finished_ = false;        //!< Has endCheckpoint been called
+
+            std::unique_ptr<z_stream> strm_; //!< Stream being written or read, if any
+            bool deflating_ = false;
+
+            // Writing
+            ArchData::line_idx_type next_idx_ = ArchData::INVALID_LINE_IDX;
+            const char* last_line_ = nullptr; //!< Last 'L' line of the current ArchData
+            size_t last_line_size_ = 0;
+
+            // Current run of lines (writing and reading)
+            char run_kind_ = 0;
+            ArchData::line_idx_type run_idx_ = 0;
+            uint32_t run_size_ = 0;
+            uint32_t run_count_ = 0;
+
+            // Reading
+            uint64_t read_bytes_ = 0;
+            bool past_end_ = false;
+            char cur_kind_ = 0;
+            uint32_t cur_size_ = 0;
+            std::vector<char> last_line_copy_; //!< Last 'L' line read
+        };
+
         /*!
          * \brief Vector of buffers storage implementation
+         *
+         * Buffers are never modified once stored, so they can be shared with
+         * ArchData lines (see ArchData::Line::share) in both directions:
+         * saving a line keeps a reference to its data and restoring a line
+         * hands it a reference to the stored data. The line copies the data
+         * only when it is next written.
+         *
+         * If constructed with compression, lines are instead stored through
+         * a CompressedStorage and are always copied.
          */
         class VectorStorage
         {
             class Segment{
                 ArchData::line_idx_type idx_;
-                std::unique_ptr<char []> data_;
+                std::shared_ptr<uint8_t []> data_;
                 uint32_t bytes_;
             public:
 
@@ -69,10 +428,20 @@ namespace sparta::serialization::checkpoint
                 {
                     sparta_assert(idx != ArchData::INVALID_LINE_IDX,
                                   "Attempted to create segment of " << bytes << " bytes with invalid line index");
-                    data_.reset(new char[bytes]);
+                    data_.reset(new uint8_t[bytes]);
                     ::memcpy(data_.get(), data, bytes);
                 }
 
+                /*!
+                 * \brief Shared data constructor. Refers to data without copying
+                 */
+                Segment(ArchData::line_idx_type idx, const std::shared_ptr<uint8_t[]>& data, size_t bytes) :
+                    idx_(idx), data_(data), bytes_(bytes)
+                {
+                    sparta_assert(idx != ArchData::INVALID_LINE_IDX,
+                                  "Attempted to create segment of " << bytes << " bytes with invalid line index");
+                }
+
                 ArchData::line_idx_type getLineIdx() const {
                     return idx_;
                 }
@@ -81,6 +450,15 @@ namespace sparta::serialization::checkpoint
                     return sizeof(decltype(*this)) + bytes_;
                 }
 
+                uint32_t getBytes() const {
+                    return bytes_;
+                }
+
+                template <typename StorageT>
+                void writeTo(StorageT& out) const {
+                    out.writeLineBytes(reinterpret_cast<const char*>(data_.get()), bytes_);
+                }
+
                 void copyTo(char* buf, uint32_t size) const {
                     sparta_assert(size == bytes_, \
                                   "Attempted to restore checkpoint data for a line where the "
@@ -90,6 +468,15 @@ namespace sparta::serialization::checkpoint
                     memcpy(buf, data_.get(), bytes_);
                 }
 
+                const std::shared_ptr<uint8_t[]>& getData(uint32_t size) const {
+                    sparta_assert(size == bytes_, \
+                                  "Attempted to restore checkpoint data for a line where the "
+                                  "data was " << bytes_ << " bytes but the loader requested "
+                                  << size << " bytes. The sizes must match up or something is "
+                                  "wrong");
+                    return data_;
+                }
+
                 void dump(std::ostream& o) const {
                     if(idx_ == ArchData::INVALID_LINE_IDX){
                         std::cout << "\nEnd of ArchData";
@@ -98,7 +485,7 @@ namespace sparta::serialization::checkpoint
 
                     std::cout << "\nLine: " << std::dec << idx_ << " (" << bytes_ << ") bytes";
                     for(uint32_t off = 0; off < bytes_;){
-                        char chr = data_[off];
+                        char chr = (char)data_[off];
                         if(off % 32 == 0){
                             o << std::endl << std::setw(7) << std::hex << off;
                         }
@@ -133,14 +520,31 @@ namespace sparta::serialization::checkpoint
              */
             decltype(data_)::const_iterator cur_restore_itr_;
 
+            /*!
+             * \brief Storage used instead of data_ if compressing
+             */
+            std::unique_ptr<CompressedStorage> compressed_;
+
         public:
-            VectorStorage() {
+            /*!
+             * \brief Constructor
+             * \param compress Compress lines (see CompressedStorage) instead of
+             * storing or sharing each line's buffer
+             */
+            explicit VectorStorage(bool compress=false) {
+                if(compress){
+                    compressed_.reset(new CompressedStorage);
+                }
             }
 
             ~VectorStorage() {
             }
 
             void dump(std::ostream& o) const {
+                if(compressed_){
+                    compressed_->dump(o);
+                    return;
+                }
                 for(auto const &seg : data_){
                     seg.dump(o);
                 }
@@ -148,13 +552,66 @@ namespace sparta::serialization::checkpoint
 
             uint32_t getSize() const {
                 uint32_t bytes = sizeof(decltype(*this));
+                if(compressed_){
+                    return bytes + compressed_->getSize();
+                }
                 for(Segment const & seg : data_){
                     bytes += seg.getSize();
                 }
                 return bytes;
             }
 
+            //! Bytes of line data stored, as if not compressed
+            uint64_t getUncompressedSize() const {
+                if(compressed_){
+                    return compressed_->getUncompressedSize();
+                }
+                uint64_t bytes = 0;
+                for(Segment const & seg : data_){
+                    bytes += seg.getBytes();
+                }
+                return bytes;
+            }
+
+            //! Bytes held for line data. Same as getUncompressedSize if not compressing
+            uint64_t getCompressedSize() const {
+                if(compressed_){
+                    return compressed_->getCompressedSize();
+                }
+                return getUncompressedSize();
+            }
+
+            //! Can lines share their data with this storage instead of copying it
+            bool canShareLines() const {
+                return compressed_ == nullptr;
+            }
+
+            /*!
+             * \brief Writes all stored lines to another storage, as
+             * ArchData::save wrote them to this one
+             * \pre Must not be compressing
+             *
+             * Does not change this storage, so it can be called from another
+             * thread while lines sharing data with this storage are written.
+             */
+            template <typename StorageT>
+            void writeTo(StorageT& out) const {
+                sparta_assert(canShareLines(), "Cannot copy lines out of a compressed VectorStorage");
+                for(Segment const & seg : data_){
+                    if(seg.getLineIdx() == ArchData::INVALID_LINE_IDX){
+                        out.endArchData();
+                    }else{
+                        out.beginLine(seg.getLineIdx());
+                        seg.writeTo(out);
+                    }
+                }
+            }
+
             void prepareForLoad() {
+                if(compressed_){
+                    compressed_->prepareForLoad();
+                    return;
+                }
                 next_restore_idx_ = 0;
                 cur_restore_itr_ = data_.begin();
             }
@@ -162,10 +619,32 @@ namespace sparta::serialization::checkpoint
             void beginLine(ArchData::line_idx_type idx) {
                 sparta_assert(idx != ArchData::INVALID_LINE_IDX,
                               "Cannot begin line with INVALID_LINE_IDX index");
+                if(compressed_){
+                    compressed_->beginLine(idx);
+                    return;
+                }
                 next_idx_ = idx;
             }
 
             void writeLineBytes(const char* data, size_t size) {
+                if(compressed_){
+                    compressed_->writeLineBytes(data, size);
+                    return;
+                }
+                sparta_assert(data_.size() == 0 || data_.back().getLineIdx() != next_idx_,
+                              "Cannot store the same line idx twice in a checkpoint. Line "
+                              << next_idx_ << " detected twice in a row");
+                sparta_assert(next_idx_ != ArchData::INVALID_LINE_IDX,
+                              "Cannot write line bytes with INVALID_LINE_IDX index");
+                data_.emplace_back(next_idx_, data, size);
+            }
+
+            /*!
+             * \brief Stores a line by keeping a reference to its data. The
+             * data must not be modified afterward
+             */
+            void shareLineBytes(const std::shared_ptr<uint8_t[]>& data, size_t size) {
+                sparta_assert(canShareLines(), "Cannot share lines with a compressed VectorStorage");
                 sparta_assert(data_.size() == 0 || data_.back().getLineIdx() != next_idx_,
                               "Cannot store the same line idx twice in a checkpoint. Line "
                               << next_idx_ << " detected twice in a row");
@@ -178,14 +657,30 @@ namespace sparta::serialization::checkpoint
              * \brief Signals end of this checkpoint's data for one ArchData
              */
             void endArchData() {
+                if(compressed_){
+                    compressed_->endArchData();
+                    return;
+                }
                 data_.emplace_back();
             }
 
+            /*!
+             * \brief Signals the end of all data in this checkpoint
+             */
+            void endCheckpoint() {
+                if(compressed_){
+                    compressed_->endCheckpoint();
+                }
+            }
+
             /*!
              * \brief Is the reading state of this storage good? (i.e. haven't tried
              * to read past the end of the data)
              */
             bool good() const {
+                if(compressed_){
+                    return compressed_->good();
+                }
                 return next_restore_idx_ <= data_.size(); // Not past end of stream
             }
 
@@ -194,6 +689,9 @@ namespace sparta::serialization::checkpoint
              * end of data.
              */
             ArchData::line_idx_type getNextRestoreLine() {
+                if(compressed_){
+                    return compressed_->getNextRestoreLine();
+                }
                 if(next_restore_idx_ == data_.size()){
                     next_restore_idx_++; // Increment to detect errors
                     return ArchData::INVALID_LINE_IDX; // Done with restore
@@ -215,6 +713,10 @@ namespace sparta::serialization::checkpoint
              * \brief Read bytes for the current line
              */
             void copyLineBytes(char* buf, uint32_t size) {
+                if(compressed_){
+                    compressed_->copyLineBytes(buf, size);
+                    return;
+                }
                 sparta_assert(cur_restore_itr_ != data_.end(),
                               "Attempted to copy line bytes from an invalid line iterator");
                 sparta_assert(cur_restore_itr_->getLineIdx() != ArchData::INVALID_LINE_IDX,
@@ -223,13 +725,17 @@ namespace sparta::serialization::checkpoint
             }
 
             /*!
-             * \brief Steal line buffer. Useful if the checkpoint is being reloaded
-             * AND simultaneouslty destroyed
-             * \todo implement this
+             * \brief Get a reference to the data of the current line instead
+             * of copying it. The data must not be modified
              */
-            //void stealLineBytes(char*& buf_ptr, uint32_t size) {
-            //    cur_restore_itr_->stealBuffer(buf_ptr, size);
-            //}
+            const std::shared_ptr<uint8_t[]>& getSharedLineBytes(uint32_t size) {
+                sparta_assert(canShareLines(), "Cannot share lines with a compressed VectorStorage");
+                sparta_assert(cur_restore_itr_ != data_.end(),
+                              "Attempted to share line bytes from an invalid line iterator");
+                sparta_assert(cur_restore_itr_->getLineIdx() != ArchData::INVALID_LINE_IDX,
+                              "About to return line from checkpoint data segment with INVALID_LINE_IDX index");
+                return cur_restore_itr_->getData(size);
+            }
         };
 
         /*!
@@ -308,6 +814,12 @@ namespace sparta::serialization::checkpoint
                               "Ostream error while writing checkpoint data");
             }
 
+            /*!
+             * \brief Signals the end of all data in this checkpoint
+             */
+            void endCheckpoint() {
+            }
+
             /*!
              * \brief Is the reading state of this storage good? (i.e. haven't tried
              * to read past the end of the data)
@@ -413,18 +925,23 @@ namespace sparta::serialization::checkpoint
          * this. If not ensured, a loaded checkpoint could produce incorrect
          * state
          *
+         * \param storage_args Arguments to construct the StorageT with
+         *
          * Snapshot checkpoint can be restored without walking any checkpoint
          * chains
          */
+        template <typename... StorageArgs>
         DeltaCheckpoint(TreeNode& root,
                         const std::vector<ArchData*>& dats,
                         chkpt_id_t id,
                         tick_t tick,
                         DeltaCheckpoint* prev_delta,
-                        bool is_snapshot) :
+                        bool is_snapshot,
+                        StorageArgs&&... storage_args) :
             Checkpoint(id, tick, prev_delta),
             deleted_id_(UNIDENTIFIED_CHECKPOINT),
-            is_snapshot_(is_snapshot)
+            is_snapshot_(is_snapshot),
+            data_(std::forward<StorageArgs>(storage_args)...)
         {
             (void) root;
             if(nullptr == prev_delta){
@@ -442,6 +959,7 @@ namespace sparta::serialization::checkpoint
             }else{
                 storeDelta_(dats);
             }
+            data_.endCheckpoint();
         }
 
         //! DeltaCheckpoints can only be constructed by the FastCheckpointer
@@ -540,6 +1058,21 @@ namespace sparta::serialization::checkpoint
             return data_.getSize();
         }
 
+        /*!
+         * \brief Returns bytes of line data in this checkpoint, as if not
+         * compressed
+         */
+        uint64_t getUncompressedSize() const noexcept {
+            return data_.getUncompressedSize();
+        }
+
+        /*!
+         * \brief Returns bytes held for the line data in this checkpoint
+         */
+        uint64_t getCompressedSize() const noexcept {
+            return data_.getCompressedSize();
+        }
+
         //! \name Checkpoint Actions
         //! @{
         ////////////////////////////////////////////////////////////////////////
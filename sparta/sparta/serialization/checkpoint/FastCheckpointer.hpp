@@ -59,7 +59,6 @@ namespace sparta::serialization::checkpoint
      * \todo Implement reverse delta storage for backward checkpoint loading
      * \todo Tune ArchData line size based on checkpointer performance
      * \todo More profiling
-     * \todo Compression
      * \todo Saving to disk using a templated checkpoint object storage class (allowing for non-binary)
      */
     class FastCheckpointer : public Checkpointer
@@ -140,6 +139,50 @@ namespace sparta::serialization::checkpoint
             snap_thresh_ = thresh;
         }
 
+        /*!
+         * \brief Compress the data of checkpoints created from now on.
+         *
+         * Compressed checkpoints take less memory but take longer to create
+         * and load, and memory lines are copied into them instead of being
+         * shared (see storage::VectorStorage). This is useful for long chains
+         * of checkpoints. Existing checkpoints are unaffected.
+         */
+        void setCompression(bool compress) noexcept {
+            compress_ = compress;
+        }
+
+        /*!
+         * \brief Are checkpoints created from now on compressed
+         * \see setCompression
+         */
+        bool isCompressionEnabled() const noexcept { return compress_; }
+
+        /*!
+         * \brief Gets the bytes of line data held in all checkpoints
+         * (including deleted checkpoints which are still needed), as if
+         * not compressed
+         */
+        uint64_t getUncompressedSize() const noexcept {
+            uint64_t bytes = 0;
+            for(auto& p : chkpts_){
+                bytes += static_cast<const checkpoint_type*>(p.second.get())->getUncompressedSize();
+            }
+            return bytes;
+        }
+
+        /*!
+         * \brief Gets the bytes held for line data in all checkpoints
+         * (including deleted checkpoints which are still needed). This equals
+         * getUncompressedSize if no checkpoints are compressed
+         */
+        uint64_t getCompressedSize() const noexcept {
+            uint64_t bytes = 0;
+            for(auto& p : chkpts_){
+                bytes += static_cast<const checkpoint_type*>(p.second.get())->getCompressedSize();
+            }
+            return bytes;
+        }
+
         ////////////////////////////////////////////////////////////////////////
         //! @}
 
@@ -446,8 +489,6 @@ namespace sparta::serialization::checkpoint
             // only) can the whole chain (including the leading shapshot) be
             // deleted.
 
-            //! \todo Support compression
-
             if(d == getHead()){
                 // Cannot delete head of checkpoint tree
                 return;
@@ -619,7 +660,7 @@ namespace sparta::serialization::checkpoint
                 throw exc;
             }
 
-            checkpoint_type* dcp = new checkpoint_type(getRoot(), getArchDatas(), next_chkpt_id_++, tick, nullptr, true);
+            checkpoint_type* dcp = new checkpoint_type(getRoot(), getArchDatas(), next_chkpt_id_++, tick, nullptr, true, compress_);
             chkpts_[dcp->getID()].reset(dcp);
             setHead_(dcp);
             num_alive_checkpoints_++;
@@ -679,7 +720,8 @@ namespace sparta::serialization::checkpoint
                                                        next_chkpt_id_++,
                                                        tick,
                                                        prev,
-                                                       force_snapshot || is_snapshot);
+                                                       force_snapshot || is_snapshot,
+                                                       compress_);
             chkpts_[dcp->getID()].reset(dcp);
             num_alive_checkpoints_++;
             num_alive_snapshots_ += (dcp->isSnapshot() == true);
@@ -702,6 +744,11 @@ namespace sparta::serialization::checkpoint
          */
         uint32_t snap_thresh_;
 
+        /*!
+         * \brief Compress new checkpoints
+         */
+        bool compress_ = false;
+
         /*!
          * \brief Next checkpoint ID value
          */
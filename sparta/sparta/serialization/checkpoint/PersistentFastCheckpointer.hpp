@@ -2,17 +2,26 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <stack>
 #include <queue>
 #include <string>
+#include <thread>
 
 #include "sparta/simulation/TreeNode.hpp"
 #include "sparta/functional/ArchData.hpp"
 #include "sparta/utils/SpartaException.hpp"
 #include "sparta/utils/SpartaAssert.hpp"
 #include "sparta/serialization/checkpoint/FastCheckpointer.hpp"
+#include "sparta/serialization/checkpoint/DeltaCheckpoint.hpp"
 
 namespace sparta::serialization::checkpoint
 {
@@ -23,11 +32,33 @@ namespace sparta::serialization::checkpoint
      * Used in conjunction with the fast checkpointer (which saves
      * checkpoints to memory), this class enables user the save the
      * checkpoints to disk for loading later.
+     *
+     * Checkpoints can also be saved asynchronously with saveAsync. The
+     * checkpoint is captured into memory on the calling thread and a
+     * background thread writes it to disk. Completed saves are reported
+     * through processAsyncSaves or finishAsyncSaves.
      */
     class PersistentFastCheckpointer : public FastCheckpointer
     {
     public:
 
+        /*!
+         * \brief Result of an asynchronous save
+         * \see saveAsync
+         */
+        struct AsyncSaveResult
+        {
+            FastCheckpointer::chkpt_id_t id; //!< Checkpoint saved
+            std::string filename;            //!< File written
+            std::exception_ptr error;        //!< Set if the file could not be written
+        };
+
+        //! Called on the simulation thread for each completed asynchronous save
+        typedef std::function<void (const AsyncSaveResult&)> AsyncSaveCallback;
+
+        //! Default number of asynchronous saves which can be in flight at once
+        static constexpr uint32_t DEFAULT_MAX_ASYNC_SAVES = 2;
+
         /*!
          * \brief file storage adpater for ArchData
          * \see DeltaCheckpoint
@@ -156,9 +187,18 @@ namespace sparta::serialization::checkpoint
         /*!
          * \brief Destructor
          *
+         * Finishes writing any asynchronous saves in flight, without
+         * reporting them
          */
         virtual ~PersistentFastCheckpointer() {
-
+            if(writer_.joinable()){
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    writer_should_exit_ = true;
+                }
+                writer_cv_.notify_one();
+                writer_.join();
+            }
         }
 
         /*! Save checkpoint to ostream.
@@ -197,16 +237,135 @@ namespace sparta::serialization::checkpoint
         FastCheckpointer::chkpt_id_t save() {
             const bool force_snapshot = true;
             FastCheckpointer::chkpt_id_t checkpoint_id = createCheckpoint(force_snapshot);
-            std::ostringstream chkpt_filename;
-            chkpt_filename << prefix_ << "."
-                           << checkpoint_id
-                           << "." << suffix_;
-            std::ofstream outf(chkpt_filename.str(), std::ofstream::binary | std::ofstream::trunc);
+            std::ofstream outf(getFilename_(checkpoint_id), std::ofstream::binary | std::ofstream::trunc);
             save_(outf);
             outf.close();
             return checkpoint_id;
         }
 
+        //! \name Asynchronous Saving
+        //! @{
+        ////////////////////////////////////////////////////////////////////////
+
+        /*! Save checkpoint to specified file in the background.
+         *
+         * Captures the checkpoint into memory and returns, leaving a
+         * background thread to write it to the file. Capturing shares
+         * line data with the ArchDatas where it can, so it costs little
+         * more than a snapshot; until the file is written, lines modified
+         * by the simulation are copied.
+         *
+         * If getMaxAsyncSaves saves are already being written, waits for
+         * one of them to finish first, so memory use stays bounded.
+         * Completed saves are reported through processAsyncSaves, which
+         * this calls.
+         *
+         * \param filename Filename to use for checkpoint
+         *
+         * \return The checkpoint ID
+         */
+        FastCheckpointer::chkpt_id_t saveAsync(const std::string& filename) {
+            waitForAsyncSaveSlot_();
+            FastCheckpointer::chkpt_id_t checkpoint_id = createCheckpoint(true);
+            queueAsyncSave_(checkpoint_id, filename);
+            return checkpoint_id;
+        }
+
+        /*! Save checkpoint to calculated filename in the background.
+         *
+         * \see save()
+         * \see saveAsync(const std::string&)
+         *
+         * \return The checkpoint ID
+         */
+        FastCheckpointer::chkpt_id_t saveAsync() {
+            waitForAsyncSaveSlot_();
+            FastCheckpointer::chkpt_id_t checkpoint_id = createCheckpoint(true);
+            queueAsyncSave_(checkpoint_id, getFilename_(checkpoint_id));
+            return checkpoint_id;
+        }
+
+        /*!
+         * \brief Sets the callback notified of each completed
+         * asynchronous save
+         *
+         * Without a callback, processAsyncSaves throws the error of any
+         * failed save.
+         */
+        void setAsyncSaveCallback(const AsyncSaveCallback& callback) {
+            async_save_callback_ = callback;
+        }
+
+        /*!
+         * \brief Sets the number of asynchronous saves which can be
+         * waiting to be written at once
+         * \pre max_saves > 0
+         */
+        void setMaxAsyncSaves(uint32_t max_saves) {
+            sparta_assert(max_saves > 0, "Must allow at least one asynchronous save");
+            std::lock_guard<std::mutex> lock(mutex_);
+            max_async_saves_ = max_saves;
+        }
+
+        //! Number of asynchronous saves which can be waiting to be written at once
+        uint32_t getMaxAsyncSaves() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return max_async_saves_;
+        }
+
+        //! Number of asynchronous saves not yet reported as complete
+        uint32_t getNumAsyncSaves() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return num_writing_ + written_.size();
+        }
+
+        /*!
+         * \brief Reports asynchronous saves which have finished writing
+         * \return Number of saves reported
+         * \throw The first error from a failed save if there is no
+         * callback (see setAsyncSaveCallback)
+         */
+        uint32_t processAsyncSaves() {
+            std::deque<std::unique_ptr<AsyncSave_>> done;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done.swap(written_);
+            }
+
+            std::exception_ptr error;
+            for(auto& save : done){
+                // Release the captured data on this thread, since it may
+                // share line data with the ArchDatas
+                const AsyncSaveResult result = std::move(save->result);
+                save.reset();
+                if(async_save_callback_){
+                    async_save_callback_(result);
+                }else if(result.error && !error){
+                    error = result.error;
+                }
+            }
+            if(error){
+                std::rethrow_exception(error);
+            }
+            return done.size();
+        }
+
+        /*!
+         * \brief Waits for all asynchronous saves to finish writing and
+         * reports them
+         * \see processAsyncSaves
+         */
+        void finishAsyncSaves() {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                producer_cv_.wait(lock, [this] { return num_writing_ == 0; });
+            }
+            processAsyncSaves();
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        //! @}
+
         /*! Restore checkpoint from istream.
          *
          * \param in Input stream from which to retrieve checkpoint data
@@ -231,6 +390,26 @@ namespace sparta::serialization::checkpoint
 
     private:
 
+        /*!
+         * \brief A checkpoint captured in memory, waiting to be written
+         */
+        struct AsyncSave_
+        {
+            AsyncSaveResult result;
+            storage::VectorStorage data;
+        };
+
+        /*! Calculates the filename for a checkpoint from the prefix and
+         * suffix
+         */
+        std::string getFilename_(FastCheckpointer::chkpt_id_t checkpoint_id) const {
+            std::ostringstream chkpt_filename;
+            chkpt_filename << prefix_ << "."
+                           << checkpoint_id
+                           << "." << suffix_;
+            return chkpt_filename.str();
+        }
+
         /*! Common save routine.
          *
          * \param outf Output stream to save to
@@ -246,9 +425,102 @@ namespace sparta::serialization::checkpoint
             }
         }
 
+        //! Waits until another asynchronous save can be queued
+        void waitForAsyncSaveSlot_() {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                producer_cv_.wait(lock, [this] { return num_writing_ < max_async_saves_; });
+            }
+            processAsyncSaves();
+        }
+
+        //! Captures the current state into memory and queues it for the writer
+        void queueAsyncSave_(FastCheckpointer::chkpt_id_t checkpoint_id,
+                             const std::string& filename) {
+            std::unique_ptr<AsyncSave_> save(new AsyncSave_);
+            save->result.id = checkpoint_id;
+            save->result.filename = filename;
+            auto adatas = getArchDatas();
+            for (auto aditr=adatas.begin(); aditr!= adatas.end(); aditr++) {
+                (*aditr)->saveAll(save->data);
+            }
+            save->data.endCheckpoint();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if(!writer_.joinable()){
+                    writer_ = std::thread(&PersistentFastCheckpointer::writerLoop_, this);
+                }
+                queued_.push_back(std::move(save));
+                ++num_writing_;
+            }
+            writer_cv_.notify_one();
+        }
+
+        //! Background thread writing queued saves to disk in order
+        void writerLoop_() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while(true){
+                writer_cv_.wait(lock, [this] { return !queued_.empty() || writer_should_exit_; });
+                if(queued_.empty()){
+                    return;
+                }
+                std::unique_ptr<AsyncSave_> save = std::move(queued_.front());
+                queued_.pop_front();
+                lock.unlock();
+
+                try{
+                    std::ofstream outf(save->result.filename, std::ofstream::binary | std::ofstream::trunc);
+                    // Throw on write failure, including failing to open
+                    outf.exceptions(std::ostream::eofbit | std::ostream::badbit |
+                                    std::ostream::failbit | std::ostream::goodbit);
+                    FileWriteAdapter fsa(outf);
+                    save->data.writeTo(fsa);
+                    outf.close();
+                }catch(...){
+                    save->result.error = std::current_exception();
+                }
+
+                lock.lock();
+                written_.push_back(std::move(save));
+                --num_writing_;
+                producer_cv_.notify_all();
+            }
+        }
+
         std::string prefix_;
         std::string suffix_;
 
+        //! Callback for completed asynchronous saves
+        AsyncSaveCallback async_save_callback_;
+
+        //! Guards the asynchronous save queues and counts
+        mutable std::mutex mutex_;
+
+        //! Signals the writer that a save is queued or it should exit
+        std::condition_variable writer_cv_;
+
+        //! Signals the simulation thread that a save finished writing
+        std::condition_variable producer_cv_;
+
+        //! Saves waiting for the writer
+        std::deque<std::unique_ptr<AsyncSave_>> queued_;
+
+        //! Saves written but not yet reported
+        std::deque<std::unique_ptr<AsyncSave_>> written_;
+
+        //! Saves queued or being written
+        uint32_t num_writing_ = 0;
+
+        //! Maximum number of saves queued or being written
+        uint32_t max_async_saves_ = DEFAULT_MAX_ASYNC_SAVES;
+
+        //! Tells the writer to exit once the queue is empty
+        bool writer_should_exit_ = false;
+
+        //! Writes queued saves to disk. Started by the first saveAsync
+        std::thread writer_;
+
     };
 
 } // namespace sparta::serialization::checkpoint
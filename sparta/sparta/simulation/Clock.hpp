@@ -147,6 +147,7 @@ namespace sparta
             sparta_assert(!isFinalized(),
                               "Should not be setting period on a sparta::Clock after device tree finalization");
             period_ = uint32_t(root_ratio_ * norm);
+            period_divider_.setDivisor(period_);
         }
 
         /*!
@@ -165,7 +166,7 @@ namespace sparta
          */
         Cycle getCycle(const Scheduler::Tick& tick) const
         {
-            return (tick / period_);
+            return period_divider_.divide(tick);
         }
 
         /**
@@ -187,23 +188,16 @@ namespace sparta
             return scheduler_->getCurrentTick();
         }
 
-        /**
-         * \brief Update the elapsed_cycles internal value given the
-         * number of ticks
-         * \param elapsed_ticks The number of ticks elapsed
-         */
-        void updateElapsedCycles(const Scheduler::Tick elapsed_ticks)
-        {
-            elapsed_cycles_ = getCycle(elapsed_ticks);
-        }
-
         /**
          * \brief Return the total elapsed cycles from this Clocks POV
          * \return The elapsed cycles
+         *
+         * Derived from the Scheduler's elapsed ticks when called; the
+         * Scheduler does not update its clocks as time advances.
          */
         Cycle elapsedCycles() const
         {
-            return elapsed_cycles_;
+            return getCycle(scheduler_->getElapsedTicks());
         }
 
         /**
@@ -246,7 +240,7 @@ namespace sparta
          */
         bool isPosedge() const
         {
-            return ((scheduler_->getCurrentTick() % period_) == 0);
+            return (period_divider_.remainder(scheduler_->getCurrentTick()) == 0);
         }
 
         //! Used for printing the clock information
@@ -333,9 +327,9 @@ namespace sparta
         utils::Rational<uint32_t> parent_ratio_  = 1;   //!< For debugging
         utils::Rational<uint32_t> root_ratio_    = 1;
         Period                    period_        = 1;
+        utils::InvariantDivider   period_divider_;      //!< Tick to cycle conversion
         StatisticSet              sset_ = {this};
         const double              frequency_mhz_ = 0.0;
-        Cycle                     elapsed_cycles_ = 0;
 
         class CurrentCycleCounter : public ReadOnlyCounter {
             Clock& clk_;
@@ -380,6 +374,17 @@ namespace sparta
 namespace sparta
 {
 
+/*
+ * Do the two schedulers keep the same time?  They do if they are the
+ * same scheduler, or partitions of one sparta::PartitionedScheduler.
+ */
+inline bool schedulersKeepSameTime(const Scheduler * a, const Scheduler * b)
+{
+    return (a == b) ||
+        ((a != nullptr) && (b != nullptr) && (a->getPartitionedScheduler() != nullptr) &&
+         (a->getPartitionedScheduler() == b->getPartitionedScheduler()));
+}
+
 /*
  * Return the delay, in ticks, incurred when crossing a clock boundary
  *
@@ -387,8 +392,9 @@ namespace sparta
  * \param src_clk   The sender's clock
  * \param dst_delay The receiver's delay (in ticks) to schedule from "now"
  * \param dst_clk   The receiver's clock
- * \note both clocks must be on the same scheduler. See
- * sparta::Clock::getScheduler
+ * \note The clocks can be on different schedulers only if those
+ * are partitions of one sparta::PartitionedScheduler (and so keep the
+ * same time).  "Now" is the source clock's scheduler's current tick.
  *
  * \return Relative scheduler tick that the crossing would incur
  */
@@ -397,10 +403,10 @@ inline Scheduler::Tick calculateClockCrossingDelay(Scheduler::Tick src_delay, co
 {
     sparta_assert(src_clk, "calculateClockCrossingDelay requires a non-null src_clk");
     sparta_assert(dst_clk, "calculateClockCrossingDelay requires a non-null dst_clk");
-    sparta_assert(src_clk->getScheduler() == dst_clk->getScheduler(),
+    sparta_assert(schedulersKeepSameTime(src_clk->getScheduler(), dst_clk->getScheduler()),
                       "calculateClockCrossingDelay requires src_clk and dst_clk to operate on "
-                      "the same scheduler. src = " << src_clk->getScheduler() << " and dst = "
-                      << dst_clk->getScheduler());
+                      "the same scheduler, or on partitions of one PartitionedScheduler. src = "
+                      << src_clk->getScheduler() << " and dst = " << dst_clk->getScheduler());
     auto scheduler = src_clk->getScheduler();
     sparta_assert(scheduler,
                       "calculateClockCrossingDelay requires src_clk (" << *src_clk << ") to "
@@ -446,8 +452,8 @@ inline Scheduler::Tick calculateClockCrossingDelay(Scheduler::Tick src_delay, co
  * \param src_clk   The sender's clock
  * \param dst_delay The receiver's delay (in ticks) to schedule from "now"
  * \param dst_clk   The receiver's clock
- * \note both clocks must be on the same scheduler. See
- * sparta::Clock::getScheduler
+ * \note The clocks can be on different schedulers only if those
+ * are partitions of one sparta::PartitionedScheduler
  *
  * \return Relative scheduler tick that the reverse crossing would incur
  */
@@ -457,10 +463,10 @@ inline Scheduler::Tick calculateReverseClockCrossingDelay(Scheduler::Tick dst_ar
 {
     sparta_assert(src_clk, "calculateReverseClockCrossingDelay requires a non-null src_clk");
     sparta_assert(dst_clk, "calculateReverseClockCrossingDelay requires a non-null dst_clk");
-    sparta_assert(src_clk->getScheduler() == dst_clk->getScheduler(),
+    sparta_assert(schedulersKeepSameTime(src_clk->getScheduler(), dst_clk->getScheduler()),
                       "calculateReverseClockCrossingDelay requires src_clk and dst_clk to operate on "
-                      "the same scheduler. src = " << src_clk->getScheduler() << " and dst = "
-                      << dst_clk->getScheduler());
+                      "the same scheduler, or on partitions of one PartitionedScheduler. src = "
+                      << src_clk->getScheduler() << " and dst = " << dst_clk->getScheduler());
     auto scheduler = src_clk->getScheduler();
     sparta_assert(scheduler,
                       "calculateReverseClockCrossingDelay requires src_clk (" << *src_clk << ") to "
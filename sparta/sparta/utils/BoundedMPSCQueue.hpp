@@ -0,0 +1,195 @@
+// <BoundedMPSCQueue.hpp> -*- C++ -*-
+
+
+/**
+ * \file   BoundedMPSCQueue.hpp
+ *
+ * \brief File that defines the BoundedMPSCQueue class -- a fixed-size,
+ * lock-free, multi-producer/single-consumer FIFO
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <memory>
+
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace sparta::utils
+{
+    /**
+     * \class BoundedMPSCQueue
+     * \brief A bounded, lock-free queue with many producers and one consumer
+     * \tparam DataT The object to pass between threads.  Must be
+     *               default constructible and movable.
+     *
+     * Any number of threads can call tryPush concurrently; only one
+     * thread at a time may call tryPop.  Neither call blocks nor
+     * allocates memory -- the storage is a ring of cells allocated
+     * at construction.
+     *
+     * Each cell carries a sequence number that tells producers and
+     * the consumer whether the cell is free or holds a value for the
+     * current lap around the ring (D. Vyukov's bounded queue).
+     * Producers claim a cell by advancing a shared tail with a CAS;
+     * the consumer owns the head outright.
+     *
+     * Caveats:
+     *
+     *  - tryPush fails (returns false) if the ring is full.  It is up
+     *    to the caller to decide what to do with the value.
+     *  - tryPop can return false while a producer is mid-push, even
+     *    if other values are further along the ring.  The value will
+     *    be seen on a later call.
+     *  - Values are FIFO per producer; there is no ordering between
+     *    producers other than the order in which they claim cells.
+     */
+    template <class DataT>
+    class BoundedMPSCQueue
+    {
+        // Keep the producer and consumer indexes off each other's
+        // cache line
+        static constexpr size_t CACHE_LINE_SIZE = 64;
+
+        struct Cell
+        {
+            std::atomic<uint64_t> sequence{0};
+            DataT data;
+        };
+
+    public:
+        /**
+         * \brief Create the queue
+         * \param capacity Number of values the queue can hold; must
+         *                 be a power of two
+         */
+        explicit BoundedMPSCQueue(size_t capacity) :
+            capacity_(capacity),
+            mask_(capacity - 1),
+            cells_(new Cell[capacity])
+        {
+            sparta_assert(capacity >= 2 && (capacity & (capacity - 1)) == 0,
+                          "BoundedMPSCQueue capacity must be a power of two: " << capacity);
+            for(size_t i = 0; i < capacity_; ++i) {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        //! No copies, no moves
+        BoundedMPSCQueue(const BoundedMPSCQueue &) = delete;
+        BoundedMPSCQueue & operator=(const BoundedMPSCQueue &) = delete;
+
+        /**
+         * \brief Add a value to the tail of the queue.  Can be called
+         *        by any thread.
+         * \param value The value to add; moved from only on success
+         * \return true if added, false if the queue was full
+         */
+        bool tryPush(DataT && value)
+        {
+            uint64_t pos = tail_.load(std::memory_order_relaxed);
+            Cell * cell = nullptr;
+            while(true)
+            {
+                cell = &cells_[pos & mask_];
+                const uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+                const int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+                if(diff == 0) {
+                    // The cell is free for this lap -- try to claim it
+                    if(tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                    // pos was updated by the failed CAS
+                }
+                else if(diff < 0) {
+                    // The consumer has not freed this cell yet
+                    return false;
+                }
+                else {
+                    // Another producer got here first
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+            cell->data = std::move(value);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! Copying version of tryPush
+        bool tryPush(const DataT & value) {
+            DataT copy(value);
+            return tryPush(std::move(copy));
+        }
+
+        /**
+         * \brief Remove the value at the head of the queue.  Must only
+         *        be called by the consumer thread.
+         * \param value Where to put the value
+         * \return true if a value was removed, false if none was ready
+         */
+        bool tryPop(DataT & value)
+        {
+            Cell & cell = cells_[head_ & mask_];
+            const uint64_t seq = cell.sequence.load(std::memory_order_acquire);
+            if(static_cast<int64_t>(seq) - static_cast<int64_t>(head_ + 1) < 0) {
+                return false;
+            }
+            value = std::move(cell.data);
+            // Free the cell for the producers' next lap
+            cell.sequence.store(head_ + capacity_, std::memory_order_release);
+            ++head_;
+            return true;
+        }
+
+        //! Number of values the queue can hold
+        size_t capacity() const {
+            return capacity_;
+        }
+
+        /**
+         * \brief Approximate number of values in the queue
+         *
+         * Only exact if no producer is pushing.  Meant for the
+         * consumer (or for statistics).
+         */
+        size_t size() const {
+            const uint64_t tail = tail_.load(std::memory_order_acquire);
+            return (tail > head_) ? static_cast<size_t>(tail - head_) : 0;
+        }
+
+        //! Is the queue (approximately) empty?
+        bool empty() const {
+            return size() == 0;
+        }
+
+        /**
+         * \brief Number of cells ever claimed by producers
+         *
+         * Every value a thread pushed before calling this is in a cell
+         * before this position.
+         */
+        uint64_t getTailPosition() const {
+            return tail_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * \brief Number of values ever popped.  Must only be called
+         *        by the consumer thread.
+         */
+        uint64_t getHeadPosition() const {
+            return head_;
+        }
+
+    private:
+        const size_t capacity_;
+        const uint64_t mask_;
+        std::unique_ptr<Cell[]> cells_;
+
+        //! Next cell a producer will claim
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail_{0};
+
+        //! Next cell the consumer will read.  Only touched by the consumer.
+        alignas(CACHE_LINE_SIZE) uint64_t head_ = 0;
+    };
+}
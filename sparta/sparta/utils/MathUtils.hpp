@@ -351,5 +351,69 @@ namespace sparta {
             return result;
         }
 
+        /**
+         * \class InvariantDivider
+         * \brief Divide 64-bit values by a divisor that rarely changes,
+         *        without a divide instruction
+         *
+         * Powers of two are a shift.  Any other divisor d multiplies
+         * by a reciprocal M = floor((2^64 - 1) / d), keeping the high
+         * 64 bits of the product.  That estimate is never more than
+         * one below the true quotient, so one compare fixes it up.
+         */
+        class InvariantDivider
+        {
+        public:
+            explicit InvariantDivider(uint32_t divisor = 1) {
+                setDivisor(divisor);
+            }
+
+            //! Change the divisor; this is the (only) expensive part
+            void setDivisor(uint32_t divisor)
+            {
+                sparta_assert(divisor != 0, "Cannot divide by zero");
+                divisor_ = divisor;
+                if(is_power_of_2(divisor)) {
+                    shift_ = static_cast<uint32_t>(floor_log2(divisor));
+                    reciprocal_ = 0;
+                }
+                else {
+                    shift_ = 0;
+                    reciprocal_ = ~uint64_t(0) / divisor;
+                }
+            }
+
+            uint32_t getDivisor() const {
+                return divisor_;
+            }
+
+            //! n / divisor
+            uint64_t divide(uint64_t n) const
+            {
+                if(reciprocal_ == 0) {
+                    return n >> shift_;
+                }
+                uint64_t q = static_cast<uint64_t>
+                    ((static_cast<uint128_t>(n) * reciprocal_) >> 64);
+                if((n - q * divisor_) >= divisor_) {
+                    ++q;
+                }
+                return q;
+            }
+
+            //! n % divisor
+            uint64_t remainder(uint64_t n) const {
+                return n - divide(n) * divisor_;
+            }
+
+        private:
+            // __extension__ keeps -pedantic quiet about the GCC/Clang type
+            __extension__ typedef unsigned __int128 uint128_t;
+
+            uint64_t reciprocal_ = 0; //!< 0 if the divisor is a power of 2
+            uint32_t divisor_ = 1;
+            uint32_t shift_ = 0;
+        };
+
     } // utils
 } // sparta
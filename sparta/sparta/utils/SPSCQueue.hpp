@@ -0,0 +1,173 @@
+// <SPSCQueue.hpp> -*- C++ -*-
+
+
+/**
+ * \file   SPSCQueue.hpp
+ *
+ * \brief File that defines the SPSCQueue class -- a fixed-size,
+ * lock-free, single-producer/single-consumer FIFO
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <memory>
+
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace sparta::utils
+{
+    /**
+     * \class SPSCQueue
+     * \brief A bounded, lock-free ring with one producer and one consumer
+     * \tparam DataT The object to pass between threads.  Must be
+     *               default constructible and movable.
+     *
+     * One thread calls tryPush while another looks at and removes
+     * values with front/pop.  Neither side blocks, takes a lock, or
+     * allocates -- the storage is allocated at construction.
+     *
+     * The producer owns the tail index and the consumer the head; each
+     * only reads the other's index with acquire semantics, and keeps a
+     * cached copy of it so that the shared cache line is only touched
+     * when the ring looks full (producer) or empty (consumer).
+     *
+     * Unlike BoundedMPSCQueue, the consumer can look at the head value
+     * before deciding whether to remove it.
+     */
+    template <class DataT>
+    class SPSCQueue
+    {
+        // Keep the producer and consumer indexes off each other's
+        // cache line
+        static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    public:
+        /**
+         * \brief Create the queue
+         * \param capacity Number of values the queue can hold; must
+         *                 be a power of two
+         */
+        explicit SPSCQueue(size_t capacity) :
+            capacity_(capacity),
+            mask_(capacity - 1),
+            cells_(new DataT[capacity])
+        {
+            sparta_assert(capacity >= 2 && (capacity & (capacity - 1)) == 0,
+                          "SPSCQueue capacity must be a power of two: " << capacity);
+        }
+
+        //! No copies, no moves
+        SPSCQueue(const SPSCQueue &) = delete;
+        SPSCQueue & operator=(const SPSCQueue &) = delete;
+
+        /**
+         * \brief Add a value to the tail of the queue.  Must only be
+         *        called by the producer thread.
+         * \param value The value to add; moved from only on success
+         * \return true if added, false if the queue was full
+         */
+        bool tryPush(DataT && value)
+        {
+            const uint64_t tail = tail_.load(std::memory_order_relaxed);
+            if(tail - cached_head_ == capacity_) {
+                cached_head_ = head_.load(std::memory_order_acquire);
+                if(tail - cached_head_ == capacity_) {
+                    return false;
+                }
+            }
+            cells_[tail & mask_] = std::move(value);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! Copying version of tryPush
+        bool tryPush(const DataT & value) {
+            DataT copy(value);
+            return tryPush(std::move(copy));
+        }
+
+        /**
+         * \brief The value at the head of the queue.  Must only be
+         *        called by the consumer thread.
+         * \return The value, or nullptr if none is ready
+         */
+        DataT * front()
+        {
+            const uint64_t head = head_.load(std::memory_order_relaxed);
+            if(head == cached_tail_) {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if(head == cached_tail_) {
+                    return nullptr;
+                }
+            }
+            return &cells_[head & mask_];
+        }
+
+        /**
+         * \brief Remove the value at the head of the queue.  Must only
+         *        be called by the consumer thread.
+         * \pre front() returned a value
+         */
+        void pop()
+        {
+            const uint64_t head = head_.load(std::memory_order_relaxed);
+            sparta_assert(head != cached_tail_, "SPSCQueue::pop on an empty queue");
+            head_.store(head + 1, std::memory_order_release);
+        }
+
+        /**
+         * \brief Remove the value at the head of the queue.  Must only
+         *        be called by the consumer thread.
+         * \param value Where to put the value
+         * \return true if a value was removed, false if none was ready
+         */
+        bool tryPop(DataT & value)
+        {
+            DataT * head = front();
+            if(head == nullptr) {
+                return false;
+            }
+            value = std::move(*head);
+            pop();
+            return true;
+        }
+
+        //! Number of values the queue can hold
+        size_t capacity() const {
+            return capacity_;
+        }
+
+        /**
+         * \brief Approximate number of values in the queue
+         *
+         * Only exact if neither side is using the queue
+         */
+        size_t size() const {
+            const uint64_t head = head_.load(std::memory_order_acquire);
+            const uint64_t tail = tail_.load(std::memory_order_acquire);
+            return (tail > head) ? static_cast<size_t>(tail - head) : 0;
+        }
+
+        //! Is the queue (approximately) empty?
+        bool empty() const {
+            return size() == 0;
+        }
+
+    private:
+        const size_t capacity_;
+        const uint64_t mask_;
+        std::unique_ptr<DataT[]> cells_;
+
+        //! Next cell the producer will fill, and the producer's copy
+        //! of the head
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail_{0};
+        uint64_t cached_head_ = 0;
+
+        //! Next cell the consumer will read, and the consumer's copy
+        //! of the tail
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head_{0};
+        uint64_t cached_tail_ = 0;
+    };
+}
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cinttypes>
 #include <cassert>
 #include <type_traits>
@@ -18,11 +19,103 @@
 
 namespace sparta
 {
+    /**
+     * \brief Reference counting policy for SpartaSharedPointer that
+     *        uses plain integers.  This is the default.
+     *
+     * Pointers using this policy (and the allocator they come from)
+     * must only be used by one thread.
+     */
+    struct SingleThreadedRefCount
+    {
+        //! This policy makes no attempt to be thread-safe
+        static constexpr bool thread_safe = false;
+
+        using CountType = int32_t;
+
+        static int32_t load(const CountType & cnt) { return cnt; }
+        static void store(CountType & cnt, int32_t val) { cnt = val; }
+        static void increment(CountType & cnt) { ++cnt; }
+
+        //! Decrement and return the new count
+        static int32_t decrement(CountType & cnt) { return --cnt; }
+
+        //! Decrement a count that only a current holder can raise
+        static int32_t decrementHeld(CountType & cnt) { return --cnt; }
+
+        //! Increment only if the count is not already 0 (for locking a weak pointer)
+        static bool incrementIfNonZero(CountType & cnt) {
+            if(cnt == 0) { return false; }
+            ++cnt;
+            return true;
+        }
+    };
+
+    /**
+     * \brief Reference counting policy for SpartaSharedPointer that
+     *        uses atomic integers.
+     *
+     * Copies of the same pointer can be created and destroyed on
+     * different threads, like std::shared_ptr.  As with
+     * std::shared_ptr, a single SpartaSharedPointer object and the
+     * object it points to are not protected.  Pointers using this
+     * policy can be allocated from a
+     * SpartaSharedPointerAllocator<PointerT, AtomicRefCount>, which
+     * is also thread-safe.
+     */
+    struct AtomicRefCount
+    {
+        //! Counts can be shared across threads
+        static constexpr bool thread_safe = true;
+
+        using CountType = std::atomic<int32_t>;
+
+        static int32_t load(const CountType & cnt) {
+            return cnt.load(std::memory_order_acquire);
+        }
+        static void store(CountType & cnt, int32_t val) {
+            cnt.store(val, std::memory_order_relaxed);
+        }
+        static void increment(CountType & cnt) {
+            // A new reference is always made from an existing one, so
+            // there is nothing to order against
+            cnt.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        //! Decrement and return the new count.  The thread that takes
+        //! the count to 0 sees every other thread's use of the object.
+        static int32_t decrement(CountType & cnt) {
+            return cnt.fetch_sub(1, std::memory_order_acq_rel) - 1;
+        }
+
+        //! Decrement a count that only a current holder can raise (the
+        //! weak count).  If the caller is the only holder, no other
+        //! thread can touch the count, so skip the atomic operation.
+        static int32_t decrementHeld(CountType & cnt) {
+            if(cnt.load(std::memory_order_acquire) == 1) {
+                return 0;
+            }
+            return decrement(cnt);
+        }
+
+        //! Increment only if the count is not already 0 (for locking a weak pointer)
+        static bool incrementIfNonZero(CountType & cnt) {
+            int32_t cur = cnt.load(std::memory_order_relaxed);
+            while(cur != 0) {
+                if(cnt.compare_exchange_weak(cur, cur + 1, std::memory_order_acq_rel,
+                                             std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
     // Forward declarations
-    template<class PointerT>
+    template<class PointerT, class RefCountPolicy>
     class SpartaSharedPointerAllocator;
 
-    template<class PointerT>
+    template<class PointerT, class RefCountPolicy>
     class SpartaWeakPointer;
 
     /**
@@ -32,6 +125,11 @@ namespace sparta
      *
      * Simple, thread-\a unsafe class that will delete memory it
      * points to when the last memory reference is deconstructed.
+     * Pointers that need to be shared across threads can use
+     * atomic reference counts instead (see AtomicRefCount and
+     * SpartaAtomicSharedPointer) at the cost of an atomic operation
+     * per copy/destruction.  The default, non-atomic policy pays
+     * nothing for this option.
      *
      * This class was created from the use case of typical model
      * development: lots and lots of small, shared objects flowing
@@ -75,12 +173,17 @@ namespace sparta
      * This class can be used independently, or more efficiently with
      * sparta::allocate_sparta_shared_pointer<T>.  See
      * sparta::SpartaSharedPointerAllocator for more information.
+     *
+     * \tparam PointerT       The type pointed to
+     * \tparam RefCountPolicy How reference counts are kept:
+     *                        SingleThreadedRefCount (default) or
+     *                        AtomicRefCount
      */
-    template <class PointerT>
+    template <class PointerT, class RefCountPolicy = SingleThreadedRefCount>
     class SpartaSharedPointer
     {
     public:
-        template<class PointerT2>
+        template<class PointerT2, class RefCountPolicy2>
         friend class SpartaSharedPointer;
 
     private:
@@ -89,6 +192,12 @@ namespace sparta
         /// If the RefCount contains a pointer to a mem_block, it does
         /// not own memory to PointerT nor is it responsible for
         /// deallocating it.
+        ///
+        /// wp_count is the number of SpartaWeakPointer objects plus
+        /// one held on behalf of all SpartaSharedPointer objects.  The
+        /// last SpartaSharedPointer destroys the object and then gives
+        /// up that extra count; whoever takes wp_count to 0 frees the
+        /// RefCount.
         struct RefCount
         {
             RefCount(PointerT * _p, void * mem_block) :
@@ -102,8 +211,9 @@ namespace sparta
             // Small cleanup -- set to nullptr
             ~RefCount() { p = nullptr; }
 
-            int32_t count   {1};
-            int32_t wp_count{0}; // For weakpointers
+            using CountType = typename RefCountPolicy::CountType;
+            CountType count   {1};
+            CountType wp_count{1}; // For weakpointers
             PointerT * p = nullptr;
             void     * mem_block = nullptr;
         };
@@ -140,15 +250,15 @@ namespace sparta
          *
          */
         template<class PointerT2>
-        SpartaSharedPointer(const SpartaSharedPointer<PointerT2>& orig) noexcept :
-            ref_count_((SpartaSharedPointer<PointerT>::RefCount*)orig.ref_count_)
+        SpartaSharedPointer(const SpartaSharedPointer<PointerT2, RefCountPolicy>& orig) noexcept :
+            ref_count_((SpartaSharedPointer<PointerT, RefCountPolicy>::RefCount*)orig.ref_count_)
         {
             static_assert(std::is_base_of<PointerT, PointerT2>::value == true,
                 "Only upcasting (derived class -> base class) of SpartaSharedPointer is supported!");
             static_assert(std::has_virtual_destructor<PointerT>::value == true,
                 "Base class must have a virtual destructor defined to support upcasting!");
             if(SPARTA_EXPECT_TRUE(ref_count_ != nullptr)) {
-                ++ref_count_->count;
+                RefCountPolicy::increment(ref_count_->count);
             }
         }
 
@@ -162,7 +272,7 @@ namespace sparta
             ref_count_(orig.ref_count_)
         {
             if(SPARTA_EXPECT_TRUE(ref_count_ != nullptr)) {
-                ++ref_count_->count;
+                RefCountPolicy::increment(ref_count_->count);
             }
         }
 
@@ -198,7 +308,7 @@ namespace sparta
             unlink_();
             ref_count_ = orig.ref_count_;
             if(SPARTA_EXPECT_TRUE(ref_count_ != nullptr)) {
-                ++ref_count_->count;
+                RefCountPolicy::increment(ref_count_->count);
             }
             return *this;
         }
@@ -287,7 +397,7 @@ namespace sparta
          */
         uint32_t use_count() const {
             if(SPARTA_EXPECT_TRUE(ref_count_ != nullptr)) {
-                return ref_count_->p ? ref_count_->count : 0;
+                return ref_count_->p ? RefCountPolicy::load(ref_count_->count) : 0;
             }
             return 0;
         }
@@ -295,76 +405,62 @@ namespace sparta
     private:
 
         /**
-         * \brief Called by the SharedPointer and the WeakPointer to
-         * release a reference count
+         * \brief Called by the SpartaSharedPointer to release a
+         *        reference
          * \param ref_count The reference count to release
          *
-         * If called by the SpartaSharedPointer and there are no weak
-         * pointers pointing to this object, delete the user object
-         * AND reclaim the reference count.
-         *
-         * If called by the SpartaWeakPointer and there are no other
-         * pointers (of any smart type) pointing to this block, delete
-         * the reference count.  The user object was already deleted
-         * when the SpartaSharedPointer was destroyed.
+         * The last SpartaSharedPointer deletes (or hands back to the
+         * allocator) the user object, then gives up the weak
+         * reference held on behalf of all SpartaSharedPointers.
          */
-        static void releaseRefCount_(RefCount *& ref_count)
+        static void releaseStrong_(RefCount * ref_count)
         {
-            if(0 == ref_count->count) {
-                // Make it go negative to show there are no
-                // SpartaSharedPointer objects using this ref_count.
-                // We can't set it to nullptr because it might be
-                // allocated on the heap and we need to ensure all
-                // SpartaWeakPointer objects are done with it too.
-                //
-                // This pointer needs to be set here to prevent a weak pointer
-                // from being destructed and calling releaseObject_ in a cycle.
-                --(ref_count->count);
-
-                // Claim a weak-pointer reference on the block. This ensures
-                // that no one else will delete the reference count block out
-                // from under us higher up the call stack.
-                ++ref_count->wp_count;
-
-                BaseAllocator::MemBlockBase * memory_block =
-                    static_cast<BaseAllocator::MemBlockBase *>(ref_count->mem_block);
-
-                // These calls are dangerous! When we're destroying our
-                // object, we may arrive at this point in the _same_ shared
-                // pointer _recursively_ further up the call stack if the
-                // pointed-to object contains a weak pointer that points back to
-                // itself.
-                if(SPARTA_EXPECT_TRUE(nullptr != memory_block)) {
-                    memory_block->alloc->releaseObject_(memory_block);
-                }
-                else {
-                    delete ref_count->p;
-                    ref_count->p = nullptr;
-                }
+            if(RefCountPolicy::decrement(ref_count->count) != 0) {
+                return;
+            }
 
-                // Release the weak-pointer reference that we claimed above. Now
-                // we will proceed to release ref_count, and can rest assured
-                // that no recursive call to weak-pointer destruction released
-                // ref_count out from under us.
-                --ref_count->wp_count;
+            BaseAllocator::MemBlockBase * memory_block =
+                static_cast<BaseAllocator::MemBlockBase *>(ref_count->mem_block);
+
+            // The user object can hold SpartaWeakPointers to itself.
+            // Destroying it releases those, but they cannot free the
+            // reference count out from under us: wp_count does not
+            // reach 0 until releaseWeak_ below.
+            if(SPARTA_EXPECT_TRUE(nullptr != memory_block)) {
+                memory_block->alloc->releaseObject_(memory_block);
+            }
+            else {
+                delete ref_count->p;
+                ref_count->p = nullptr;
             }
 
-            if((0 >= ref_count->count) && (0 == ref_count->wp_count))
-            {
-                // Because we claimed the weak-pointer reference above, we can
-                // ensure that we only make one pass through this block---even
-                // if we destroy a weak pointer recursively, it will not try to
-                // destroy this block.
-                BaseAllocator::MemBlockBase * memory_block =
-                    static_cast<BaseAllocator::MemBlockBase *>(ref_count->mem_block);
-
-                if(SPARTA_EXPECT_TRUE(nullptr != memory_block)) {
-                    memory_block->alloc->releaseBlock_(memory_block);
-                }
-                else {
-                    delete ref_count;
-                }
-                ref_count = nullptr;
+            releaseWeak_(ref_count);
+        }
+
+        /**
+         * \brief Called by the SpartaWeakPointer (and the last
+         *        SpartaSharedPointer) to release a weak reference
+         * \param ref_count The reference count to release
+         *
+         * If this is the last reference of any kind, delete the
+         * reference count (or return its block to the allocator).
+         * The user object was already deleted when the last
+         * SpartaSharedPointer was destroyed.
+         */
+        static void releaseWeak_(RefCount * ref_count)
+        {
+            if(RefCountPolicy::decrementHeld(ref_count->wp_count) != 0) {
+                return;
+            }
+
+            BaseAllocator::MemBlockBase * memory_block =
+                static_cast<BaseAllocator::MemBlockBase *>(ref_count->mem_block);
+
+            if(SPARTA_EXPECT_TRUE(nullptr != memory_block)) {
+                memory_block->alloc->releaseBlock_(memory_block);
+            }
+            else {
+                delete ref_count;
             }
         }
 
@@ -373,27 +469,26 @@ namespace sparta
         {
             if(SPARTA_EXPECT_TRUE(ref_count_ != nullptr))
             {
-                --ref_count_->count;
-                releaseRefCount_(ref_count_);
+                releaseStrong_(ref_count_);
+                ref_count_ = nullptr;
             }
         }
 
-        // Used by SpartaWeakPointer and Allocator.  weak_alloc is
-        // true if from WP
-        explicit SpartaSharedPointer(RefCount * cnt, const bool weak_ptr = false) :
+        // Used by SpartaWeakPointer and Allocator.  Takes over a
+        // reference already counted in cnt.
+        explicit SpartaSharedPointer(RefCount * cnt) :
             ref_count_(cnt)
-        {
-            if(weak_ptr && ref_count_) { ++ref_count_->count; }
-        }
+        {}
 
         RefCount * ref_count_ = nullptr;
 
-        friend class SpartaSharedPointerAllocator<PointerT>;
-        friend class SpartaWeakPointer<PointerT>;
+        friend class SpartaSharedPointerAllocator<PointerT, RefCountPolicy>;
+        friend class SpartaWeakPointer<PointerT, RefCountPolicy>;
 
-        template<typename PtrT, typename... Args>
-        friend SpartaSharedPointer<PtrT>
-        allocate_sparta_shared_pointer(SpartaSharedPointerAllocator<PtrT> &, Args&&...args);
+        template<typename PtrT, typename RefCountPolicyT, typename... Args>
+        friend SpartaSharedPointer<PtrT, RefCountPolicyT>
+        allocate_sparta_shared_pointer(SpartaSharedPointerAllocator<PtrT, RefCountPolicyT> &,
+                                       Args&&...args);
     };
 
 
@@ -403,9 +498,11 @@ namespace sparta
      *
      *  Works like the original, just tons faster
      */
-    template<class PointerT>
+    template<class PointerT, class RefCountPolicy = SingleThreadedRefCount>
     class SpartaWeakPointer
     {
+        using SharedPointerType = sparta::SpartaSharedPointer<PointerT, RefCountPolicy>;
+
     public:
         //! Create an empty, expired weakpointer
         constexpr SpartaWeakPointer() noexcept = default;
@@ -414,19 +511,18 @@ namespace sparta
          * \brief Construct a SpartaWeakPointer with the given SpartaSharedPointer
          * \param sp Pointer to the SpartaSharedPointer to "watch"
          */
-        SpartaWeakPointer(const sparta::SpartaSharedPointer<PointerT> & sp) noexcept :
+        SpartaWeakPointer(const SharedPointerType & sp) noexcept :
             wp_ref_cnt_(sp.ref_count_)
         {
             if(SPARTA_EXPECT_TRUE(nullptr != wp_ref_cnt_)) {
-                ++(wp_ref_cnt_->wp_count);
+                RefCountPolicy::increment(wp_ref_cnt_->wp_count);
             }
         }
 
         //! Destroy (and detach) from a SpartaSharedPointer
         ~SpartaWeakPointer() {
             if(SPARTA_EXPECT_TRUE(nullptr != wp_ref_cnt_)) {
-                --(wp_ref_cnt_->wp_count);
-                SpartaSharedPointer<PointerT>::releaseRefCount_(wp_ref_cnt_);
+                SharedPointerType::releaseWeak_(wp_ref_cnt_);
                 wp_ref_cnt_ = nullptr;
             }
         }
@@ -439,7 +535,7 @@ namespace sparta
             wp_ref_cnt_(orig.wp_ref_cnt_)
         {
             if(SPARTA_EXPECT_TRUE(nullptr != wp_ref_cnt_)) {
-                ++(wp_ref_cnt_->wp_count);
+                RefCountPolicy::increment(wp_ref_cnt_->wp_count);
             }
         }
 
@@ -459,15 +555,15 @@ namespace sparta
          */
         SpartaWeakPointer & operator=(const SpartaWeakPointer & orig)
         {
-            if(SPARTA_EXPECT_TRUE(nullptr != wp_ref_cnt_)) {
-                --(wp_ref_cnt_->wp_count);
-                SpartaSharedPointer<PointerT>::releaseRefCount_(wp_ref_cnt_);
+            // Take the new reference first in case orig and this
+            // share the last one
+            if(SPARTA_EXPECT_TRUE(nullptr != orig.wp_ref_cnt_)) {
+                RefCountPolicy::increment(orig.wp_ref_cnt_->wp_count);
             }
-            wp_ref_cnt_ = orig.wp_ref_cnt_;
-
             if(SPARTA_EXPECT_TRUE(nullptr != wp_ref_cnt_)) {
-                ++(wp_ref_cnt_->wp_count);
+                SharedPointerType::releaseWeak_(wp_ref_cnt_);
             }
+            wp_ref_cnt_ = orig.wp_ref_cnt_;
             return *this;
         }
 
@@ -478,8 +574,7 @@ namespace sparta
         SpartaWeakPointer & operator=(SpartaWeakPointer && orig)
         {
             if(SPARTA_EXPECT_TRUE(nullptr != wp_ref_cnt_)) {
-                --(wp_ref_cnt_->wp_count);
-                SpartaSharedPointer<PointerT>::releaseRefCount_(wp_ref_cnt_);
+                SharedPointerType::releaseWeak_(wp_ref_cnt_);
             }
 
             wp_ref_cnt_ = orig.wp_ref_cnt_;
@@ -493,7 +588,7 @@ namespace sparta
          */
         long use_count() const noexcept {
             if(SPARTA_EXPECT_TRUE(nullptr != wp_ref_cnt_)) {
-                return (wp_ref_cnt_->count <= 0 ? 0 : wp_ref_cnt_->count);
+                return RefCountPolicy::load(wp_ref_cnt_->count);
             }
             return 0;
         }
@@ -504,7 +599,7 @@ namespace sparta
          */
         bool expired() const noexcept {
             if(SPARTA_EXPECT_TRUE(nullptr != wp_ref_cnt_)) {
-                return wp_ref_cnt_->count <= 0;
+                return RefCountPolicy::load(wp_ref_cnt_->count) == 0;
             }
             return true;
         }
@@ -513,42 +608,56 @@ namespace sparta
          * \brief Lock and return a SpartaSharedPointer this SpartaWeakPointer points to
          * \return nullptr if the SpartaSharedPointer has expired; otherwise a locked version
          */
-        SpartaSharedPointer<PointerT> lock() const noexcept {
-            return SpartaSharedPointer<PointerT>(wp_ref_cnt_, true);
+        SharedPointerType lock() const noexcept {
+            if(SPARTA_EXPECT_TRUE(nullptr != wp_ref_cnt_) &&
+               RefCountPolicy::incrementIfNonZero(wp_ref_cnt_->count))
+            {
+                return SharedPointerType(wp_ref_cnt_);
+            }
+            return SharedPointerType();
         }
 
     private:
         //! Shared reference count between SpartaSharedPointer and SpartaWeakPointer
-        typename SpartaSharedPointer<PointerT>::RefCount * wp_ref_cnt_ = nullptr;
+        typename SharedPointerType::RefCount * wp_ref_cnt_ = nullptr;
     };
 
+    //! A SpartaSharedPointer with atomic reference counts that can be
+    //! shared across threads
+    template<class PointerT>
+    using SpartaAtomicSharedPointer = SpartaSharedPointer<PointerT, AtomicRefCount>;
+
+    //! A SpartaWeakPointer to a SpartaAtomicSharedPointer
+    template<class PointerT>
+    using SpartaAtomicWeakPointer = SpartaWeakPointer<PointerT, AtomicRefCount>;
+
 
-    template<typename PtrT, typename Ptr2>
-    bool operator==(const SpartaSharedPointer<PtrT>& ptr1, const SpartaSharedPointer<Ptr2>& ptr2) noexcept
+    template<typename PtrT, typename Ptr2, typename RefCountPolicy>
+    bool operator==(const SpartaSharedPointer<PtrT, RefCountPolicy>& ptr1, const SpartaSharedPointer<Ptr2, RefCountPolicy>& ptr2) noexcept
     { return ptr1.get() == ptr2.get(); }
 
-    template<typename PtrT>
-    bool operator==(const SpartaSharedPointer<PtrT>& ptr1, std::nullptr_t) noexcept
+    template<typename PtrT, typename RefCountPolicy>
+    bool operator==(const SpartaSharedPointer<PtrT, RefCountPolicy>& ptr1, std::nullptr_t) noexcept
     { return !ptr1; }
 
-    template<typename PtrT>
-    bool operator==(std::nullptr_t, const SpartaSharedPointer<PtrT>& ptr1) noexcept
+    template<typename PtrT, typename RefCountPolicy>
+    bool operator==(std::nullptr_t, const SpartaSharedPointer<PtrT, RefCountPolicy>& ptr1) noexcept
     { return !ptr1; }
 
-    template<typename PtrT, typename Ptr2>
-    bool operator!=(const SpartaSharedPointer<PtrT>& ptr1, const SpartaSharedPointer<Ptr2>& ptr2) noexcept
+    template<typename PtrT, typename Ptr2, typename RefCountPolicy>
+    bool operator!=(const SpartaSharedPointer<PtrT, RefCountPolicy>& ptr1, const SpartaSharedPointer<Ptr2, RefCountPolicy>& ptr2) noexcept
     { return ptr1.get() != ptr2.get(); }
 
-    template<typename PtrT>
-    bool operator!=(const SpartaSharedPointer<PtrT>& ptr1, std::nullptr_t) noexcept
+    template<typename PtrT, typename RefCountPolicy>
+    bool operator!=(const SpartaSharedPointer<PtrT, RefCountPolicy>& ptr1, std::nullptr_t) noexcept
     { return (bool)ptr1; }
 
-    template<typename PtrT>
-    bool operator!=(std::nullptr_t, const SpartaSharedPointer<PtrT>& ptr1) noexcept
+    template<typename PtrT, typename RefCountPolicy>
+    bool operator!=(std::nullptr_t, const SpartaSharedPointer<PtrT, RefCountPolicy>& ptr1) noexcept
     { return (bool)ptr1; }
 
-    template<typename PtrT>
-    std::ostream& operator<<(std::ostream & os, const SpartaSharedPointer<PtrT> & p)
+    template<typename PtrT, typename RefCountPolicy>
+    std::ostream& operator<<(std::ostream & os, const SpartaSharedPointer<PtrT, RefCountPolicy> & p)
     {
         os << p.get();
         return os;
@@ -560,27 +669,27 @@ namespace sparta
 namespace MetaStruct {
 
     // Helper structs
-    template<typename T>
-    struct is_any_pointer<sparta::SpartaSharedPointer<T>> : public std::true_type {};
+    template<typename T, typename RefCountPolicy>
+    struct is_any_pointer<sparta::SpartaSharedPointer<T, RefCountPolicy>> : public std::true_type {};
 
-    template<typename T>
-    struct is_any_pointer<sparta::SpartaSharedPointer<T> const> : public std::true_type {};
+    template<typename T, typename RefCountPolicy>
+    struct is_any_pointer<sparta::SpartaSharedPointer<T, RefCountPolicy> const> : public std::true_type {};
 
-    template<typename T>
-    struct is_any_pointer<sparta::SpartaSharedPointer<T> &> : public std::true_type {};
+    template<typename T, typename RefCountPolicy>
+    struct is_any_pointer<sparta::SpartaSharedPointer<T, RefCountPolicy> &> : public std::true_type {};
 
-    template<typename T>
-    struct is_any_pointer<sparta::SpartaSharedPointer<T> const &> : public std::true_type {};
+    template<typename T, typename RefCountPolicy>
+    struct is_any_pointer<sparta::SpartaSharedPointer<T, RefCountPolicy> const &> : public std::true_type {};
 
-    template<typename T>
-    struct remove_any_pointer<sparta::SpartaSharedPointer<T>> { using type = T; };
+    template<typename T, typename RefCountPolicy>
+    struct remove_any_pointer<sparta::SpartaSharedPointer<T, RefCountPolicy>> { using type = T; };
 
-    template<typename T>
-    struct remove_any_pointer<sparta::SpartaSharedPointer<T> const> { using type = T; };
+    template<typename T, typename RefCountPolicy>
+    struct remove_any_pointer<sparta::SpartaSharedPointer<T, RefCountPolicy> const> { using type = T; };
 
-    template<typename T>
-    struct remove_any_pointer<sparta::SpartaSharedPointer<T> &> { using type = T; };
+    template<typename T, typename RefCountPolicy>
+    struct remove_any_pointer<sparta::SpartaSharedPointer<T, RefCountPolicy> &> { using type = T; };
 
-    template<typename T>
-    struct remove_any_pointer<sparta::SpartaSharedPointer<T> const &> { using type = T; };
+    template<typename T, typename RefCountPolicy>
+    struct remove_any_pointer<sparta::SpartaSharedPointer<T, RefCountPolicy> const &> { using type = T; };
 }
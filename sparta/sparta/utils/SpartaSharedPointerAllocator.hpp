@@ -1,5 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "sparta/utils/SpartaSharedPointer.hpp"
 
 namespace sparta
@@ -20,6 +26,16 @@ namespace sparta
      * allocating/deallocating with the same
      * sparta::SpartaSharedPointerAllocator<PointerT> instance.
      *
+     * For that, use the thread-safe version,
+     * sparta::SpartaSharedPointerAllocator<PointerT, AtomicRefCount>
+     * (or sparta::SpartaAtomicSharedPointerAllocator<PointerT>),
+     * which hands out sparta::SpartaAtomicSharedPointer objects.
+     * Each thread keeps a small cache of free blocks for the
+     * allocator so that allocating and releasing objects only
+     * takes a lock when a cache runs dry or overflows.  A block
+     * released on one thread goes into that thread's cache; the
+     * overflow is shared with the other threads.
+     *
      * Also, the allocator *must outlive* any simulator
      * componentry that uses objects allocated by this allocator.
      * If not, random seg faults will plague the developer.
@@ -150,14 +166,25 @@ namespace sparta
      * situation.
      *
      */
-    template<class PointerT>
+    template<class PointerT, class RefCountPolicy = SingleThreadedRefCount>
     class SpartaSharedPointerAllocator : public BaseAllocator
     {
+        using SharedPointerType = SpartaSharedPointer<PointerT, RefCountPolicy>;
+        using RefCountType      = typename SharedPointerType::RefCount;
+
+        //! Is this allocator to be used by multiple threads?
+        static constexpr bool thread_safe = RefCountPolicy::thread_safe;
+
     public:
 
         //! Handy typedef
         using element_type = PointerT;
 
+        //! The number of free blocks each thread keeps for itself
+        //! (thread-safe allocator only).  Beyond that, half are
+        //! returned to the shared pool.
+        static constexpr size_t THREAD_CACHE_SIZE = 64;
+
         //! Used for defining a custom watermark warning callback.
         //! Default is to print a warning
         using WaterMarkWarningCallback = std::function<void (const SpartaSharedPointerAllocator &)>;
@@ -188,7 +215,13 @@ namespace sparta
                           "The water_mark on SpartaSharedPointerAllocator should be less than or " <<
                           "equal to the maximum number of blocks. water_mark=" << water_mark <<
                           " max_num_blocks=" << max_num_blocks);
-            free_blocks_.resize(max_num_blocks, nullptr);
+            if constexpr (thread_safe) {
+                pool_ = std::make_shared<SharedPool>();
+                pool_->free_blocks.reserve(max_num_blocks);
+            }
+            else {
+                free_blocks_.resize(max_num_blocks, nullptr);
+            }
         }
 
         //! Disallow copies/assignments/moves
@@ -204,15 +237,22 @@ namespace sparta
             {
                 std::cerr << "WARNING: Seems that not all of the blocks made it back.  \n'" <<
                     __PRETTY_FUNCTION__ << "'\nAllocated: " << allocated_ <<
-                    "\nReturned: " << free_idx_ << std::endl;
+                    "\nReturned: " << getNumFree() << std::endl;
             }
         }
 
         /**
          * \brief Return the number of freed objects this allocator holds
          * \return Number of freed objects
+         *
+         * For the thread-safe allocator, this includes the blocks
+         * held in every thread's cache.
          */
         size_t getNumFree() const {
+            if constexpr (thread_safe) {
+                std::lock_guard<std::recursive_mutex> guard(pool_->mutex);
+                return allocated_ - pool_->numInUse();
+            }
             return free_idx_;
         }
 
@@ -223,6 +263,10 @@ namespace sparta
          * This count should always be <= getNumFree()
          */
         size_t getNumAllocated() const {
+            if constexpr (thread_safe) {
+                std::lock_guard<std::recursive_mutex> guard(pool_->mutex);
+                return memory_blocks_.size();
+            }
             return memory_blocks_.size();
         }
 
@@ -231,6 +275,10 @@ namespace sparta
          * \return True if there are outstanding blocks not yet returned to the allocator
          */
         bool hasOutstandingObjects() const {
+            if constexpr (thread_safe) {
+                std::lock_guard<std::recursive_mutex> guard(pool_->mutex);
+                return pool_->numInUse() != 0;
+            }
             return (allocated_ != free_idx_);
         }
 
@@ -238,19 +286,19 @@ namespace sparta
          * \brief Return a vector of objects that have not been deleted/not yet returned to the allocator
          *
          * \return vector of PointerT objects that still have reference counts > 0
+         *
+         * For the thread-safe allocator, other threads can keep
+         * allocating (and freeing) while this runs, so the answer is a
+         * snapshot.
          */
         std::vector<const PointerT*> getOutstandingAllocatedObjects() const
         {
-            std::vector<const PointerT*> allocated_objs;
-
-            const size_t size = memory_blocks_.size();
-            for(uint32_t i = 0; i < size; ++i) {
-                if(memory_blocks_[i]->ref_count->count > 0) {
-                    allocated_objs.emplace_back(memory_blocks_[i]->object);
-                }
+            if constexpr (thread_safe) {
+                // Blocks are built under the pool mutex
+                std::lock_guard<std::recursive_mutex> guard(pool_->mutex);
+                return findOutstandingAllocatedObjects_();
             }
-
-            return allocated_objs;
+            return findOutstandingAllocatedObjects_();
         }
 
         /**
@@ -278,18 +326,17 @@ namespace sparta
     private:
 
         // Let's make friends
-        friend class SpartaSharedPointer<PointerT>;
+        friend class SpartaSharedPointer<PointerT, RefCountPolicy>;
 
         // Make the allocate function a buddy
-        template<typename PtrT, typename... Args>
-        friend SpartaSharedPointer<PtrT>
-        allocate_sparta_shared_pointer(SpartaSharedPointerAllocator<PtrT> &, Args&&...args);
+        template<typename PtrT, typename RefCountPolicyT, typename... Args>
+        friend SpartaSharedPointer<PtrT, RefCountPolicyT>
+        allocate_sparta_shared_pointer(SpartaSharedPointerAllocator<PtrT, RefCountPolicyT> &,
+                                       Args&&...args);
 
         // Internal MemoryBlock
         struct MemBlock : public BaseAllocator::MemBlockBase
         {
-            using RefCountType = typename SpartaSharedPointer<PointerT>::RefCount;
-
             using RefCountAlignedStorage =
                 typename std::aligned_storage<sizeof(RefCountType), alignof(RefCountType)>::type;
 
@@ -373,6 +420,160 @@ namespace sparta
             }
         };
 
+        struct ThreadCache;
+
+        // State shared by all threads (thread-safe allocator only).
+        // Threads' caches hold it through a weak_ptr so a thread that
+        // exits after the allocator is gone does not touch freed
+        // memory.  Everything here is guarded by the mutex.
+        struct SharedPool
+        {
+            // Recursive so that the watermark and over-allocation
+            // callbacks, called with it held, can query the allocator
+            std::recursive_mutex      mutex;
+            std::vector<MemBlock*>    free_blocks;
+            std::vector<ThreadCache*> caches;            // Caches of live threads
+            int64_t                   exited_in_use = 0; // Net allocations by exited threads
+
+            // Objects handed out and not yet returned, by any thread
+            size_t numInUse() const {
+                int64_t in_use = exited_in_use;
+                for(const ThreadCache * cache : caches) {
+                    in_use += cache->in_use.load(std::memory_order_relaxed);
+                }
+                return static_cast<size_t>(in_use);
+            }
+        };
+
+        // One thread's free blocks for one allocator.  Only changed
+        // by that thread.
+        struct ThreadCache
+        {
+            ThreadCache(uint64_t id, const std::shared_ptr<SharedPool> & shared_pool) :
+                alloc_id(id), pool(shared_pool)
+            {
+                blocks.reserve(THREAD_CACHE_SIZE + 1);
+                std::lock_guard<std::recursive_mutex> guard(shared_pool->mutex);
+                shared_pool->caches.emplace_back(this);
+            }
+
+            // Give the blocks back when the thread exits
+            ~ThreadCache() {
+                if(auto shared_pool = pool.lock()) {
+                    std::lock_guard<std::recursive_mutex> guard(shared_pool->mutex);
+                    shared_pool->free_blocks.insert(shared_pool->free_blocks.end(),
+                                                    blocks.begin(), blocks.end());
+                    shared_pool->exited_in_use += in_use.load(std::memory_order_relaxed);
+                    auto & caches = shared_pool->caches;
+                    caches.erase(std::find(caches.begin(), caches.end(), this));
+                }
+            }
+
+            // Only this thread writes in_use, so it is updated
+            // without a locked instruction.  Others read it to sum the
+            // allocator's totals.
+            void addInUse(int64_t delta) {
+                in_use.store(in_use.load(std::memory_order_relaxed) + delta,
+                             std::memory_order_relaxed);
+            }
+
+            const uint64_t            alloc_id;
+            std::weak_ptr<SharedPool> pool;
+            std::vector<MemBlock*>    blocks;
+            std::atomic<int64_t>      in_use{0}; // Allocated minus released by this thread
+        };
+
+        // Find (or create) the calling thread's cache for this allocator
+        ThreadCache & getThreadCache_()
+        {
+            thread_local std::vector<std::unique_ptr<ThreadCache>> caches;
+            thread_local ThreadCache * last_cache = nullptr;
+
+            if(SPARTA_EXPECT_TRUE(last_cache != nullptr && last_cache->alloc_id == id_)) {
+                return *last_cache;
+            }
+            for(auto & cache : caches) {
+                if(cache->alloc_id == id_) {
+                    last_cache = cache.get();
+                    return *last_cache;
+                }
+            }
+
+            // New to this thread.  Drop caches for allocators that are gone.
+            caches.erase(std::remove_if(caches.begin(), caches.end(),
+                                        [](const std::unique_ptr<ThreadCache> & cache) {
+                                            return cache->pool.expired();
+                                        }),
+                         caches.end());
+            caches.emplace_back(new ThreadCache(id_, pool_));
+            last_cache = caches.back().get();
+            return *last_cache;
+        }
+
+        // Take a free block from this thread's cache, refilling it
+        // from the shared pool if needed.  nullptr if there are none.
+        MemBlock * takeCachedBlock_(ThreadCache & cache)
+        {
+            if(SPARTA_EXPECT_FALSE(cache.blocks.empty()))
+            {
+                std::lock_guard<std::recursive_mutex> guard(pool_->mutex);
+                auto & free_blocks = pool_->free_blocks;
+                const size_t num = std::min(free_blocks.size(), THREAD_CACHE_SIZE / 2);
+                cache.blocks.insert(cache.blocks.end(), free_blocks.end() - num, free_blocks.end());
+                free_blocks.resize(free_blocks.size() - num);
+                if(cache.blocks.empty()) {
+                    return nullptr;
+                }
+            }
+            MemBlock * block = cache.blocks.back();
+            cache.blocks.pop_back();
+            return block;
+        }
+
+        // The objects of the blocks still referenced.  The caller must
+        // hold the pool mutex on the thread-safe allocator.
+        std::vector<const PointerT*> findOutstandingAllocatedObjects_() const
+        {
+            std::vector<const PointerT*> allocated_objs;
+
+            const size_t size = memory_blocks_.size();
+            for(uint32_t i = 0; i < size; ++i) {
+                if(RefCountPolicy::load(memory_blocks_[i]->ref_count->count) > 0) {
+                    allocated_objs.emplace_back(memory_blocks_[i]->object);
+                }
+            }
+
+            return allocated_objs;
+        }
+
+        // Build a brand new block.  The caller must hold the pool
+        // mutex on the thread-safe allocator.
+        template<typename ...PointerTArgs>
+        MemBlock * allocateNewBlock_(PointerTArgs&&... args)
+        {
+            if(SPARTA_EXPECT_FALSE(allocated_ > water_mark_)) {
+                if(SPARTA_EXPECT_FALSE(!water_mark_warning_)) {
+                    watermark_warning_callback_(*this);
+                    water_mark_warning_ = true;
+                }
+
+                // Only need to check for overallocation if we've passed the watermark
+                if(SPARTA_EXPECT_FALSE(allocated_ >= memory_blocks_.capacity())) {
+                    over_allocation_callback_(*this);
+                    SpartaException ex;
+                    ex << "This allocator has run out of memory: \n\n\t"
+                       << __PRETTY_FUNCTION__
+                       << "\n\n"
+                       << "\t\tNumber blocks preallocated: " << memory_blocks_.capacity()
+                       << "\n\t\tWatermark                 : " << water_mark_;
+                    throw ex;
+                }
+            }
+            MemBlock * block = memory_blocks_.allocate(this, std::forward<PointerTArgs>(args)...);
+            ++allocated_;
+            return block;
+        }
+
         /**
          * \brief Allocate a memory block for the given object to be
          *        used by the SpartaSharedPointer
@@ -383,42 +584,40 @@ namespace sparta
          *         SpartaSharedPointer to release the memory
          */
         template<typename ...PointerTArgs>
-        typename SpartaSharedPointer<PointerT>::RefCount * allocate_(PointerTArgs&&... args)
+        RefCountType * allocate_(PointerTArgs&&... args)
         {
             // Return memory allocated here.
             MemBlock * block = nullptr;
 
             // Check for previously freed blocks and reuse them.
-            if(free_idx_ > 0) {
+            [[maybe_unused]] ThreadCache * cache = nullptr;
+            if constexpr (thread_safe) {
+                cache = &getThreadCache_();
+                block = takeCachedBlock_(*cache);
+            }
+            else if(free_idx_ > 0) {
                 --free_idx_;
                 block = free_blocks_[free_idx_];
+            }
+
+            if(block != nullptr) {
                 sparta_assert(block->ref_count->p != nullptr);
                 block->ref_count->mem_block = (void*)block;
-                block->ref_count->count = 1;
+                RefCountPolicy::store(block->ref_count->count, 1);
+                RefCountPolicy::store(block->ref_count->wp_count, 1);
                 // perform an in place new on the reused pointer
                 new (block->ref_count->p) PointerT(std::forward<PointerTArgs>(args)...);
             }
+            else if constexpr (thread_safe) {
+                std::lock_guard<std::recursive_mutex> guard(pool_->mutex);
+                block = allocateNewBlock_(std::forward<PointerTArgs>(args)...);
+            }
             else {
-                if(SPARTA_EXPECT_FALSE(allocated_ > water_mark_)) {
-                    if(SPARTA_EXPECT_FALSE(!water_mark_warning_)) {
-                        watermark_warning_callback_(*this);
-                        water_mark_warning_ = true;
-                    }
+                block = allocateNewBlock_(std::forward<PointerTArgs>(args)...);
+            }
 
-                    // Only need to check for overallocation if we've passed the watermark
-                    if(SPARTA_EXPECT_FALSE(allocated_ >= memory_blocks_.capacity())) {
-                        over_allocation_callback_(*this);
-                        SpartaException ex;
-                        ex << "This allocator has run out of memory: \n\n\t"
-                           << __PRETTY_FUNCTION__
-                           << "\n\n"
-                           << "\t\tNumber blocks preallocated: " << memory_blocks_.capacity()
-                           << "\n\t\tWatermark                 : " << water_mark_;
-                        throw ex;
-                    }
-                }
-                block = memory_blocks_.allocate(this, std::forward<PointerTArgs>(args)...);
-                ++allocated_;
+            if constexpr (thread_safe) {
+                cache->addInUse(1);
             }
             return block->ref_count;
         }
@@ -454,9 +653,27 @@ namespace sparta
          * in the future.
          */
         void releaseBlock_(void * block) override {
-            sparta_assert(free_idx_ < free_blocks_.capacity());
-            free_blocks_[free_idx_] = static_cast<MemBlock *>(block);
-            ++free_idx_;
+            if constexpr (thread_safe) {
+                ThreadCache & cache = getThreadCache_();
+                cache.blocks.push_back(static_cast<MemBlock *>(block));
+                if(SPARTA_EXPECT_FALSE(cache.blocks.size() > THREAD_CACHE_SIZE))
+                {
+                    // Share the older half with the other threads
+                    const auto half = cache.blocks.begin() + THREAD_CACHE_SIZE / 2;
+                    {
+                        std::lock_guard<std::recursive_mutex> guard(pool_->mutex);
+                        pool_->free_blocks.insert(pool_->free_blocks.end(),
+                                                  cache.blocks.begin(), half);
+                    }
+                    cache.blocks.erase(cache.blocks.begin(), half);
+                }
+                cache.addInUse(-1);
+            }
+            else {
+                sparta_assert(free_idx_ < free_blocks_.capacity());
+                free_blocks_[free_idx_] = static_cast<MemBlock *>(block);
+                ++free_idx_;
+            }
         }
 
         MemBlockVector           memory_blocks_;
@@ -467,8 +684,18 @@ namespace sparta
         bool                     water_mark_warning_ = false;
         WaterMarkWarningCallback watermark_warning_callback_;
         OverAllocationCallback   over_allocation_callback_;
+
+        // Thread-safe allocator only
+        static inline std::atomic<uint64_t> next_id_{0};
+        const uint64_t              id_ = next_id_.fetch_add(1, std::memory_order_relaxed);
+        std::shared_ptr<SharedPool> pool_;
     };
 
+    //! A thread-safe SpartaSharedPointerAllocator that hands out
+    //! SpartaAtomicSharedPointer objects
+    template<class PointerT>
+    using SpartaAtomicSharedPointerAllocator = SpartaSharedPointerAllocator<PointerT, AtomicRefCount>;
+
     /**
      * \brief Allocate a SpartaSharedPointer
      * \tparam PointerT The pointer type to allocate
@@ -480,15 +707,15 @@ namespace sparta
      *
      * See SpartaSharedPointerAllocator for example usage
      */
-    template<typename PointerT, typename... Args>
-    SpartaSharedPointer<PointerT>
-    allocate_sparta_shared_pointer(SpartaSharedPointerAllocator<PointerT> & alloc,
+    template<typename PointerT, typename RefCountPolicy, typename... Args>
+    SpartaSharedPointer<PointerT, RefCountPolicy>
+    allocate_sparta_shared_pointer(SpartaSharedPointerAllocator<PointerT, RefCountPolicy> & alloc,
                                    Args&&...args)
     {
         static_assert(std::is_constructible<PointerT, Args...>::value,
                       "Can't construct object in allocate_sparta_shared_pointer with the arguments given");
 
-        SpartaSharedPointer<PointerT> ptr(alloc.allocate_(std::forward<Args>(args)...));
+        SpartaSharedPointer<PointerT, RefCountPolicy> ptr(alloc.allocate_(std::forward<Args>(args)...));
         return ptr;
     }
 
@@ -10,7 +10,7 @@ namespace sparta
     // (SpartaSharedPointer) of the base type is being reclaimed via
     // an allocator, we want to steer that deallocation to the correct
     // deallocator.
-    template <class PointerT>
+    template <class PointerT, class RefCountPolicy>
     class SpartaSharedPointer;
 
     //! Base class for the Allocator -- typeless and allows releasing
@@ -25,7 +25,7 @@ namespace sparta
             BaseAllocator * const alloc = nullptr;
         };
 
-        template<class PointerT>
+        template<class PointerT, class RefCountPolicy>
         friend class SpartaSharedPointer;
 
     protected:
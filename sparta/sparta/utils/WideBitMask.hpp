@@ -0,0 +1,381 @@
+// <WideBitMask.hpp> -*- C++ -*-
+
+/**
+ * \file WideBitMask.hpp
+ * \brief A fixed size bit mask, many words wide, with vectorized operations
+ */
+
+#pragma once
+
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <ostream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "sparta/utils/SpartaAssert.hpp"
+
+namespace sparta {
+    namespace utils {
+
+        /*!
+         * \class WideBitMask
+         * \brief A bit mask whose size is known at compile time, meant
+         *        for masks of hundreds of bits such as register
+         *        scoreboards
+         * \tparam NumBits The number of bits, a multiple of 64
+         *
+         * The interface follows std::bitset, so it can stand in for
+         * one.  The bitwise operations and the any/all/none tests work
+         * on 256 bits at a time when the compiler targets AVX2
+         * (e.g. -mavx2 or -march=native), 128 bits at a time with SSE2,
+         * and a word at a time otherwise.
+         *
+         * containsAll and intersects test one mask against another
+         * without building the intermediate mask that the equivalent
+         * std::bitset expressions need.
+         */
+        template<uint32_t NumBits>
+        class WideBitMask
+        {
+            static_assert(NumBits > 0 && (NumBits % 64) == 0,
+                          "A WideBitMask must be a whole number of 64-bit words");
+
+        public:
+            //! The number of 64-bit words in the mask
+            static constexpr uint32_t NUM_WORDS = NumBits / 64;
+
+            //! A reference to a single bit, like std::bitset::reference
+            class reference
+            {
+            public:
+                operator bool() const {
+                    return mask_->test(pos_);
+                }
+
+                reference & operator=(bool val) {
+                    mask_->set(pos_, val);
+                    return *this;
+                }
+
+                reference & operator=(const reference & other) {
+                    return operator=(bool(other));
+                }
+
+            private:
+                friend WideBitMask;
+
+                reference(WideBitMask * mask, uint32_t pos) : mask_(mask), pos_(pos) { }
+
+                WideBitMask * mask_;
+                uint32_t pos_;
+            };
+
+            //! Construct a mask with all bits clear
+            constexpr WideBitMask() = default;
+
+            //! Construct a mask from the lowest 64 bits
+            constexpr WideBitMask(uint64_t value) {
+                words_[0] = value;
+            }
+
+            //! \return The number of bits in the mask
+            constexpr size_t size() const {
+                return NumBits;
+            }
+
+            //! \return The value of the bit at pos
+            bool test(size_t pos) const {
+                sparta_assert(pos < NumBits, "Bit " << pos << " is outside a mask of " << NumBits);
+                return (words_[pos / 64] >> (pos % 64)) & 1;
+            }
+
+            bool operator[](size_t pos) const {
+                return test(pos);
+            }
+
+            reference operator[](size_t pos) {
+                sparta_assert(pos < NumBits, "Bit " << pos << " is outside a mask of " << NumBits);
+                return reference(this, pos);
+            }
+
+            //! Set all bits
+            WideBitMask & set() {
+                for(auto & word : words_) {
+                    word = ~0ull;
+                }
+                return *this;
+            }
+
+            //! Set (or clear) the bit at pos
+            WideBitMask & set(size_t pos, bool val = true) {
+                sparta_assert(pos < NumBits, "Bit " << pos << " is outside a mask of " << NumBits);
+                const uint64_t bit = 1ull << (pos % 64);
+                if(val) {
+                    words_[pos / 64] |= bit;
+                }
+                else {
+                    words_[pos / 64] &= ~bit;
+                }
+                return *this;
+            }
+
+            //! Clear all bits
+            WideBitMask & reset() {
+                for(auto & word : words_) {
+                    word = 0;
+                }
+                return *this;
+            }
+
+            //! Clear the bit at pos
+            WideBitMask & reset(size_t pos) {
+                return set(pos, false);
+            }
+
+            //! \return true if any bit is set
+            bool any() const {
+                return anyOf_<OrOp>(words_, words_);
+            }
+
+            //! \return true if no bit is set
+            bool none() const {
+                return !any();
+            }
+
+            //! \return true if every bit is set
+            bool all() const {
+                return !anyOf_<AndNotOp>(words_, ONES_.data());
+            }
+
+            //! \return The number of bits set
+            size_t count() const {
+                size_t num_set = 0;
+                for(const auto word : words_) {
+                    num_set += __builtin_popcountll(word);
+                }
+                return num_set;
+            }
+
+            //! \return true if every bit set in bits is set in this mask
+            bool containsAll(const WideBitMask & bits) const {
+                return !anyOf_<AndNotOp>(words_, bits.words_);
+            }
+
+            //! \return true if any bit set in bits is set in this mask
+            bool intersects(const WideBitMask & bits) const {
+                return anyOf_<AndOp>(words_, bits.words_);
+            }
+
+            //! \return The lowest set bit, or size() if none is set
+            size_t findFirst() const {
+                return findFrom_(0);
+            }
+
+            //! \return The lowest set bit above pos, or size() if none is
+            size_t findNext(size_t pos) const {
+                return findFrom_(pos + 1);
+            }
+
+            //! \return The idx'th 64-bit word of the mask, bit 0 lowest
+            uint64_t getWord(uint32_t idx) const {
+                sparta_assert(idx < NUM_WORDS);
+                return words_[idx];
+            }
+
+            WideBitMask & operator&=(const WideBitMask & other) {
+                combine_<AndOp>(words_, other.words_, words_);
+                return *this;
+            }
+
+            WideBitMask & operator|=(const WideBitMask & other) {
+                combine_<OrOp>(words_, other.words_, words_);
+                return *this;
+            }
+
+            WideBitMask & operator^=(const WideBitMask & other) {
+                combine_<XorOp>(words_, other.words_, words_);
+                return *this;
+            }
+
+            WideBitMask operator~() const {
+                WideBitMask res;
+                combine_<AndNotOp>(words_, ONES_.data(), res.words_);
+                return res;
+            }
+
+            friend WideBitMask operator&(const WideBitMask & lhs, const WideBitMask & rhs) {
+                WideBitMask res;
+                combine_<AndOp>(lhs.words_, rhs.words_, res.words_);
+                return res;
+            }
+
+            friend WideBitMask operator|(const WideBitMask & lhs, const WideBitMask & rhs) {
+                WideBitMask res;
+                combine_<OrOp>(lhs.words_, rhs.words_, res.words_);
+                return res;
+            }
+
+            friend WideBitMask operator^(const WideBitMask & lhs, const WideBitMask & rhs) {
+                WideBitMask res;
+                combine_<XorOp>(lhs.words_, rhs.words_, res.words_);
+                return res;
+            }
+
+            bool operator==(const WideBitMask & other) const {
+                return !anyOf_<XorOp>(words_, other.words_);
+            }
+
+            bool operator!=(const WideBitMask & other) const {
+                return !operator==(other);
+            }
+
+            //! Print the bits highest first, like std::bitset
+            friend std::ostream & operator<<(std::ostream & os, const WideBitMask & mask) {
+                for(size_t pos = NumBits; pos > 0; --pos) {
+                    os << (mask.test(pos - 1) ? '1' : '0');
+                }
+                return os;
+            }
+
+        private:
+            // The operations, a word, an SSE register and an AVX
+            // register at a time.  AndNotOp is (~lhs & rhs).
+            struct AndOp {
+                static uint64_t word(uint64_t lhs, uint64_t rhs) { return lhs & rhs; }
+#if defined(__SSE2__)
+                static __m128i vec(__m128i lhs, __m128i rhs) { return _mm_and_si128(lhs, rhs); }
+#endif
+#if defined(__AVX2__)
+                static __m256i vec(__m256i lhs, __m256i rhs) { return _mm256_and_si256(lhs, rhs); }
+#endif
+            };
+
+            struct OrOp {
+                static uint64_t word(uint64_t lhs, uint64_t rhs) { return lhs | rhs; }
+#if defined(__SSE2__)
+                static __m128i vec(__m128i lhs, __m128i rhs) { return _mm_or_si128(lhs, rhs); }
+#endif
+#if defined(__AVX2__)
+                static __m256i vec(__m256i lhs, __m256i rhs) { return _mm256_or_si256(lhs, rhs); }
+#endif
+            };
+
+            struct XorOp {
+                static uint64_t word(uint64_t lhs, uint64_t rhs) { return lhs ^ rhs; }
+#if defined(__SSE2__)
+                static __m128i vec(__m128i lhs, __m128i rhs) { return _mm_xor_si128(lhs, rhs); }
+#endif
+#if defined(__AVX2__)
+                static __m256i vec(__m256i lhs, __m256i rhs) { return _mm256_xor_si256(lhs, rhs); }
+#endif
+            };
+
+            struct AndNotOp {
+                static uint64_t word(uint64_t lhs, uint64_t rhs) { return ~lhs & rhs; }
+#if defined(__SSE2__)
+                static __m128i vec(__m128i lhs, __m128i rhs) { return _mm_andnot_si128(lhs, rhs); }
+#endif
+#if defined(__AVX2__)
+                static __m256i vec(__m256i lhs, __m256i rhs) { return _mm256_andnot_si256(lhs, rhs); }
+#endif
+            };
+
+            // res = OpT(lhs, rhs), word by word
+            template<class OpT>
+            static void combine_(const uint64_t * lhs, const uint64_t * rhs, uint64_t * res)
+            {
+                uint32_t idx = 0;
+#if defined(__AVX2__)
+                for(; idx + 4 <= NUM_WORDS; idx += 4) {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(res + idx),
+                                        OpT::vec(load256_(lhs + idx), load256_(rhs + idx)));
+                }
+#endif
+#if defined(__SSE2__)
+                for(; idx + 2 <= NUM_WORDS; idx += 2) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(res + idx),
+                                     OpT::vec(load128_(lhs + idx), load128_(rhs + idx)));
+                }
+#endif
+                for(; idx < NUM_WORDS; ++idx) {
+                    res[idx] = OpT::word(lhs[idx], rhs[idx]);
+                }
+            }
+
+            // Is any bit of OpT(lhs, rhs) set?
+            template<class OpT>
+            static bool anyOf_(const uint64_t * lhs, const uint64_t * rhs)
+            {
+                uint32_t idx = 0;
+                uint64_t found = 0;
+#if defined(__AVX2__)
+                if constexpr (NUM_WORDS >= 4) {
+                    __m256i acc = _mm256_setzero_si256();
+                    for(; idx + 4 <= NUM_WORDS; idx += 4) {
+                        acc = _mm256_or_si256(acc, OpT::vec(load256_(lhs + idx), load256_(rhs + idx)));
+                    }
+                    found = !_mm256_testz_si256(acc, acc);
+                }
+#endif
+#if defined(__SSE2__)
+                if constexpr (NUM_WORDS >= 2) {
+                    __m128i acc = _mm_setzero_si128();
+                    for(; idx + 2 <= NUM_WORDS; idx += 2) {
+                        acc = _mm_or_si128(acc, OpT::vec(load128_(lhs + idx), load128_(rhs + idx)));
+                    }
+                    found |= (_mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) != 0xffff);
+                }
+#endif
+                for(; idx < NUM_WORDS; ++idx) {
+                    found |= OpT::word(lhs[idx], rhs[idx]);
+                }
+                return found != 0;
+            }
+
+#if defined(__AVX2__)
+            static __m256i load256_(const uint64_t * words) {
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words));
+            }
+#endif
+#if defined(__SSE2__)
+            static __m128i load128_(const uint64_t * words) {
+                return _mm_loadu_si128(reinterpret_cast<const __m128i *>(words));
+            }
+#endif
+
+            size_t findFrom_(size_t pos) const
+            {
+                if(pos >= NumBits) {
+                    return NumBits;
+                }
+                uint32_t idx = pos / 64;
+                uint64_t word = words_[idx] & (~0ull << (pos % 64));
+                while(word == 0) {
+                    if(++idx == NUM_WORDS) {
+                        return NumBits;
+                    }
+                    word = words_[idx];
+                }
+                return (idx * 64) + __builtin_ctzll(word);
+            }
+
+            // All bits set, for all() and operator~
+            static constexpr std::array<uint64_t, NUM_WORDS> ONES_ = [] {
+                std::array<uint64_t, NUM_WORDS> ones{};
+                for(auto & word : ones) {
+                    word = ~0ull;
+                }
+                return ones;
+            }();
+
+            uint64_t words_[NUM_WORDS] = {};
+        };
+
+    } // namespace utils
+} // namespace sparta
@@ -9,6 +9,7 @@
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <zlib.h>
 
 #include "sparta/pipeViewer/Outputter.hpp"
 #include "sparta/utils/SpartaAssert.hpp"
@@ -18,14 +19,21 @@
 // #define PIPELINE_DBG 1
 namespace sparta::pipeViewer
 {
-    Outputter::Outputter(const std::string& filepath, const uint64_t interval) :
+    Outputter::Outputter(const std::string& filepath, const uint64_t interval,
+                         bool background_writer, std::size_t block_bytes, uint32_t max_blocks,
+                         bool compress) :
         record_file_(filepath + "record.bin", std::fstream::out | std::fstream::binary),
         index_file_(filepath + "index.bin", std::fstream::out | std::fstream::binary),
         map_file_(filepath + "map.dat", std::ios::out),
         data_file_(filepath + "data.dat", std::ios::out),
         string_file_(filepath + "string_map.dat", std::ios::out),
         display_format_file_(filepath + "display_format.dat", std::ios::out),
-        last_record_pos_(0)
+        last_record_pos_(0),
+        background_(background_writer),
+        compress_(compress),
+        buffered_(background_writer || compress),
+        block_bytes_(block_bytes),
+        max_blocks_(max_blocks)
     {
         // Make sure the files opened correctly!
         sparta_assert(index_file_.is_open() && record_file_.is_open(),
@@ -35,10 +43,18 @@ namespace sparta::pipeViewer
         // Throw on write failure
         record_file_.exceptions(std::ostream::eofbit | std::ostream::badbit | std::ostream::failbit | std::ostream::goodbit);
         index_file_.exceptions(std::ostream::eofbit | std::ostream::badbit | std::ostream::failbit | std::ostream::goodbit);
+        if(compress_) {
+            chunk_file_.open(filepath + "chunk.bin", std::fstream::out | std::fstream::binary);
+            sparta_assert(chunk_file_.is_open(),
+                          "Failed to open the chunk index for pipeline collection at filepath: "
+                          "FILEPATH+PREFIX=" << filepath);
+            chunk_file_.exceptions(std::ostream::eofbit | std::ostream::badbit | std::ostream::failbit | std::ostream::goodbit);
+        }
         // Write the index file version first. The index file should naturally skip this
         // Do not 0-pad the version number - it will be cast from a string to an int
         std::ostringstream t;
-        t << HEADER_PREFIX << std::setw(VERSION_LENGTH) << FILE_VERSION << '\n';
+        t << HEADER_PREFIX << std::setw(VERSION_LENGTH)
+          << (compress_ ? COMPRESSED_FILE_VERSION : UNCOMPRESSED_FILE_VERSION) << '\n';
         const std::string header = t.str();
         sparta_assert(header.size() == HEADER_SIZE); // Do not change the header format
         static_assert(sizeof(transaction_t) == 48,
@@ -49,8 +65,41 @@ namespace sparta::pipeViewer
         // Notice that we write the interval offset first.
         writeData_(index_file_, interval);
         index_file_.flush();
+
+        if(buffered_) {
+            sparta_assert(block_bytes_ > 0 && max_blocks_ > 0);
+            block_.records.reserve(block_bytes_);
+        }
+        if(background_) {
+            writer_ = std::thread(&Outputter::writerLoop_, this);
+        }
     }
     Outputter::~Outputter(){
+        if(background_) {
+            // Hand over what is left without waiting on the queue bound;
+            // the writer drains the queue before it stops
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if(!block_.records.empty() || !block_.index.empty()) {
+                    full_.emplace_back(std::move(block_));
+                }
+                stop_ = true;
+            }
+            writer_cv_.notify_one();
+            writer_.join();
+
+            if(writer_error_) {
+                try {
+                    checkWriterError_();
+                }
+                catch(std::exception& e) {
+                    std::cerr << "Warning: " << e.what() << std::endl;
+                }
+            }
+        }
+        else if(compress_) {
+            writeBlock_(block_);
+        }
         //Write an index for the end of the record file, so that the last record
         //is always easily accessable reguardless of indexing.
         writeData_(index_file_, last_record_pos_);
@@ -63,11 +112,140 @@ namespace sparta::pipeViewer
         data_file_.close();
         string_file_.close();
         display_format_file_.close();
+        chunk_file_.close();
         std::cout << "The outputter is done destructing." << std::endl;
     }
     void Outputter::writeIndex(){
-        const uint64_t current_record_pos = record_file_.tellp();
+        const uint64_t current_record_pos = record_pos_;
+        if(buffered_) {
+            block_.index.append(reinterpret_cast<const char*>(&current_record_pos),
+                                sizeof(current_record_pos));
+            if(compress_) {
+                endChunk_();
+            }
+            return;
+        }
         writeData_(index_file_, current_record_pos);
         index_file_.flush();
     }
+
+    uint64_t Outputter::getNumBlocksWritten() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return num_written_;
+    }
+
+    void Outputter::queueBlock_()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        producer_cv_.wait(lock, [this]() {
+            return full_.size() < max_blocks_ || writer_error_;
+        });
+        checkWriterError_();
+
+        full_.emplace_back(std::move(block_));
+        if(!spare_.empty()) {
+            block_ = std::move(spare_.back());
+            spare_.pop_back();
+        }
+        else {
+            block_ = Block();
+            block_.records.reserve(block_bytes_);
+        }
+        writer_cv_.notify_one();
+    }
+
+    void Outputter::endChunk_()
+    {
+        if(background_) {
+            queueBlock_();
+            return;
+        }
+        writeBlock_(block_);
+        block_.records.clear();
+        block_.index.clear();
+    }
+
+    void Outputter::writeBlock_(const Block& block)
+    {
+        if(!compress_) {
+            writeData_(record_file_, block.records.data(), block.records.size());
+            writeData_(index_file_, block.index.data(), block.index.size());
+            return;
+        }
+
+        if(!block.records.empty()) {
+            uLongf compressed_size = compressBound(block.records.size());
+            compressed_.resize(compressed_size);
+            const int ret = compress2(reinterpret_cast<Bytef*>(compressed_.data()), &compressed_size,
+                                      reinterpret_cast<const Bytef*>(block.records.data()),
+                                      block.records.size(), Z_BEST_SPEED);
+            if(ret != Z_OK) {
+                throw SpartaException("Failed to compress pipeline collection records: zlib error ")
+                    << ret;
+            }
+            writeData_(record_file_, compressed_.data(), compressed_size);
+
+            chunk_.size = block.records.size();
+            chunk_.compressed_size = compressed_size;
+            // Index entries only ever point at records which are
+            // already in the record file
+            record_file_.flush();
+            writeData_(chunk_file_, chunk_);
+            chunk_file_.flush();
+            chunk_.record_pos += chunk_.size;
+            chunk_.file_pos += chunk_.compressed_size;
+        }
+        writeData_(index_file_, block.index.data(), block.index.size());
+        index_file_.flush();
+    }
+
+    void Outputter::checkWriterError_() const
+    {
+        if(writer_error_) {
+            try {
+                std::rethrow_exception(writer_error_);
+            }
+            catch(std::exception& e) {
+                throw SpartaException("Pipeline collection background writer failed: ") << e.what();
+            }
+        }
+    }
+
+    void Outputter::writerLoop_()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while(true)
+        {
+            writer_cv_.wait(lock, [this]() {
+                return stop_ || !full_.empty();
+            });
+            if(full_.empty()) {
+                return; // Stopped, with everything written
+            }
+
+            Block block = std::move(full_.front());
+            full_.pop_front();
+            lock.unlock();
+
+            try {
+                writeBlock_(block);
+            }
+            catch(...) {
+                lock.lock();
+                writer_error_ = std::current_exception();
+                producer_cv_.notify_all();
+                return;
+            }
+
+            block.records.clear();
+            block.index.clear();
+            lock.lock();
+            ++num_written_;
+            if(spare_.size() < max_blocks_) {
+                spare_.emplace_back(std::move(block));
+            }
+            producer_cv_.notify_one();
+        }
+    }
 }//namespace sparta::pipeViewer
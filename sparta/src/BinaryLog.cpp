@@ -0,0 +1,265 @@
+// <BinaryLog.cpp> -*- C++ -*-
+
+
+/*!
+ * \file BinaryLog.cpp
+ * \brief Writing and reading the binary log format
+ */
+
+#include "sparta/log/BinaryLog.hpp"
+
+#include <cstring>
+#include <sstream>
+
+#include "sparta/app/SimulationInfo.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/utils/SpartaException.hpp"
+
+namespace sparta {
+    namespace log {
+
+namespace {
+
+void putVarint(std::vector<char>& out, uint64_t val)
+{
+    while(val >= 0x80){
+        out.push_back(char((val & 0x7f) | 0x80));
+        val >>= 7;
+    }
+    out.push_back(char(val));
+}
+
+bool getByte(std::istream& in, char& c)
+{
+    return static_cast<bool>(in.get(c));
+}
+
+uint64_t getVarint(std::istream& in)
+{
+    uint64_t val = 0;
+    for(uint32_t shift = 0; shift < 64; shift += 7){
+        char c;
+        if(!getByte(in, c)){
+            throw SpartaException("Binary log is truncated");
+        }
+        val |= uint64_t(uint8_t(c) & 0x7f) << shift;
+        if((uint8_t(c) & 0x80) == 0){
+            return val;
+        }
+    }
+    throw SpartaException("Binary log has a malformed integer");
+}
+
+void getString(std::istream& in, std::string& str)
+{
+    const uint64_t len = getVarint(in);
+    str.resize(len);
+    if(len > 0 && !in.read(&str[0], len)){
+        throw SpartaException("Binary log is truncated");
+    }
+}
+
+} // namespace
+
+BinaryFormatter::BinaryFormatter(std::ostream& stream) :
+    Formatter(stream)
+{
+    stream_.write(MAGIC, sizeof(MAGIC) - 1);
+    stream_.put(char(VERSION));
+}
+
+void BinaryFormatter::write(const sparta::log::Message& msg)
+{
+    const uint32_t location_id = getLocationID_(msg.info.origin);
+    const uint32_t category_id = getCategoryID_(msg.info.category);
+
+    record_.clear();
+    record_.push_back(RECORD_MESSAGE);
+    putVarint(record_, location_id);
+    putVarint(record_, category_id);
+    putVarint(record_, msg.info.sim_time);
+    const Clock* clk = msg.info.origin.getClock();
+    putVarint(record_, clk ? clk->currentCycle() + 1 : 0);
+    char wall_time[sizeof(MessageInfo::wall_time_type)];
+    std::memcpy(wall_time, &msg.info.wall_time, sizeof(wall_time));
+    record_.insert(record_.end(), wall_time, wall_time + sizeof(wall_time));
+    putVarint(record_, msg.info.thread_id);
+    putVarint(record_, uint64_t(msg.info.seq_num));
+    putVarint(record_, msg.content.size());
+    stream_.write(record_.data(), record_.size());
+    stream_.write(msg.content.data(), msg.content.size());
+}
+
+void BinaryFormatter::writeHeader(const SimulationInfo& sim_info)
+{
+    std::stringstream ss;
+    sim_info.write(ss, "#", "\n");
+    writeString_(RECORD_HEADER, ss.str());
+}
+
+uint32_t BinaryFormatter::getLocationID_(const TreeNode& origin)
+{
+    // Nodes can't move once their tree is built, so their location can
+    // be remembered.  Before that, look it up every time.
+    if(SPARTA_EXPECT_TRUE(origin.isBuilt())){
+        auto itr = node_location_ids_.find(origin.getNodeUID());
+        if(SPARTA_EXPECT_TRUE(itr != node_location_ids_.end())){
+            return itr->second;
+        }
+        const uint32_t id = internLocation_(origin.getLocation());
+        node_location_ids_[origin.getNodeUID()] = id;
+        return id;
+    }
+    return internLocation_(origin.getLocation());
+}
+
+uint32_t BinaryFormatter::internLocation_(const std::string& location)
+{
+    auto result = location_ids_.emplace(location, uint32_t(location_ids_.size()));
+    if(result.second){
+        writeString_(RECORD_LOCATION, location);
+    }
+    return result.first->second;
+}
+
+uint32_t BinaryFormatter::getCategoryID_(const std::string* category)
+{
+    auto result = category_ids_.emplace(category, uint32_t(category_ids_.size()));
+    if(SPARTA_EXPECT_FALSE(result.second)){
+        writeString_(RECORD_CATEGORY, *category);
+    }
+    return result.first->second;
+}
+
+void BinaryFormatter::writeString_(RecordType type, const std::string& str)
+{
+    record_.clear();
+    record_.push_back(type);
+    putVarint(record_, str.size());
+    stream_.write(record_.data(), record_.size());
+    stream_.write(str.data(), str.size());
+}
+
+BinaryLogReader::BinaryLogReader(std::istream& in) :
+    in_(in)
+{
+    char magic[sizeof(BinaryFormatter::MAGIC) - 1];
+    char version = 0;
+    if(!in_.read(magic, sizeof(magic)) ||
+       std::memcmp(magic, BinaryFormatter::MAGIC, sizeof(magic)) != 0){
+        throw SpartaException("Not a sparta binary log");
+    }
+    if(!getByte(in_, version) || uint8_t(version) != BinaryFormatter::VERSION){
+        throw SpartaException("Unsupported sparta binary log version: ") << int(uint8_t(version));
+    }
+}
+
+bool BinaryLogReader::next()
+{
+    char type;
+    while(getByte(in_, type)){
+        switch(type){
+        case BinaryFormatter::RECORD_HEADER: {
+            std::string header;
+            getString(in_, header);
+            header_ += header;
+            break;
+        }
+        case BinaryFormatter::RECORD_LOCATION:
+            locations_.emplace_back();
+            getString(in_, locations_.back());
+            break;
+        case BinaryFormatter::RECORD_CATEGORY:
+            categories_.emplace_back();
+            getString(in_, categories_.back());
+            break;
+        case BinaryFormatter::RECORD_MESSAGE: {
+            location_id_ = getVarint(in_);
+            category_id_ = getVarint(in_);
+            if(location_id_ >= locations_.size() || category_id_ >= categories_.size()){
+                throw SpartaException("Binary log refers to an undefined location or category");
+            }
+            fields_.sim_time = getVarint(in_);
+            const uint64_t cycle = getVarint(in_);
+            fields_.has_cycle = cycle != 0;
+            fields_.cycle = fields_.has_cycle ? cycle - 1 : 0;
+            char wall_time[sizeof(MessageInfo::wall_time_type)];
+            if(!in_.read(wall_time, sizeof(wall_time))){
+                throw SpartaException("Binary log is truncated");
+            }
+            std::memcpy(&fields_.wall_time, wall_time, sizeof(wall_time));
+            fields_.thread_id = getVarint(in_);
+            fields_.seq_num = seq_num_type(getVarint(in_));
+            getString(in_, content_);
+            fields_.location = &locations_[location_id_];
+            fields_.category = &categories_[category_id_];
+            fields_.content = &content_;
+            return true;
+        }
+        default:
+            throw SpartaException("Binary log has an unknown record type: ") << int(uint8_t(type));
+        }
+    }
+    return false;
+}
+
+bool BinaryLogFilter::matches(const BinaryLogReader& reader)
+{
+    const MessageFields& fields = reader.getMessage();
+    if(fields.sim_time < start_ || fields.sim_time > end_){
+        return false;
+    }
+
+    // Each location and category is only matched against the patterns once
+    auto lookup = [](std::vector<uint8_t>& results, uint32_t id, auto match) {
+        if(id >= results.size()){
+            results.resize(id + 1, 0);
+        }
+        if(results[id] == 0){
+            results[id] = match() ? 2 : 1;
+        }
+        return results[id] == 2;
+    };
+    if(!location_patterns_.empty() &&
+       !lookup(location_matches_, reader.getLocationID(),
+               [&]() { return matchesLocation_(*fields.location); })){
+        return false;
+    }
+    if(!category_patterns_.empty() &&
+       !lookup(category_matches_, reader.getCategoryID(),
+               [&]() { return matchesCategory_(*fields.category); })){
+        return false;
+    }
+    return true;
+}
+
+bool BinaryLogFilter::matchesLocation_(const std::string& location) const
+{
+    for(const std::string& pattern : location_patterns_){
+        // Try the location and each of its ancestors
+        size_t end = location.size();
+        while(true){
+            if(TreeNode::matchesGlobLike(pattern, location.substr(0, end))){
+                return true;
+            }
+            end = location.rfind('.', end - 1);
+            if(end == std::string::npos || end == 0){
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+bool BinaryLogFilter::matchesCategory_(const std::string& category) const
+{
+    for(const std::string& pattern : category_patterns_){
+        if(TreeNode::matchesGlobLike(pattern, category)){
+            return true;
+        }
+    }
+    return false;
+}
+
+    } // namespace log
+} // namespace sparta
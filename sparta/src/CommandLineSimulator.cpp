@@ -95,6 +95,11 @@ void showLoggingHelp()
                  "below for a particular type of formatting:\n"
               << std::endl;
     sparta::log::DestinationManager::dumpFileExtensions(std::cout, true);
+    std::cout << "\n  A filename prefixed with \"" << sparta::log::ASYNC_DEST_PREFIX
+              << "\" (e.g. \"" << sparta::log::ASYNC_DEST_PREFIX << "core0_all.log\") is written\n"
+                 "  by a background thread and flushed only every --log-flush-interval ms, at the\n"
+                 "  end of the run, and on errors. Use this for heavy (e.g. debug) logging.\n"
+              << std::endl;
 }
 
 void showConfigHelp()
@@ -380,6 +385,16 @@ CommandLineSimulator::CommandLineSimulator(const std::string& usage,
         ("heartbeat",
          named_value<std::string>("HEARTBEAT", &pipeline_heartbeat_)->default_value(pipeline_heartbeat_),
          heartbeat_doc.str().c_str())
+        ("pipeline-writer-thread",
+         "Write the pipeline collection files from a background thread, in large blocks, instead "
+         "of on the simulation thread as each transaction ends. The files are the same either way. "
+         "Only applies with --pipeline-collection",
+         "Write pipeline collection files from a background thread") // Brief
+        ("pipeline-compress",
+         "Write the pipeline collection record file as zlib-compressed chunks, one per heartbeat, "
+         "with a chunk index for seeking. The pipeout is written as format version 3, which older "
+         "pipeViewer versions cannot read. Only applies with --pipeline-collection",
+         "Compress the pipeline collection record file") // Brief
         ;
 
     std::stringstream arch_search_dirs_str;
@@ -491,12 +506,18 @@ CommandLineSimulator::CommandLineSimulator(const std::string& usage,
          "that watches for messages having the category CATEGORY. Matching messages from those "
          "node's subtree are written to the filename in DEST. DEST may also be '1' to refer to "
          "stdout and '2' to refer to cerr. Any number of taps can be added anywhere in the device "
-         "tree. An error is generated if PATTERN does not refer to a 1 or more nodes. Use "
-         "--help for more details\n"
+         "tree. An error is generated if PATTERN does not refer to a 1 or more nodes. Prefixing "
+         "DEST with 'async:' writes the file from a background thread (see --log-flush-interval). "
+         "Use --help for more details\n"
          "Example: \"--log top.core0 warning core0_warnings.log\"",
          "Example: \"--log top.core0 '*' core0_all.log\"",
          "Attaches logging tap(s) at nodes matching a location pattern. Directs output matching "
          "category to destination") // Brief
+        ("log-flush-interval",
+         named_value<std::vector<std::string>>("MS", 1, 1),
+         "Longest time in milliseconds that asynchronous log destinations (DEST prefixed with "
+         "'async:' in --log) hold messages before writing and flushing them. Default is 1000\n"
+         "Example: \"--log-flush-interval 250\"")
         ("warn-file",
          named_value<std::string>("FILENAME", &sim_config_.warnings_file),
          "Filename to which warnings from the simulator will be logged. This file will be "
@@ -1113,6 +1134,20 @@ bool CommandLineSimulator::parse(int argc,
                 }
                 sim_config_.setMemoryUsageDefFile(def_file);
                 opts.options.erase(opts.options.begin() + i);
+            }else if (o.string_key == "log-flush-interval") {
+                size_t end_pos;
+                uint64_t interval_ms = 0;
+                try {
+                    interval_ms = utils::smartLexicalCast<uint64_t>(o.value.at(0), end_pos);
+                } catch (...) {
+                    throw SpartaException("log-flush-interval must take an integer value, not \"")
+                        << o.value.at(0) << "\"";
+                }
+                if(interval_ms == 0){
+                    throw SpartaException("log-flush-interval must be greater than 0");
+                }
+                sparta::log::AsyncDestination::setDefaultFlushInterval(std::chrono::milliseconds(interval_ms));
+                opts.options.erase(opts.options.begin() + i);
             }else if (o.string_key == "report-verif-output-dir") {
                 db::ReportVerifier::writeVerifResultsTo(o.value[0]);
                 opts.options.erase(opts.options.begin() + i);
@@ -1730,6 +1765,8 @@ bool CommandLineSimulator::parse(int argc,
     }
 
     sim_config_.validate_post_run = vm_.count("validate-post-run") > 0;
+    sim_config_.pipeline_writer_thread = vm_.count("pipeline-writer-thread") > 0;
+    sim_config_.pipeline_compress = vm_.count("pipeline-compress") > 0;
 
     if (!sim_config_.parsed_path_to_retired_inst_counter_.empty()) {
         sim_config_.path_to_retired_inst_counter.first =
@@ -1892,6 +1929,8 @@ bool CommandLineSimulator::parse(int argc,
         if(collecting){
             std::cout << "  output dir:          " << sim_config_.pipeline_collection_file_prefix << std::endl;
             std::cout << "  pipeline heartbeat:  " << pipeline_heartbeat_ << std::endl;
+            std::cout << "  writer thread:       " << std::boolalpha << sim_config_.pipeline_writer_thread << std::endl;
+            std::cout << "  compressed:          " << std::boolalpha << sim_config_.pipeline_compress << std::endl;
         }
     }
 
@@ -2107,7 +2146,9 @@ void CommandLineSimulator::populateSimulation_(Simulation* sim)
                                                                        heartbeat,
                                                                        multiple_triggers,
                                                                        sim->getRootClock(),
-                                                                       sim->getRoot()));
+                                                                       sim->getRoot(),
+                                                                       sim_config_.pipeline_writer_thread,
+                                                                       sim_config_.pipeline_compress));
 
             // If pipeline collection is turned on begin writing an info file
             // about the simulation.
@@ -11,7 +11,9 @@
 #include <fstream>
 #include <iomanip>
 #include <ostream>
+#include <sstream>
 
+#include "sparta/log/BinaryLog.hpp"
 #include "sparta/simulation/Clock.hpp"
 
 namespace sparta {
@@ -34,6 +36,12 @@ const Formatter::Info FMTLIST[] = {
       "verbose formatter. Contains no message meta-data",
       [](std::ostream& s) -> sparta::log::Formatter* { return new sparta::log::RawFormatter(s); } },
 
+    /*! Compact binary. Decode with sparta_log_decode */
+    { ".log.bin",
+      "binary formatter. Contains all message data in a compact form which is not flushed per "
+      "message. Use sparta_log_decode to convert to text",
+      [](std::ostream& s) -> sparta::log::Formatter* { return new sparta::log::BinaryFormatter(s); } },
+
     /*! Writes all content to HTML table */
     /*{ ".log.html",  "html formatting. Contains all message data",
       [](std::ofstream& s) -> sparta::log::Formatter* { return new sparta::log::HTMLFormatter(s); } },*/
@@ -47,7 +55,24 @@ const Formatter::Info FMTLIST[] = {
 
 const Formatter::Info* Formatter::FORMATTERS = FMTLIST;
 
-void DefaultFormatter::write(const sparta::log::Message& msg)
+const Formatter::Info* Formatter::findInfo(const std::string& filename)
+{
+    const Info* fmtinfo = FORMATTERS;
+    while(true){
+        if(nullptr == fmtinfo->extension){
+            break; // End of the list. Use this formatter
+        }
+        std::string ext = fmtinfo->extension;
+        size_t pos = filename.find(ext);
+        if(pos != std::string::npos && pos == filename.size() - ext.size()){
+            break; // Use this fmtinfo->factory to construct
+        }
+        ++fmtinfo;
+    }
+    return fmtinfo;
+}
+
+void DefaultFormatter::writeFields(const MessageFields& fields)
 {
     std::ios::fmtflags f = stream_.flags();
 
@@ -56,28 +81,235 @@ void DefaultFormatter::write(const sparta::log::Message& msg)
     stream_ << std::setfill('0') << std::dec; // Applies to the following numbers
 
     // sim time
-    stream_ << "" << std::setw(10) << std::right << msg.info.sim_time << INFO_DELIMITER;
+    stream_ << "" << std::setw(10) << std::right << fields.sim_time << INFO_DELIMITER;
 
     // clock time
-    const Clock* clk = msg.info.origin.getClock();
-    if(clk){
-        stream_ << std::setw(8) << std::right << clk->currentCycle() << INFO_DELIMITER;
+    if(fields.has_cycle){
+        stream_ << std::setw(8) << std::right << fields.cycle << INFO_DELIMITER;
     }else{
         stream_ << "--------" << INFO_DELIMITER;
     }
 
     // origin
-    stream_ << msg.info.origin.getLocation() << INFO_DELIMITER;
+    stream_ << *fields.location << INFO_DELIMITER;
 
     // category
-    stream_ << *msg.info.category << "} ";
+    stream_ << *fields.category << "} ";
 
-    stream_ << copyWithReplace(msg.content, '\n', "") << std::endl;
+    stream_ << copyWithReplace(*fields.content, '\n', "") << '\n';
 
     // restore ostream flags
     stream_.flags(f);
+}
+
+std::chrono::milliseconds AsyncDestination::default_flush_interval_(1000);
+
+AsyncDestination::AsyncDestination(const std::string& filename,
+                                   std::chrono::milliseconds flush_interval,
+                                   size_t batch_bytes,
+                                   uint32_t max_batches) :
+    filename_(filename),
+    stream_(filename, std::ofstream::out), // write mode
+    fmtinfo_(Formatter::findInfo(filename)),
+    flush_interval_(flush_interval),
+    batch_bytes_(batch_bytes),
+    max_batches_(max_batches)
+{
+    if(stream_.good() == false){
+        throw SpartaException("Failed to open logging destination file for append \"")
+            << filename << "\"";
+    }
+    sparta_assert(flush_interval_.count() > 0,
+                  "Asynchronous logging destination \"" << filename << "\" needs a nonzero flush interval");
+    sparta_assert(max_batches_ > 0);
+
+    // Throw on write errors. These are caught in the writer thread
+    stream_.exceptions(std::ostream::badbit | std::ostream::failbit);
+
+    formatter_.reset(fmtinfo_->factory(fmt_stream_));
+    sparta_assert(formatter_ != nullptr);
+
+    pending_.reserve(batch_bytes_);
+    formatter_->writeHeader(SimulationInfo::getInstance());
+
+    writer_ = std::thread(&AsyncDestination::writerLoop_, this);
+}
+
+AsyncDestination::~AsyncDestination()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    writer_cv_.notify_one();
+    writer_.join();
+
+    if(writer_error_){
+        try{
+            checkWriterError_();
+        }catch(std::exception& e){
+            std::cerr << "Warning: " << e.what() << std::endl;
+        }
+    }
+}
+
+std::string AsyncDestination::stringize(bool pretty) const
+{
+    (void) pretty;
+    std::stringstream ss;
+    ss << "<" << "destination async file=\"" << filename_ << "\" format=\""
+       << fmtinfo_->extname << "\" ext=\"";
+    if(nullptr == fmtinfo_->extension){
+        ss << "(default)";
+    }else{
+        ss << fmtinfo_->extension;
+    }
+    ss << "\" flush_interval=" << flush_interval_.count() << "ms"
+       << " batches=" << getNumBatchesWritten()
+       << " rcv=" << getNumMessagesReceived()
+       << " wrote=" << getNumMessagesWritten()
+       << " dups=" << getNumMessageDuplicates() << ">";
+    return ss.str();
+}
+
+void AsyncDestination::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    queuePending_();
+    const uint64_t target = num_queued_;
+    if(target > flush_target_){
+        flush_target_ = target;
+    }
+    writer_cv_.notify_one();
+    producer_cv_.wait(lock, [this, target]() {
+        return num_flushed_ >= target || writer_error_;
+    });
+    checkWriterError_();
+}
+
+uint64_t AsyncDestination::getNumBatchesWritten() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_written_;
+}
 
-    stream_.flush();
+void AsyncDestination::setDefaultFlushInterval(std::chrono::milliseconds interval)
+{
+    sparta_assert(interval.count() > 0,
+                  "Asynchronous logging destinations need a nonzero flush interval");
+    default_flush_interval_ = interval;
+}
+
+void AsyncDestination::write_(const sparta::log::Message& msg)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    checkWriterError_();
+
+    // Format now: the message refers to simulator state (e.g. the
+    // origin's clock) which will have moved on by the time the writer
+    // thread gets to it
+    formatter_->write(msg);
+
+    if(pending_.size() >= batch_bytes_){
+        producer_cv_.wait(lock, [this]() {
+            return full_.size() < max_batches_ || writer_error_;
+        });
+        checkWriterError_();
+        queuePending_();
+        writer_cv_.notify_one();
+    }
+}
+
+void AsyncDestination::queuePending_()
+{
+    if(pending_.empty()){
+        return;
+    }
+    full_.emplace_back(std::move(pending_));
+    ++num_queued_;
+    if(spare_.empty() == false){
+        pending_ = std::move(spare_.back());
+        spare_.pop_back();
+    }else{
+        pending_ = std::string();
+        pending_.reserve(batch_bytes_);
+    }
+}
+
+void AsyncDestination::checkWriterError_() const
+{
+    if(SPARTA_EXPECT_FALSE(writer_error_)){
+        try{
+            std::rethrow_exception(writer_error_);
+        }catch(std::exception& e){
+            throw SpartaException("Failed to write logging destination file \"")
+                << filename_ << "\": " << e.what();
+        }
+    }
+}
+
+void AsyncDestination::writerLoop_()
+{
+    std::vector<std::string> batches;
+    auto last_flush = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(true){
+        const auto flush_at = last_flush + flush_interval_;
+        writer_cv_.wait_until(lock, flush_at, [this]() {
+            return stop_ || !full_.empty() || flush_target_ > num_flushed_;
+        });
+        const bool flush_due = stop_ || flush_target_ > num_flushed_ ||
+            std::chrono::steady_clock::now() >= flush_at;
+        if(flush_due){
+            // Don't hold a partial batch past the flush interval
+            queuePending_();
+        }
+        while(full_.empty() == false){
+            batches.emplace_back(std::move(full_.front()));
+            full_.pop_front();
+        }
+        producer_cv_.notify_all();
+        const bool stopping = stop_;
+
+        // Write with the lock released so logging can continue
+        lock.unlock();
+        std::exception_ptr error;
+        if(!writer_error_){
+            try{
+                for(const std::string& b : batches){
+                    stream_.write(b.data(), b.size());
+                }
+                if(flush_due){
+                    stream_.flush();
+                }
+            }catch(...){
+                error = std::current_exception();
+            }
+        }
+        lock.lock();
+
+        num_written_ += batches.size();
+        if(flush_due){
+            num_flushed_ = num_written_;
+            last_flush = std::chrono::steady_clock::now();
+        }
+        if(error){
+            writer_error_ = error;
+        }
+        for(std::string& b : batches){
+            if(spare_.size() < max_batches_){
+                b.clear();
+                spare_.emplace_back(std::move(b));
+            }
+        }
+        batches.clear();
+        producer_cv_.notify_all();
+
+        if(stopping){
+            break;
+        }
+    }
 }
 
     } // namespace log
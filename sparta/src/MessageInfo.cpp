@@ -17,22 +17,45 @@
 namespace sparta {
     namespace log {
 
+MessageFields::MessageFields(const MessageInfo& info,
+                             const std::string& loc,
+                             const std::string& msg_content) :
+    sim_time(info.sim_time),
+    wall_time(info.wall_time),
+    thread_id(info.thread_id),
+    seq_num(info.seq_num),
+    location(&loc),
+    category(info.category),
+    content(&msg_content)
+{
+    const Clock* clk = info.origin.getClock();
+    if(clk){
+        has_cycle = true;
+        cycle = clk->currentCycle();
+    }
+}
+
 std::ostream& operator<<(std::ostream& o, const MessageInfo& info) {
+    const std::string location = info.origin.getLocation();
+    const std::string no_content;
+    return o << MessageFields(info, location, no_content);
+}
+
+std::ostream& operator<<(std::ostream& o, const MessageFields& fields) {
     std::ios::fmtflags f = o.flags();
 
-    double t = double(info.wall_time);
+    double t = double(fields.wall_time);
 
     o << '{';
 
     o << std::setfill('0') << std::dec; // Applies to the following numbers
 
     // sim time
-    o << std::setw(8) << std::right << info.sim_time << INFO_DELIMITER;
+    o << std::setw(8) << std::right << fields.sim_time << INFO_DELIMITER;
 
     // clock time
-    const Clock* clk = info.origin.getClock();
-    if(clk){
-        o << std::setw(8) << std::right << clk->currentCycle() << INFO_DELIMITER;
+    if(fields.has_cycle){
+        o << std::setw(8) << std::right << fields.cycle << INFO_DELIMITER;
     }else{
         o << "--------" << INFO_DELIMITER;
     }
@@ -47,16 +70,16 @@ std::ostream& operator<<(std::ostream& o, const MessageInfo& info) {
     o << std::hex;
 
     // thread id
-    o << "0x" << std::setw(2) << info.thread_id << INFO_DELIMITER;
+    o << "0x" << std::setw(2) << fields.thread_id << INFO_DELIMITER;
 
     // sequence id
-    o << "0x" << std::setw(8) << info.seq_num << INFO_DELIMITER;
+    o << "0x" << std::setw(8) << fields.seq_num << INFO_DELIMITER;
 
     // origin
-    o << info.origin.getLocation() << INFO_DELIMITER;
+    o << *fields.location << INFO_DELIMITER;
 
     // category
-    o << *info.category << "} ";
+    o << *fields.category << "} ";
 
     // restore ostream flags
     o.flags(f);
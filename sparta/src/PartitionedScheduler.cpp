@@ -0,0 +1,300 @@
+// <PartitionedScheduler.cpp> -*- C++ -*-
+
+
+/**
+ * \file PartitionedScheduler.cpp
+ * \brief Runs several Schedulers (partitions) on their own threads in
+ *        lock-step windows
+ */
+
+#include "sparta/kernel/PartitionedScheduler.hpp"
+
+#include <algorithm>
+
+#include "sparta/kernel/SleeperThread.hpp"
+#include "sparta/utils/SpartaAssert.hpp"
+#include "sparta/utils/SpartaException.hpp"
+
+namespace sparta
+{
+
+PartitionLink::PartitionLink(const Scheduler * sender, Scheduler * receiver,
+                             Scheduler::Tick latency, const std::string & name) :
+    sender_(sender),
+    receiver_(receiver),
+    latency_(latency),
+    name_(name)
+{
+    sparta_assert(sender_ != nullptr && receiver_ != nullptr);
+    sparta_assert(sender_ != receiver_,
+                  "PartitionLink '" << name_ << "' sends to its own Scheduler");
+    sparta_assert(latency_ > 0,
+                  "PartitionLink '" << name_ << "' must have a latency");
+    sparta_assert(!receiver_->isRunning(),
+                  "Cannot create PartitionLink '" << name_ << "' while its receiver is running");
+    receiver_->inbound_links_.emplace_back(this);
+}
+
+PartitionLink::~PartitionLink()
+{
+    auto & links = receiver_->inbound_links_;
+    links.erase(std::remove(links.begin(), links.end(), this), links.end());
+}
+
+PartitionedScheduler::~PartitionedScheduler()
+{
+    for(Scheduler * sched : partitions_) {
+        sched->partitioned_scheduler_ = nullptr;
+    }
+}
+
+uint32_t PartitionedScheduler::addPartition(Scheduler * sched)
+{
+    sparta_assert(sched != nullptr);
+    sparta_assert(!finalized_, "Cannot add a partition to a finalized PartitionedScheduler");
+    if(std::find(partitions_.begin(), partitions_.end(), sched) != partitions_.end()) {
+        throw SpartaException("Scheduler '") << sched->getName()
+                                             << "' is already a partition of this PartitionedScheduler";
+    }
+    if(sched->partitioned_scheduler_ != nullptr) {
+        throw SpartaException("Scheduler '") << sched->getName()
+                                             << "' is already a partition of another PartitionedScheduler";
+    }
+    sched->partitioned_scheduler_ = this;
+    partitions_.emplace_back(sched);
+    return partitions_.size() - 1;
+}
+
+void PartitionedScheduler::finalize()
+{
+    sparta_assert(!finalized_, "PartitionedScheduler is already finalized");
+    if(partitions_.empty()) {
+        throw SpartaException("PartitionedScheduler has no partitions");
+    }
+
+    for(Scheduler * sched : partitions_) {
+        sched->finalize();
+        if(sched->getCurrentTick() != partitions_.front()->getCurrentTick()) {
+            throw SpartaException("Partitions must start at the same tick. Scheduler '")
+                << sched->getName() << "' is at tick " << sched->getCurrentTick()
+                << " but '" << partitions_.front()->getName() << "' is at tick "
+                << partitions_.front()->getCurrentTick();
+        }
+    }
+
+    // Every link into a partition must come from another partition,
+    // or nothing would ever deliver it
+    lookahead_ = Scheduler::INDEFINITE;
+    for(Scheduler * sched : partitions_) {
+        for(const PartitionLink * link : sched->getInboundLinks()) {
+            if(std::find(partitions_.begin(), partitions_.end(), link->getSender()) == partitions_.end()) {
+                throw SpartaException("PartitionLink '") << link->getName()
+                    << "' into Scheduler '" << sched->getName()
+                    << "' is from a Scheduler that is not a partition";
+            }
+            lookahead_ = std::min(lookahead_, link->getLatency());
+        }
+    }
+
+    // A single partition runs exactly as its Scheduler would on its own
+    if(partitions_.size() > 1) {
+        for(Scheduler * sched : partitions_) {
+            sched->partitioned_ = true;
+        }
+    }
+    partition_errors_.resize(partitions_.size());
+    finalized_ = true;
+}
+
+void PartitionedScheduler::run(Tick num_ticks, bool exacting_run)
+{
+    sparta_assert(finalized_, "Cannot run the PartitionedScheduler before it is finalized");
+
+    if(partitions_.size() == 1) {
+        partitions_.front()->run(num_ticks, exacting_run);
+        return;
+    }
+    if(num_ticks == 0) {
+        return;
+    }
+
+    SleeperThread::getInstance()->unpause();
+    startWorkers_();
+    try {
+        if(lookahead_ == Scheduler::INDEFINITE) {
+            // The partitions are independent; run each to the end
+            runWindow_(num_ticks, exacting_run);
+        }
+        else {
+            const Tick start = partitions_.front()->getCurrentTick();
+            const Tick end = (Scheduler::INDEFINITE - start <= num_ticks) ?
+                Scheduler::INDEFINITE : start + num_ticks;
+
+            Tick now = start;
+            while(now < end)
+            {
+                // Anything sent in the last window is due in this one
+                // or later.  Concurrent links are delivered by their
+                // receivers as the window starts.
+                deliverLinks_(false);
+
+                bool finished = true;
+                Tick next_event = Scheduler::INDEFINITE;
+                for(const Scheduler * sched : partitions_) {
+                    // Startup events have not been scheduled before the
+                    // first run
+                    finished = finished && sched->isFinished() && !sched->first_tick_;
+                    next_event = std::min(next_event, sched->first_tick_ ? now : sched->nextEventTick());
+                    for(const PartitionLink * link : sched->getInboundLinks()) {
+                        if(link->isConcurrent() && link->hasPending()) {
+                            // Not yet scheduled, so the Scheduler can't
+                            // say when it is due
+                            finished = false;
+                            next_event = now;
+                        }
+                    }
+                }
+                if(finished && (!exacting_run || end == Scheduler::INDEFINITE)) {
+                    break;
+                }
+
+                // Nothing can be sent before the earliest pending
+                // event, so the window can stretch over idle time.
+                // With no events at all, nothing more will be sent.
+                const Tick window_base = (next_event == Scheduler::INDEFINITE) ?
+                    end : std::max(now, next_event);
+                const Tick window_end = (window_base >= end || end - window_base <= lookahead_) ?
+                    end : window_base + lookahead_;
+
+                runWindow_(window_end - now, true);
+                now = window_end;
+
+                // A partition stopped by its model ends the run
+                bool stopped = false;
+                for(const Scheduler * sched : partitions_) {
+                    stopped = stopped || (sched->getCurrentTick() != now);
+                }
+                if(stopped) {
+                    break;
+                }
+            }
+
+            // Schedule what was sent in the last window so that it is
+            // there for the next run
+            deliverLinks_(true);
+        }
+    }
+    catch(...) {
+        stopWorkers_();
+        SleeperThread::getInstance()->pause();
+        throw;
+    }
+    stopWorkers_();
+    SleeperThread::getInstance()->pause();
+}
+
+void PartitionedScheduler::runWindow_(Tick num_ticks, bool exacting_run)
+{
+    window_ticks_ = num_ticks;
+    window_exacting_ = exacting_run;
+    workers_done_.store(0, std::memory_order_relaxed);
+
+    // Release the workers, then run the first partition here
+    window_start_count_.fetch_add(1, std::memory_order_release);
+    runPartition_(0);
+
+    const uint32_t num_workers = workers_.size();
+    while(workers_done_.load(std::memory_order_acquire) != num_workers) {
+        std::this_thread::yield();
+    }
+    ++num_windows_;
+
+    rethrowPartitionException_();
+}
+
+void PartitionedScheduler::runPartition_(uint32_t idx)
+{
+    try {
+        deliverConcurrentLinks_(idx);
+        partitions_[idx]->run(window_ticks_, window_exacting_, false);
+    }
+    catch(...) {
+        partition_errors_[idx] = std::current_exception();
+    }
+}
+
+void PartitionedScheduler::workerLoop_(uint32_t idx)
+{
+    uint64_t windows_seen = 0;
+    while(true)
+    {
+        uint64_t count;
+        while((count = window_start_count_.load(std::memory_order_acquire)) == windows_seen) {
+            std::this_thread::yield();
+        }
+        windows_seen = count;
+        if(quit_) {
+            return;
+        }
+        runPartition_(idx);
+        workers_done_.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void PartitionedScheduler::startWorkers_()
+{
+    sparta_assert(workers_.empty());
+    quit_ = false;
+    window_start_count_.store(0, std::memory_order_relaxed);
+    for(uint32_t idx = 1; idx < partitions_.size(); ++idx) {
+        workers_.emplace_back(&PartitionedScheduler::workerLoop_, this, idx);
+    }
+}
+
+void PartitionedScheduler::stopWorkers_()
+{
+    quit_ = true;
+    window_start_count_.fetch_add(1, std::memory_order_release);
+    for(auto & worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+void PartitionedScheduler::deliverLinks_(bool all)
+{
+    for(Scheduler * sched : partitions_) {
+        for(PartitionLink * link : sched->getInboundLinks()) {
+            if(!link->isConcurrent()) {
+                link->deliver();
+            }
+        }
+    }
+    if(all) {
+        for(uint32_t idx = 0; idx < partitions_.size(); ++idx) {
+            deliverConcurrentLinks_(idx);
+        }
+    }
+}
+
+void PartitionedScheduler::deliverConcurrentLinks_(uint32_t idx)
+{
+    for(PartitionLink * link : partitions_[idx]->getInboundLinks()) {
+        if(link->isConcurrent()) {
+            link->deliver();
+        }
+    }
+}
+
+void PartitionedScheduler::rethrowPartitionException_()
+{
+    for(auto & error : partition_errors_) {
+        if(error) {
+            std::exception_ptr first = error;
+            std::fill(partition_errors_.begin(), partition_errors_.end(), nullptr);
+            std::rethrow_exception(first);
+        }
+    }
+}
+
+} // namespace sparta
@@ -9,6 +9,7 @@
 
 #include "sparta/kernel/Scheduler.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <string>
 #include <vector>
@@ -16,7 +17,7 @@
 
 #include "sparta/kernel/SpartaHandler.hpp"
 #include "sparta/kernel/DAG.hpp"
-#include "sparta/kernel/ObjectAllocator.hpp"
+#include "sparta/kernel/SlabObjectAllocator.hpp"
 #include "sparta/simulation/RootTreeNode.hpp"
 #include "sparta/log/MessageSource.hpp"
 #include "sparta/events/Scheduleable.hpp"
@@ -43,7 +44,16 @@ Scheduler::Scheduler() :
 }
 
 Scheduler::Scheduler(const std::string& name, GlobalTreeNode* search_scope) :
+    Scheduler(name, search_scope, TickQuantumBackend::LINKED_LIST)
+{
+    // Delegated construction
+}
+
+Scheduler::Scheduler(const std::string& name, GlobalTreeNode* search_scope,
+                     TickQuantumBackend backend, uint32_t wheel_bucket_shift) :
     RootTreeNode(name, "DES Scheduler", search_scope),
+    tick_quantum_backend_(backend),
+    wheel_bucket_shift_(wheel_bucket_shift),
     stop_event_(new Scheduleable(CREATE_SPARTA_HANDLER(Scheduler, stopRunning), 0, SchedulingPhase::Trigger)),
     cancelled_event_(new Scheduleable(CREATE_SPARTA_HANDLER(Scheduler, cancelCallback_), 0, SchedulingPhase::Tick)),
     debug_(this,
@@ -105,6 +115,12 @@ Scheduler::Scheduler(const std::string& name, GlobalTreeNode* search_scope) :
     wall_time_cnt_   (&sset_, "host_wall_time_count_ms",
                       "Wall scheduler performance (not simulated time) in milliseconds",
                       Counter::COUNT_NORMAL, &wall_time_),
+    tick_quanta_peak_cnt_(&sset_, "tick_quanta_peak",
+                          "Most time quanta (ticks with events) outstanding at once",
+                          Counter::COUNT_LATEST, &tick_quantum_allocator_.getStats().peak_in_use),
+    empty_groups_skipped_cnt_(&sset_, "empty_groups_skipped",
+                              "Empty firing groups skipped over while running time quanta",
+                              Counter::COUNT_NORMAL, &empty_groups_skipped_),
     es_uptr_(new EventSet(this))
 #ifdef SYSTEMC_SUPPORT
     , item_scheduled_(this, "item_scheduled", "Broadcasted when something is scheduled", "item_scheduled")
@@ -133,6 +149,12 @@ Scheduler::Scheduler(const std::string& name, GlobalTreeNode* search_scope) :
                                   (Scheduler, fireGlobalEvent_, GlobalEventProxy)));
     }
 
+    sparta_assert(wheel_bucket_shift_ < 48,
+                  "Timing wheel bucket shift is too large: " << wheel_bucket_shift_);
+    if(tick_quantum_backend_ == TickQuantumBackend::TIMING_WHEEL) {
+        wheel_buckets_.resize(TIMING_WHEEL_NUM_BUCKETS);
+    }
+
     timer_.stop();
 }
 
@@ -250,6 +272,9 @@ void Scheduler::clearEvents()
             // Iterate each scheduled sparta event, and cancel's it.
             // There's no need to replace the event with a null
             // delegate since the list is to be completely emptied.
+            for(uint32_t i = 0; i < events.size(); ++i) {
+                events[i]->sched_location_.reset();
+            }
             for(uint32_t i = last_event_idx; i < events.size(); ++i)
             {
                 events[i]->eventCancelled_();
@@ -257,6 +282,7 @@ void Scheduler::clearEvents()
             events.clear();
             last_event_idx = 0;
         }
+        tq->clearAllOccupied();
 
         auto temp_tq = tq;
         tq = tq->next;
@@ -265,6 +291,23 @@ void Scheduler::clearEvents()
         tick_quantum_allocator_.free(temp_tq);
     }
     current_tick_quantum_ = nullptr;
+
+    for(auto tq : wheel_overflow_heap_)
+    {
+        for(auto & events : tq->groups)
+        {
+            for(uint32_t i = 0; i < events.size(); ++i)
+            {
+                events[i]->sched_location_.reset();
+                events[i]->eventCancelled_();
+            }
+            events.clear();
+        }
+        tq->clearAllOccupied();
+        tick_quantum_allocator_.free(tq);
+    }
+    clearWheel_();
+
     latest_continuing_event_ = 0;
     is_finished_ = true;
 }
@@ -295,6 +338,10 @@ Scheduler::TickQuantum* Scheduler::determineTickQuantum_(Tick rel_time)
 {
     const Tick index_time = calcIndexTime(rel_time);
 
+    if(tick_quantum_backend_ == TickQuantumBackend::TIMING_WHEEL) {
+        return determineWheelTickQuantum_(index_time);
+    }
+
     // This might look inefficient, but 99.9% of the time the
     // event being scheduled is either on the current time
     // quantum or the next.  A straight walk of two elements
@@ -349,6 +396,221 @@ Scheduler::TickQuantum* Scheduler::determineTickQuantum_(Tick rel_time)
     return rit;
 }
 
+Scheduler::TickQuantum* Scheduler::findTickQuantum_(Tick index_time) const
+{
+    if(tick_quantum_backend_ == TickQuantumBackend::TIMING_WHEEL)
+    {
+        if(index_time < wheel_base_) {
+            return nullptr;
+        }
+        if(index_time >= wheelHorizon_()) {
+            auto it = wheel_overflow_quanta_.find(index_time);
+            return (it == wheel_overflow_quanta_.end() ? nullptr : it->second);
+        }
+        const WheelBucket & bucket = wheel_buckets_[wheelBucketIdx_(index_time)];
+        if(bucket.first == nullptr) {
+            return nullptr;
+        }
+        const TickQuantum * end = bucket.last->next;
+        for(TickQuantum * rit = bucket.first; rit != end; rit = rit->next) {
+            if(rit->tick == index_time) {
+                return rit;
+            }
+        }
+        return nullptr;
+    }
+
+    TickQuantum * rit = current_tick_quantum_;
+    while(rit != nullptr)
+    {
+        if(rit->tick == index_time) {
+            return rit;
+        }
+        else if(rit->tick > index_time) {
+            // We're past the tick quantum -- didn't find it
+            return nullptr;
+        }
+        rit = rit->next;
+    }
+    return nullptr;
+}
+
+Scheduler::TickQuantum* Scheduler::determineWheelTickQuantum_(Tick index_time)
+{
+    // An empty wheel can be re-based to the current time.  Otherwise,
+    // the only way to land before the wheel's base is to schedule
+    // after the Scheduler stopped short of a far-future quantum.  In
+    // that case, push everything on the wheel to the overflow heap
+    // and slide the wheel back.
+    if(current_tick_quantum_ == nullptr && wheel_overflow_heap_.empty()) {
+        wheel_base_ = (current_tick_ >> wheel_bucket_shift_) << wheel_bucket_shift_;
+    }
+    else if(SPARTA_EXPECT_FALSE(index_time < wheel_base_)) {
+        TickQuantum * rit = current_tick_quantum_;
+        while(rit != nullptr) {
+            TickQuantum * next = rit->next;
+            rit->next = nullptr;
+            wheel_overflow_heap_.emplace_back(rit);
+            wheel_overflow_quanta_[rit->tick] = rit;
+            rit = next;
+        }
+        current_tick_quantum_ = nullptr;
+        wheel_buckets_.assign(TIMING_WHEEL_NUM_BUCKETS, WheelBucket());
+        wheel_occupancy_.fill(0);
+        std::make_heap(wheel_overflow_heap_.begin(), wheel_overflow_heap_.end(),
+                       laterTickQuantum_);
+        advanceWheel_(current_tick_);
+    }
+
+    if(SPARTA_EXPECT_FALSE(index_time >= wheelHorizon_()))
+    {
+        // Far-future events go to the overflow heap
+        auto & tq = wheel_overflow_quanta_[index_time];
+        if(tq == nullptr) {
+            tq = tick_quantum_allocator_.create(firing_group_count_);
+            tq->tick = index_time;
+            wheel_overflow_heap_.emplace_back(tq);
+            std::push_heap(wheel_overflow_heap_.begin(), wheel_overflow_heap_.end(),
+                           laterTickQuantum_);
+        }
+
+        // With nothing on the wheel, run() and nextEventTick() would
+        // not see the quantum.  Jump the wheel ahead to it.
+        if(current_tick_quantum_ == nullptr) {
+            advanceWheel_(wheel_overflow_heap_.front()->tick);
+        }
+        return tq;
+    }
+
+    // Look in the bucket's run of quanta first
+    const WheelBucket & bucket = wheel_buckets_[wheelBucketIdx_(index_time)];
+    if(bucket.first != nullptr)
+    {
+        const TickQuantum * end = bucket.last->next;
+        for(TickQuantum * rit = bucket.first; rit != end; rit = rit->next)
+        {
+            if(rit->tick == index_time) {
+                return rit;
+            }
+            else if(rit->tick > index_time) {
+                break;
+            }
+        }
+    }
+
+    TickQuantum * tq = tick_quantum_allocator_.create(firing_group_count_);
+    tq->tick = index_time;
+    linkWheelTickQuantum_(tq);
+    return tq;
+}
+
+void Scheduler::linkWheelTickQuantum_(TickQuantum * tq)
+{
+    sparta_assert(tq->tick >= wheel_base_ && tq->tick < wheelHorizon_());
+    const uint32_t bucket_idx = wheelBucketIdx_(tq->tick);
+    WheelBucket & bucket = wheel_buckets_[bucket_idx];
+
+    // Find the quantum that will precede tq in the list
+    TickQuantum * prev = nullptr;
+    if(bucket.first != nullptr && bucket.first->tick < tq->tick) {
+        prev = bucket.first;
+        while(prev != bucket.last && prev->next->tick < tq->tick) {
+            prev = prev->next;
+        }
+    }
+    else {
+        prev = wheelPredecessor_(bucket_idx);
+    }
+
+    if(prev == nullptr) {
+        tq->next = current_tick_quantum_;
+        current_tick_quantum_ = tq;
+    }
+    else {
+        tq->next = prev->next;
+        prev->next = tq;
+    }
+
+    if(bucket.first == nullptr) {
+        bucket.first = bucket.last = tq;
+        wheel_occupancy_[bucket_idx / 64] |= (uint64_t(1) << (bucket_idx % 64));
+    }
+    else if(tq->tick < bucket.first->tick) {
+        bucket.first = tq;
+    }
+    else if(prev == bucket.last) {
+        bucket.last = tq;
+    }
+}
+
+Scheduler::TickQuantum* Scheduler::wheelPredecessor_(uint32_t bucket_idx) const
+{
+    constexpr uint32_t mask = TIMING_WHEEL_NUM_BUCKETS - 1;
+
+    // Number of buckets between the wheel's base and bucket_idx
+    uint32_t remaining = (bucket_idx - wheelBucketIdx_(wheel_base_)) & mask;
+    uint32_t idx = (bucket_idx - 1) & mask;
+    while(remaining > 0)
+    {
+        // Look at the bits [idx - span + 1, idx] of this word
+        const uint32_t bit  = idx % 64;
+        const uint32_t span = std::min(bit + 1, remaining);
+        uint64_t word = wheel_occupancy_[idx / 64] & (~uint64_t(0) >> (63 - bit));
+        if(span < 64) {
+            word &= ~((uint64_t(1) << (bit + 1 - span)) - 1);
+        }
+        if(word != 0) {
+            const uint32_t found = (idx & ~63u) | (63 - __builtin_clzll(word));
+            return wheel_buckets_[found].last;
+        }
+        remaining -= span;
+        idx = (idx - span) & mask;
+    }
+    return nullptr;
+}
+
+void Scheduler::unlinkWheelHead_(TickQuantum * tq)
+{
+    const uint32_t bucket_idx = wheelBucketIdx_(tq->tick);
+    WheelBucket & bucket = wheel_buckets_[bucket_idx];
+    sparta_assert(bucket.first == tq);
+    if(bucket.last == tq) {
+        bucket.first = bucket.last = nullptr;
+        wheel_occupancy_[bucket_idx / 64] &= ~(uint64_t(1) << (bucket_idx % 64));
+    }
+    else {
+        bucket.first = tq->next;
+    }
+}
+
+void Scheduler::advanceWheel_(Tick index_time)
+{
+    wheel_base_ = (index_time >> wheel_bucket_shift_) << wheel_bucket_shift_;
+
+    // Pull in all overflow quanta that are now within reach
+    const Tick horizon = wheelHorizon_();
+    while(!wheel_overflow_heap_.empty() && wheel_overflow_heap_.front()->tick < horizon)
+    {
+        TickQuantum * tq = wheel_overflow_heap_.front();
+        std::pop_heap(wheel_overflow_heap_.begin(), wheel_overflow_heap_.end(),
+                      laterTickQuantum_);
+        wheel_overflow_heap_.pop_back();
+        wheel_overflow_quanta_.erase(tq->tick);
+        linkWheelTickQuantum_(tq);
+    }
+}
+
+void Scheduler::clearWheel_()
+{
+    if(tick_quantum_backend_ == TickQuantumBackend::TIMING_WHEEL) {
+        wheel_buckets_.assign(TIMING_WHEEL_NUM_BUCKETS, WheelBucket());
+    }
+    wheel_occupancy_.fill(0);
+    wheel_overflow_heap_.clear();
+    wheel_overflow_quanta_.clear();
+    wheel_base_ = 0;
+}
+
 
 void Scheduler::scheduleEvent(Scheduleable * scheduleable,
                               Tick rel_time,
@@ -402,9 +664,10 @@ void Scheduler::scheduleEvent(Scheduleable * scheduleable,
 
     if (false == add_if_not_scheduled) {
         rit->addEvent(firing_group, scheduleable);
+        trackScheduled_(scheduleable, rit, firing_group);
     }
-    else {
-        rit->addEventIfNotScheduled(firing_group, scheduleable);
+    else if(rit->addEventIfNotScheduled(firing_group, scheduleable)) {
+        trackScheduled_(scheduleable, rit, firing_group);
     }
 
     if(continuing){
@@ -424,9 +687,66 @@ void Scheduler::scheduleEvent(Scheduleable * scheduleable,
 void Scheduler::scheduleAsyncEvent(Scheduleable *scheduleable,
                                    Scheduler::Tick rel_tick)
 {
-    std::unique_lock<std::mutex> lock(async_event_list_mutex_);
-    async_event_list_.emplace_back(scheduleable, rel_tick);
-    async_event_list_empty_hint_ = false;
+    // Once events have spilled into the overflow list, keep adding
+    // to it until the main thread empties it.  Otherwise a producer's
+    // later events could overtake its earlier ones.
+    if(SPARTA_EXPECT_FALSE(async_event_overflow_size_.load(std::memory_order_acquire) != 0) ||
+       SPARTA_EXPECT_FALSE(!async_event_queue_.tryPush(AsyncEventInfo(scheduleable, rel_tick))))
+    {
+        const uint64_t queue_tail = async_event_queue_.getTailPosition();
+        std::unique_lock<std::mutex> lock(async_event_overflow_mutex_);
+        async_event_overflow_.emplace_back(scheduleable, rel_tick, queue_tail);
+        async_event_overflow_size_.store(async_event_overflow_.size(), std::memory_order_release);
+    }
+    async_event_list_empty_hint_.store(false);
+}
+
+void Scheduler::collectAsyncEvents_()
+{
+    AsyncEventInfo info;
+    while(async_event_queue_.tryPop(info)) {
+        async_event_staged_.emplace_back(info);
+    }
+
+    // Popping stops at a cell whose producer has claimed it but not
+    // yet filled it, so other producers' events can be left in the
+    // queue behind it.  An overflow event is only collected once
+    // everything queued before it was added has been popped;
+    // otherwise it could overtake its producer's earlier events.
+    if(async_event_overflow_size_.load(std::memory_order_acquire) != 0)
+    {
+        const uint64_t queue_head = async_event_queue_.getHeadPosition();
+        std::unique_lock<std::mutex> lock(async_event_overflow_mutex_);
+        auto ready_end = std::find_if(async_event_overflow_.begin(), async_event_overflow_.end(),
+                                      [queue_head](const AsyncEventInfo & i) {
+                                          return i.queue_tail > queue_head;
+                                      });
+        async_event_staged_.insert(async_event_staged_.end(),
+                                   async_event_overflow_.begin(), ready_end);
+        async_event_overflow_.erase(async_event_overflow_.begin(), ready_end);
+        async_event_overflow_size_.store(async_event_overflow_.size(), std::memory_order_release);
+    }
+}
+
+void Scheduler::scheduleAsyncEvents_()
+{
+    // Clear the hint before collecting.  A producer that queues an
+    // event after this point sets it again, so the event is picked
+    // up on a later tick even if collection below misses it.
+    async_event_list_empty_hint_.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    collectAsyncEvents_();
+    if(async_event_overflow_size_.load(std::memory_order_acquire) != 0) {
+        // Left behind for a producer still filling its queue cell
+        async_event_list_empty_hint_.store(false);
+    }
+    for (auto &i : async_event_staged_) {
+        scheduleEvent(i.sched, i.tick,
+                      i.sched->getGroupID(),
+                      i.sched->isContinuing());
+    }
+    async_event_staged_.clear();
 }
 
 void Scheduler::run(Tick num_ticks,
@@ -452,7 +772,9 @@ void Scheduler::run(Tick num_ticks,
     }
 
     // unpause infinite loop protection if we need
-    SleeperThread::getInstance()->unpause();
+    if(SPARTA_EXPECT_TRUE(!partitioned_)) {
+        SleeperThread::getInstance()->unpause();
+    }
 
     // Special case the first tick.  Current Tick is always 1-based
     // and trails elapsed ticks. Since we can't make current_tick_ -1,
@@ -502,9 +824,6 @@ void Scheduler::run(Tick num_ticks,
 
                 // Elapsed ticks always trail current_tick_ by one
                 elapsed_ticks_ += std::llabs(int64_t(current_tick_) - int64_t(elapsed_ticks_) - 1);
-                for(auto clk : registered_clocks_) {
-                    clk->updateElapsedCycles(elapsed_ticks_);
-                }
             }
             running_ = false;
             if(SPARTA_EXPECT_TRUE(measure_run_time)) {
@@ -542,11 +861,12 @@ void Scheduler::run(Tick num_ticks,
         // elapsed tick count > current_tick
         elapsed_ticks_             += std::llabs(int64_t(current_tick_) - int64_t(elapsed_ticks_));
 
-        // Optimization -- start at the first group with events
-        current_group_firing_       = quantum->first_group_idx;
+        // Nothing has fired in this quantum yet
+        current_group_firing_       = 0;
 
-        for(auto clk : registered_clocks_) {
-            clk->updateElapsedCycles(elapsed_ticks_);
+        // Slide the timing wheel up to now
+        if(tick_quantum_backend_ == TickQuantumBackend::TIMING_WHEEL) {
+            advanceWheel_(current_tick_);
         }
 
         if(SPARTA_EXPECT_FALSE(debug_)) {
@@ -555,33 +875,23 @@ void Scheduler::run(Tick num_ticks,
                    << SPARTA_CURRENT_COLOR_NORMAL;
         }
 
-        // Note on locking. The read of async_event_list_empty_hint_ below is
-        // not protected by async_event_list_mutex_. From a correctness point of
-        // view this is not a problem since we test if async_event_list_ is
-        // empty with async_event_list_mutex_ acquired before scheduling events,
-        // clearing async_event_list_ and setting async_event_list_empty_hint_.
-        // This however might cause events that are on async_event_list_ to not
-        // be scheduled until writes to async_event_list_empty_hint_ have
-        // propagated to this thread, but since we do not give any guarantees of
-        // when async event are scheduled this is not a problem.
-        if (SPARTA_EXPECT_FALSE(!async_event_list_empty_hint_)) {
-            std::unique_lock<std::mutex> lock(async_event_list_mutex_);
-            if (!async_event_list_.empty()) {
-                sparta_assert(!async_event_list_empty_hint_);
-
-                for (auto &i : async_event_list_) {
-                    scheduleEvent(i.sched, i.tick,
-                                  i.sched->getGroupID(),
-                                  i.sched->isContinuing());
-                }
-                async_event_list_.clear();
-                async_event_list_empty_hint_ = true;
-            }
+        // Asynchronous events are handed over through a lock-free
+        // queue.  The hint is only a relaxed read here: an event
+        // queued just as it is read is scheduled on a later tick,
+        // which is fine since there is no guarantee of when
+        // asynchronous events are scheduled.
+        if (SPARTA_EXPECT_FALSE(!async_event_list_empty_hint_.load(std::memory_order_relaxed))) {
+            scheduleAsyncEvents_();
         }
 
+        // Only visit the groups with events, jumping straight from
+        // one to the next
         const uint32_t grp_cnt = firing_group_count_;
+        uint32_t groups_visited = 0;
+        current_group_firing_ = quantum->nextOccupiedGroup(0);
         while(current_group_firing_ < grp_cnt)
         {
+            ++groups_visited;
             TickQuantum::ScheduleableGroup & events = quantum->groups[current_group_firing_];
 
             // The design of this for loop is important to keep as is.
@@ -611,10 +921,17 @@ void Scheduler::run(Tick num_ticks,
                 }
                 sched->getHandler()();
                 ++events_fired_;
+
+                // Look at the slot again -- the handler might have
+                // cancelled this event
+                trackFired_(quantum, current_group_firing_, current_event_firing_);
             }
             events.clear();
-            ++current_group_firing_;
+            quantum->clearOccupied(current_group_firing_);
+            current_group_firing_ = quantum->nextOccupiedGroup(current_group_firing_ + 1);
         }
+        // Group 0 is never used
+        empty_groups_skipped_ += (grp_cnt - 1) - groups_visited;
 
         if(SPARTA_EXPECT_FALSE(call_trace_logger_)) {
             call_trace_logger_ << call_trace_stream_.str();
@@ -622,9 +939,19 @@ void Scheduler::run(Tick num_ticks,
         }
 
         // Move to the next quantum
+        if(tick_quantum_backend_ == TickQuantumBackend::TIMING_WHEEL) {
+            unlinkWheelHead_(quantum);
+        }
         current_tick_quantum_ = quantum->next;
         quantum->next         = nullptr;
         tick_quantum_allocator_.free(quantum);
+
+        // If the wheel ran dry, jump it ahead to the next far-future
+        // quantum
+        if(SPARTA_EXPECT_FALSE(current_tick_quantum_ == nullptr &&
+                               !wheel_overflow_heap_.empty())) {
+            advanceWheel_(wheel_overflow_heap_.front()->tick);
+        }
         sparta_assert(watchdogExpired_() == false);
 
         // Update state
@@ -665,7 +992,9 @@ void Scheduler::run(Tick num_ticks,
     ++current_tick_;
 
     // pause infinite loop protection if we need
-    SleeperThread::getInstance()->pause();
+    if(SPARTA_EXPECT_TRUE(!partitioned_)) {
+        SleeperThread::getInstance()->pause();
+    }
 
     running_ = false;
     if(SPARTA_EXPECT_TRUE(measure_run_time)) {
@@ -678,45 +1007,61 @@ void Scheduler::run(Tick num_ticks,
     }
 }
 
-bool Scheduler::isScheduled(const Scheduleable * scheduleable, Tick rel_time) const
+void Scheduler::trackScheduled_(const Scheduleable * scheduleable, TickQuantum * tq, uint32_t group)
 {
-    const uint32_t dag_group =
-        (scheduleable->getGroupID() != 0 ? scheduleable->getGroupID() + 1 : group_zero_);
-    const Tick index_time = calcIndexTime(rel_time);
-    const TickQuantum * rit = current_tick_quantum_;
-    while(rit != nullptr)
+    Scheduleable::SchedulerLocation & loc = scheduleable->sched_location_;
+    ++loc.num_outstanding;
+    loc.quantum = tq;
+    loc.group   = group;
+    loc.slot    = tq->groups[group].size() - 1;
+}
+
+void Scheduler::trackFired_(TickQuantum * tq, uint32_t group, uint32_t slot)
+{
+    Scheduleable::SchedulerLocation & loc = tq->groups[group][slot]->sched_location_;
+    sparta_assert(loc.num_outstanding > 0);
+    --loc.num_outstanding;
+    if(loc.quantum == tq && loc.group == group && loc.slot == slot) {
+        loc.quantum = nullptr;
+    }
+}
+
+void Scheduler::cancelAt_(TickQuantum * tq, uint32_t group, uint32_t slot)
+{
+    TickQuantum::ScheduleableGroup & scheduleables = tq->groups[group];
+    if(!isFired_(tq, group, slot))
     {
-        if(rit->tick == index_time)
-        {
-            // This is the time quantum requested
-            const auto events = rit->groups[dag_group];
-            const auto grp_size = events.size();
-            for(size_t idx = 0; idx < grp_size; ++idx)
-            {
-                if(events[idx] == scheduleable) {
-                    return true;
-                }
-            }
-            return false;
-        }
-        else if(rit->tick > index_time) {
-            // We're past the tick quantum -- didn't find it
-            return false;
-        }
-        rit = rit->next;
+        Scheduleable::SchedulerLocation & loc = scheduleables[slot]->sched_location_;
+        sparta_assert(loc.num_outstanding > 0);
+        --loc.num_outstanding;
+        loc.quantum = nullptr;
+
+        Scheduleable::SchedulerLocation & cancelled_loc = cancelled_event_->sched_location_;
+        ++cancelled_loc.num_outstanding;
+        cancelled_loc.quantum = nullptr;
     }
-    return false;
+    scheduleables[slot] = cancelled_event_.get();
 }
 
-bool Scheduler::isScheduled(const Scheduleable * scheduleable) const
+bool Scheduler::isScheduled(const Scheduleable * scheduleable, Tick rel_time) const
 {
+    const Scheduleable::SchedulerLocation & loc = scheduleable->sched_location_;
+    if(loc.num_outstanding == 0) {
+        return false;
+    }
+
+    const Tick index_time = calcIndexTime(rel_time);
+    if(loc.num_outstanding == 1 && loc.quantum != nullptr) {
+        return (static_cast<const TickQuantum*>(loc.quantum)->tick == index_time);
+    }
+
     const uint32_t dag_group =
         (scheduleable->getGroupID() != 0 ? scheduleable->getGroupID() + 1 : group_zero_);
-
-    const TickQuantum * rit = current_tick_quantum_;
-    while(rit != nullptr)
+    const TickQuantum * rit = findTickQuantum_(index_time);
+    if(rit != nullptr)
     {
-        const auto events = rit->groups[dag_group];
+        // This is the time quantum requested
+        const auto & events = rit->groups[dag_group];
         const auto grp_size = events.size();
         for(size_t idx = 0; idx < grp_size; ++idx)
         {
@@ -724,13 +1069,39 @@ bool Scheduler::isScheduled(const Scheduleable * scheduleable) const
                 return true;
             }
         }
-        rit = rit->next;
     }
     return false;
 }
 
+bool Scheduler::isScheduled(const Scheduleable * scheduleable) const
+{
+    return (scheduleable->sched_location_.num_outstanding > 0);
+}
+
 void Scheduler::cancelEvent(const Scheduleable * scheduleable)
 {
+    const Scheduleable::SchedulerLocation & loc = scheduleable->sched_location_;
+    if(loc.num_outstanding == 0) {
+        return;
+    }
+
+    if(loc.num_outstanding == 1 && loc.quantum != nullptr)
+    {
+        TickQuantum * rit = static_cast<TickQuantum*>(loc.quantum);
+        const uint32_t group = loc.group;
+        const uint32_t slot  = loc.slot;
+        sparta_assert(rit->groups[group][slot] == scheduleable);
+        cancelAt_(rit, group, slot);
+        if(SPARTA_EXPECT_FALSE(debug_)) {
+            debug_ << SPARTA_CURRENT_COLOR_BRIGHT_YELLOW
+                   << "canceling: " << scheduleable->getLabel()
+                   << " at tick: " << rit->tick
+                   << " group: " << group
+                   << SPARTA_CURRENT_COLOR_NORMAL;
+        }
+        return;
+    }
+
     uint32_t dag_group = scheduleable->getGroupID();
     if(SPARTA_EXPECT_FALSE(dag_group == 0)) {
         dag_group = group_zero_;
@@ -738,14 +1109,12 @@ void Scheduler::cancelEvent(const Scheduleable * scheduleable)
         dag_group += 1;
     }
 
-    TickQuantum * rit = current_tick_quantum_;
-    while(rit != nullptr)
-    {
+    forEachTickQuantum_([&](TickQuantum * rit) {
         TickQuantum::ScheduleableGroup & scheduleables = rit->groups[dag_group];
         for(uint32_t i = 0; i < scheduleables.size(); ++i)
         {
             if(scheduleables[i] == scheduleable) {
-                scheduleables[i] = cancelled_event_.get();
+                cancelAt_(rit, dag_group, i);
                 if(SPARTA_EXPECT_FALSE(debug_)) {
                     debug_ << SPARTA_CURRENT_COLOR_BRIGHT_YELLOW
                            << "canceling: " << scheduleable->getLabel()
@@ -755,54 +1124,91 @@ void Scheduler::cancelEvent(const Scheduleable * scheduleable)
                 }
             }
         }
-        rit = rit->next;
-    }
+    });
 }
 
 void Scheduler::cancelEvent(const Scheduleable * scheduleable, Tick rel_time)
 {
-    uint32_t dag_group = scheduleable->getGroupID();
-    if(SPARTA_EXPECT_FALSE(dag_group == 0)) {
-        dag_group = group_zero_;
-    } else {
-        dag_group += 1;
+    const Scheduleable::SchedulerLocation & loc = scheduleable->sched_location_;
+    if(loc.num_outstanding == 0) {
+        return;
     }
+
     const Tick index_time = calcIndexTime(rel_time);
+    if(loc.num_outstanding == 1 && loc.quantum != nullptr)
+    {
+        // The one and only place this Scheduleable is
+        TickQuantum * rit = static_cast<TickQuantum*>(loc.quantum);
+        if(rit->tick == index_time) {
+            const uint32_t group = loc.group;
+            const uint32_t slot  = loc.slot;
+            sparta_assert(rit->groups[group][slot] == scheduleable);
+            rit->groups[group][slot]->eventCancelled_();
+            cancelAt_(rit, group, slot);
+            if(SPARTA_EXPECT_FALSE(debug_)) {
+                debug_ << SPARTA_CURRENT_COLOR_BRIGHT_YELLOW
+                       << "canceling: " << scheduleable->getLabel()
+                       << " at tick: " << rit->tick
+                       << " reltime: " << rel_time
+                       << " group: " << group
+                       << SPARTA_CURRENT_COLOR_NORMAL;
+            }
+        }
+        return;
+    }
 
-    TickQuantum * rit = current_tick_quantum_;
-    while(rit != nullptr)
+    TickQuantum * rit = findTickQuantum_(index_time);
+    if(rit != nullptr)
     {
-        if(rit->tick == index_time)
+        uint32_t dag_group = scheduleable->getGroupID();
+        if(SPARTA_EXPECT_FALSE(dag_group == 0)) {
+            dag_group = group_zero_;
+        } else {
+            dag_group += 1;
+        }
+
+        TickQuantum::ScheduleableGroup & scheduleables = rit->groups[dag_group];
+        for(uint32_t i = 0; i < scheduleables.size(); ++i)
         {
-            TickQuantum::ScheduleableGroup & scheduleables = rit->groups[dag_group];
-            for(uint32_t i = 0; i < scheduleables.size(); ++i)
-            {
-                if(scheduleables[i] == scheduleable) {
-                    scheduleables[i]->eventCancelled_();
-                    scheduleables[i] = cancelled_event_.get();
-                    if(SPARTA_EXPECT_FALSE(debug_)) {
-                        debug_ << SPARTA_CURRENT_COLOR_BRIGHT_YELLOW
-                               << "canceling: " << scheduleable->getLabel()
-                               << " at tick: " << rit->tick
-                               << " reltime: " << rel_time
-                               << " group: " << dag_group
-                               << SPARTA_CURRENT_COLOR_NORMAL;
-                    }
+            if(scheduleables[i] == scheduleable) {
+                scheduleables[i]->eventCancelled_();
+                cancelAt_(rit, dag_group, i);
+                if(SPARTA_EXPECT_FALSE(debug_)) {
+                    debug_ << SPARTA_CURRENT_COLOR_BRIGHT_YELLOW
+                           << "canceling: " << scheduleable->getLabel()
+                           << " at tick: " << rit->tick
+                           << " reltime: " << rel_time
+                           << " group: " << dag_group
+                           << SPARTA_CURRENT_COLOR_NORMAL;
                 }
             }
-            return;
         }
-        rit = rit->next;
     }
 }
 
 void Scheduler::cancelAsyncEvent(Scheduleable *scheduleable)
 {
-    std::unique_lock<std::mutex> lock(async_event_list_mutex_);
-
-    /* Remove the Scheduleable from async_event_list_ */
-    async_event_list_.remove_if(AsyncEventInfo(scheduleable));
-    async_event_list_empty_hint_ = async_event_list_.empty();
+    /* Pull everything off the queue so the Scheduleable can be
+     * removed.  The rest are scheduled on the next tick as usual. */
+    collectAsyncEvents_();
+    async_event_staged_.erase(std::remove_if(async_event_staged_.begin(),
+                                             async_event_staged_.end(),
+                                             AsyncEventInfo(scheduleable)),
+                              async_event_staged_.end());
+    if(async_event_overflow_size_.load(std::memory_order_acquire) != 0) {
+        // Some may be left in the overflow list for a producer still
+        // filling its queue cell
+        std::unique_lock<std::mutex> lock(async_event_overflow_mutex_);
+        async_event_overflow_.erase(std::remove_if(async_event_overflow_.begin(),
+                                                   async_event_overflow_.end(),
+                                                   AsyncEventInfo(scheduleable)),
+                                    async_event_overflow_.end());
+        async_event_overflow_size_.store(async_event_overflow_.size(), std::memory_order_release);
+    }
+    if(!async_event_staged_.empty() ||
+       async_event_overflow_size_.load(std::memory_order_acquire) != 0) {
+        async_event_list_empty_hint_.store(false, std::memory_order_relaxed);
+    }
 
     /* In case the event has already been scheduled, cancel it. */
     cancelEvent(scheduleable);
@@ -1,8 +1,22 @@
 
 #include "sparta/resources/Scoreboard.hpp"
 
+#include <algorithm>
+
 namespace sparta
 {
+    namespace
+    {
+        // Call func with the index of each set bit in bits
+        template<class FuncT>
+        void forEachSetBit(const Scoreboard::RegisterBitMask & bits, FuncT && func)
+        {
+            for(size_t bit = bits.findFirst(); bit < bits.size(); bit = bits.findNext(bit)) {
+                func(bit);
+            }
+        }
+    }
+
     const char Scoreboard::name[] = "Scoreboard";
 
     Scoreboard::ScoreboardParameters::ScoreboardParameters(sparta::TreeNode * n) :
@@ -164,13 +178,17 @@ namespace sparta
         sparta_assert(producer < forwarding_latencies_.size(),
                       "could not find producer ID in forwarding_latencies table");
 
-        for(auto [sbv, latency] : producer_to_consumer_scoreboard_views_[producer])
+        const auto & consumer_groups = producer_to_consumer_scoreboard_views_[producer];
+        for(uint32_t group = 0; group < consumer_groups.size(); ++group)
         {
-            if(latency != 0) {
+            const auto & consumers = consumer_groups[group];
+            if(consumers.latency != 0) {
                 scoreboard_view_updates_.
-                    preparePayload(ScoreboardViewUpdate{{bits, producer}, sbv, false})->schedule(latency);
+                    preparePayload(ScoreboardViewUpdate{{bits, producer}, group})->schedule(consumers.latency);
             } else {
-                sbv->receiveScoreboardUpdate_(bits, producer);
+                for(auto * sbv : consumers.views) {
+                    sbv->receiveScoreboardUpdate_(bits, producer);
+                }
             }
         }
     }
@@ -189,7 +207,7 @@ namespace sparta
     }
 
     bool Scoreboard::isSet(const Scoreboard::RegisterBitMask & bits) const {
-        return (global_reg_ready_mask_ & bits) == bits;
+        return global_reg_ready_mask_.containsAll(bits);
     }
 
     Scoreboard::UnitID Scoreboard::registerView(const std::string & producer_name,
@@ -210,8 +228,17 @@ namespace sparta
         for(uint32_t producer = 0; producer < producer_to_consumer_scoreboard_views_.size(); ++producer)
         {
             if(const auto latency = forwarding_latencies_[producer][unit_id];
-               latency != INVALID_LATENCY) {
-               producer_to_consumer_scoreboard_views_[producer].emplace_back(std::make_tuple(view, latency));
+               latency != INVALID_LATENCY)
+            {
+                auto & consumer_groups = producer_to_consumer_scoreboard_views_[producer];
+                auto group = std::find_if(consumer_groups.begin(), consumer_groups.end(),
+                                          [latency](const ConsumerSBVs & consumers) {
+                                              return consumers.latency == latency;
+                                          });
+                if(group == consumer_groups.end()) {
+                    group = consumer_groups.insert(group, ConsumerSBVs{latency, {}});
+                }
+                group->views.emplace_back(view);
             }
         }
         return unit_id;
@@ -221,7 +248,11 @@ namespace sparta
     // Payload receiving methods
     void Scoreboard::deliverScoreboardUpdate_(const ScoreboardViewUpdate & update)
     {
-        update.second->receiveScoreboardUpdate_(update.first.bits, update.first.producer);
+        const auto & consumers =
+            producer_to_consumer_scoreboard_views_[update.update.producer][update.consumer_group];
+        for(auto * sbv : consumers.views) {
+            sbv->receiveScoreboardUpdate_(update.update.bits, update.update.producer);
+        }
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -231,6 +262,7 @@ namespace sparta
     ScoreboardView::ScoreboardView(const std::string & unit_name,
                                    const std::string & scoreboard_type,
                                    sparta::TreeNode * parent) :
+        register_waiters_(Scoreboard::MAX_REGISTERS),
         clock_(parent->getClock()),
         unit_id_(findMasterScoreboard_(unit_name, scoreboard_type, parent)),
         scoreboard_type_(scoreboard_type)
@@ -254,48 +286,166 @@ namespace sparta
                       "Update should only be generated for non-empty vector");
 
         // Setting local ready bits
+        const auto newly_ready = bits & ~local_ready_mask_;
         local_ready_mask_ |= bits;
 
-        auto cbit = ready_callbacks_.begin();
-        const auto eit = ready_callbacks_.end();
-        while(cbit != eit)
+        // Take the scratch list in case a callback updates this view again
+        std::vector<WaiterRef> ready;
+        ready.swap(ready_scratch_);
+
+        // Only the waiters of the registers that became ready can
+        // become ready themselves
+        forEachSetBit(newly_ready, [this, &ready](uint32_t reg) {
+            forEachWaiter_(reg, [&ready](const WaiterRef & ref, Waiter & waiter) {
+                if(--waiter.remaining == 0) {
+                    ready.emplace_back(ref);
+                }
+            });
+        });
+
+        callReadyWaiters_(ready, bits);
+        ready_scratch_.swap(ready);
+    }
+
+    void ScoreboardView::callReadyWaiters_(std::vector<WaiterRef> & ready,
+                                           const Scoreboard::RegisterBitMask & bits)
+    {
+        // Waiters registered with all their registers ready, before
+        // this update or by one of its callbacks, are called in this
+        // update too.  Those registered by a callback are called after
+        // the ones already ready, since they are younger.
+        takeReadyAtRegistration_(ready);
+        while(!ready.empty())
         {
-            const auto & cb_data = *cbit;
-            if (cb_data.needed_bits == (local_ready_mask_ & cb_data.needed_bits))
+            // Call them in registration order
+            std::sort(ready.begin(), ready.end(),
+                      [this](const WaiterRef & lhs, const WaiterRef & rhs) {
+                          return waiters_[lhs.index].sequence < waiters_[rhs.index].sequence;
+                      });
+
+            for(const auto & ref : ready)
             {
-                cb_data.callback(bits);
-                cbit = ready_callbacks_.erase(cbit);
-                continue;
+                // Skip waiters already called, or cleared by an earlier
+                // callback.  An earlier callback can also clear one of
+                // a waiter's registers; it stays on its register lists
+                // until that register is ready again.
+                if(!isCurrent_(ref) || (waiters_[ref.index].remaining != 0)) {
+                    continue;
+                }
+                // The callback can register more callbacks, so take it out first
+                ReadinessCallback callback = std::move(waiters_[ref.index].callback);
+                releaseWaiter_(ref.index);
+                callback(bits);
+            }
+            ready.clear();
+            takeReadyAtRegistration_(ready);
+        }
+    }
+
+    void ScoreboardView::takeReadyAtRegistration_(std::vector<WaiterRef> & ready)
+    {
+        for(const auto & ref : ready_at_registration_) {
+            if(isCurrent_(ref) && (waiters_[ref.index].remaining == 0)) {
+                ready.emplace_back(ref);
+            }
+        }
+        ready_at_registration_.clear();
+    }
+
+    template<class FuncT>
+    void ScoreboardView::forEachWaiter_(uint32_t reg, FuncT && func)
+    {
+        auto & refs = register_waiters_[reg];
+        uint32_t num_kept = 0;
+        for(uint32_t i = 0; i < refs.size(); ++i)
+        {
+            const WaiterRef ref = refs[i];
+            if(isCurrent_(ref)) {
+                refs[num_kept++] = ref;
+                func(ref, waiters_[ref.index]);
             }
-            ++cbit;
         }
+        refs.resize(num_kept);
     }
 
-    void ScoreboardView::registerReadyCallback(const Scoreboard::RegisterBitMask & bits,
-                                               const Scoreboard::InstID inst_id,
-                                               const ReadinessCallback & callback)
+    void ScoreboardView::pruneWaiters_(std::vector<WaiterRef> & refs)
     {
-        ready_callbacks_.emplace_back(bits, inst_id, callback, clock_->currentCycle());
+        refs.erase(std::remove_if(refs.begin(), refs.end(),
+                                  [this](const WaiterRef & ref) { return !isCurrent_(ref); }),
+                   refs.end());
+    }
+
+    void ScoreboardView::releaseWaiter_(uint32_t index)
+    {
+        Waiter & waiter = waiters_[index];
+        waiter.callback = nullptr;
+        waiter.in_use = false;
+        ++waiter.generation;
+        free_waiters_.emplace_back(index);
+        --num_waiters_;
+    }
+
+    ScoreboardView::CallbackHandle
+    ScoreboardView::registerReadyCallback(const Scoreboard::RegisterBitMask & bits,
+                                          const Scoreboard::InstID inst_id,
+                                          const ReadinessCallback & callback)
+    {
+        uint32_t index;
+        if(free_waiters_.empty()) {
+            index = waiters_.size();
+            waiters_.emplace_back();
+        }
+        else {
+            index = free_waiters_.back();
+            free_waiters_.pop_back();
+        }
+        ++num_waiters_;
+
+        Waiter & waiter = waiters_[index];
+        waiter.callback = callback;
+        waiter.inst_id = inst_id;
+        waiter.registered_time = clock_->currentCycle();
+        waiter.sequence = next_sequence_++;
+        waiter.remaining = (bits & ~local_ready_mask_).count();
+        waiter.in_use = true;
+
+        // Every needed register tracks the waiter, even the ready
+        // ones, since they can be cleared again
+        const WaiterRef ref{index, waiter.generation};
+        forEachSetBit(bits, [this, ref](uint32_t reg) {
+            auto & refs = register_waiters_[reg];
+            // Drop the stale references before growing the list
+            if(refs.size() == refs.capacity()) {
+                pruneWaiters_(refs);
+            }
+            refs.emplace_back(ref);
+        });
+
+        if(waiter.remaining == 0) {
+            ready_at_registration_.emplace_back(ref);
+        }
+        return CallbackHandle(index, ref.generation);
     }
 
     void ScoreboardView::clearCallbacks(const Scoreboard::InstID inst_id)
     {
-        auto clear_fn = [inst_id] (auto & callbacks)
-                        {
-                            auto cbit = callbacks.begin();
-                            const auto eit = callbacks.end();
-                            while (cbit != eit)
-                            {
-                                const auto & cb_data = *cbit;
-                                if((cb_data.inst_id == inst_id))
-                                {
-                                    cbit = callbacks.erase(cbit);
-                                } else {
-                                    ++cbit;
-                                }
-                            }
-                        };
-        clear_fn(ready_callbacks_);
+        for(uint32_t index = 0; index < waiters_.size(); ++index)
+        {
+            if(waiters_[index].in_use && (waiters_[index].inst_id == inst_id)) {
+                releaseWaiter_(index);
+            }
+        }
+    }
+
+    bool ScoreboardView::clearCallback(const CallbackHandle & handle)
+    {
+        if(!handle.isValid() || (handle.index_ >= waiters_.size()) ||
+           !isCurrent_({handle.index_, handle.generation_}))
+        {
+            return false;
+        }
+        releaseWaiter_(handle.index_);
+        return true;
     }
 
 
@@ -362,7 +512,15 @@ namespace sparta
 
     void ScoreboardView::clearBits_(const Scoreboard::RegisterBitMask & bits)
     {
+        const auto newly_cleared = bits & local_ready_mask_;
         local_ready_mask_ &= ~bits;
+
+        // The waiters of the cleared registers need them again
+        forEachSetBit(newly_cleared, [this](uint32_t reg) {
+            forEachWaiter_(reg, [](const WaiterRef &, Waiter & waiter) {
+                ++waiter.remaining;
+            });
+        });
     }
 
     std::string printBitSet(const Scoreboard::RegisterBitMask & bits)
@@ -951,6 +951,16 @@ void Simulation::run(uint64_t run_time)
         eptr = std::current_exception(); // capture
     }
 
+    // Get any buffered log messages onto disk, especially if the run
+    // failed
+    try{
+        log::DestinationManager::flushDestinations();
+    }catch(...){
+        if(eptr == std::exception_ptr()){
+            eptr = std::current_exception();
+        }
+    }
+
     if(eptr == std::exception_ptr()) {
         // Indicate to the root and its components that simulation has
         // terminated
@@ -0,0 +1,82 @@
+// Times an aged Array on a scheduler like workload.
+//
+// An aged array is filled to a given occupancy, then every cycle the
+// age order is walked from the oldest entry to pick the first two ready
+// entries, which are erased and replaced by newly written entries.  A
+// few entries are also looked up by age with getOldestIndex().
+
+#include <inttypes.h>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/resources/Array.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+TEST_INIT
+
+constexpr uint32_t CYCLES = 200000;
+constexpr uint32_t PICKS_PER_CYCLE = 2;
+
+using AgedArray = sparta::Array<uint32_t, sparta::ArrayType::AGED>;
+
+// Runs the workload, returning ns per cycle and a checksum of the
+// entries picked
+std::pair<double, uint64_t> runCycles(uint32_t occupancy)
+{
+    sparta::Scheduler sched;
+    sparta::Clock clk("clock", &sched);
+    AgedArray array("scheduler", occupancy, &clk);
+    std::mt19937 rng(1234);
+
+    // Entries are ready on a random cycle in the near future
+    uint32_t cycle = 0;
+    auto ready_cycle = [&]() { return cycle + rng() % 32; };
+    for(uint32_t i = 0; i < occupancy; ++i) {
+        array.write(i, ready_cycle());
+    }
+
+    uint64_t checksum = 0;
+    std::vector<uint32_t> picked;
+    const auto start = std::chrono::steady_clock::now();
+    for(; cycle < CYCLES; ++cycle)
+    {
+        picked.clear();
+        for(auto it = array.abegin(); it != array.aend(); ++it) {
+            if(*it <= cycle) {
+                picked.push_back(it.getIndex());
+                if(picked.size() == PICKS_PER_CYCLE) {
+                    break;
+                }
+            }
+        }
+        for(const uint32_t idx : picked) {
+            checksum = checksum * 31 + idx;
+            array.erase(idx);
+        }
+        for(const uint32_t idx : picked) {
+            array.write(idx, ready_cycle());
+        }
+        checksum += array.getOldestIndex(occupancy / 4).getIndex();
+        checksum += array.getAge(picked.empty() ? 0 : picked.front());
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQUAL(array.numValid(), occupancy);
+    return {ns / CYCLES, checksum};
+}
+
+int main()
+{
+    for(uint32_t occupancy : {16u, 64u, 128u, 256u, 512u})
+    {
+        const auto result = runCycles(occupancy);
+        std::cout << "Occupancy " << occupancy << ": " << result.first
+                  << " ns/cycle (checksum " << result.second << ")" << std::endl;
+    }
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
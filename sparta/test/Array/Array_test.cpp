@@ -20,6 +20,8 @@
 
 #include "sparta/collection/PipelineCollector.hpp"
 
+#include <algorithm>
+#include <random>
 #include <string>
 
 TEST_INIT
@@ -106,6 +108,83 @@ content:
     rtn.enterTeardown();
 }
 
+// Compare the age order of an aged array against a simple model
+// through random writes, overwrites and erases
+void testAgeOrder()
+{
+    sparta::Scheduler sched;
+    sparta::Clock clk("clock", &sched);
+
+    constexpr uint32_t num_entries = 37;
+    AgedArray aged_array("age_order_array", num_entries, &clk);
+    std::vector<uint32_t> model; // Indexes, oldest first
+
+    auto check = [&]() {
+        EXPECT_EQUAL(aged_array.numValid(), model.size());
+
+        std::vector<uint32_t> walked;
+        for(auto it = aged_array.abegin(); it != aged_array.aend(); ++it) {
+            walked.push_back(it.getIndex());
+        }
+        EXPECT_TRUE(walked == model);
+
+        // The aged list is youngest first
+        std::vector<uint32_t> listed(aged_array.getAgedList().begin(),
+                                     aged_array.getAgedList().end());
+        EXPECT_TRUE(std::equal(listed.begin(), listed.end(), model.rbegin(), model.rend()));
+
+        for(uint32_t nth = 0; nth < model.size(); ++nth) {
+            EXPECT_EQUAL(aged_array.getOldestIndex(nth).getIndex(), model[nth]);
+            EXPECT_EQUAL(aged_array.getYoungestIndex(nth).getIndex(), model[model.size() - 1 - nth]);
+            EXPECT_EQUAL(aged_array.getAge(model[nth]), nth);
+            EXPECT_EQUAL(aged_array.read(model[nth]), model[nth] * 3);
+        }
+        if(!model.empty()) {
+            uint32_t idx = model.front();
+            for(uint32_t nth = 1; nth < model.size(); ++nth) {
+                EXPECT_TRUE(aged_array.getNextOldestIndex(idx));
+                EXPECT_EQUAL(idx, model[nth]);
+            }
+            EXPECT_FALSE(aged_array.getNextOldestIndex(idx));
+        }
+    };
+
+    std::mt19937 rng(17);
+    for(uint32_t i = 0; i < 2000; ++i)
+    {
+        const uint32_t idx = rng() % num_entries;
+        const auto pos = std::find(model.begin(), model.end(), idx);
+        if(rng() % 3 == 0) {
+            // Erase from anywhere, often the oldest
+            if(pos != model.end()) {
+                aged_array.erase(idx);
+                model.erase(pos);
+            }
+            else if(!model.empty()) {
+                aged_array.erase(aged_array.abegin());
+                model.erase(model.begin());
+            }
+        }
+        else {
+            // Write, possibly over a valid entry
+            aged_array.write(idx, idx * 3);
+            if(pos != model.end()) {
+                model.erase(pos);
+            }
+            model.push_back(idx);
+        }
+        if(i % 7 == 0) {
+            check();
+        }
+        if(i == 1000) {
+            aged_array.clear();
+            model.clear();
+            check();
+        }
+    }
+    check();
+}
+
 int main()
 {
     sparta::Scheduler sched;
@@ -712,6 +791,7 @@ int main()
     root_node.enterTeardown();
 
     testStatsOutput();
+    testAgeOrder();
 
     ENSURE_ALL_REACHED(0);
     REPORT_ERROR;
@@ -0,0 +1,97 @@
+// Compares a Buffer with a gap tolerant one on ROB-like patterns.
+//
+// Each cycle up to DISPATCH_WIDTH entries are appended and up to
+// RETIRE_WIDTH of the oldest are erased, keeping the Buffer nearly
+// full.  Every FLUSH_PERIOD cycles the youngest half is flushed, from
+// the back.  A second pattern also completes entries out of order,
+// erasing them from the middle like a load/store queue.
+
+#include <inttypes.h>
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+#include "sparta/resources/Buffer.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+TEST_INIT
+
+constexpr uint32_t CYCLES         = 200000;
+constexpr uint32_t DISPATCH_WIDTH = 4;
+constexpr uint32_t RETIRE_WIDTH   = 4;
+constexpr uint32_t FLUSH_PERIOD   = 500;
+
+struct Inst
+{
+    uint64_t uid;
+    uint64_t pc;
+};
+
+std::ostream & operator<<(std::ostream & os, const Inst & inst) {
+    return os << inst.uid;
+}
+
+// Runs the pattern, returning ns per cycle and a checksum of the
+// entries retired
+std::pair<double, uint64_t> runCycles(uint32_t num_entries, bool gap_tolerant, bool out_of_order)
+{
+    sparta::Buffer<Inst> rob("rob", num_entries, nullptr);
+    if(gap_tolerant) {
+        rob.makeGapTolerant();
+    }
+
+    uint64_t uid = 0;
+    uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for(uint32_t cycle = 0; cycle < CYCLES; ++cycle)
+    {
+        for(uint32_t i = 0; i < DISPATCH_WIDTH && rob.numFree() > 0; ++i, ++uid) {
+            rob.push_back(Inst{uid, 0x1000 + uid * 4});
+        }
+
+        // Retire only once nearly full, so the Buffer stays full
+        if(rob.numFree() < DISPATCH_WIDTH) {
+            for(uint32_t i = 0; i < RETIRE_WIDTH && !rob.empty(); ++i) {
+                checksum = checksum * 31 + rob.read(0).uid;
+                rob.erase(rob.begin());
+            }
+        }
+
+        if(out_of_order && rob.size() > 8) {
+            // Complete an entry somewhere in the middle
+            const uint32_t idx = rob.size() / 2 + cycle % (rob.size() / 4);
+            checksum = checksum * 31 + rob.read(idx).pc;
+            rob.erase(idx);
+        }
+
+        if(cycle % FLUSH_PERIOD == 0) {
+            const uint32_t num_flushed = rob.size() / 2;
+            for(uint32_t i = 0; i < num_flushed; ++i) {
+                rob.erase(rob.size() - 1);
+            }
+        }
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return {ns / CYCLES, checksum};
+}
+
+int main()
+{
+    for(bool out_of_order : {false, true})
+    {
+        for(uint32_t num_entries : {64u, 128u, 256u, 512u})
+        {
+            const auto shifting = runCycles(num_entries, false, out_of_order);
+            const auto gap_tolerant = runCycles(num_entries, true, out_of_order);
+            EXPECT_EQUAL(gap_tolerant.second, shifting.second);
+
+            std::cout << (out_of_order ? "ROB + middle erase, " : "ROB, ") << num_entries
+                      << " entries (ns/cycle): shifting " << shifting.first
+                      << ", gap tolerant " << gap_tolerant.first
+                      << " (" << shifting.first / gap_tolerant.first << "x)" << std::endl;
+        }
+    }
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
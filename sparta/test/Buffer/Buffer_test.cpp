@@ -4,6 +4,7 @@
 #include <iostream>
 #include <cinttypes>
 #include <memory>
+#include <random>
 #include <vector>
 
 #include "sparta/resources/Buffer.hpp"
@@ -752,12 +753,142 @@ void testInvalidates()
     EXPECT_EQUAL(SimpleStruct::simple_allocs, 0);
 }
 
+// A gap tolerant Buffer behaves like a model vector through appends,
+// erases anywhere, inserts and lazy compaction
+void testGapTolerant()
+{
+    sparta::Buffer<uint32_t> buf("gap_buf", 16, nullptr);
+    EXPECT_FALSE(buf.isGapTolerant());
+    buf.push_back(100);
+    buf.push_back(101);
+    buf.makeGapTolerant();
+    EXPECT_TRUE(buf.isGapTolerant());
+    EXPECT_EQUAL(buf.size(), 2);
+    EXPECT_EQUAL(buf.read(1), 101);
+
+    // Erasing the head or a middle entry leaves holes but keeps indexing
+    auto first = buf.begin();
+    auto second = std::next(first);
+    for(uint32_t i = 0; i < 6; ++i) {
+        buf.push_back(i);
+    }
+    buf.erase(first);
+    EXPECT_FALSE(first.isValid());
+    buf.erase(3); // 2
+    EXPECT_EQUAL(buf.size(), 6);
+    std::vector<uint32_t> expected {101, 0, 1, 3, 4, 5};
+    for(uint32_t i = 0; i < buf.size(); ++i) {
+        EXPECT_EQUAL(buf.read(i), expected[i]);
+    }
+    EXPECT_EQUAL(*second, 101);
+    EXPECT_EQUAL(buf.read(second), 101);
+    EXPECT_EQUAL(buf.accessBack(), 5);
+    EXPECT_THROW(buf.read(first));
+    auto it = buf.end();
+    --it;
+    EXPECT_EQUAL(*it, 5);
+    std::advance(it, -2);
+    EXPECT_EQUAL(*it, 3);
+    EXPECT_TRUE(second < it);
+    EXPECT_TRUE(it < buf.end());
+    EXPECT_THROW_MSG_CONTAINS(--buf.begin(), "Decrementing the iterator results in buffer underrun");
+
+    // Inserting compacts; iterators stay valid
+    buf.insert(it, 77);
+    expected.insert(expected.begin() + 3, 77);
+    EXPECT_TRUE(std::equal(buf.begin(), buf.end(), expected.begin(), expected.end()));
+    EXPECT_EQUAL(*second, 101);
+    EXPECT_EQUAL(*it, 3);
+    EXPECT_EQUAL(buf.read(3), 77);
+
+    // Model a ROB: retire from the head, dispatch at the tail, and
+    // flush younger entries, with some middle erases, against a vector
+    std::mt19937 rng(7);
+    std::vector<uint32_t> model(buf.begin(), buf.end());
+    uint32_t next = 1000;
+    for(uint32_t op = 0; op < 20000; ++op)
+    {
+        const uint32_t choice = rng() % 16;
+        if(choice < 7 && buf.numFree()) {
+            auto pushed = buf.push_back(next);
+            EXPECT_EQUAL(*pushed, next);
+            model.push_back(next++);
+        }
+        else if(choice < 11 && !model.empty()) {
+            buf.erase(buf.begin());
+            model.erase(model.begin());
+        }
+        else if(choice < 12 && !model.empty()) {
+            // Flush the youngest few
+            const uint32_t num = 1 + rng() % std::min<uint32_t>(model.size(), 4);
+            for(uint32_t i = 0; i < num; ++i) {
+                buf.erase(std::prev(buf.end()));
+                model.pop_back();
+            }
+        }
+        else if(choice < 14 && !model.empty()) {
+            const uint32_t idx = rng() % model.size();
+            if(op % 2) {
+                buf.erase(idx);
+            }
+            else {
+                buf.erase(std::next(buf.begin(), idx));
+            }
+            model.erase(model.begin() + idx);
+        }
+        else if(choice < 15 && buf.numFree()) {
+            const uint32_t idx = rng() % (model.size() + 1);
+            buf.insert(idx, next);
+            model.insert(model.begin() + idx, next++);
+        }
+        else if(!model.empty()) {
+            const uint32_t idx = rng() % model.size();
+            EXPECT_EQUAL(buf.read(idx), model[idx]);
+            buf.access(idx) = next;
+            model[idx] = next++;
+        }
+
+        EXPECT_EQUAL(buf.size(), model.size());
+        if(op % 64 == 0) {
+            EXPECT_TRUE(std::equal(buf.begin(), buf.end(), model.begin(), model.end()));
+            EXPECT_TRUE(std::equal(buf.rbegin(), buf.rend(), model.rbegin(), model.rend()));
+            for(uint32_t i = 0; i < model.size(); ++i) {
+                EXPECT_EQUAL(buf.read(i), model[i]);
+            }
+        }
+    }
+
+    buf.clear();
+    EXPECT_TRUE(buf.empty());
+    EXPECT_TRUE(buf.begin() == buf.end());
+
+    // Gap tolerant and infinite
+    sparta::Buffer<uint32_t> inf_buf("gap_inf_buf", 2, nullptr);
+    inf_buf.makeGapTolerant();
+    inf_buf.makeInfinite(3);
+    std::vector<uint32_t> inf_model;
+    for(uint32_t i = 0; i < 200; ++i) {
+        inf_buf.push_back(i);
+        inf_model.push_back(i);
+        if(i % 3 == 0) {
+            inf_buf.erase(inf_buf.begin());
+            inf_model.erase(inf_model.begin());
+        }
+        if(i % 7 == 0 && !inf_model.empty()) {
+            inf_buf.erase(inf_buf.size() / 2);
+            inf_model.erase(inf_model.begin() + inf_model.size() / 2);
+        }
+    }
+    EXPECT_TRUE(std::equal(inf_buf.begin(), inf_buf.end(), inf_model.begin(), inf_model.end()));
+    EXPECT_TRUE(inf_buf.capacity() >= inf_model.size());
+}
 
 int main()
 {
     testPointerTypes<std::shared_ptr<dummy_struct>>();
     testPointerTypes<sparta::SpartaSharedPointer<dummy_struct>>();
     generalTest();
+    testGapTolerant();
     testConstIterator();
     testInvalidates();
 
@@ -0,0 +1,169 @@
+
+// Measures what it costs to keep many clock domains' cycle counts
+// current.
+//
+// The Scheduler used to divide its elapsed ticks by every registered
+// Clock's period on every tick.  Clocks now derive elapsed cycles on
+// demand with a precomputed divider, so a tick costs the same no
+// matter how many clock domains there are.
+
+#include <inttypes.h>
+#include <iostream>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "sparta/sparta.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/ClockManager.hpp"
+#include "sparta/events/EventSet.hpp"
+#include "sparta/events/Event.hpp"
+#include "sparta/utils/MathUtils.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+TEST_INIT
+
+using sparta::Clock;
+using sparta::Scheduler;
+
+constexpr uint32_t NUM_CLOCK_DOMAINS = 24;
+constexpr uint64_t NUM_TICKS = 2000000;
+
+// Keeps the Scheduler busy on every tick
+class Ticker
+{
+public:
+    Ticker(sparta::EventSet * es) :
+        ev_(es, "ticker", CREATE_SPARTA_HANDLER(Ticker, tick_), 1)
+    {}
+
+    void start() { ev_.schedule(); }
+
+    uint64_t ticks = 0;
+
+private:
+    void tick_() {
+        ++ticks;
+        ev_.schedule();
+    }
+
+    sparta::Event<> ev_;
+};
+
+// Check InvariantDivider against the divide instruction around the
+// places it could go wrong
+void testInvariantDivider()
+{
+    std::mt19937_64 rng(0xC10C);
+    std::vector<uint32_t> divisors = {1, 2, 3, 5, 7, 10, 1000, 1024, 1500, 2500,
+                                      3000, 3333, 65535, 65536, 65537,
+                                      0x7FFFFFFF, 0x80000000, 0xFFFFFFFF};
+    for(uint32_t i = 0; i < 200; ++i) {
+        divisors.emplace_back(uint32_t(rng()) | 1);
+    }
+
+    for(const uint32_t d : divisors)
+    {
+        const sparta::utils::InvariantDivider div(d);
+        std::vector<uint64_t> values = {0, 1, d - 1ull, d, d + 1ull,
+                                        std::numeric_limits<uint64_t>::max(),
+                                        std::numeric_limits<uint64_t>::max() - d};
+        for(uint32_t i = 0; i < 500; ++i) {
+            const uint64_t q = rng() / d;
+            values.emplace_back(q * d);
+            values.emplace_back(q * d - 1);
+            values.emplace_back(rng());
+        }
+        for(const uint64_t n : values) {
+            EXPECT_EQUAL(div.divide(n), n / d);
+            EXPECT_EQUAL(div.remainder(n), n % d);
+        }
+    }
+}
+
+int main()
+{
+    testInvariantDivider();
+
+    Scheduler sched;
+    sparta::ClockManager m(&sched);
+    sparta::RootTreeNode rtn;
+
+    // A mix of power-of-two and other periods (in picoseconds)
+    Clock::Handle c_root = m.makeRoot(&rtn);
+    std::vector<Clock::Handle> clocks;
+    for(uint32_t i = 0; i < NUM_CLOCK_DOMAINS; ++i) {
+        const double freq_mhz = (i % 3 == 0) ?
+            (1000000.0 / (256 << (i % 4))) : (100.0 + 37.5 * i);
+        clocks.emplace_back(m.makeClock("clk" + std::to_string(i), c_root, freq_mhz));
+    }
+    m.normalize();
+    rtn.setClock(c_root.get());
+
+    sparta::EventSet es(&rtn);
+    Ticker ticker(&es);
+
+    sched.finalize();
+    rtn.enterConfiguring();
+    rtn.enterFinalized();
+
+    ticker.start();
+    auto start = std::chrono::steady_clock::now();
+    sched.run(NUM_TICKS, true, false);
+    const double run_ns = std::chrono::duration<double, std::nano>
+        (std::chrono::steady_clock::now() - start).count();
+    // The first firing is one tick in
+    EXPECT_EQUAL(ticker.ticks, NUM_TICKS - 1);
+
+    for(const auto & clk : clocks) {
+        EXPECT_EQUAL(clk->elapsedCycles(), sched.getElapsedTicks() / clk->getPeriod());
+    }
+
+    // What the Scheduler used to do on each of those ticks
+    std::vector<Clock::Period> periods;
+    for(const auto & clk : clocks) {
+        periods.emplace_back(clk->getPeriod());
+    }
+    volatile Clock::Cycle sink = 0;
+    start = std::chrono::steady_clock::now();
+    for(uint64_t t = 0; t < NUM_TICKS; ++t) {
+        for(const auto p : periods) {
+            sink = t / p;
+        }
+    }
+    const double eager_ns = std::chrono::duration<double, std::nano>
+        (std::chrono::steady_clock::now() - start).count();
+
+    // Reading cycles on demand: divide instruction vs. InvariantDivider
+    start = std::chrono::steady_clock::now();
+    for(uint64_t t = 0; t < NUM_TICKS; ++t) {
+        for(const auto p : periods) {
+            sink = (t * 7919) / p;
+        }
+    }
+    const double div_ns = std::chrono::duration<double, std::nano>
+        (std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for(uint64_t t = 0; t < NUM_TICKS; ++t) {
+        for(const auto & clk : clocks) {
+            sink = clk->getCycle(t * 7919);
+        }
+    }
+    const double inv_ns = std::chrono::duration<double, std::nano>
+        (std::chrono::steady_clock::now() - start).count();
+    (void)sink;
+
+    const double num_reads = double(NUM_TICKS) * NUM_CLOCK_DOMAINS;
+    std::cout << "Clock domains:                     " << NUM_CLOCK_DOMAINS << "\n"
+              << "Scheduler run:                     " << run_ns / NUM_TICKS << " ns/tick\n"
+              << "Removed per-tick clock updates:    " << eager_ns / NUM_TICKS << " ns/tick\n"
+              << "Tick to cycle, divide:             " << div_ns / num_reads << " ns\n"
+              << "Tick to cycle, InvariantDivider:   " << inv_ns / num_reads << " ns" << std::endl;
+
+    rtn.enterTeardown();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
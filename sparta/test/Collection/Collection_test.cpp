@@ -2,6 +2,7 @@
 
 #include "sparta/collection/Collectable.hpp"
 #include "sparta/collection/PipelineCollector.hpp"
+#include "sparta/pipeViewer/Outputter.hpp"
 
 #include "sparta/utils/SpartaTester.hpp"
 
@@ -9,7 +10,14 @@
 #include "sparta/simulation/ClockManager.hpp"
 #include "sparta/kernel/Scheduler.hpp"
 
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <tuple>
+#include <vector>
+#include <zlib.h>
 
 struct EmptyData {};
 std::ostream & operator<<(std::ostream & os, const EmptyData &) {
@@ -63,9 +71,228 @@ void testEmptyCollection()
     EXPECT_TRUE(record_file.peek() == std::ifstream::traits_type::eof());
 }
 
+// A slot in some structure; empty slots have no annotation
+struct Slot
+{
+    uint32_t id = 0;
+    uint32_t stage = 0;
+
+    bool operator==(const Slot & other) const {
+        return id == other.id && stage == other.stage;
+    }
+};
+std::ostream & operator<<(std::ostream & os, const Slot & slot) {
+    if(slot.id != 0) {
+        os << std::hex << slot.id << std::dec << ":" << slot.stage;
+    }
+    return os;
+}
+
+// Start, end, and annotation of every annotation record in a
+// pipeout, by location
+using RecordList = std::vector<std::tuple<uint64_t, uint64_t, std::string>>;
+std::map<uint32_t, RecordList> readRecords(const std::string & filename)
+{
+    std::map<uint32_t, RecordList> records;
+    std::ifstream record_file(filename, std::fstream::in | std::fstream::binary);
+    transaction_t trans;
+    while(record_file.read(reinterpret_cast<char *>(&trans), sizeof(trans))) {
+        uint16_t length = 0;
+        record_file.read(reinterpret_cast<char *>(&length), sizeof(length));
+        std::string annt(length, '\0');
+        record_file.read(annt.data(), length);
+        records[trans.location_ID].emplace_back(trans.time_Start, trans.time_End, annt);
+    }
+    return records;
+}
+
+void testCompareByValue()
+{
+    // The same values collected by formatting, by value, and by
+    // fingerprint must give the same records
+    sparta::Scheduler sched;
+    sparta::ClockManager cm(&sched);
+    sparta::RootTreeNode rtn;
+    sparta::Clock::Handle root_clk;
+    root_clk = cm.makeRoot(&rtn, "root_clk");
+    cm.normalize();
+    rtn.setClock(root_clk.get());
+
+    sparta::collection::Collectable<Slot> by_annot(&rtn, "by_annot");
+    sparta::collection::Collectable<Slot> by_value(&rtn, "by_value");
+    sparta::collection::Collectable<Slot> by_fingerprint(&rtn, "by_fingerprint");
+    by_value.setCompareByValue();
+    by_fingerprint.setFingerprint([](const Slot & slot) {
+        return (uint64_t(slot.id) << 32) | slot.stage;
+    });
+
+    rtn.enterConfiguring();
+    rtn.enterFinalized();
+
+    // Heartbeats restart open records every 16 ticks
+    sparta::collection::PipelineCollector pc("lazyPipe", 16,
+                                             root_clk.get(), &rtn);
+    sched.finalize();
+    pc.startCollection(&rtn);
+
+    EXPECT_THROW(by_value.setCompareByValue());
+
+    for(uint32_t tick = 0; tick < 200; ++tick)
+    {
+        Slot slot;
+        slot.id = (tick / 7) % 5;
+        slot.stage = (tick % 11 < 4) ? 0 : (tick / 3) % 2;
+        for(auto * col : {&by_annot, &by_value, &by_fingerprint}) {
+            if(tick % 23 == 0) {
+                col->collectWithDuration(slot, 2);
+            }
+            else if(tick % 31 == 30) {
+                col->closeRecord();
+            }
+            else {
+                col->collect(slot);
+                // Collecting twice in a tick doesn't change anything
+                col->collect(slot);
+            }
+        }
+        sched.run(1, true);
+    }
+
+    rtn.enterTeardown();
+    pc.destroy();
+
+    const auto records = readRecords("lazyPiperecord.bin");
+    EXPECT_EQUAL(records.size(), 3);
+    const auto & expected = records.at(by_annot.getNodeUID());
+    EXPECT_TRUE(expected.size() > 20);
+    EXPECT_EQUAL(records.at(by_value.getNodeUID()), expected);
+    EXPECT_EQUAL(records.at(by_fingerprint.getNodeUID()), expected);
+}
+
+std::string readFile(const std::string & filename)
+{
+    std::ifstream file(filename, std::fstream::in | std::fstream::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Writes the same transactions with an Outputter
+void writeTransactions(sparta::pipeViewer::Outputter & out)
+{
+    out.writeIndex();
+    for(uint64_t i = 0; i < 5000; ++i)
+    {
+        annotation_t annt;
+        annt.time_Start = i;
+        annt.time_End = i + 1 + i % 3;
+        annt.transaction_ID = i;
+        annt.location_ID = i % 17;
+        annt.flags = is_Annotation;
+        annt.annt = "annotation " + std::to_string(i * 7919);
+        annt.length = annt.annt.size();
+        out.writeTransaction(annt);
+        if(i % 100 == 99) {
+            out.writeIndex();
+        }
+    }
+}
+
+void testBackgroundWriter()
+{
+    // The background writer writes the same files; small blocks make
+    // it go through the queue many times
+    {
+        sparta::pipeViewer::Outputter out("syncPipe", 100);
+        EXPECT_FALSE(out.hasBackgroundWriter());
+        writeTransactions(out);
+    }
+    uint64_t num_blocks = 0;
+    {
+        sparta::pipeViewer::Outputter out("bgPipe", 100, true, 4096, 2);
+        EXPECT_TRUE(out.hasBackgroundWriter());
+        writeTransactions(out);
+        num_blocks = out.getNumBlocksWritten();
+    }
+    EXPECT_TRUE(num_blocks > 10);
+
+    const std::string records = readFile("syncPiperecord.bin");
+    const std::string index = readFile("syncPipeindex.bin");
+    EXPECT_TRUE(records.size() > 5000 * sizeof(transaction_t));
+    EXPECT_TRUE(records == readFile("bgPiperecord.bin"));
+    EXPECT_TRUE(index == readFile("bgPipeindex.bin"));
+    EXPECT_EQUAL(index.size(), HEADER_SIZE + sizeof(uint64_t) * (1 + 1 + 50 + 1));
+}
+
+// Decompresses the chunks of a compressed record file, checking the
+// chunk index along the way
+std::string readChunks(const std::string & prefix)
+{
+    const std::string records = readFile(prefix + "record.bin");
+    const std::string chunks = readFile(prefix + "chunk.bin");
+    EXPECT_EQUAL(chunks.size() % sizeof(chunk_index_t), 0);
+
+    std::string data;
+    for(size_t pos = 0; pos + sizeof(chunk_index_t) <= chunks.size(); pos += sizeof(chunk_index_t))
+    {
+        chunk_index_t chunk;
+        std::memcpy(&chunk, chunks.data() + pos, sizeof(chunk));
+        EXPECT_EQUAL(chunk.record_pos, data.size());
+        EXPECT_TRUE(chunk.file_pos + chunk.compressed_size <= records.size());
+
+        std::string buf(chunk.size, '\0');
+        uLongf size = chunk.size;
+        EXPECT_EQUAL(uncompress(reinterpret_cast<Bytef*>(buf.data()), &size,
+                                reinterpret_cast<const Bytef*>(records.data() + chunk.file_pos),
+                                chunk.compressed_size), Z_OK);
+        EXPECT_EQUAL(size, chunk.size);
+        data += buf;
+    }
+    return data;
+}
+
+void testCompression()
+{
+    // Compressed record files hold the same records, in chunks cut at
+    // each index; the index still points into the uncompressed records
+    {
+        sparta::pipeViewer::Outputter out("zPipe", 100, false, sparta::pipeViewer::Outputter::DEFAULT_BLOCK_BYTES,
+                                          sparta::pipeViewer::Outputter::DEFAULT_MAX_BLOCKS, true);
+        EXPECT_TRUE(out.isCompressed());
+        writeTransactions(out);
+    }
+    {
+        sparta::pipeViewer::Outputter out("bgzPipe", 100, true, sparta::pipeViewer::Outputter::DEFAULT_BLOCK_BYTES,
+                                          2, true);
+        writeTransactions(out);
+    }
+    // Chunks are also cut at the block size
+    {
+        sparta::pipeViewer::Outputter out("smallzPipe", 100, false, 1000, 2, true);
+        writeTransactions(out);
+    }
+
+    const std::string records = readFile("syncPiperecord.bin");
+    const std::string index = readFile("syncPipeindex.bin");
+    for(const std::string prefix : {"zPipe", "bgzPipe", "smallzPipe"})
+    {
+        EXPECT_TRUE(readChunks(prefix) == records);
+        EXPECT_TRUE(readFile(prefix + "record.bin").size() * 2 < records.size());
+
+        const std::string zindex = readFile(prefix + "index.bin");
+        EXPECT_TRUE(zindex.compare(HEADER_SIZE, std::string::npos, index, HEADER_SIZE) == 0);
+        EXPECT_TRUE(zindex.find("version:   3") != std::string::npos);
+    }
+    EXPECT_TRUE(readFile("zPipechunk.bin") == readFile("bgzPipechunk.bin"));
+    EXPECT_EQUAL(readFile("zPipechunk.bin").size(), sizeof(chunk_index_t) * 50);
+    EXPECT_TRUE(readFile("smallzPipechunk.bin").size() > sizeof(chunk_index_t) * 50);
+    EXPECT_TRUE(index.find("version:   2") != std::string::npos);
+}
+
 int main()
 {
     testEmptyCollection();
+    testCompareByValue();
+    testBackgroundWriter();
+    testCompression();
 
     REPORT_ERROR;
     return ERROR_CODE;
@@ -6,6 +6,8 @@
 #include <cstdio>
 #include <cstring>
 #include <ctime>
+#include <chrono>
+#include <vector>
 
 #include "sparta/sparta.hpp"
 #include "sparta/events/EventSet.hpp"
@@ -177,6 +179,159 @@ private:
     unsigned long async_event_count_ = 0;
 };
 
+/*
+ * Stress test: several threads schedule async events back to back, with no
+ * pause, so the hand-off queue fills up and spills over.  Each producer
+ * alternates between two of its own events; since every producer's events
+ * must be scheduled in the order they were sent, the handlers must see them
+ * alternate as well.  Also used as a throughput benchmark.
+ */
+class AsyncStress
+{
+    // One of a producer's two events
+    struct Receiver
+    {
+        Receiver(sparta::EventSet *event_set, AsyncStress *owner,
+                 unsigned int producer, unsigned int idx)
+        : owner(owner), producer(producer), idx(idx),
+          event(event_set,
+                "stress_event_" + std::to_string(producer) + "_" + std::to_string(idx),
+                CREATE_SPARTA_HANDLER(Receiver, received))
+        {}
+
+        void received() { owner->received_(producer, idx); }
+
+        AsyncStress *owner;
+        const unsigned int producer;
+        const unsigned int idx;
+        sparta::AsyncEvent<> event;
+    };
+
+public:
+    AsyncStress(sparta::TreeNode *node,
+                sparta::EventSet *event_set,
+                unsigned int num_producers,
+                unsigned int events_per_producer,
+                unsigned int yield_every)
+    : keep_alive_(event_set, "keep_alive",
+                  CREATE_SPARTA_HANDLER(AsyncStress, keepAlive_)),
+      num_producers_(num_producers),
+      events_per_producer_(events_per_producer),
+      yield_every_(yield_every),
+      received_count_(num_producers, 0)
+    {
+        for (unsigned int p = 0; p < num_producers_; ++p) {
+            for (unsigned int e = 0; e < 2; ++e) {
+                receivers_.emplace_back(new Receiver(event_set, this, p, e));
+            }
+        }
+        sparta::StartupEvent(node, CREATE_SPARTA_HANDLER(AsyncStress, startUp_));
+    }
+
+    ~AsyncStress()
+    {
+        for (auto &t : threads_) {
+            t.join();
+        }
+    }
+
+    //! Events delivered per second, from the first send to the last handler
+    double eventsPerSecond() const
+    {
+        const double secs = std::chrono::duration<double>(end_ - start_).count();
+        return (num_producers_ * events_per_producer_) / secs;
+    }
+
+    void check() const
+    {
+        for (unsigned int p = 0; p < num_producers_; ++p) {
+            EXPECT_EQUAL(received_count_[p], events_per_producer_);
+        }
+        EXPECT_EQUAL(out_of_order_, 0);
+    }
+
+private:
+    void startUp_()
+    {
+        keep_alive_.schedule(1);
+        start_ = std::chrono::steady_clock::now();
+        for (unsigned int p = 0; p < num_producers_; ++p) {
+            threads_.emplace_back(&AsyncStress::produce_, this, p);
+        }
+    }
+
+    void produce_(unsigned int producer)
+    {
+        // Even sends use event 0, odd sends use event 1
+        for (unsigned int i = 0; i < events_per_producer_; ++i) {
+            receivers_[2 * producer + (i & 1)]->event.schedule(sparta::Clock::Cycle(0));
+            if (yield_every_ != 0 && (i % yield_every_) == 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void received_(unsigned int producer, unsigned int idx)
+    {
+        if ((received_count_[producer] & 1) != idx) {
+            ++out_of_order_;
+        }
+        ++received_count_[producer];
+        ++total_received_;
+        if (total_received_ == num_producers_ * events_per_producer_) {
+            end_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    void keepAlive_()
+    {
+        if (total_received_ < num_producers_ * events_per_producer_) {
+            keep_alive_.schedule(1);
+        }
+    }
+
+    sparta::Event<> keep_alive_;
+    const unsigned int num_producers_;
+    const unsigned int events_per_producer_;
+    const unsigned int yield_every_;
+    std::vector<std::unique_ptr<Receiver>> receivers_;
+    std::vector<std::thread> threads_;
+    std::vector<unsigned int> received_count_;
+    unsigned int total_received_ = 0;
+    unsigned int out_of_order_ = 0;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point end_;
+};
+
+double runAsyncStress(unsigned int num_producers, unsigned int events_per_producer,
+                      unsigned int yield_every = 0)
+{
+    sparta::Scheduler sched;
+    sparta::Clock clk("clock", &sched);
+    sparta::RootTreeNode rtn;
+    sparta::EventSet event_set(&rtn);
+    rtn.setClock(&clk);
+
+    double rate = 0;
+    {
+        AsyncStress stress(&rtn, &event_set, num_producers, events_per_producer, yield_every);
+
+        sched.finalize();
+        rtn.enterConfiguring();
+        rtn.enterFinalized();
+
+        sched.run();
+        stress.check();
+        rate = stress.eventsPerSecond();
+    }
+    rtn.enterTeardown();
+
+    std::cout << "Async events: " << num_producers << " producer(s) x "
+              << events_per_producer << " events: "
+              << uint64_t(rate) << " events/s" << std::endl;
+    return rate;
+}
+
 int main()
 {
     sparta::Scheduler sched;
@@ -198,6 +353,18 @@ int main()
 
     rtn.enterTeardown();
 
+    // Stress the hand-off with more events in flight than the queue
+    // holds, then measure throughput
+    runAsyncStress(8, 100000);
+    runAsyncStress(1, 1000000);
+    runAsyncStress(4, 250000);
+
+    // Many more producers than cores, yielding often, so that the
+    // queue spills over while other producers are preempted between
+    // claiming a queue cell and filling it.  Their later events go to
+    // the overflow list and must not overtake the unfilled cell.
+    runAsyncStress(64, 20000, 16);
+
     REPORT_ERROR;
     return ERROR_CODE;
 }
@@ -4,6 +4,8 @@
 #include <stack>
 #include <ctime>
 #include <array>
+#include <map>
+#include <vector>
 
 #include "sparta/sparta.hpp"
 #include "sparta/simulation/TreeNode.hpp"
@@ -898,6 +900,207 @@ void deletionTest3()
     clocks.enterTeardown();
 }
 
+//! \brief Checkpoints share memory lines with the live ArchData until written
+void copyOnWriteTest()
+{
+    sparta::Scheduler sched;
+    RootTreeNode clocks("clocks");
+    sparta::Clock clk(&clocks, "clock", &sched);
+
+    RootTreeNode root;
+    DummyDevice dummy(&root);
+    std::unique_ptr<RegisterSet> rset(RegisterSet::create(&dummy, reg_defs));
+    auto r1 = rset->getRegister("reg2");
+    MemoryObject mem_obj(&dummy,
+                         64, // 64B blocks
+                         64 * 1024, // 64k size
+                         0xcc, // fill with conspicuous bytes
+                         1 // 1 byte of fill
+                         );
+    BlockingMemoryObjectIFNode mem_if(&dummy, // Parent node
+                                      "mem", // Name
+                                      "Memory interface",
+                                      nullptr, // associated translation interface
+                                      mem_obj);
+
+    FastCheckpointer fcp(root, &sched);
+    fcp.setSnapshotThreshold(3);
+
+    root.enterConfiguring();
+    root.enterFinalized();
+    sched.finalize();
+
+    // Fill memory with the block number
+    uint8_t buf[64];
+    for(uint32_t addr = 0; addr < 64 * 1024; addr += 64){
+        memset(buf, addr / 64, sizeof(buf));
+        mem_if.write(addr, 64, buf);
+    }
+    r1->write<uint32_t>(0x11);
+
+    // A DMI line is never shared since its writes cannot be seen. DMI
+    // pointers are only valid until the next checkpoint load.
+    auto dmi = mem_if.getDMI(0x400, 64);
+    EXPECT_NOTEQUAL(dmi, nullptr);
+    uint8_t* dmi_data = static_cast<uint8_t*>(dmi->getRawDataPtr());
+
+    // The snapshot refers to every memory line instead of copying it.
+    // Registers hold pointers into their lines, so those are copied.
+    EXPECT_NOTHROW(fcp.createHead());
+    const auto head_id = fcp.getHeadID();
+    EXPECT_TRUE(mem_obj.tryGetLine(0x0)->isShared());
+    EXPECT_TRUE(mem_obj.tryGetLine(0xffc0)->isShared());
+    EXPECT_FALSE(mem_obj.tryGetLine(0x400)->isShared());
+
+    // Writing a line copies it, leaving the snapshot alone
+    const uint8_t* old_data = mem_obj.tryGetLine(0x80)->getDataPointer(0);
+    memset(buf, 0xaa, sizeof(buf));
+    mem_if.write(0x80, 8, buf);
+    EXPECT_FALSE(mem_obj.tryGetLine(0x80)->isShared());
+    EXPECT_NOTEQUAL(mem_obj.tryGetLine(0x80)->getDataPointer(0), old_data);
+    EXPECT_TRUE(mem_obj.tryGetLine(0xc0)->isShared());
+    dmi_data[0] = 0xbb;
+    r1->write<uint32_t>(0x22);
+
+    const auto delta_id = fcp.createCheckpoint();
+    EXPECT_TRUE(mem_obj.tryGetLine(0x80)->isShared()); // Dirty again, so in the delta
+
+    mem_if.write(0x80, 64, buf);
+    mem_if.write(0x1000, 64, buf);
+    r1->write<uint32_t>(0x33);
+
+    // Loads see the data as of each checkpoint, however often they are
+    // loaded and written in between
+    for(uint32_t i = 0; i < 2; ++i){
+        EXPECT_NOTHROW(fcp.loadCheckpoint(head_id));
+        mem_if.read(0x80, 64, buf);
+        EXPECT_EQUAL(buf[0], 2);
+        EXPECT_EQUAL(buf[63], 2);
+        mem_if.read(0x1000, 1, buf);
+        EXPECT_EQUAL(buf[0], 0x40);
+        mem_if.read(0x400, 1, buf);
+        EXPECT_EQUAL(buf[0], 0x10);
+        EXPECT_EQUAL(r1->read<uint32_t>(), 0x11);
+
+        // Overwrite restored (shared) lines
+        memset(buf, 0xee, sizeof(buf));
+        mem_if.write(0x80, 64, buf);
+        mem_if.write(0x1000, 64, buf);
+
+        EXPECT_NOTHROW(fcp.loadCheckpoint(delta_id));
+        mem_if.read(0x80, 64, buf);
+        EXPECT_EQUAL(buf[0], 0xaa);
+        EXPECT_EQUAL(buf[8], 2);
+        mem_if.read(0x1000, 1, buf);
+        EXPECT_EQUAL(buf[0], 0x40);
+        EXPECT_EQUAL(r1->read<uint32_t>(), 0x22);
+
+        memset(buf, 0xee, sizeof(buf));
+        mem_if.write(0x80, 64, buf);
+    }
+
+    // Snapshots taken by the checkpointer share lines as well
+    for(uint32_t i = 0; i < 4; ++i){
+        mem_if.write(0x2000 + i * 64, 64, buf);
+        fcp.createCheckpoint();
+    }
+    EXPECT_TRUE(fcp.getNumSnapshots() > 1);
+    EXPECT_TRUE(mem_obj.tryGetLine(0x3000)->isShared());
+    EXPECT_NOTHROW(fcp.loadCheckpoint(delta_id));
+    mem_if.read(0x2000, 1, buf);
+    EXPECT_EQUAL(buf[0], 0x80);
+
+    // Teardown
+    root.enterTeardown();
+    clocks.enterTeardown();
+}
+
+//! \brief Compressed checkpoints load the same state as uncompressed ones
+void compressionTest()
+{
+    sparta::Scheduler sched;
+    RootTreeNode clocks("clocks");
+    sparta::Clock clk(&clocks, "clock", &sched);
+
+    RootTreeNode root;
+    DummyDevice dummy(&root);
+    std::unique_ptr<RegisterSet> rset(RegisterSet::create(&dummy, reg_defs));
+    auto r1 = rset->getRegister("reg2");
+    constexpr uint32_t MEM_SIZE = 64 * 1024;
+    MemoryObject mem_obj(&dummy,
+                         64, // 64B blocks
+                         MEM_SIZE,
+                         0xcc, // fill with conspicuous bytes
+                         1 // 1 byte of fill
+                         );
+    BlockingMemoryObjectIFNode mem_if(&dummy, // Parent node
+                                      "mem", // Name
+                                      "Memory interface",
+                                      nullptr, // associated translation interface
+                                      mem_obj);
+
+    FastCheckpointer fcp(root, &sched);
+    fcp.setSnapshotThreshold(4);
+    EXPECT_FALSE(fcp.isCompressionEnabled());
+    fcp.setCompression(true);
+    EXPECT_TRUE(fcp.isCompressionEnabled());
+
+    root.enterConfiguring();
+    root.enterFinalized();
+    sched.finalize();
+
+    // Zero-filled, repeated, and varied lines
+    std::vector<uint8_t> image(MEM_SIZE);
+    std::fill(image.begin(), image.begin() + 0x1000, 0);
+    std::fill(image.begin() + 0x1000, image.begin() + 0x2000, 0x5a);
+    uint32_t lcg = 1;
+    for(uint32_t i = 0x2000; i < MEM_SIZE; ++i){
+        lcg = lcg * 1103515245 + 12345;
+        image[i] = (lcg >> 16) % 8;
+    }
+    for(uint32_t addr = 0; addr < MEM_SIZE; addr += 64){
+        mem_if.write(addr, 64, &image[addr]);
+    }
+    r1->write<uint32_t>(0);
+
+    std::map<FastCheckpointer::chkpt_id_t, std::vector<uint8_t>> images;
+    fcp.createHead();
+    images[fcp.getHeadID()] = image;
+    EXPECT_FALSE(mem_obj.tryGetLine(0)->isShared());
+    EXPECT_TRUE(fcp.getCompressedSize() * 2 < fcp.getUncompressedSize());
+    EXPECT_TRUE(fcp.getUncompressedSize() > MEM_SIZE);
+
+    // Deltas and snapshots, with and without compression
+    for(uint32_t i = 1; i <= 12; ++i){
+        fcp.setCompression(i < 5 || i > 8);
+        for(uint32_t j = 0; j < 8; ++j){
+            lcg = lcg * 1103515245 + 12345;
+            const uint32_t addr = (lcg >> 8) % MEM_SIZE;
+            image[addr] = i;
+            mem_if.write(addr, 1, &image[addr]);
+        }
+        r1->write<uint32_t>(i);
+        sched.run(1, true, false);
+        images[fcp.createCheckpoint()] = image;
+    }
+    EXPECT_TRUE(fcp.getNumSnapshots() > 2);
+    EXPECT_TRUE(fcp.getCompressedSize() < fcp.getUncompressedSize());
+
+    std::vector<uint8_t> buf(MEM_SIZE);
+    for(auto id : {7u, 0u, 12u, 3u, 10u, 1u, 12u, 6u}){
+        fcp.loadCheckpoint(id);
+        for(uint32_t addr = 0; addr < MEM_SIZE; addr += 64){
+            mem_if.read(addr, 64, &buf[addr]);
+        }
+        EXPECT_TRUE(buf == images[id]);
+        EXPECT_EQUAL(r1->read<uint32_t>(), id);
+    }
+
+    // Teardown
+    root.enterTeardown();
+    clocks.enterTeardown();
+}
+
 void speedTest1()
 {
     RootTreeNode clocks("clocks");
@@ -978,6 +1181,8 @@ int main()
     deletionTest1();
     deletionTest2();
     deletionTest3();
+    copyOnWriteTest();
+    compressionTest();
 
     clock_t start = clock();
     std::array<clock_t, 5> times{{0,0,0,0,0}};
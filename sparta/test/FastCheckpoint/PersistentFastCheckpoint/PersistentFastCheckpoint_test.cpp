@@ -5,6 +5,9 @@
 #include <stack>
 #include <ctime>
 #include <array>
+#include <fstream>
+#include <sstream>
+#include <vector>
 
 #include "sparta/sparta.hpp"
 #include "sparta/simulation/TreeNode.hpp"
@@ -216,6 +219,121 @@ void generalTest()
     EXPECT_TRUE(memcmp(buf, compare, 32) == 0);
 }
 
+//! \brief Test for saving PersistentFastCheckpoints in the background
+void asyncTest()
+{
+    sparta::Scheduler sched;
+    RootTreeNode clocks("clocks");
+    sparta::Clock clk(&clocks, "clock", &sched);
+
+    RootTreeNode root;
+    DummyDevice dummy(&root);
+    std::unique_ptr<RegisterSet> rset(RegisterSet::create(&dummy, reg_defs));
+    auto r1 = rset->getRegister("reg2");
+    MemoryObject mem_obj(&dummy, 64, 4096, 0xcc, 1);
+    BlockingMemoryObjectIFNode mem_if(&dummy, "mem", "Memory interface", nullptr, mem_obj);
+
+    PersistentFastCheckpointer pfcp(root, &sched);
+    EXPECT_EQUAL(pfcp.getMaxAsyncSaves(), PersistentFastCheckpointer::DEFAULT_MAX_ASYNC_SAVES);
+    EXPECT_THROW(pfcp.setMaxAsyncSaves(0));
+    pfcp.setMaxAsyncSaves(2);
+
+    std::vector<PersistentFastCheckpointer::AsyncSaveResult> results;
+    pfcp.setAsyncSaveCallback([&](const PersistentFastCheckpointer::AsyncSaveResult& result) {
+        results.push_back(result);
+    });
+
+    root.enterConfiguring();
+    root.enterFinalized();
+    sched.finalize();
+
+    // Save several checkpoints, modifying everything right after each so
+    // the writer must see the state captured at the save
+    const uint32_t NUM_SAVES = 6;
+    uint8_t buf[32];
+    std::vector<PersistentFastCheckpointer::chkpt_id_t> ids;
+    for(uint32_t i = 0; i < NUM_SAVES; ++i){
+        r1->write<uint32_t>(0x100 + i);
+        memset(buf, 0x10 + i, sizeof(buf));
+        mem_if.write(0x100, 32, buf);
+        mem_if.write(0x800 + 64 * i, 32, buf);
+        std::ostringstream filename;
+        filename << "async_chkpt" << i;
+        ids.push_back(pfcp.saveAsync(filename.str()));
+        EXPECT_TRUE(pfcp.getNumAsyncSaves() + results.size() <= NUM_SAVES);
+
+        r1->write<uint32_t>(0xdead);
+        memset(buf, 0xee, sizeof(buf));
+        mem_if.write(0x100, 32, buf);
+        sched.run(10, true);
+    }
+
+    // A synchronous save of the same state writes the same file
+    r1->write<uint32_t>(0x200);
+    const PersistentFastCheckpointer::chkpt_id_t calculated_id = pfcp.saveAsync();
+    EXPECT_NOTHROW(pfcp.save("sync_chkpt"));
+
+    EXPECT_NOTHROW(pfcp.finishAsyncSaves());
+    EXPECT_EQUAL(pfcp.getNumAsyncSaves(), 0);
+    EXPECT_EQUAL(pfcp.processAsyncSaves(), 0);
+    EXPECT_EQUAL(results.size(), NUM_SAVES + 1);
+    for(uint32_t i = 0; i < results.size(); ++i){
+        EXPECT_TRUE(results[i].error == nullptr);
+        if(i < NUM_SAVES){
+            EXPECT_EQUAL(results[i].id, ids[i]);
+        }
+    }
+    EXPECT_EQUAL(results.back().id, calculated_id);
+    std::ostringstream calculated_filename;
+    calculated_filename << "chkpt." << calculated_id << ".data";
+    EXPECT_EQUAL(results.back().filename, calculated_filename.str());
+
+    auto readFile = [](const std::string& filename) {
+        std::ifstream in(filename, std::ifstream::binary);
+        std::ostringstream contents;
+        contents << in.rdbuf();
+        return contents.str();
+    };
+    const std::string sync_file = readFile("sync_chkpt");
+    EXPECT_FALSE(sync_file.empty());
+    EXPECT_TRUE(readFile(calculated_filename.str()) == sync_file);
+
+    // Restore in reverse order
+    uint8_t compare[32];
+    for(uint32_t i = NUM_SAVES; i-- > 0;){
+        EXPECT_NOTHROW(pfcp.restore(results[i].filename));
+        EXPECT_EQUAL(r1->read<uint32_t>(), 0x100 + i);
+        memset(compare, 0x10 + i, sizeof(compare));
+        mem_if.read(0x100, 32, buf);
+        EXPECT_TRUE(memcmp(buf, compare, 32) == 0);
+        for(uint32_t j = 0; j < NUM_SAVES; ++j){
+            mem_if.read(0x800 + 64 * j, 32, buf);
+            if(j > i){
+                memset(compare, 0xcc, sizeof(compare));
+            }else{
+                memset(compare, 0x10 + j, sizeof(compare));
+            }
+            EXPECT_TRUE(memcmp(buf, compare, 32) == 0);
+        }
+    }
+
+    // Failures are reported to the callback
+    results.clear();
+    EXPECT_NOTHROW(pfcp.saveAsync("no_such_dir/async_chkpt"));
+    EXPECT_NOTHROW(pfcp.finishAsyncSaves());
+    EXPECT_EQUAL(results.size(), 1);
+    EXPECT_TRUE(results.back().error != nullptr);
+
+    // Or thrown without one
+    pfcp.setAsyncSaveCallback(nullptr);
+    EXPECT_NOTHROW(pfcp.saveAsync("no_such_dir/async_chkpt"));
+    EXPECT_THROW(pfcp.finishAsyncSaves());
+    EXPECT_EQUAL(pfcp.getNumAsyncSaves(), 0);
+
+    // Saves still in flight are written on destruction
+    EXPECT_NOTHROW(pfcp.saveAsync("async_chkpt_last"));
+}
+
 int main() {
     std::unique_ptr<sparta::log::Tap> warn_cerr(new sparta::log::Tap(sparta::TreeNode::getVirtualGlobalNode(),
                                                                  sparta::log::categories::WARN,
@@ -226,6 +344,7 @@ int main() {
                                                                  "warnings.log"));
 
     generalTest();
+    asyncTest();
 
     REPORT_ERROR;
 
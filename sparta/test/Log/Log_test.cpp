@@ -6,6 +6,9 @@
 #include <chrono>
 #include <thread>
 #include <limits>
+#include <memory>
+#include <fstream>
+#include <sstream>
 
 #include "sparta/sparta.hpp"
 #include "sparta/simulation/TreeNode.hpp"
@@ -13,6 +16,7 @@
 #include "sparta/utils/LogUtils.hpp"
 #include "sparta/log/Tap.hpp"
 #include "sparta/log/MessageSource.hpp"
+#include "sparta/log/BinaryLog.hpp"
 
 /*!
  * \file main.cpp
@@ -93,6 +97,185 @@ public:
 
 sparta::ResourceFactory<TalkativeTreeNode::TalkativeResource> TalkativeTreeNode::talktive_res_fact;
 
+// Decodes a binary log into a text file using the formatter for the
+// text file's extension
+void decodeBinaryLog(const std::string& bin_file, const std::string& text_file,
+                     sparta::log::BinaryLogFilter filter = sparta::log::BinaryLogFilter())
+{
+    std::ifstream in(bin_file, std::ios::binary);
+    std::ofstream out(text_file);
+    std::unique_ptr<sparta::log::Formatter> fmt(sparta::log::Formatter::findInfo(text_file)->factory(out));
+    sparta::log::BinaryLogReader reader(in);
+    while(reader.next()){
+        if(filter.matches(reader)){
+            fmt->writeFields(reader.getMessage());
+        }
+    }
+    out << reader.getHeader();
+}
+
+// Checks that a binary log decodes to exactly what the text formatters
+// write, and that it can be filtered
+void testBinaryLog()
+{
+    sparta::RootTreeNode top("top");
+    sparta::TreeNode x("x", "X node");
+    sparta::TreeNode y("y", "Y node");
+    sparta::TreeNode z("z", "Z node");
+    top.addChild(x);
+    top.addChild(y);
+    y.addChild(z);
+    sparta::Scheduler sched;
+    sparta::Clock clk("clock", &sched);
+    x.setClock(&clk);
+
+    sparta::log::MessageSource x_src(&x, "bin_cat", "Messages for binary log tests");
+    sparta::log::MessageSource y_src(&y, "bin_cat", "Messages for binary log tests");
+    sparta::log::MessageSource z_src(&z, "other_bin_cat", "Messages for binary log tests");
+
+    const std::vector<std::string> text_logs = {"binary_ref.log", "binary_ref.log.basic",
+                                                "binary_ref.log.verbose", "binary_ref.log.raw"};
+    std::vector<std::unique_ptr<sparta::log::Tap>> taps;
+    for(const auto& text_log : text_logs){
+        taps.emplace_back(new sparta::log::Tap(&top, "", text_log));
+    }
+    taps.emplace_back(new sparta::log::Tap(&top, "", "binary.log.bin"));
+    taps.emplace_back(new sparta::log::Tap(&top, "", "async:binary_async.log.bin"));
+
+    // Some messages before the tree is built, whose locations can't be
+    // remembered
+    x_src << "Before the tree is built";
+    z_src << "Multi-line\nmessage before the tree is built";
+
+    top.enterConfiguring();
+    top.enterFinalized();
+    sched.finalize();
+
+    for(uint32_t i = 0; i < 100; ++i){
+        x_src << "Message " << i << " from x";
+        y_src << "Message " << i << " from y";
+        if(i % 10 == 0){
+            z_src << "Message " << i << " from z\nwith a newline";
+        }
+        sched.run(1, true, false);
+    }
+    sparta::log::DestinationManager::flushDestinations();
+
+    // Decoded logs match the text logs
+    for(const auto& text_log : text_logs){
+        const std::string decoded = "decoded_" + text_log;
+        decodeBinaryLog("binary.log.bin", decoded);
+        EXPECT_FILES_EQUAL(text_log, decoded);
+        decodeBinaryLog("binary_async.log.bin", "async_" + decoded);
+        EXPECT_FILES_EQUAL(text_log, "async_" + decoded);
+    }
+
+    // The header is kept
+    {
+        std::ifstream in("binary.log.bin", std::ios::binary);
+        sparta::log::BinaryLogReader reader(in);
+        EXPECT_TRUE(reader.next());
+        EXPECT_TRUE(reader.getHeader().find("#Name:") != std::string::npos);
+        EXPECT_EQUAL(*reader.getMessage().location, "top.x");
+        EXPECT_EQUAL(*reader.getMessage().category, "bin_cat");
+        EXPECT_EQUAL(*reader.getMessage().content, "Before the tree is built");
+    }
+
+    // Filters
+    auto countMatches = [](const sparta::log::BinaryLogFilter& f) {
+        sparta::log::BinaryLogFilter filter(f);
+        std::ifstream in("binary.log.bin", std::ios::binary);
+        sparta::log::BinaryLogReader reader(in);
+        uint32_t count = 0;
+        while(reader.next()){
+            count += filter.matches(reader);
+        }
+        return count;
+    };
+    sparta::log::BinaryLogFilter filter;
+    EXPECT_EQUAL(countMatches(filter), 212);
+
+    filter.addLocation("top.y");
+    EXPECT_EQUAL(countMatches(filter), 111); // y and its child z
+
+    filter.addCategory("other_*");
+    EXPECT_EQUAL(countMatches(filter), 11);
+
+    // Only x has a clock, so only its messages have ticks
+    filter.setTickRange(1, 50);
+    EXPECT_EQUAL(countMatches(filter), 0);
+
+    sparta::log::BinaryLogFilter x_filter;
+    x_filter.addLocation("top.?");
+    x_filter.addCategory("bin_*");
+    x_filter.setTickRange(1, 50);
+    EXPECT_EQUAL(countMatches(x_filter), 50);
+    x_filter.setTickRange(0, 9);
+    EXPECT_EQUAL(countMatches(x_filter), 111); // All of y, x before the tree is built and 10 cycles of x
+
+    // Not a binary log
+    std::ifstream not_binary("binary_ref.log");
+    EXPECT_THROW(sparta::log::BinaryLogReader reader(not_binary));
+
+    taps.clear();
+    top.enterTeardown();
+}
+
+// Checks that an asynchronous destination writes the same thing a
+// synchronous one does
+void testAsyncDestination()
+{
+    sparta::RootTreeNode top("top");
+    sparta::TreeNode x("x", "X node");
+    sparta::TreeNode y("y", "Y node");
+    top.addChild(x);
+    top.addChild(y);
+    sparta::log::MessageSource x_src(&x, "async_cat", "Messages for async destination tests");
+    sparta::log::MessageSource y_src(&y, "async_cat", "Messages for async destination tests");
+
+    sparta::log::Tap sync_tap(&top, "async_cat", "sync.log.basic");
+    sparta::log::Tap async_tap(&top, "async_cat", "async:async.log.basic");
+
+    // The unprefixed name refers to the same destination. Messages seen
+    // by both taps are written once
+    sparta::log::Tap async_tap_x(&x, "async_cat", "async.log.basic");
+    EXPECT_EQUAL(async_tap.getDestination(), async_tap_x.getDestination());
+
+    sparta::log::AsyncDestination* async_dest =
+        dynamic_cast<sparta::log::AsyncDestination*>(async_tap.getDestination());
+    EXPECT_NOTEQUAL(async_dest, nullptr);
+    EXPECT_EQUAL(dynamic_cast<sparta::log::AsyncDestination*>(sync_tap.getDestination()), nullptr);
+
+    // Enough interleaved messages to fill several batches
+    for(uint32_t i = 0; i < 20000; ++i){
+        x_src << "Message " << i << " from x";
+        y_src << "Message " << i << " from y";
+    }
+    sparta::log::DestinationManager::flushDestinations();
+    EXPECT_FILES_EQUAL("sync.log.basic", "async.log.basic");
+    if(async_dest){
+        EXPECT_TRUE(async_dest->getNumBatchesWritten() > 1);
+        EXPECT_EQUAL(async_dest->getNumMessagesWritten(), 40000);
+        EXPECT_EQUAL(async_dest->getNumMessageDuplicates(), 20000);
+    }
+
+    // Without a flush, a message is written within the flush interval
+    sparta::log::AsyncDestination::setDefaultFlushInterval(std::chrono::milliseconds(10));
+    sparta::log::Tap timed_tap(&x, "async_cat", "async:async_timed.log.basic");
+    x_src << "Timed message";
+    bool found = false;
+    for(uint32_t tries = 0; tries < 500 && !found; ++tries){
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::ifstream in("async_timed.log.basic");
+        std::stringstream content;
+        content << in.rdbuf();
+        found = content.str().find("Timed message") != std::string::npos;
+    }
+    EXPECT_TRUE(found);
+
+    top.enterTeardown();
+}
+
 int main()
 {
     // Tap which outlives the tree to capture destructors
@@ -395,6 +578,9 @@ int main()
     EXPECT_FILES_EQUAL("a_nodups.log.EXPECTED",         "a_nodups.log");
     EXPECT_FILES_EQUAL("a_cats_wildcard.log.EXPECTED",  "a_cats_wildcard.log");
 
+    testAsyncDestination();
+    testBinaryLog();
+
     // Done
 
     REPORT_ERROR;
@@ -3,6 +3,8 @@
 #include <iostream>
 #include <cstring>
 #include <memory>
+#include <array>
+#include <vector>
 
 #include "Producer.hpp"
 #include "Consumer.hpp"
@@ -28,6 +30,7 @@ TEST_INIT
  */
 
 void testPortCancels_();
+void testPortBatches_();
 void tryDAGIssue_(bool);
 
 int main ()
@@ -39,6 +42,9 @@ int main ()
     // Test port cancels
     testPortCancels_();
 
+    // Test batched sends
+    testPortBatches_();
+
     // Test communication between blocks using ports
     sparta::Scheduler sched;
     sparta::ClockManager cm(&sched);
@@ -400,3 +406,145 @@ void testPortCancels_()
     // Reset for next tests
     sched.reset();
 }
+
+// Records every item it gets, one at a time
+class ItemReceiver
+{
+public:
+    ItemReceiver(sparta::PortSet * ps, sparta::Clock::Cycle delay) :
+        receiver_pt(ps, "item_receiver", delay)
+    {
+        receiver_pt.registerConsumerHandler(CREATE_SPARTA_HANDLER_WITH_DATA(ItemReceiver, getItem, uint32_t));
+    }
+
+    void getItem(const uint32_t & dat) {
+        received.emplace_back(dat);
+    }
+
+    sparta::DataInPort<uint32_t> receiver_pt;
+    std::vector<uint32_t> received;
+};
+
+// Records items sent individually and batches separately
+class BatchReceiver
+{
+public:
+    BatchReceiver(sparta::PortSet * ps, sparta::Clock::Cycle delay) :
+        receiver_pt(ps, "batch_receiver", delay)
+    {
+        receiver_pt.registerConsumerHandler(CREATE_SPARTA_HANDLER_WITH_DATA(BatchReceiver, getItem, uint32_t));
+        receiver_pt.registerConsumerBatchHandler(CREATE_SPARTA_HANDLER_WITH_DATA(BatchReceiver, getBatch,
+                                                                                 sparta::DataBatchView<uint32_t>));
+    }
+
+    void getItem(const uint32_t & dat) {
+        received.emplace_back(1, dat);
+    }
+
+    void getBatch(const sparta::DataBatchView<uint32_t> & batch) {
+        EXPECT_EQUAL(receiver_pt.peekData(), batch[batch.size() - 1]);
+        received.emplace_back(batch.begin(), batch.end());
+    }
+
+    sparta::DataInPort<uint32_t> receiver_pt;
+    std::vector<std::vector<uint32_t>> received;
+};
+
+void testPortBatches_()
+{
+    sparta::Scheduler sched;
+    sparta::Clock    clk("dummy", &sched);
+    sparta::PortSet  ps(nullptr);
+    ps.setClock(&clk);
+    ItemReceiver  item_receiver(&ps, 0);
+    BatchReceiver batch_receiver(&ps, 1);
+    sparta::DataOutPort<uint32_t> sender_pt(&ps, "sender");
+
+    // Fan out to both
+    sparta::bind(item_receiver.receiver_pt, sender_pt);
+    sparta::bind(batch_receiver.receiver_pt, sender_pt);
+    EXPECT_NOTHROW(sched.finalize());
+
+    using Batch = std::vector<uint32_t>;
+    using Batches = std::vector<Batch>;
+
+    // One batch.  The item receiver unrolls it; the batch receiver,
+    // with one more cycle of port delay, gets it a cycle later
+    const Batch first{1, 2, 3, 4};
+    sender_pt.sendBatch(first, 1);
+    EXPECT_TRUE(item_receiver.receiver_pt.isDriven(1));
+    EXPECT_TRUE(batch_receiver.receiver_pt.isDriven(2));
+    EXPECT_FALSE(batch_receiver.receiver_pt.isDriven(1));
+    sched.run(2);
+    EXPECT_EQUAL(item_receiver.received, first);
+    EXPECT_TRUE(batch_receiver.received.empty());
+    EXPECT_TRUE(batch_receiver.receiver_pt.isDriven());
+    sched.run(1);
+    EXPECT_EQUAL(batch_receiver.received, Batches{first});
+    EXPECT_FALSE(item_receiver.receiver_pt.isDriven());
+    EXPECT_FALSE(batch_receiver.receiver_pt.isDriven());
+    item_receiver.received.clear();
+    batch_receiver.received.clear();
+
+    // Empty batches are not sent
+    sender_pt.sendBatch(Batch{});
+    EXPECT_FALSE(item_receiver.receiver_pt.isDriven());
+    EXPECT_FALSE(batch_receiver.receiver_pt.isDriven());
+
+    // Single sends and batches sent for the same cycle arrive in the
+    // order they were sent
+    const std::array<uint32_t, 2> second{11, 12};
+    sender_pt.send(10, 1);
+    sender_pt.sendBatch(second, 1);
+    sender_pt.send(13, 1);
+    sender_pt.sendBatch(sparta::DataBatchView<uint32_t>(first.data(), 2), 1);
+    sched.run(3);
+    EXPECT_EQUAL(item_receiver.received, (Batch{10, 11, 12, 13, 1, 2}));
+    EXPECT_EQUAL(batch_receiver.received, (Batches{{10}, {11, 12}, {13}, {1, 2}}));
+    item_receiver.received.clear();
+    batch_receiver.received.clear();
+
+    // Zero-cycle batches sent outside of the delivery phase are
+    // delivered later in the same cycle, as single sends are
+    sender_pt.sendBatch(first, 0);
+    EXPECT_TRUE(item_receiver.received.empty());
+    sched.run(1);
+    EXPECT_EQUAL(item_receiver.received, first);
+    sched.run(1);
+    EXPECT_EQUAL(batch_receiver.received, Batches{first});
+    item_receiver.received.clear();
+    batch_receiver.received.clear();
+
+    // Cancel everything: each item counts
+    sender_pt.sendBatch(first, 1);
+    sender_pt.sendBatch(second, 2);
+    sender_pt.send(5, 2);
+    EXPECT_EQUAL(item_receiver.receiver_pt.cancel(), 7u);
+    EXPECT_EQUAL(batch_receiver.receiver_pt.cancel(), 7u);
+    EXPECT_FALSE(item_receiver.receiver_pt.isDriven());
+    EXPECT_FALSE(batch_receiver.receiver_pt.isDriven());
+    sched.run(4);
+    EXPECT_TRUE(item_receiver.received.empty());
+    EXPECT_TRUE(batch_receiver.received.empty());
+
+    // Cancel some items: the rest of the batch still goes; a batch
+    // left empty is dropped
+    sender_pt.sendBatch(first, 1);
+    sender_pt.sendBatch(Batch{2, 2}, 2);
+    sender_pt.send(2, 2);
+    EXPECT_EQUAL(item_receiver.receiver_pt.cancelIf(uint32_t(2)), 4u);
+    EXPECT_EQUAL(batch_receiver.receiver_pt.cancelIf([](const uint32_t & val) {
+                return val == 2 || val == 4;
+            }), 5u);
+    EXPECT_TRUE(item_receiver.receiver_pt.isDriven(1));
+    EXPECT_FALSE(item_receiver.receiver_pt.isDriven(2));
+    EXPECT_TRUE(batch_receiver.receiver_pt.isDriven(2));
+    EXPECT_FALSE(batch_receiver.receiver_pt.isDriven(3));
+    sched.run(4);
+    EXPECT_EQUAL(item_receiver.received, (Batch{1, 3, 4}));
+    EXPECT_EQUAL(batch_receiver.received, (Batches{{1, 3}}));
+
+    // Sending on an unbound port is an error
+    sparta::DataOutPort<uint32_t> unbound_pt(&ps, "unbound");
+    EXPECT_THROW(unbound_pt.sendBatch(first));
+}
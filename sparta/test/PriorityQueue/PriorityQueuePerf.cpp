@@ -0,0 +1,101 @@
+// Compares the PriorityQueue backends on an issue-queue like workload.
+//
+// A queue is filled to a given occupancy, then every cycle one entry
+// is inserted and the highest priority entry popped; every fourth cycle
+// an entry is also removed from the middle and another inserted.  The
+// list backends (std::list and FastList) scan for each insertion point;
+// the tree backend finds it in O(log n).
+
+#include <inttypes.h>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "sparta/resources/PriorityQueue.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+TEST_INIT
+
+constexpr uint32_t CYCLES = 200000;
+constexpr size_t   MAX_ENTRIES = 1024;
+
+struct Entry
+{
+    uint32_t priority;
+    uint32_t id;
+    bool operator==(const Entry & other) const { return id == other.id; }
+};
+
+struct EntrySorter
+{
+    bool operator()(const Entry & a, const Entry & b) const { return a.priority < b.priority; }
+};
+
+using ListPQ       = sparta::PriorityQueue<Entry, EntrySorter>;
+using FastListPQ   = sparta::PriorityQueue<Entry, EntrySorter, MAX_ENTRIES>;
+using TreePQ       = sparta::PriorityQueue<Entry, EntrySorter, 0, sparta::PriorityQueueBackend::TREE>;
+using BoundedTreePQ = sparta::PriorityQueue<Entry, EntrySorter, MAX_ENTRIES, sparta::PriorityQueueBackend::TREE>;
+
+// Runs the workload, returning ns per cycle and a checksum of the
+// entries popped
+template<class PQueueT>
+std::pair<double, uint64_t> runCycles(uint32_t occupancy)
+{
+    PQueueT pqueue;
+    std::mt19937 rng(1234);
+    uint32_t next_id = 0;
+    // Priorities are mostly the age of the entry, with some jitter,
+    // like an age-ordered scheduler with a few high priority entries
+    auto next = [&]() {
+        const uint32_t jitter = (rng() % 8 == 0) ? (rng() % occupancy) : 0;
+        ++next_id;
+        return Entry{next_id - jitter, next_id};
+    };
+    for(uint32_t i = 0; i < occupancy; ++i) {
+        pqueue.insert(next());
+    }
+
+    uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for(uint32_t cycle = 0; cycle < CYCLES; ++cycle)
+    {
+        pqueue.insert(next());
+        checksum = checksum * 31 + pqueue.top().id;
+        pqueue.pop();
+        if(cycle % 4 == 0) {
+            auto it = pqueue.begin();
+            std::advance(it, 3);
+            pqueue.erase(it);
+            pqueue.insert(next());
+        }
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQUAL(pqueue.size(), occupancy);
+    return {ns / CYCLES, checksum};
+}
+
+int main()
+{
+    for(uint32_t occupancy : {16u, 64u, 128u, 256u, 512u})
+    {
+        const auto list        = runCycles<ListPQ>(occupancy);
+        const auto fast_list   = runCycles<FastListPQ>(occupancy);
+        const auto tree        = runCycles<TreePQ>(occupancy);
+        const auto bounded_tree = runCycles<BoundedTreePQ>(occupancy);
+
+        // Every backend pops the same entries
+        EXPECT_EQUAL(fast_list.second, list.second);
+        EXPECT_EQUAL(tree.second, list.second);
+        EXPECT_EQUAL(bounded_tree.second, list.second);
+
+        std::cout << "Occupancy " << occupancy << " (ns/cycle): list " << list.first
+                  << ", FastList " << fast_list.first
+                  << ", tree " << tree.first
+                  << ", bounded tree " << bounded_tree.first
+                  << " (" << fast_list.first / tree.first << "x FastList)" << std::endl;
+    }
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
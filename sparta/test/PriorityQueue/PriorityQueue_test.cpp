@@ -4,6 +4,8 @@
 #include <cinttypes>
 #include <iostream>
 #include <chrono>
+#include <random>
+#include <vector>
 
 #include "sparta/utils/SpartaTester.hpp"
 
@@ -198,6 +200,146 @@ void test_fastlist_vs_list()
 }
 
 
+using TreePQ = sparta::PriorityQueue<uint32_t, std::less<uint32_t>, 0, sparta::PriorityQueueBackend::TREE>;
+
+void test_tree_pq()
+{
+    TreePQ pqueue;
+
+    for(auto i : {1,3,2,5,6,4,8,7}) {
+        pqueue.insert(i);
+    }
+
+    EXPECT_EQUAL(pqueue.size(), 8);
+    EXPECT_EQUAL(pqueue.top(), 1);
+    EXPECT_EQUAL(pqueue.back(), 8);
+    pqueue.pop(); // 1
+    EXPECT_EQUAL(pqueue.top(), 2);
+
+    pqueue.insert(100);
+    EXPECT_EQUAL(pqueue.top(), 2);
+    EXPECT_EQUAL(pqueue.back(), 100);
+
+    pqueue.remove(5);
+    EXPECT_EQUAL(pqueue.size(), 7);
+    pqueue.pop(); // 2
+    pqueue.pop(); // 3
+    pqueue.pop(); // 4
+    EXPECT_EQUAL(pqueue.top(), 6);
+
+    // Forced entries stay in front, the most recent first
+    pqueue.forceFront(500);
+    pqueue.forceFront(400);
+    pqueue.insert(1);
+    EXPECT_EQUAL(pqueue.top(), 400);
+    pqueue.remove(500);
+    pqueue.pop(); // 400
+    EXPECT_EQUAL(pqueue.top(), 1);
+
+    std::vector<uint32_t> contents(pqueue.begin(), pqueue.end());
+    EXPECT_TRUE(contents == std::vector<uint32_t>({1, 6, 7, 8, 100}));
+
+    while(!pqueue.empty()) {
+        pqueue.pop();
+    }
+    EXPECT_THROW(pqueue.pop());
+    EXPECT_THROW(pqueue.top());
+    EXPECT_THROW(pqueue.back());
+    EXPECT_NOTHROW(pqueue.remove(10));
+
+    pqueue.insert(100);
+    pqueue.insert(100);
+    auto it = pqueue.begin();
+    EXPECT_EQUAL(*it, 100);
+    pqueue.erase(it);
+    EXPECT_EQUAL(pqueue.size(), 1);
+
+    const TreePQ & const_pqueue = pqueue;
+    pqueue.erase(const_pqueue.begin());
+    EXPECT_TRUE(pqueue.empty());
+
+    // Bounded trees
+    sparta::PriorityQueue<int, std::less<int>, 4, sparta::PriorityQueueBackend::TREE> bounded_pq;
+    for(auto i : {3, 1, 4, 2}) {
+        bounded_pq.insert(i);
+    }
+    EXPECT_EQUAL(bounded_pq.top(), 1);
+    EXPECT_THROW(bounded_pq.insert(5));
+    EXPECT_THROW(bounded_pq.forceFront(5));
+}
+
+// Entries ordered by priority only, so equal priorities keep their
+// insertion order
+struct Entry
+{
+    uint32_t priority;
+    uint32_t id;
+    bool operator==(const Entry & other) const { return id == other.id; }
+};
+
+struct EntrySorter
+{
+    bool operator()(const Entry & a, const Entry & b) const { return a.priority < b.priority; }
+};
+
+void test_tree_matches_list()
+{
+    sparta::PriorityQueue<Entry, EntrySorter> list_pq;
+    sparta::PriorityQueue<Entry, EntrySorter, 256, sparta::PriorityQueueBackend::TREE> tree_pq;
+
+    std::mt19937 rng(42);
+    std::vector<Entry> live;
+    uint32_t next_id = 0;
+    for(uint32_t op = 0; op < 20000; ++op)
+    {
+        const uint32_t choice = rng() % 10;
+        if(choice < 5 && list_pq.size() < 256) {
+            const Entry e{static_cast<uint32_t>(rng() % 32), next_id++};
+            list_pq.insert(e);
+            tree_pq.insert(e);
+        }
+        else if(choice < 7 && !list_pq.empty()) {
+            list_pq.pop();
+            tree_pq.pop();
+        }
+        else if(choice < 8 && !list_pq.empty()) {
+            // Remove from the middle
+            auto it = list_pq.begin();
+            std::advance(it, rng() % list_pq.size());
+            const Entry e = *it;
+            list_pq.remove(e);
+            tree_pq.remove(e);
+        }
+        else if(choice < 9 && !list_pq.empty()) {
+            const uint32_t pos = rng() % list_pq.size();
+            auto lit = list_pq.begin();
+            auto tit = tree_pq.begin();
+            std::advance(lit, pos);
+            std::advance(tit, pos);
+            list_pq.erase(lit);
+            tree_pq.erase(tit);
+        }
+        else if(list_pq.size() < 256) {
+            // A forced entry is handled right away
+            const Entry e{0xffff, next_id++};
+            list_pq.forceFront(e);
+            tree_pq.forceFront(e);
+            EXPECT_EQUAL(tree_pq.top().id, e.id);
+            list_pq.pop();
+            tree_pq.pop();
+        }
+
+        EXPECT_EQUAL(tree_pq.size(), list_pq.size());
+        if(!list_pq.empty()) {
+            EXPECT_EQUAL(tree_pq.top().id, list_pq.top().id);
+            EXPECT_EQUAL(tree_pq.back().id, list_pq.back().id);
+        }
+        if(op % 100 == 0) {
+            EXPECT_TRUE(std::equal(tree_pq.begin(), tree_pq.end(), list_pq.begin(), list_pq.end()));
+        }
+    }
+}
+
 int main()
 {
     test_defafult_pq();
@@ -205,6 +347,9 @@ int main()
 
     test_fastlist_vs_list();
 
+    test_tree_pq();
+    test_tree_matches_list();
+
     REPORT_ERROR;
     return ERROR_CODE;
 }
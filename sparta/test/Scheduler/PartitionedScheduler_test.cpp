@@ -0,0 +1,289 @@
+
+
+// Tests sparta::PartitionedScheduler: the same model run on one
+// Scheduler, as a single partition, and split into partitions must
+// see the same data at the same ticks.
+
+#include <inttypes.h>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "sparta/sparta.hpp"
+#include "sparta/kernel/PartitionedScheduler.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/events/Event.hpp"
+#include "sparta/events/EventSet.hpp"
+#include "sparta/ports/DataPort.hpp"
+#include "sparta/ports/PortSet.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+TEST_INIT
+
+constexpr sparta::Clock::Cycle PORT_DELAY = 3;
+
+// A TreeNode with a clock, for the ports and events below it
+class ClockedNode : public sparta::TreeNode
+{
+public:
+    ClockedNode(const std::string & name, sparta::Clock * clk) :
+        sparta::TreeNode(nullptr, name, "Core")
+    {
+        setClock(clk);
+    }
+};
+
+// A core that sends a stream of items (some in batches) to its peer
+// and echoes some of what it receives back
+class Core
+{
+public:
+    using Record = std::pair<sparta::Scheduler::Tick, uint32_t>;
+
+    Core(sparta::Clock * clk, uint32_t id, uint32_t num_sends) :
+        node("core" + std::to_string(id), clk),
+        ps(&node),
+        es(&node),
+        out(&ps, "data_out"),
+        in(&ps, "data_in", PORT_DELAY),
+        id_(id),
+        num_sends_(num_sends)
+    {
+        in.registerConsumerHandler(CREATE_SPARTA_HANDLER_WITH_DATA(Core, receive_, uint32_t));
+        in.registerConsumerBatchHandler(CREATE_SPARTA_HANDLER_WITH_DATA(Core, receiveBatch_,
+                                                                       sparta::DataBatchView<uint32_t>));
+    }
+
+    void start() {
+        if(num_sends_ > 0) {
+            send_event_.schedule(1);
+        }
+    }
+
+    ClockedNode      node;
+    sparta::PortSet  ps;
+    sparta::EventSet es;
+    sparta::DataOutPort<uint32_t> out;
+    sparta::DataInPort<uint32_t>  in;
+
+    //! Ticks and values of everything received
+    std::vector<Record> received;
+
+    //! Throw when receiving this value
+    uint32_t throw_on = ~0u;
+
+private:
+    void send_()
+    {
+        const uint32_t val = id_ * 1000 + sent_;
+        if(sent_ % 4 == 3) {
+            const std::vector<uint32_t> batch{val, val + 500};
+            out.sendBatch(batch, sent_ % 3);
+        }
+        else {
+            out.send(val, sent_ % 3);
+        }
+        if(++sent_ < num_sends_) {
+            send_event_.schedule(1 + sent_ % 2);
+        }
+    }
+
+    void receive_(const uint32_t & val)
+    {
+        sparta_assert(val != throw_on, "Received " << val);
+        received.emplace_back(node.getClock()->currentTick(), val);
+        // Echo the first few back, once
+        if(val % 1000 < 20) {
+            out.send(val + 100);
+        }
+    }
+
+    void receiveBatch_(const sparta::DataBatchView<uint32_t> & batch)
+    {
+        for(const uint32_t val : batch) {
+            received.emplace_back(node.getClock()->currentTick(), val + 10000);
+        }
+    }
+
+    sparta::Event<> send_event_{&es, "send_event", CREATE_SPARTA_HANDLER(Core, send_)};
+    const uint32_t id_;
+    const uint32_t num_sends_;
+    uint32_t sent_ = 0;
+};
+
+// Two cores exchanging data, on one Scheduler or one each
+struct Model
+{
+    Model(bool partitioned, uint32_t num_sends0 = 40, uint32_t num_sends1 = 30) :
+        clk0("clk0", &sched0),
+        clk1("clk1", partitioned ? &sched1 : &sched0),
+        core0(&clk0, 0, num_sends0),
+        core1(&clk1, 1, num_sends1)
+    {
+        sparta::bind(core0.out, core1.in);
+        sparta::bind(core1.out, core0.in);
+    }
+
+    void start() {
+        core0.start();
+        core1.start();
+    }
+
+    sparta::Scheduler sched0{"sched0"};
+    sparta::Scheduler sched1{"sched1"};
+    sparta::Clock clk0;
+    sparta::Clock clk1;
+    Core core0;
+    Core core1;
+};
+
+void testSameResults()
+{
+    // Reference: both cores on one Scheduler
+    Model ref(false);
+    ref.sched0.finalize();
+    ref.start();
+    ref.sched0.run();
+    EXPECT_TRUE(ref.sched0.getInboundLinks().empty());
+    EXPECT_FALSE(ref.core0.received.empty());
+    EXPECT_FALSE(ref.core1.received.empty());
+
+    // One partition runs the Scheduler as is
+    {
+        Model m(false);
+        sparta::PartitionedScheduler psched;
+        psched.addPartition(&m.sched0);
+        psched.finalize();
+        EXPECT_EQUAL(psched.getLookahead(), sparta::Scheduler::INDEFINITE);
+        m.start();
+        psched.run();
+        EXPECT_EQUAL(psched.getNumWindows(), 0);
+        EXPECT_EQUAL(m.core0.received, ref.core0.received);
+        EXPECT_EQUAL(m.core1.received, ref.core1.received);
+        EXPECT_EQUAL(m.sched0.getCurrentTick(), ref.sched0.getCurrentTick());
+        EXPECT_EQUAL(m.sched0.getNumFired(), ref.sched0.getNumFired());
+    }
+
+    // Two partitions, run several times
+    for(uint32_t i = 0; i < 3; ++i)
+    {
+        Model m(true);
+        EXPECT_EQUAL(m.sched0.getInboundLinks().size(), 1);
+        EXPECT_EQUAL(m.sched1.getInboundLinks().size(), 1);
+        sparta::PartitionedScheduler psched;
+        EXPECT_EQUAL(psched.addPartition(&m.sched0), 0);
+        EXPECT_EQUAL(psched.addPartition(&m.sched1), 1);
+        EXPECT_THROW(psched.addPartition(&m.sched1));
+        psched.finalize();
+        EXPECT_EQUAL(psched.getLookahead(), PORT_DELAY);
+        m.start();
+        psched.run();
+        EXPECT_EQUAL(m.core0.received, ref.core0.received);
+        EXPECT_EQUAL(m.core1.received, ref.core1.received);
+        EXPECT_TRUE(m.sched0.isFinished());
+        EXPECT_TRUE(m.sched1.isFinished());
+        EXPECT_EQUAL(m.sched0.getCurrentTick(), m.sched1.getCurrentTick());
+        EXPECT_TRUE(m.sched0.getCurrentTick() >= ref.sched0.getCurrentTick());
+        EXPECT_TRUE(psched.getNumWindows() > 1);
+    }
+}
+
+void testRunLimits()
+{
+    // Run in pieces, exactly
+    Model ref(false);
+    ref.sched0.finalize();
+    ref.start();
+    ref.sched0.run();
+
+    Model m(true);
+    sparta::PartitionedScheduler psched;
+    psched.addPartition(&m.sched0);
+    psched.addPartition(&m.sched1);
+    psched.finalize();
+    m.start();
+    psched.run(10, true);
+    EXPECT_EQUAL(m.sched0.getCurrentTick(), 10);
+    EXPECT_EQUAL(m.sched1.getCurrentTick(), 10);
+    psched.run(7, true);
+    EXPECT_EQUAL(m.sched0.getCurrentTick(), 17);
+    EXPECT_EQUAL(m.sched1.getCurrentTick(), 17);
+    psched.run(1, true);
+    EXPECT_EQUAL(m.sched0.getCurrentTick(), 18);
+    psched.run();
+    EXPECT_EQUAL(m.core0.received, ref.core0.received);
+    EXPECT_EQUAL(m.core1.received, ref.core1.received);
+
+    // Nothing left to do, but an exacting run advances time
+    const sparta::Scheduler::Tick end = m.sched0.getCurrentTick();
+    psched.run(100);
+    EXPECT_EQUAL(m.sched0.getCurrentTick(), end);
+    psched.run(100, true);
+    EXPECT_EQUAL(m.sched0.getCurrentTick(), end + 100);
+    EXPECT_EQUAL(m.sched1.getCurrentTick(), end + 100);
+}
+
+void testIdleWindows()
+{
+    // A single send far in the future; the idle time between is
+    // covered by few windows
+    Model m(true, 0, 0);
+    sparta::PartitionedScheduler psched;
+    psched.addPartition(&m.sched0);
+    psched.addPartition(&m.sched1);
+    psched.finalize();
+    m.core0.out.send(7, 1000);
+    psched.run();
+    const std::vector<Core::Record> expected{{1000 + PORT_DELAY, 7}};
+    EXPECT_EQUAL(m.core1.received, expected);
+    EXPECT_TRUE(psched.getNumWindows() < 5);
+}
+
+void testErrors()
+{
+    // Cross-partition DataInPorts need a delay
+    {
+        sparta::Scheduler sched0, sched1;
+        sparta::Clock clk0("clk0", &sched0), clk1("clk1", &sched1);
+        sparta::PortSet ps0(nullptr), ps1(nullptr);
+        ps0.setClock(&clk0);
+        ps1.setClock(&clk1);
+        sparta::DataOutPort<uint32_t> out(&ps0, "data_out");
+        sparta::DataInPort<uint32_t> in(&ps1, "data_in", 0);
+        EXPECT_THROW(sparta::bind(out, in));
+    }
+
+    // All senders must be partitions
+    {
+        Model m(true);
+        sparta::PartitionedScheduler psched;
+        psched.addPartition(&m.sched0);
+        EXPECT_THROW(psched.finalize());
+    }
+
+    // Exceptions in any partition come back through run
+    {
+        Model m(true);
+        m.core0.throw_on = 1005;
+        sparta::PartitionedScheduler psched;
+        psched.addPartition(&m.sched0);
+        psched.addPartition(&m.sched1);
+        psched.finalize();
+        m.start();
+        EXPECT_THROW(psched.run());
+    }
+}
+
+int main()
+{
+    testSameResults();
+    testRunLimits();
+    testIdleWindows();
+    testErrors();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -0,0 +1,136 @@
+
+// Measures the cost of Scheduler::isScheduled and
+// Scheduler::cancelEvent with many outstanding events.
+//
+// Each Scheduleable that is scheduled exactly once is found through
+// the location the Scheduler recorded for it.  Scheduling an event a
+// second time forces the Scheduler to search for it, which is how
+// every query/cancellation used to be done.
+
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/events/Scheduleable.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/RootTreeNode.hpp"
+#include "sparta/statistics/CounterBase.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+TEST_INIT
+
+class PerfEvent : public sparta::Scheduleable
+{
+public:
+    PerfEvent(sparta::TreeNode * rtn) :
+        Scheduleable(CREATE_SPARTA_HANDLER(PerfEvent, fire), 0, sparta::SchedulingPhase::Tick)
+    {
+        sparta::Scheduleable::local_clk_ = rtn->getClock();
+        sparta::Scheduleable::scheduler_ = rtn->getClock()->getScheduler();
+    }
+
+    void fire() { ++fired; }
+
+    uint32_t fired = 0;
+};
+
+constexpr uint32_t NUM_OUTSTANDING = 10000;
+
+// Query and cancel each of the given events, then put them back;
+// return the average time in nanoseconds per query/cancel.
+// Rescheduling is left out of the measurement.
+double queryAndCancel(sparta::Scheduler & sched,
+                      std::vector<std::unique_ptr<PerfEvent>> & events,
+                      uint32_t num_events, uint32_t passes)
+{
+    double total_ns = 0;
+    for(uint32_t pass = 0; pass < passes; ++pass)
+    {
+        uint32_t num_found = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < num_events; ++i)
+        {
+            PerfEvent * ev = events[i].get();
+            const sparta::Scheduler::Tick rel_tick = i + 1;
+            num_found += sched.isScheduled(ev);
+            num_found += sched.isScheduled(ev, rel_tick);
+            sched.cancelEvent(ev, rel_tick);
+        }
+        const auto stop = std::chrono::steady_clock::now();
+        total_ns += std::chrono::duration<double, std::nano>(stop - start).count();
+        EXPECT_EQUAL(num_found, 2 * num_events);
+
+        for(uint32_t i = 0; i < num_events; ++i) {
+            EXPECT_FALSE(sched.isScheduled(events[i].get(), i + 1));
+            sched.scheduleEvent(events[i].get(), i + 1, events[i]->getGroupID());
+        }
+    }
+    return total_ns / (double(num_events) * passes);
+}
+
+int main()
+{
+    sparta::Scheduler sched;
+    sparta::Clock clk("clock", &sched);
+    sparta::RootTreeNode rtn("dummyrtn");
+    rtn.setClock(&clk);
+
+    std::vector<std::unique_ptr<PerfEvent>> events;
+    for(uint32_t i = 0; i < NUM_OUTSTANDING; ++i) {
+        events.emplace_back(new PerfEvent(&rtn));
+    }
+    sched.finalize();
+
+    // One event per tick, 10k ticks into the future
+    for(uint32_t i = 0; i < NUM_OUTSTANDING; ++i) {
+        sched.scheduleEvent(events[i].get(), i + 1, events[i]->getGroupID());
+    }
+
+    // Every one of those ticks has its own time quantum
+    const sparta::CounterBase * tick_quanta_peak =
+        sched.getChildAs<sparta::CounterBase>("stats.tick_quanta_peak");
+    EXPECT_EQUAL(tick_quanta_peak->get(), NUM_OUTSTANDING);
+
+    const double tracked_ns = queryAndCancel(sched, events, NUM_OUTSTANDING, 10);
+
+    // Schedule a second copy of a subset of the events past all the
+    // others.  These can no longer be located directly and must be
+    // searched for.
+    constexpr uint32_t NUM_SEARCHED = 1000;
+    for(uint32_t i = 0; i < NUM_SEARCHED; ++i) {
+        sched.scheduleEvent(events[i].get(), 2 * NUM_OUTSTANDING, events[i]->getGroupID());
+    }
+    const double searched_ns = queryAndCancel(sched, events, NUM_SEARCHED, 10);
+
+    std::cout << "Outstanding events:     " << NUM_OUTSTANDING << "\n"
+              << "Located query/cancel:   " << tracked_ns << " ns/event\n"
+              << "Searched query/cancel:  " << searched_ns << " ns/event\n"
+              << "Speedup:                " << (searched_ns / tracked_ns) << "x" << std::endl;
+
+    // Cancel everything everywhere, and make sure nothing fires
+    for(uint32_t i = 0; i < NUM_OUTSTANDING; ++i) {
+        sched.cancelEvent(events[i].get());
+        EXPECT_FALSE(sched.isScheduled(events[i].get()));
+    }
+    sched.run(3 * NUM_OUTSTANDING, true, false);
+    for(const auto & ev : events) {
+        EXPECT_EQUAL(ev->fired, 0);
+    }
+
+    // Reschedule and run them all
+    for(uint32_t i = 0; i < NUM_OUTSTANDING; ++i) {
+        sched.scheduleEvent(events[i].get(), i + 1, events[i]->getGroupID());
+    }
+    sched.run();
+    for(const auto & ev : events) {
+        EXPECT_EQUAL(ev->fired, 1);
+        EXPECT_FALSE(sched.isScheduled(ev.get()));
+    }
+
+    rtn.enterTeardown();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -104,6 +104,128 @@ public:
 
 };
 
+// An event that records when it fired and reschedules itself using
+// a fixed pseudo-random pattern of near and far-future delays
+using FiringLog = std::vector<std::pair<sparta::Scheduler::Tick, uint32_t>>;
+template<sparta::SchedulingPhase phase>
+class RecordingEvent : public sparta::Scheduleable
+{
+public:
+    RecordingEvent(sparta::TreeNode * rtn, uint32_t id, FiringLog & log) :
+        Scheduleable(CREATE_SPARTA_HANDLER(RecordingEvent, fire), 0, phase),
+        id_(id),
+        log_(log),
+        lcg_(id * 2654435761u + 1)
+    {
+        sparta::Scheduleable::local_clk_ = rtn->getClock();
+        sparta::Scheduleable::scheduler_ = rtn->getClock()->getScheduler();
+    }
+
+    sparta::Scheduler::Tick nextDelay() {
+        static const sparta::Scheduler::Tick delays[] =
+            {1, 2, 7, 1000, 1024, 50000, 400000, 3000000};
+        lcg_ = lcg_ * 1103515245u + 12345u;
+        return delays[(lcg_ >> 16) % (sizeof(delays) / sizeof(delays[0]))];
+    }
+
+    void fire() {
+        log_.emplace_back(scheduler_->getCurrentTick(), id_);
+        if(++fired_ < 200) {
+            scheduler_->scheduleEvent(this, nextDelay(), getGroupID());
+        }
+    }
+
+private:
+    const uint32_t id_;
+    FiringLog & log_;
+    uint32_t lcg_;
+    uint32_t fired_ = 0;
+};
+
+// Run the same pattern of events on a scheduler with the given tick
+// quantum backend and return the firing order
+FiringLog runTickQuantumPattern(sparta::Scheduler::TickQuantumBackend backend,
+                                const std::string & name,
+                                uint64_t & empty_groups_skipped)
+{
+    FiringLog log;
+    sparta::Scheduler sched(name, nullptr, backend);
+    sparta::Clock clk("clock", &sched);
+    sparta::RootTreeNode rtn(name + "_rtn");
+    rtn.setClock(&clk);
+
+    std::vector<std::unique_ptr<RecordingEvent<sparta::SchedulingPhase::Tick>>> tick_events;
+    std::vector<std::unique_ptr<RecordingEvent<sparta::SchedulingPhase::Update>>> update_events;
+    for(uint32_t i = 0; i < 8; ++i) {
+        tick_events.emplace_back(new RecordingEvent<sparta::SchedulingPhase::Tick>(&rtn, i, log));
+        update_events.emplace_back(new RecordingEvent<sparta::SchedulingPhase::Update>(&rtn, 100 + i, log));
+    }
+    sched.finalize();
+
+    for(uint32_t i = 0; i < tick_events.size(); ++i) {
+        sched.scheduleEvent(tick_events[i].get(), tick_events[i]->nextDelay(),
+                            tick_events[i]->getGroupID());
+        sched.scheduleEvent(update_events[i].get(), update_events[i]->nextDelay(),
+                            update_events[i]->getGroupID());
+    }
+
+    // Far-future queries and cancellation
+    RecordingEvent<sparta::SchedulingPhase::Tick> & far_ev = *tick_events[0];
+    sched.scheduleEvent(&far_ev, 10000000, far_ev.getGroupID());
+    EXPECT_TRUE(sched.isScheduled(&far_ev, 10000000));
+    EXPECT_FALSE(sched.isScheduled(&far_ev, 10000001));
+    sched.cancelEvent(&far_ev, 10000000);
+    EXPECT_FALSE(sched.isScheduled(&far_ev, 10000000));
+
+    // Step in small increments for a while (stopping short of
+    // far-future events), then run to completion
+    for(uint32_t i = 0; i < 50; ++i) {
+        sched.run(20000, true, false);
+    }
+    sched.run();
+    EXPECT_TRUE(sched.isFinished());
+    EXPECT_EQUAL(sched.nextEventTick(), sparta::Scheduler::INDEFINITE);
+    empty_groups_skipped =
+        sched.getChildAs<sparta::CounterBase>("stats.empty_groups_skipped")->get();
+
+    // A far-future event on an empty scheduler is the next event
+    // and fires
+    const sparta::Scheduler::Tick far_tick = sched.getCurrentTick() + 5000000;
+    sched.scheduleEvent(&far_ev, 5000000, far_ev.getGroupID());
+    EXPECT_EQUAL(sched.nextEventTick(), far_tick);
+    sched.run();
+    EXPECT_EQUAL(log.back().first, far_tick);
+    EXPECT_EQUAL(sched.nextEventTick(), sparta::Scheduler::INDEFINITE);
+
+    // Schedule far in the future, clear, and make sure nothing fires
+    sched.scheduleEvent(&far_ev, 5000000, far_ev.getGroupID());
+    EXPECT_TRUE(sched.isScheduled(&far_ev));
+    sched.clearEvents();
+    EXPECT_FALSE(sched.isScheduled(&far_ev));
+
+    rtn.enterTeardown();
+    return log;
+}
+
+void testTimingWheel()
+{
+    uint64_t list_skipped = 0;
+    uint64_t wheel_skipped = 0;
+    const FiringLog list_log =
+        runTickQuantumPattern(sparta::Scheduler::TickQuantumBackend::LINKED_LIST, "list_sched",
+                              list_skipped);
+    const FiringLog wheel_log =
+        runTickQuantumPattern(sparta::Scheduler::TickQuantumBackend::TIMING_WHEEL, "wheel_sched",
+                              wheel_skipped);
+    EXPECT_EQUAL(list_log.size(), 16 * 200 + 1);
+    EXPECT_TRUE(list_log == wheel_log);
+
+    // Only the Tick and Update phase groups ever have events; the
+    // rest are jumped over
+    EXPECT_TRUE(list_skipped > 0);
+    EXPECT_EQUAL(list_skipped, wheel_skipped);
+}
+
 static_assert(sparta::NUM_SCHEDULING_PHASES == 7,
               "\n\nIf you got this compile-time assert, then you need to update this test 'cause you added more phases to SchedulingPhase. \n"
               "Specifically, you need to add more TestEvent's below\n\n");
@@ -373,6 +495,8 @@ int main()
 
     rtn.enterTeardown();
 
+    testTimingWheel();
+
     REPORT_ERROR;
     return ERROR_CODE;
 }
@@ -0,0 +1,228 @@
+// Times ScoreboardView wakeup on an out-of-order scheduler like workload.
+//
+// A view holds a given number of waiting instructions, each needing
+// two in-flight registers.  Every cycle the oldest in-flight register
+// is written back, waking the instructions that needed it; each woken
+// instruction is replaced by a new one with a newly renamed
+// destination.  Now and then an instruction is flushed.
+//
+// A second workload times broadcasting writebacks from one unit to
+// many consumer views that share a forwarding latency.
+
+#include <inttypes.h>
+#include <iostream>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "sparta/resources/Scoreboard.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/sparta.hpp"
+#include "sparta/simulation/ClockManager.hpp"
+#include "sparta/simulation/ResourceTreeNode.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+
+TEST_INIT
+
+constexpr uint32_t CYCLES = 100000;
+constexpr uint32_t FLUSH_INTERVAL = 64;
+
+using RegisterBitMask = sparta::Scoreboard::RegisterBitMask;
+
+sparta::Scoreboard::ScoreboardParameters::LatencyMatrixParameterType FORWARDING_MATRIX =
+    {
+        {""    , "ALU0", "ALU1"},
+        {"ALU0",    "0",    "1"},
+        {"ALU1",    "1",    "0"}
+    };
+
+class Workload
+{
+public:
+    Workload(sparta::Scoreboard * master_sb, sparta::ScoreboardView * view) :
+        master_sb_(master_sb), view_(view)
+    {
+        RegisterBitMask all;
+        all.set();
+        master_sb_->clearBits(all);
+        for(uint32_t reg = 0; reg < sparta::Scoreboard::MAX_REGISTERS; ++reg) {
+            free_regs_.push_back(reg);
+        }
+    }
+
+    // Rename a destination and wait for two in-flight sources
+    void dispatch()
+    {
+        RegisterBitMask srcs;
+        for(uint32_t i = 0; i < 2 && !in_flight_.empty(); ++i) {
+            srcs.set(in_flight_[rng_() % in_flight_.size()]);
+        }
+
+        const uint32_t dest = free_regs_.front();
+        free_regs_.pop_front();
+        RegisterBitMask dest_bits;
+        dest_bits.set(dest);
+        master_sb_->clearBits(dest_bits);
+        in_flight_.push_back(dest);
+
+        const sparta::Scoreboard::InstID inst_id = next_inst_id_++;
+        view_->registerReadyCallback(srcs, inst_id,
+                                     [this, inst_id](const RegisterBitMask &) { issue(inst_id); });
+    }
+
+    void issue(sparta::Scoreboard::InstID inst_id)
+    {
+        checksum = checksum * 31 + inst_id;
+        ++num_issued;
+        ++to_dispatch_;
+    }
+
+    // Write back the oldest in-flight register
+    void cycle(uint32_t cycle_num)
+    {
+        const uint32_t reg = in_flight_.front();
+        in_flight_.pop_front();
+        RegisterBitMask bits;
+        bits.set(reg);
+        master_sb_->set(bits);
+        free_regs_.push_back(reg);
+
+        if(cycle_num % FLUSH_INTERVAL == 0) {
+            // Flush a recent instruction
+            view_->clearCallbacks(next_inst_id_ - 1 - rng_() % 8);
+            ++to_dispatch_;
+        }
+        for(; to_dispatch_ > 0; --to_dispatch_) {
+            dispatch();
+        }
+    }
+
+    uint64_t checksum = 0;
+    uint64_t num_issued = 0;
+
+private:
+    sparta::Scoreboard * master_sb_;
+    sparta::ScoreboardView * view_;
+    std::deque<uint32_t> in_flight_;
+    std::deque<uint32_t> free_regs_;
+    sparta::Scoreboard::InstID next_inst_id_ = 0;
+    uint32_t to_dispatch_ = 0;
+    std::mt19937 rng_{1234};
+};
+
+// Runs the workload, returning ns per cycle and a checksum of the
+// instructions woken
+std::pair<double, uint64_t> runCycles(uint32_t num_waiting)
+{
+    sparta::RootTreeNode rtn;
+    sparta::Scheduler    sched;
+    sparta::ClockManager cm(&sched);
+    sparta::Clock::Handle root_clk = cm.makeRoot(&rtn, "root_clk");
+    cm.normalize();
+    rtn.setClock(root_clk.get());
+
+    sparta::TreeNode cpu(&rtn, "core", "Dummy CPU");
+    sparta::ResourceFactory<sparta::Scoreboard,
+                            sparta::Scoreboard::ScoreboardParameters> fact;
+    sparta::ResourceTreeNode sbtn(&cpu, "sb_integer",
+                                  sparta::TreeNode::GROUP_NAME_NONE,
+                                  sparta::TreeNode::GROUP_IDX_NONE,
+                                  "Test scoreboard", &fact);
+    auto * params = dynamic_cast<sparta::Scoreboard::ScoreboardParameters *>(sbtn.getParameterSet());
+    params->latency_matrix = FORWARDING_MATRIX;
+
+    rtn.enterConfiguring();
+    rtn.enterFinalized();
+    sparta::Scoreboard * master_sb = sbtn.getResourceAs<sparta::Scoreboard>();
+    sparta::ScoreboardView view("ALU0", "sb_integer", &sbtn);
+
+    Workload workload(master_sb, &view);
+    for(uint32_t i = 0; i < num_waiting; ++i) {
+        workload.dispatch();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for(uint32_t cycle = 0; cycle < CYCLES; ++cycle) {
+        workload.cycle(cycle);
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_TRUE(workload.num_issued > CYCLES / 2);
+
+    rtn.enterTeardown();
+    return {ns / CYCLES, workload.checksum};
+}
+
+// Every cycle a register written by ALU0 is broadcast to num_views
+// ALU1 views one cycle away.  Returns ns per cycle.
+double runBroadcast(uint32_t num_views)
+{
+    sparta::RootTreeNode rtn;
+    sparta::Scheduler    sched;
+    sparta::ClockManager cm(&sched);
+    sparta::Clock::Handle root_clk = cm.makeRoot(&rtn, "root_clk");
+    cm.normalize();
+    rtn.setClock(root_clk.get());
+
+    sparta::TreeNode cpu(&rtn, "core", "Dummy CPU");
+    sparta::ResourceFactory<sparta::Scoreboard,
+                            sparta::Scoreboard::ScoreboardParameters> fact;
+    sparta::ResourceTreeNode sbtn(&cpu, "sb_integer",
+                                  sparta::TreeNode::GROUP_NAME_NONE,
+                                  sparta::TreeNode::GROUP_IDX_NONE,
+                                  "Test scoreboard", &fact);
+    auto * params = dynamic_cast<sparta::Scoreboard::ScoreboardParameters *>(sbtn.getParameterSet());
+    params->latency_matrix = FORWARDING_MATRIX;
+
+    rtn.enterConfiguring();
+    rtn.enterFinalized();
+    sched.finalize();
+    sparta::ScoreboardView producer("ALU0", "sb_integer", &sbtn);
+    std::vector<std::unique_ptr<sparta::ScoreboardView>> consumers;
+    for(uint32_t i = 0; i < num_views; ++i) {
+        consumers.emplace_back(new sparta::ScoreboardView("ALU1", "sb_integer", &sbtn));
+    }
+    RegisterBitMask all;
+    all.set();
+    sbtn.getResourceAs<sparta::Scoreboard>()->clearBits(all);
+
+    const auto start = std::chrono::steady_clock::now();
+    for(uint32_t cycle = 0; cycle < CYCLES; ++cycle)
+    {
+        RegisterBitMask bits;
+        bits.set(cycle % sparta::Scoreboard::MAX_REGISTERS);
+        producer.setReady(bits);
+        sched.run(1, true, false);
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    for(const auto & consumer : consumers) {
+        EXPECT_TRUE(consumer->isSet(all));
+    }
+
+    rtn.enterTeardown();
+    return ns / CYCLES;
+}
+
+int main()
+{
+    for(uint32_t num_waiting : {16u, 64u, 128u, 256u})
+    {
+        // Each waiting instruction holds a renamed register
+        if(num_waiting >= sparta::Scoreboard::MAX_REGISTERS / 2) {
+            continue;
+        }
+        const auto result = runCycles(num_waiting);
+        std::cout << "Waiting " << num_waiting << ": " << result.first
+                  << " ns/cycle (checksum " << result.second << ")" << std::endl;
+    }
+
+    for(uint32_t num_views : {1u, 4u, 16u})
+    {
+        std::cout << "Broadcast to " << num_views << " views: "
+                  << runBroadcast(num_views) << " ns/cycle" << std::endl;
+    }
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -14,6 +14,9 @@
 #include "sparta/statistics/StatisticSet.hpp"
 #include "sparta/events/UniqueEvent.hpp"
 
+#include <list>
+#include <random>
+
 TEST_INIT
 
 enum Units
@@ -559,6 +562,253 @@ void testScoreboardClearing()
     rtn.enterTeardown();
 }
 
+// Compare the ready callbacks of a view against the original
+// behavior: on every update, call (in registration order) every
+// callback whose bits are all ready
+void testReadyCallbackOrder()
+{
+    sparta::RootTreeNode rtn;
+    sparta::Scheduler    sched;
+    sparta::ClockManager cm(&sched);
+    sparta::Clock::Handle root_clk;
+    root_clk = cm.makeRoot(&rtn, "root_clk");
+    cm.normalize();
+    rtn.setClock(root_clk.get());
+
+    sparta::TreeNode cpu(&rtn, "core", "Dummy CPU");
+
+    sparta::ResourceFactory<sparta::Scoreboard,
+                            sparta::Scoreboard::ScoreboardParameters> fact;
+
+    sparta::ResourceTreeNode sbtn(&cpu,
+                                  SB_NAMES[0],
+                                  sparta::TreeNode::GROUP_NAME_NONE,
+                                  sparta::TreeNode::GROUP_IDX_NONE,
+                                  "Test scoreboard",
+                                  &fact);
+
+    sparta::Scoreboard::ScoreboardParameters * params =
+        dynamic_cast<sparta::Scoreboard::ScoreboardParameters *>(sbtn.getParameterSet());
+    params->latency_matrix = GPR_FORWARDING_MATRIX;
+
+    rtn.enterConfiguring();
+    rtn.enterFinalized();
+    sparta::Scoreboard * master_sb = sbtn.getResourceAs<sparta::Scoreboard>();
+    sparta::ScoreboardView view(UNIT_NAMES[0], SB_NAMES[0], &sbtn);
+
+    using RegisterBitMask = sparta::Scoreboard::RegisterBitMask;
+    struct ModelCallback {
+        RegisterBitMask needed;
+        sparta::Scoreboard::InstID inst_id;
+        uint32_t id;
+    };
+    std::list<ModelCallback> model;
+    RegisterBitMask model_ready{0xffffffff};
+
+    std::vector<uint32_t> called;
+    std::vector<uint32_t> expected;
+    std::vector<sparta::ScoreboardView::CallbackHandle> handles;
+    std::mt19937 rng(3);
+    constexpr uint32_t NUM_REGS = 80;
+
+    auto random_bits = [&](uint32_t max_bits) {
+        RegisterBitMask bits;
+        const uint32_t num_bits = rng() % (max_bits + 1);
+        for(uint32_t i = 0; i < num_bits; ++i) {
+            bits.set(rng() % NUM_REGS);
+        }
+        return bits;
+    };
+
+    for(uint32_t i = 0; i < 20000; ++i)
+    {
+        const uint32_t op = rng() % 16;
+        if(op < 7) {
+            const auto needed = random_bits(3);
+            const sparta::Scoreboard::InstID inst_id = rng() % 50;
+            const uint32_t id = handles.size();
+            handles.emplace_back(view.registerReadyCallback(needed, inst_id,
+                                                            [&called, id](const RegisterBitMask &) {
+                                                                called.emplace_back(id);
+                                                            }));
+            EXPECT_TRUE(handles.back().isValid());
+            model.push_back({needed, inst_id, id});
+        }
+        else if(op < 11 || op == 15) {
+            auto bits = random_bits(2);
+            if(op == 15) {
+                // An update that makes nothing new ready
+                bits = model_ready & RegisterBitMask(0xff);
+            }
+            if(bits.none()) {
+                continue;
+            }
+            master_sb->set(bits);
+            model_ready |= bits;
+            for(auto it = model.begin(); it != model.end();) {
+                if((it->needed & model_ready) == it->needed) {
+                    expected.emplace_back(it->id);
+                    it = model.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+        else if(op < 13) {
+            const auto bits = random_bits(3);
+            master_sb->clearBits(bits);
+            model_ready &= ~bits;
+        }
+        else if(op == 13) {
+            const sparta::Scoreboard::InstID inst_id = rng() % 50;
+            view.clearCallbacks(inst_id);
+            model.remove_if([inst_id](const ModelCallback & cb) { return cb.inst_id == inst_id; });
+        }
+        else if(!handles.empty()) {
+            const uint32_t id = rng() % handles.size();
+            const auto it = std::find_if(model.begin(), model.end(),
+                                         [id](const ModelCallback & cb) { return cb.id == id; });
+            EXPECT_EQUAL(view.clearCallback(handles[id]), it != model.end());
+            if(it != model.end()) {
+                model.erase(it);
+            }
+        }
+        EXPECT_EQUAL(view.getNumReadyCallbacks(), model.size());
+    }
+    EXPECT_TRUE(called == expected);
+    EXPECT_TRUE(expected.size() > 1000);
+    EXPECT_FALSE(view.clearCallback(sparta::ScoreboardView::CallbackHandle()));
+
+    // Callbacks can clear other callbacks made ready by the same
+    // update.  Use registers the callbacks above do not.
+    RegisterBitMask reg_a, reg_b;
+    reg_a.set(NUM_REGS);
+    reg_b.set(NUM_REGS + 1);
+    master_sb->clearBits(reg_a | reg_b);
+    bool second_called = false;
+    sparta::ScoreboardView::CallbackHandle second;
+    view.registerReadyCallback(reg_a, 100, [&](const RegisterBitMask &) { view.clearCallback(second); });
+    second = view.registerReadyCallback(reg_a | reg_b, 101, [&](const RegisterBitMask &) { second_called = true; });
+    master_sb->set(reg_b);
+    master_sb->set(reg_a);
+    EXPECT_FALSE(second_called);
+    EXPECT_EQUAL(view.getNumReadyCallbacks(), model.size());
+
+    // A callback registered by a callback with its registers already
+    // ready is called in the same update, after the others
+    std::vector<uint32_t> order;
+    master_sb->clearBits(reg_a | reg_b);
+    view.registerReadyCallback(reg_a, 102, [&](const RegisterBitMask &) {
+        order.emplace_back(0);
+        view.registerReadyCallback(reg_b, 103, [&](const RegisterBitMask &) {
+            order.emplace_back(2);
+            view.registerReadyCallback(reg_a | reg_b, 104, [&](const RegisterBitMask &) {
+                order.emplace_back(3);
+            });
+        });
+    });
+    view.registerReadyCallback(reg_a, 105, [&](const RegisterBitMask &) { order.emplace_back(1); });
+    master_sb->set(reg_b);
+    EXPECT_TRUE(order.empty());
+    master_sb->set(reg_a);
+    EXPECT_TRUE(order == std::vector<uint32_t>({0, 1, 2, 3}));
+    EXPECT_EQUAL(view.getNumReadyCallbacks(), model.size());
+
+    // A callback can clear a register that another callback made
+    // ready by the same update needs.  That callback waits until the
+    // register is ready again.
+    bool needs_b_called = false;
+    master_sb->clearBits(reg_a | reg_b);
+    view.registerReadyCallback(reg_a, 106, [&](const RegisterBitMask &) { master_sb->clearBits(reg_b); });
+    view.registerReadyCallback(reg_a | reg_b, 107, [&](const RegisterBitMask &) { needs_b_called = true; });
+    master_sb->set(reg_b);
+    master_sb->set(reg_a);
+    EXPECT_FALSE(needs_b_called);
+    EXPECT_EQUAL(view.getNumReadyCallbacks(), model.size() + 1);
+    master_sb->set(reg_a);
+    EXPECT_FALSE(needs_b_called);
+    master_sb->set(reg_b);
+    EXPECT_TRUE(needs_b_called);
+    EXPECT_EQUAL(view.getNumReadyCallbacks(), model.size());
+
+    rtn.enterTeardown();
+}
+
+// Views with the same forwarding latency from a producer get its
+// updates together
+void testBatchedUpdates()
+{
+    sparta::RootTreeNode rtn;
+    sparta::Scheduler    sched;
+    sparta::ClockManager cm(&sched);
+    sparta::Clock::Handle root_clk;
+    root_clk = cm.makeRoot(&rtn, "root_clk");
+    cm.normalize();
+    rtn.setClock(root_clk.get());
+
+    sparta::TreeNode cpu(&rtn, "core", "Dummy CPU");
+
+    sparta::ResourceFactory<sparta::Scoreboard,
+                            sparta::Scoreboard::ScoreboardParameters> fact;
+
+    sparta::ResourceTreeNode sbtn(&cpu,
+                                  SB_NAMES[0],
+                                  sparta::TreeNode::GROUP_NAME_NONE,
+                                  sparta::TreeNode::GROUP_IDX_NONE,
+                                  "Test scoreboard",
+                                  &fact);
+
+    sparta::Scoreboard::ScoreboardParameters * params =
+        dynamic_cast<sparta::Scoreboard::ScoreboardParameters *>(sbtn.getParameterSet());
+    params->latency_matrix = GPR_FORWARDING_MATRIX;
+
+    rtn.enterConfiguring();
+    rtn.enterFinalized();
+    sched.finalize();
+    sparta::Scoreboard * master_sb = sbtn.getResourceAs<sparta::Scoreboard>();
+
+    // From ALU0: 0 cycles to ALU0, 1 to both LSU views, 3 to FPU, 5 to ALU1
+    sparta::ScoreboardView alu0(UNIT_NAMES[ALU0], SB_NAMES[0], &sbtn);
+    sparta::ScoreboardView lsu_a(UNIT_NAMES[LSU], SB_NAMES[0], &sbtn);
+    sparta::ScoreboardView lsu_b(UNIT_NAMES[LSU], SB_NAMES[0], &sbtn);
+    sparta::ScoreboardView fpu(UNIT_NAMES[FPU], SB_NAMES[0], &sbtn);
+    sparta::ScoreboardView alu1(UNIT_NAMES[ALU1], SB_NAMES[0], &sbtn);
+    master_sb->clearBits({0xFFFFFFFF});
+
+    sparta::Scoreboard::RegisterBitMask bits;
+    bits.set(sparta::Scoreboard::MAX_REGISTERS - 1);
+    bits.set(7);
+    uint32_t lsu_calls = 0;
+    auto lsu_ready = [&lsu_calls](const sparta::Scoreboard::RegisterBitMask &) { ++lsu_calls; };
+    lsu_a.registerReadyCallback(bits, 1, lsu_ready);
+    lsu_b.registerReadyCallback(bits, 2, lsu_ready);
+
+    alu0.setReady(bits);
+    EXPECT_TRUE(alu0.isSet(bits));
+
+    constexpr bool exacting_run = true;
+    constexpr bool measure_run_time = false;
+    std::vector<uint32_t> ticks_to_ready(4, 0);
+    sparta::ScoreboardView * views[] = {&lsu_a, &lsu_b, &fpu, &alu1};
+    for(uint32_t tick = 1; tick <= 10; ++tick)
+    {
+        sched.run(1, exacting_run, measure_run_time);
+        for(uint32_t i = 0; i < 4; ++i) {
+            if(ticks_to_ready[i] == 0 && views[i]->isSet(bits)) {
+                ticks_to_ready[i] = tick;
+            }
+        }
+    }
+    EXPECT_TRUE(ticks_to_ready[0] > 0);
+    EXPECT_EQUAL(ticks_to_ready[1], ticks_to_ready[0]);
+    EXPECT_EQUAL(ticks_to_ready[2], ticks_to_ready[0] + 2);
+    EXPECT_EQUAL(ticks_to_ready[3], ticks_to_ready[0] + 4);
+    EXPECT_EQUAL(lsu_calls, 2);
+
+    rtn.enterTeardown();
+}
+
 void testPrintBits()
 {
     sparta::Scoreboard::RegisterBitMask some_bits(0b011000110011);
@@ -577,6 +827,10 @@ int main ()
 
     testScoreboardClearing();
 
+    testReadyCallbackOrder();
+
+    testBatchedUpdates();
+
     testPrintBits();
 
     REPORT_ERROR;
@@ -0,0 +1,147 @@
+#include "sparta/kernel/SlabObjectAllocator.hpp"
+#include "sparta/kernel/ObjectAllocator.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+#include <chrono>
+#include <set>
+#include <vector>
+
+TEST_INIT
+
+uint32_t my_obj_constructions = 0;
+uint32_t my_obj_destructions = 0;
+class MyObj
+{
+public:
+    explicit MyObj(uint32_t v) : v(v), payload(16, v) { ++my_obj_constructions; }
+    ~MyObj() { ++my_obj_destructions; }
+
+    uint32_t v;
+    std::vector<uint64_t> payload;
+};
+
+void testSlabObjectAllocator()
+{
+    my_obj_constructions = 0;
+    my_obj_destructions = 0;
+    {
+        sparta::SlabObjectAllocator<MyObj> alloc(4);
+        EXPECT_EQUAL(alloc.getStats().allocated, 0);
+        EXPECT_EQUAL(alloc.getStats().chunks, 0);
+
+        // Fill a bit more than two chunks
+        std::vector<MyObj*> objs;
+        for(uint32_t i = 0; i < 10; ++i) {
+            objs.emplace_back(alloc.create(i));
+            EXPECT_EQUAL(objs.back()->v, i);
+        }
+        EXPECT_EQUAL(my_obj_constructions, 10);
+        EXPECT_EQUAL(alloc.getStats().allocated, 10);
+        EXPECT_EQUAL(alloc.getStats().in_use, 10);
+        EXPECT_EQUAL(alloc.getStats().peak_in_use, 10);
+        EXPECT_EQUAL(alloc.getStats().chunks, 3);
+
+        // Objects in a chunk are contiguous
+        EXPECT_TRUE(reinterpret_cast<char*>(objs[1]) > reinterpret_cast<char*>(objs[0]));
+        EXPECT_TRUE(reinterpret_cast<char*>(objs[3]) - reinterpret_cast<char*>(objs[0]) <
+                    static_cast<std::ptrdiff_t>(4 * (sizeof(MyObj) + 2 * alignof(MyObj) + sizeof(void*))));
+
+        // Freed objects come back most recent first, and are not
+        // reconstructed
+        alloc.free(objs[2]);
+        alloc.free(objs[7]);
+        EXPECT_EQUAL(alloc.getStats().in_use, 8);
+        MyObj * reused = alloc.create(100);
+        EXPECT_EQUAL(reused, objs[7]);
+        EXPECT_EQUAL(reused->v, 7);
+        reused = alloc.create(100);
+        EXPECT_EQUAL(reused, objs[2]);
+        EXPECT_EQUAL(reused->v, 2);
+        EXPECT_EQUAL(my_obj_constructions, 10);
+        EXPECT_EQUAL(alloc.getStats().in_use, 10);
+        EXPECT_EQUAL(alloc.getStats().peak_in_use, 10);
+
+        // Free everything and take one back; peak stays
+        for(auto obj : objs) {
+            alloc.free(obj);
+        }
+        EXPECT_EQUAL(alloc.getStats().in_use, 0);
+        EXPECT_EQUAL(alloc.create(0), objs.back());
+        EXPECT_EQUAL(alloc.getStats().in_use, 1);
+        EXPECT_EQUAL(alloc.getStats().peak_in_use, 10);
+        EXPECT_EQUAL(my_obj_destructions, 0);
+
+        // Pre-warm past what has been allocated
+        alloc.prewarm(20, 42u);
+        EXPECT_EQUAL(my_obj_constructions, 20);
+        EXPECT_EQUAL(alloc.getStats().allocated, 20);
+        EXPECT_EQUAL(alloc.getStats().chunks, 5);
+        EXPECT_EQUAL(alloc.getStats().in_use, 1);
+        alloc.prewarm(5, 42u);
+        EXPECT_EQUAL(alloc.getStats().allocated, 20);
+
+        // No constructions needed to hand out everything
+        std::set<MyObj*> unique_objs;
+        for(uint32_t i = 0; i < 19; ++i) {
+            unique_objs.insert(alloc.create(1000));
+        }
+        EXPECT_EQUAL(unique_objs.size(), 19);
+        EXPECT_EQUAL(my_obj_constructions, 20);
+        EXPECT_EQUAL(alloc.getStats().peak_in_use, 20);
+
+        // One more needs a new chunk
+        alloc.create(1000);
+        EXPECT_EQUAL(my_obj_constructions, 21);
+        EXPECT_EQUAL(alloc.getStats().chunks, 6);
+
+        alloc.clear();
+        EXPECT_EQUAL(my_obj_destructions, 21);
+        EXPECT_EQUAL(alloc.getStats().allocated, 0);
+        EXPECT_EQUAL(alloc.getStats().peak_in_use, 0);
+
+        // Usable after clearing
+        EXPECT_EQUAL(alloc.create(5)->v, 5);
+    }
+    EXPECT_EQUAL(my_obj_constructions, 22);
+    EXPECT_EQUAL(my_obj_destructions, 22);
+
+    EXPECT_THROW(sparta::SlabObjectAllocator<MyObj> bad_alloc(0));
+}
+
+// Keep a sliding window of objects outstanding, like the Scheduler's
+// time quanta
+template<class AllocT>
+double timeChurn(uint32_t window, uint32_t iterations)
+{
+    AllocT alloc;
+    std::vector<MyObj*> live(window, nullptr);
+    uint64_t sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < iterations; ++i) {
+        MyObj *& slot = live[i % window];
+        if(slot != nullptr) {
+            sum += slot->payload[0];
+            alloc.free(slot);
+        }
+        slot = alloc.create(i);
+        slot->payload[0] = i;
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    EXPECT_TRUE(sum > 0);
+    return std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+}
+
+int main()
+{
+    testSlabObjectAllocator();
+
+    for(uint32_t window : {4, 64, 4096}) {
+        const double slab_ns = timeChurn<sparta::SlabObjectAllocator<MyObj>>(window, 10000000);
+        const double obj_ns  = timeChurn<sparta::ObjectAllocator<MyObj>>(window, 10000000);
+        std::cout << "Window " << window << ": SlabObjectAllocator " << slab_ns
+                  << " ns/op, ObjectAllocator " << obj_ns << " ns/op" << std::endl;
+    }
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -0,0 +1,196 @@
+
+// Compares SpartaSharedPointer, with single-threaded and atomic
+// reference counts, against std::shared_ptr.
+//
+// Three things are measured: copying/destroying pointers (reference
+// count traffic only), allocating/releasing objects on one thread,
+// and allocating on several threads with objects released on a
+// different thread than the one that allocated them.
+
+#include <inttypes.h>
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "sparta/utils/SpartaSharedPointer.hpp"
+#include "sparta/utils/SpartaSharedPointerAllocator.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+TEST_INIT
+
+constexpr uint32_t NUM_PTRS    = 10000;
+constexpr uint32_t ITERATIONS  = 200;
+constexpr uint32_t NUM_THREADS = 4;
+
+struct Payload
+{
+    Payload(uint32_t _a) : a(_a) {}
+    uint32_t a;
+    uint64_t pad[3] = {0};
+};
+
+sparta::SpartaSharedPointerAllocator<Payload>       payload_allocator(NUM_PTRS + 1, NUM_PTRS + 1);
+sparta::SpartaAtomicSharedPointerAllocator<Payload> atomic_payload_allocator(NUM_PTRS * (NUM_THREADS + 1),
+                                                                             NUM_PTRS * (NUM_THREADS + 1));
+
+double elapsedNs(const std::chrono::steady_clock::time_point & start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Copy every pointer into a second vector and drop the copies
+template<class PtrT>
+double copyRelease(const std::vector<PtrT> & ptrs)
+{
+    std::vector<PtrT> copies(ptrs.size());
+    const auto start = std::chrono::steady_clock::now();
+    for(uint32_t j = 0; j < ITERATIONS; ++j)
+    {
+        for(uint32_t i = 0; i < ptrs.size(); ++i) {
+            copies[i] = ptrs[i];
+        }
+        for(auto & p : copies) {
+            p.reset();
+        }
+    }
+    const double ns = elapsedNs(start);
+    EXPECT_EQUAL(ptrs[0].use_count(), 1);
+    return ns / (double(ptrs.size()) * ITERATIONS);
+}
+
+// Replace every pointer with a newly allocated object, releasing the old one
+template<class PtrT, class AllocFunc>
+double allocateRelease(AllocFunc alloc)
+{
+    std::vector<PtrT> ptrs(NUM_PTRS);
+    const auto start = std::chrono::steady_clock::now();
+    for(uint32_t j = 0; j < ITERATIONS; ++j)
+    {
+        for(uint32_t i = 0; i < NUM_PTRS; ++i) {
+            ptrs[i] = alloc(i);
+        }
+    }
+    const double ns = elapsedNs(start);
+    for(uint32_t i = 0; i < NUM_PTRS; ++i) {
+        EXPECT_EQUAL(ptrs[i]->a, i);
+    }
+    return ns / (double(NUM_PTRS) * ITERATIONS);
+}
+
+// Threads take turns filling each other's slots, so every object a
+// thread allocates is released by a different thread.  Returns ns
+// per object allocated.
+template<class PtrT, class AllocFunc>
+double crossThreadAllocateRelease(AllocFunc alloc)
+{
+    std::vector<std::vector<PtrT>> handoff(NUM_THREADS, std::vector<PtrT>(NUM_PTRS));
+    std::atomic<uint32_t> errors{0};
+
+    // Wait for all threads to finish a round before rotating slots
+    std::atomic<uint32_t> arrived{0};
+    auto endRound = [&arrived](uint32_t round) {
+        ++arrived;
+        while(arrived < (round + 1) * NUM_THREADS) {
+            std::this_thread::yield();
+        }
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for(uint32_t t = 0; t < NUM_THREADS; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for(uint32_t j = 0; j < ITERATIONS / NUM_THREADS; ++j)
+            {
+                // The previous occupants of this slot were
+                // allocated by another thread
+                auto & slot = handoff[(t + j) % NUM_THREADS];
+                for(uint32_t i = 0; i < NUM_PTRS; ++i) {
+                    slot[i] = alloc(i);
+                    if(slot[i]->a != i) { ++errors; }
+                }
+                endRound(j);
+            }
+        });
+    }
+    for(auto & th : threads) {
+        th.join();
+    }
+    const double ns = elapsedNs(start);
+    EXPECT_EQUAL(errors.load(), 0u);
+    return ns / (double(NUM_PTRS) * (ITERATIONS / NUM_THREADS) * NUM_THREADS);
+}
+
+int main()
+{
+    // libstdc++'s std::shared_ptr skips atomic operations while the
+    // process has only one thread.  Keep an idle thread around so it
+    // is measured the way it would run in a threaded simulator.
+    std::atomic<bool> done{false};
+    std::thread idle([&done]() {
+        while(!done) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    // Reference count traffic
+    std::vector<sparta::SpartaSharedPointer<Payload>>       ssp_ptrs;
+    std::vector<sparta::SpartaAtomicSharedPointer<Payload>> assp_ptrs;
+    std::vector<std::shared_ptr<Payload>>                   sp_ptrs;
+    for(uint32_t i = 0; i < NUM_PTRS; ++i) {
+        ssp_ptrs.emplace_back(new Payload(i));
+        assp_ptrs.emplace_back(new Payload(i));
+        sp_ptrs.emplace_back(new Payload(i));
+    }
+    const double ssp_copy_ns  = copyRelease(ssp_ptrs);
+    const double assp_copy_ns = copyRelease(assp_ptrs);
+    const double sp_copy_ns   = copyRelease(sp_ptrs);
+
+    // Allocation on one thread
+    const double ssp_alloc_ns =
+        allocateRelease<sparta::SpartaSharedPointer<Payload>>([](uint32_t i) {
+            return sparta::allocate_sparta_shared_pointer<Payload>(payload_allocator, i);
+        });
+    const double assp_alloc_ns =
+        allocateRelease<sparta::SpartaAtomicSharedPointer<Payload>>([](uint32_t i) {
+            return sparta::allocate_sparta_shared_pointer<Payload>(atomic_payload_allocator, i);
+        });
+    const double sp_alloc_ns =
+        allocateRelease<std::shared_ptr<Payload>>([](uint32_t i) {
+            return std::make_shared<Payload>(i);
+        });
+
+    // Allocation on many threads, released on others
+    const double assp_mt_ns =
+        crossThreadAllocateRelease<sparta::SpartaAtomicSharedPointer<Payload>>([](uint32_t i) {
+            return sparta::allocate_sparta_shared_pointer<Payload>(atomic_payload_allocator, i);
+        });
+    const double sp_mt_ns =
+        crossThreadAllocateRelease<std::shared_ptr<Payload>>([](uint32_t i) {
+            return std::make_shared<Payload>(i);
+        });
+
+    done = true;
+    idle.join();
+
+    EXPECT_FALSE(payload_allocator.hasOutstandingObjects());
+    EXPECT_FALSE(atomic_payload_allocator.hasOutstandingObjects());
+
+    std::cout << "Copy + release (ns/pointer):\n"
+              << "  SpartaSharedPointer:          " << ssp_copy_ns << "\n"
+              << "  SpartaAtomicSharedPointer:    " << assp_copy_ns << "\n"
+              << "  std::shared_ptr:              " << sp_copy_ns << "\n"
+              << "Allocate + release (ns/object):\n"
+              << "  SpartaSharedPointer:          " << ssp_alloc_ns << "\n"
+              << "  SpartaAtomicSharedPointer:    " << assp_alloc_ns << "\n"
+              << "  std::make_shared:             " << sp_alloc_ns << "\n"
+              << NUM_THREADS << " threads, released on another thread (ns/object):\n"
+              << "  SpartaAtomicSharedPointer:    " << assp_mt_ns << "\n"
+              << "  std::make_shared:             " << sp_mt_ns << std::endl;
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -4,8 +4,11 @@
 #include "sparta/utils/SpartaTester.hpp"
 
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #ifdef __linux__
 #include <ext/pool_allocator.h>
@@ -633,6 +636,124 @@ void testSelfReferentialWeakPointer() {
     tmp.reset();
 }
 
+// Destroyed on any thread
+std::atomic<uint32_t> shared_type_deleted{0};
+struct SharedType
+{
+    SharedType(uint32_t _a) : a(_a) {}
+    ~SharedType() { ++shared_type_deleted; }
+    uint32_t a;
+};
+
+sparta::SpartaAtomicSharedPointerAllocator<MyType>     atomic_type_allocator(10, 10);
+sparta::SpartaAtomicSharedPointerAllocator<SharedType> shared_type_allocator(20000, 20000);
+
+void testAtomicSharedPointer()
+{
+    // Same semantics as the single-threaded pointer
+    my_type_deleted = 0;
+    {
+        sparta::SpartaAtomicSharedPointer<MyType> ptr(new MyType(5));
+        sparta::SpartaAtomicSharedPointer<MyType> ptr2 = ptr;
+        sparta::SpartaAtomicWeakPointer<MyType> wp = ptr;
+        EXPECT_EQUAL(ptr.use_count(), 2);
+        EXPECT_EQUAL(wp.use_count(), 2);
+        EXPECT_EQUAL(ptr2->a, 5);
+        ptr.reset();
+        ptr2.reset();
+        EXPECT_TRUE(wp.expired());
+        EXPECT_TRUE(wp.lock() == nullptr);
+        EXPECT_EQUAL(my_type_deleted, 1);
+
+        sparta::SpartaAtomicSharedPointer<DerivedType> dptr(new DerivedType(7));
+        sparta::SpartaAtomicSharedPointer<MyType> bptr = dptr;
+        EXPECT_EQUAL(bptr.use_count(), 2);
+    }
+    EXPECT_EQUAL(my_type_deleted, 2);
+
+    auto aptr = sparta::allocate_sparta_shared_pointer<MyType>(atomic_type_allocator, 30);
+    sparta::SpartaAtomicWeakPointer<MyType> awp = aptr;
+    EXPECT_EQUAL(aptr->a, 30);
+    EXPECT_TRUE(atomic_type_allocator.hasOutstandingObjects());
+    aptr.reset();
+    EXPECT_TRUE(awp.expired());
+    // The weak pointer still holds the block
+    EXPECT_TRUE(atomic_type_allocator.hasOutstandingObjects());
+    awp = sparta::SpartaAtomicWeakPointer<MyType>();
+    EXPECT_FALSE(atomic_type_allocator.hasOutstandingObjects());
+
+    // Objects allocated on one thread, copied by several, and
+    // released on whichever thread lets go last
+    constexpr uint32_t NUM_THREADS = 4;
+    constexpr uint32_t NUM_PTRS    = 2000;
+    constexpr uint32_t ITERATIONS  = 20;
+    for(uint32_t iter = 0; iter < ITERATIONS; ++iter)
+    {
+        std::vector<sparta::SpartaAtomicSharedPointer<SharedType>> ptrs;
+        for(uint32_t i = 0; i < NUM_PTRS; ++i) {
+            ptrs.emplace_back(sparta::allocate_sparta_shared_pointer<SharedType>(shared_type_allocator, i));
+        }
+
+        std::vector<std::thread> threads;
+        std::vector<uint32_t> errors(NUM_THREADS, 0);
+        std::atomic<uint32_t> num_copied{0};
+        for(uint32_t t = 0; t < NUM_THREADS; ++t)
+        {
+            threads.emplace_back([&ptrs, &errors, &num_copied, t]() {
+                std::vector<sparta::SpartaAtomicSharedPointer<SharedType>> copies(ptrs.begin(), ptrs.end());
+                std::vector<sparta::SpartaAtomicWeakPointer<SharedType>> weak(ptrs.begin(), ptrs.end());
+                ++num_copied;
+                for(uint32_t i = 0; i < NUM_PTRS; ++i) {
+                    if(weak[i].lock()->a != i) { ++errors[t]; }
+                }
+                // Allocate and release some of our own, recycling
+                // blocks released by the other threads
+                for(uint32_t i = 0; i < NUM_PTRS; ++i) {
+                    auto mine = sparta::allocate_sparta_shared_pointer<SharedType>(shared_type_allocator, i);
+                    copies[i] = mine;
+                    if(copies[i]->a != i) { ++errors[t]; }
+                }
+            });
+        }
+        // Let go of the originals while the threads are using them
+        while(num_copied != NUM_THREADS) {
+            std::this_thread::yield();
+        }
+        ptrs.clear();
+        // Look for leaks while the threads are still allocating
+        const auto outstanding = shared_type_allocator.getOutstandingAllocatedObjects();
+        EXPECT_TRUE(outstanding.size() <= shared_type_allocator.getNumAllocated());
+        for(auto & th : threads) {
+            th.join();
+        }
+        for(auto err : errors) {
+            EXPECT_EQUAL(err, 0);
+        }
+    }
+    EXPECT_EQUAL(shared_type_deleted, ITERATIONS * NUM_PTRS * (1 + NUM_THREADS));
+    EXPECT_FALSE(shared_type_allocator.hasOutstandingObjects());
+    // Exited threads gave their cached blocks back
+    EXPECT_EQUAL(shared_type_allocator.getNumFree(), shared_type_allocator.getNumAllocated());
+    // Free blocks sitting in other threads' caches can force a few
+    // extra allocations
+    EXPECT_TRUE(shared_type_allocator.getNumAllocated() <=
+                NUM_PTRS * (1 + NUM_THREADS) + NUM_THREADS * decltype(shared_type_allocator)::THREAD_CACHE_SIZE);
+
+    // The callbacks can query the allocator
+    sparta::SpartaAtomicSharedPointerAllocator<MyType> watched_allocator(4, 2);
+    size_t outstanding_at_watermark = 0;
+    watched_allocator.registerCustomWaterMarkCallback(
+        [&outstanding_at_watermark](const sparta::SpartaAtomicSharedPointerAllocator<MyType> & allocator) {
+            outstanding_at_watermark = allocator.getOutstandingAllocatedObjects().size();
+        });
+    std::vector<sparta::SpartaAtomicSharedPointer<MyType>> watched;
+    for(uint32_t i = 0; i < 4; ++i) {
+        watched.emplace_back(sparta::allocate_sparta_shared_pointer<MyType>(watched_allocator, i));
+    }
+    EXPECT_EQUAL(outstanding_at_watermark, 3);
+    EXPECT_EQUAL(watched_allocator.getOutstandingAllocatedObjects().size(), 4);
+}
+
 int main()
 {
     testBasicSpartaSharedPointer();
@@ -644,6 +765,7 @@ int main()
 
     testWeakPointer();
     testSelfReferentialWeakPointer();
+    testAtomicSharedPointer();
 
     for(uint32_t i = 0; i < 100; ++i) {
         testMemoryAllocation(i == 0, i == 0);
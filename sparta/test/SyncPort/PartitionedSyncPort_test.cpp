@@ -0,0 +1,295 @@
+
+
+// Tests SyncOutPort/SyncInPort pairs whose ends are on different
+// Schedulers, run by a sparta::PartitionedScheduler
+
+#include <inttypes.h>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "sparta/sparta.hpp"
+#include "sparta/kernel/PartitionedScheduler.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/events/Event.hpp"
+#include "sparta/events/EventSet.hpp"
+#include "sparta/ports/PortSet.hpp"
+#include "sparta/ports/SyncPort.hpp"
+#include "sparta/simulation/Clock.hpp"
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/utils/SpartaTester.hpp"
+
+TEST_INIT
+
+constexpr uint32_t SRC_PERIOD = 1000;
+constexpr uint32_t DST_PERIOD = 2500;
+constexpr sparta::Clock::Cycle DATA_DELAY = 2;
+constexpr sparta::Clock::Cycle ECHO_DELAY = 3;
+constexpr uint32_t NUM_ITEMS = 60;
+
+using Record = std::pair<sparta::Scheduler::Tick, uint32_t>;
+
+// A clock with a fixed period
+class PeriodClock : public sparta::Clock
+{
+public:
+    PeriodClock(const std::string & name, sparta::Scheduler * sched, uint32_t period) :
+        sparta::Clock(name, sched)
+    {
+        setPeriod(period);
+    }
+};
+
+// A TreeNode with a clock, for the ports and events below it
+class ClockedNode : public sparta::TreeNode
+{
+public:
+    ClockedNode(const std::string & name, sparta::Clock * clk) :
+        sparta::TreeNode(nullptr, name, "Unit")
+    {
+        setClock(clk);
+    }
+};
+
+// Sends items whenever the sink looks ready; an optional burst goes
+// out all at once on the first cycle
+class Source
+{
+public:
+    Source(sparta::Clock * clk, uint32_t burst) :
+        node("source", clk),
+        ps(&node),
+        es(&node),
+        out(&ps, "data_out", clk),
+        echo_in(&ps, "echo_in", clk),
+        burst_(burst),
+        end_(burst + NUM_ITEMS)
+    {
+        echo_in.setPortDelay(ECHO_DELAY);
+        echo_in.registerConsumerHandler(CREATE_SPARTA_HANDLER_WITH_DATA(Source, receiveEcho_, uint32_t));
+    }
+
+    void start() {
+        send_event_.schedule(1);
+    }
+
+    ClockedNode      node;
+    sparta::PortSet  ps;
+    sparta::EventSet es;
+    sparta::SyncOutPort<uint32_t> out;
+    sparta::SyncInPort<uint32_t>  echo_in;
+
+    std::vector<Record> echoes;
+
+private:
+    void send_()
+    {
+        for(; burst_ > 0; --burst_) {
+            out.sendAndAllowSlide(next_++);
+        }
+        if(next_ < end_ && out.isReady()) {
+            out.sendAndAllowSlide(next_, next_ % 4 == 3 ? 1 : 0);
+            ++next_;
+        }
+        if(next_ < end_) {
+            send_event_.schedule(1);
+        }
+    }
+
+    void receiveEcho_(const uint32_t & val) {
+        echoes.emplace_back(node.getClock()->currentTick(), val);
+    }
+
+    sparta::Event<> send_event_{&es, "send_event", CREATE_SPARTA_HANDLER(Source, send_)};
+    uint32_t next_ = 0;
+    uint32_t burst_;
+    const uint32_t end_;
+};
+
+// Receives items, echoes some back, and optionally drives not-ready
+// for a few cycles out of every 16
+class Sink
+{
+public:
+    Sink(sparta::Clock * clk, bool toggle_ready) :
+        node("sink", clk),
+        ps(&node),
+        es(&node),
+        in(&ps, "data_in", clk),
+        echo_out(&ps, "echo_out", clk),
+        toggle_ready_(toggle_ready)
+    {
+        in.setPortDelay(DATA_DELAY);
+        in.registerConsumerHandler(CREATE_SPARTA_HANDLER_WITH_DATA(Sink, receive_, uint32_t));
+    }
+
+    void start() {
+        if(toggle_ready_) {
+            ready_event_.schedule(1);
+        }
+    }
+
+    ClockedNode      node;
+    sparta::PortSet  ps;
+    sparta::EventSet es;
+    sparta::SyncInPort<uint32_t>  in;
+    sparta::SyncOutPort<uint32_t> echo_out;
+
+    std::vector<Record> received;
+
+    //! Cycles on which ready was changed, and to what
+    std::vector<std::pair<sparta::Clock::Cycle, bool>> ready_changes;
+
+private:
+    void receive_(const uint32_t & val)
+    {
+        received.emplace_back(node.getClock()->currentTick(), val);
+        if(val % 5 == 0) {
+            echo_out.sendAndAllowSlide(val);
+        }
+    }
+
+    void toggleReady_()
+    {
+        const sparta::Clock::Cycle cycle = node.getClock()->currentCycle();
+        if(cycle % 16 == 5 || cycle % 16 == 9) {
+            const bool ready = (cycle % 16 == 9);
+            in.setReady(ready);
+            ready_changes.emplace_back(cycle, ready);
+        }
+        if(cycle < 200) {
+            ready_event_.schedule(1);
+        }
+    }
+
+    sparta::Event<> ready_event_{&es, "ready_event", CREATE_SPARTA_HANDLER(Sink, toggleReady_)};
+    const bool toggle_ready_;
+};
+
+// A source and a sink, on one Scheduler or one each
+struct Model
+{
+    Model(bool partitioned, bool toggle_ready, uint32_t burst = 0) :
+        src_clk("src_clk", &sched0, SRC_PERIOD),
+        dst_clk("dst_clk", partitioned ? &sched1 : &sched0, DST_PERIOD),
+        source(&src_clk, burst),
+        sink(&dst_clk, toggle_ready)
+    {
+        sparta::bind(source.out, sink.in);
+        sparta::bind(sink.echo_out, source.echo_in);
+    }
+
+    void run(uint32_t num_partitions)
+    {
+        sparta::PartitionedScheduler psched;
+        psched.addPartition(&sched0);
+        if(num_partitions > 1) {
+            psched.addPartition(&sched1);
+        }
+        psched.finalize();
+        source.start();
+        sink.start();
+        psched.run();
+        num_windows = psched.getNumWindows();
+    }
+
+    sparta::Scheduler sched0{"sched0"};
+    sparta::Scheduler sched1{"sched1"};
+    PeriodClock src_clk;
+    PeriodClock dst_clk;
+    Source source;
+    Sink sink;
+    uint64_t num_windows = 0;
+};
+
+// Everything arrived once, in order, no more than one per cycle
+void checkReceived(const Sink & sink, uint32_t num_items)
+{
+    EXPECT_EQUAL(sink.received.size(), num_items);
+    for(uint32_t idx = 0; idx < sink.received.size(); ++idx) {
+        EXPECT_EQUAL(sink.received[idx].second, idx);
+        EXPECT_EQUAL(sink.received[idx].first % DST_PERIOD, 0);
+        if(idx > 0) {
+            EXPECT_TRUE(sink.received[idx].first > sink.received[idx - 1].first);
+        }
+    }
+}
+
+void testSameAsOneScheduler()
+{
+    // Without backpressure, data arrives on the same ticks as it does
+    // on one Scheduler, slides and all
+    for(uint32_t burst : {0u, 100u})
+    {
+        Model ref(false, false, burst);
+        ref.run(1);
+        EXPECT_TRUE(ref.sched0.getInboundLinks().empty());
+        checkReceived(ref.sink, NUM_ITEMS + burst);
+        EXPECT_FALSE(ref.source.echoes.empty());
+
+        Model m(true, false, burst);
+        // Data one way, credits the other, for each direction
+        EXPECT_EQUAL(m.sched0.getInboundLinks().size(), 2);
+        EXPECT_EQUAL(m.sched1.getInboundLinks().size(), 2);
+        m.run(2);
+        EXPECT_EQUAL(m.sink.received, ref.sink.received);
+        EXPECT_EQUAL(m.source.echoes, ref.source.echoes);
+        EXPECT_TRUE(m.num_windows > 1);
+    }
+}
+
+void testBackpressure()
+{
+    // With backpressure, the sender sees ready a port delay late, so
+    // the timing differs from one Scheduler.  It must still be the
+    // same on every run, and nothing may be delivered while not ready.
+    Model first(true, true);
+    first.run(2);
+    checkReceived(first.sink, NUM_ITEMS);
+    EXPECT_FALSE(first.sink.ready_changes.empty());
+
+    for(const Record & rec : first.sink.received) {
+        // Ready driven on cycle M applies from M+1
+        const sparta::Clock::Cycle cycle = rec.first / DST_PERIOD;
+        bool ready = true;
+        for(const auto & change : first.sink.ready_changes) {
+            if(change.first < cycle) {
+                ready = change.second;
+            }
+        }
+        if(!EXPECT_TRUE(ready)) {
+            std::cerr << "Delivered " << rec.second << " on not-ready cycle " << cycle << std::endl;
+        }
+    }
+
+    for(uint32_t i = 0; i < 3; ++i) {
+        Model m(true, true);
+        m.run(2);
+        EXPECT_EQUAL(m.sink.received, first.sink.received);
+        EXPECT_EQUAL(m.source.echoes, first.source.echoes);
+        EXPECT_EQUAL(m.sched0.getCurrentTick(), first.sched0.getCurrentTick());
+    }
+}
+
+void testErrors()
+{
+    // Cross-partition SyncInPorts need a delay
+    sparta::Scheduler sched0, sched1;
+    PeriodClock clk0("clk0", &sched0, SRC_PERIOD), clk1("clk1", &sched1, DST_PERIOD);
+    ClockedNode n0("n0", &clk0), n1("n1", &clk1);
+    sparta::PortSet ps0(&n0), ps1(&n1);
+    sparta::SyncOutPort<uint32_t> out(&ps0, "data_out", &clk0);
+    sparta::SyncInPort<uint32_t> in(&ps1, "data_in", &clk1);
+    EXPECT_THROW(sparta::bind(out, in));
+}
+
+int main()
+{
+    testSameAsOneScheduler();
+    testBackpressure();
+    testErrors();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
@@ -0,0 +1,126 @@
+/*
+ */
+#include "sparta/utils/SpartaTester.hpp"
+#include "sparta/utils/WideBitMask.hpp"
+
+#include <bitset>
+#include <random>
+#include <sstream>
+
+using namespace sparta::utils;
+
+TEST_INIT
+
+// Build the same random mask as a WideBitMask and a std::bitset
+template <uint32_t NumBits>
+static std::pair<WideBitMask<NumBits>, std::bitset<NumBits>> randomMasks(std::mt19937_64 & rng)
+{
+    WideBitMask<NumBits> mask;
+    std::bitset<NumBits> expected;
+    // Mostly sparse masks, some dense ones
+    const uint32_t density = rng() % 4;
+    for(uint32_t pos = 0; pos < NumBits; ++pos) {
+        const bool val = (density == 0) ? (rng() % 2) : ((rng() % (NumBits * density)) < 2);
+        mask[pos] = val;
+        expected[pos] = val;
+    }
+    return {mask, expected};
+}
+
+template <uint32_t NumBits>
+static bool sameBits(const WideBitMask<NumBits> & mask, const std::bitset<size_t(NumBits)> & expected)
+{
+    std::ostringstream mask_str;
+    mask_str << mask;
+    return mask_str.str() == expected.to_string();
+}
+
+template <uint32_t NumBits>
+static void testAgainstBitset()
+{
+    std::mt19937_64 rng(NumBits);
+    for(uint32_t i = 0; i < 500; ++i)
+    {
+        const auto [a, a_expected] = randomMasks<NumBits>(rng);
+        const auto [b, b_expected] = randomMasks<NumBits>(rng);
+
+        EXPECT_TRUE(sameBits(a, a_expected));
+        EXPECT_TRUE(sameBits(a & b, a_expected & b_expected));
+        EXPECT_TRUE(sameBits(a | b, a_expected | b_expected));
+        EXPECT_TRUE(sameBits(a ^ b, a_expected ^ b_expected));
+        EXPECT_TRUE(sameBits(~a, ~a_expected));
+        EXPECT_EQUAL(a.count(), a_expected.count());
+        EXPECT_EQUAL(a.any(), a_expected.any());
+        EXPECT_EQUAL(a.none(), a_expected.none());
+        EXPECT_EQUAL(a.all(), a_expected.all());
+        EXPECT_EQUAL(a == b, a_expected == b_expected);
+        EXPECT_EQUAL(a.containsAll(b), (a_expected & b_expected) == b_expected);
+        EXPECT_EQUAL(a.containsAll(a & b), true);
+        EXPECT_EQUAL(a.intersects(b), (a_expected & b_expected).any());
+
+        auto c = a;
+        c |= b;
+        EXPECT_TRUE(sameBits(c, a_expected | b_expected));
+        c &= b;
+        EXPECT_TRUE(c == b);
+        c ^= b;
+        EXPECT_TRUE(c.none());
+
+        // Walk the set bits
+        size_t num_found = 0;
+        for(size_t pos = a.findFirst(); pos < a.size(); pos = a.findNext(pos)) {
+            EXPECT_TRUE(a_expected.test(pos));
+            ++num_found;
+        }
+        EXPECT_EQUAL(num_found, a_expected.count());
+    }
+
+    // Single bits, at word edges and the ends
+    for(const uint32_t pos : {0u, 1u, 63u, 64u, NumBits - 64, NumBits - 1})
+    {
+        if(pos >= NumBits) {
+            continue;
+        }
+        WideBitMask<NumBits> mask;
+        EXPECT_TRUE(mask.none());
+        EXPECT_EQUAL(mask.findFirst(), NumBits);
+        mask.set(pos);
+        EXPECT_TRUE(mask.any());
+        EXPECT_TRUE(mask.test(pos));
+        EXPECT_EQUAL(mask.count(), 1);
+        EXPECT_EQUAL(mask.findFirst(), pos);
+        EXPECT_EQUAL(mask.findNext(pos), NumBits);
+        EXPECT_EQUAL(mask.getWord(pos / 64), 1ull << (pos % 64));
+        mask.reset(pos);
+        EXPECT_TRUE(mask.none());
+    }
+
+    WideBitMask<NumBits> all;
+    all.set();
+    EXPECT_TRUE(all.all());
+    EXPECT_EQUAL(all.count(), NumBits);
+    all[NumBits - 1] = false;
+    EXPECT_FALSE(all.all());
+    EXPECT_TRUE(all.any());
+    all.reset();
+    EXPECT_TRUE(all.none());
+
+    // Construction from the low word, like std::bitset
+    const WideBitMask<NumBits> low(0b1011);
+    EXPECT_TRUE(sameBits(low, std::bitset<NumBits>(0b1011)));
+    EXPECT_TRUE(low[3]);
+    EXPECT_FALSE(low[2]);
+    EXPECT_THROW(low.test(NumBits));
+}
+
+int main()
+{
+    testAgainstBitset<64>();
+    testAgainstBitset<128>();
+    testAgainstBitset<192>();
+    testAgainstBitset<512>();
+    testAgainstBitset<1024>();
+
+    REPORT_ERROR;
+    return ERROR_CODE;
+}
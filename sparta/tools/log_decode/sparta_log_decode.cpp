@@ -0,0 +1,144 @@
+// <sparta_log_decode> -*- C++ -*-
+
+
+/*!
+ * \file sparta_log_decode.cpp
+ * \brief Converts a binary log (a --log destination ending in ".log.bin")
+ * back to one of the text log formats, optionally selecting messages by
+ * location, category and tick range.
+ *
+ * \code
+ * sparta_log_decode run.log.bin
+ * sparta_log_decode run.log.bin --location 'top.core0.*' --start 10000 --end 20000
+ * sparta_log_decode run.log.bin --category debug -o core0.log.verbose
+ * \endcode
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "sparta/log/BinaryLog.hpp"
+#include "sparta/log/Destination.hpp"
+#include "sparta/utils/SpartaException.hpp"
+
+namespace po = boost::program_options;
+
+int main(int argc, char** argv)
+{
+    std::string input;
+    std::string output;
+    std::string format;
+    std::vector<std::string> locations;
+    std::vector<std::string> categories;
+    uint64_t start = 0;
+    uint64_t end = std::numeric_limits<uint64_t>::max();
+
+    po::options_description opts("sparta_log_decode [options] LOG.log.bin\n\n"
+                                 "Converts a binary log to text. Options");
+    opts.add_options()
+        ("help,h", "Show this help")
+        ("output,o", po::value<std::string>(&output),
+         "Write to this file instead of stdout. Its extension selects the format, as with "
+         "--log destinations")
+        ("format,f", po::value<std::string>(&format),
+         "Format when writing to stdout: default, basic, verbose or raw")
+        ("location,l", po::value<std::vector<std::string>>(&locations)->composing(),
+         "Only messages from nodes matching this location pattern, or their subtrees. "
+         "May be given more than once")
+        ("category,c", po::value<std::vector<std::string>>(&categories)->composing(),
+         "Only messages whose category matches this pattern. May be given more than once")
+        ("start", po::value<uint64_t>(&start), "Only messages logged at or after this tick")
+        ("end", po::value<uint64_t>(&end), "Only messages logged at or before this tick")
+        ("no-header", "Do not write the simulation information header")
+        ;
+    po::options_description hidden;
+    hidden.add_options()
+        ("input", po::value<std::string>(&input), "Binary log");
+    po::options_description all;
+    all.add(opts).add(hidden);
+    po::positional_options_description positional;
+    positional.add("input", 1);
+
+    po::variables_map vm;
+    try{
+        po::store(po::command_line_parser(argc, argv).options(all).positional(positional).run(), vm);
+        po::notify(vm);
+    }catch(const po::error& e){
+        std::cerr << e.what() << "\n\n" << opts << std::endl;
+        return 1;
+    }
+    if(vm.count("help") || input.empty()){
+        std::cout << opts << "\nFormats by output file extension:\n";
+        sparta::log::DestinationManager::dumpFileExtensions(std::cout, true);
+        return vm.count("help") ? 0 : 1;
+    }
+
+    try{
+        std::ifstream in(input, std::ios::binary);
+        if(!in){
+            throw sparta::SpartaException("Could not open \"") << input << "\"";
+        }
+        // Large reads; the log is read once front to back
+        std::vector<char> in_buf(1 << 20);
+        in.rdbuf()->pubsetbuf(in_buf.data(), in_buf.size());
+
+        std::ofstream out_file;
+        std::ostream* out = &std::cout;
+        std::string fmt_name = output;
+        if(!output.empty()){
+            out_file.open(output);
+            if(!out_file){
+                throw sparta::SpartaException("Could not open \"") << output << "\" for writing";
+            }
+            out = &out_file;
+        }else if(!format.empty() && format != "default"){
+            fmt_name = ".log." + format;
+        }
+        const sparta::log::Formatter::Info* fmtinfo = sparta::log::Formatter::findInfo(fmt_name);
+        if(!format.empty() && format != "default" && fmtinfo->extension == nullptr){
+            throw sparta::SpartaException("Unknown format \"") << format << "\"";
+        }
+        std::unique_ptr<sparta::log::Formatter> formatter(fmtinfo->factory(*out));
+        if(dynamic_cast<sparta::log::BinaryFormatter*>(formatter.get())){
+            throw sparta::SpartaException("Output must be a text format, not \"") << output << "\"";
+        }
+
+        sparta::log::BinaryLogFilter filter;
+        for(const auto& l : locations){
+            filter.addLocation(l);
+        }
+        for(const auto& c : categories){
+            filter.addCategory(c);
+        }
+        filter.setTickRange(start, end);
+
+        sparta::log::BinaryLogReader reader(in);
+        bool header_written = vm.count("no-header") != 0;
+        while(reader.next()){
+            if(!header_written){
+                // The header is at the start of the log
+                *out << reader.getHeader();
+                header_written = true;
+            }
+            if(filter.matches(reader)){
+                formatter->writeFields(reader.getMessage());
+            }
+        }
+        if(!header_written){
+            *out << reader.getHeader();
+        }
+        out->flush();
+    }catch(const std::exception& e){
+        std::cerr << "sparta_log_decode: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}